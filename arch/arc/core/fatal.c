@@ -16,6 +16,7 @@
 #include <offsets_short.h>
 #include <toolchain.h>
 #include <arch/cpu.h>
+#include <drivers/console/uart_console.h>
 
 #ifdef CONFIG_PRINTK
 #include <misc/printk.h>
@@ -46,6 +47,9 @@ const NANO_ESF _default_esf = {
 FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
 							const NANO_ESF *pEsf)
 {
+	/* report the error with the console busy waiting */
+	uart_console_panic();
+
 	switch (reason) {
 	case _NANO_ERR_INVALID_TASK_EXIT:
 		PR_EXC("***** Invalid Exit Software Error! *****\n");
@@ -17,6 +17,7 @@
 
 #include <kernel.h>
 #include <kernel_structs.h>
+#include <drivers/console/uart_console.h>
 
 #ifdef CONFIG_PRINTK
 #include <misc/printk.h>
@@ -69,6 +70,9 @@ const NANO_ESF _default_esf = {
 FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
 					  const NANO_ESF *pEsf)
 {
+	/* report the error with the console busy waiting */
+	uart_console_panic();
+
 	switch (reason) {
 	case _NANO_ERR_INVALID_TASK_EXIT:
 		PR_EXC("***** Invalid Exit Software Error! *****\n");
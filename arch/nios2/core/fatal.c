@@ -8,6 +8,7 @@
 #include <arch/cpu.h>
 #include <kernel_structs.h>
 #include <misc/printk.h>
+#include <drivers/console/uart_console.h>
 #include <inttypes.h>
 
 const NANO_ESF _default_esf = {
@@ -50,6 +51,9 @@ const NANO_ESF _default_esf = {
 FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
 					  const NANO_ESF *esf)
 {
+	/* report the error with the console busy waiting */
+	uart_console_panic();
+
 #ifdef CONFIG_PRINTK
 	switch (reason) {
 	case _NANO_ERR_CPU_EXCEPTION:
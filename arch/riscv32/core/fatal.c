@@ -8,6 +8,7 @@
 #include <arch/cpu.h>
 #include <kernel_structs.h>
 #include <inttypes.h>
+#include <drivers/console/uart_console.h>
 
 #ifdef CONFIG_PRINTK
 #include <misc/printk.h>
@@ -67,6 +68,9 @@ const NANO_ESF _default_esf = {
 FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
 					  const NANO_ESF *esf)
 {
+	/* report the error with the console busy waiting */
+	uart_console_panic();
+
 	switch (reason) {
 	case _NANO_ERR_CPU_EXCEPTION:
 	case _NANO_ERR_SPURIOUS_INT:
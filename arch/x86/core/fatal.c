@@ -17,6 +17,7 @@
 #include <kernel.h>
 #include <kernel_structs.h>
 #include <misc/printk.h>
+#include <drivers/console/uart_console.h>
 #include <arch/x86/irq_controller.h>
 #include <arch/x86/segmentation.h>
 #include <exception.h>
@@ -61,6 +62,9 @@ const NANO_ESF _default_esf = {
 FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
 					  const NANO_ESF *pEsf)
 {
+	/* report the error with the console busy waiting */
+	uart_console_panic();
+
 	_debug_fatal_hook(pEsf);
 
 #ifdef CONFIG_PRINTK
@@ -9,6 +9,7 @@
 #include <inttypes.h>
 #include <kernel_arch_data.h>
 #include <misc/printk.h>
+#include <drivers/console/uart_console.h>
 #include <xtensa/specreg.h>
 
 const NANO_ESF _default_esf = {
@@ -47,6 +48,9 @@ const NANO_ESF _default_esf = {
 FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
 					  const NANO_ESF *pEsf)
 {
+	/* report the error with the console busy waiting */
+	uart_console_panic();
+
 	switch (reason) {
 	case _NANO_ERR_HW_EXCEPTION:
 	case _NANO_ERR_RESERVED_IRQ:
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Private API for ADC drivers: continuous sampling buffer ring
+ *
+ * Drivers fill the buffer returned by these helpers and report it full
+ * from their ISR, the helpers hand it to the application and track which
+ * buffers of the ring the application gave back, the overruns and the
+ * samples lost during them.
+ */
+
+#ifndef __ADC_CONTINUOUS_H__
+#define __ADC_CONTINUOUS_H__
+
+#include <kernel.h>
+#include <string.h>
+#include <adc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct adc_continuous {
+	struct device *dev;
+	struct adc_continuous_cfg cfg;
+	struct adc_continuous_stats stats;
+
+	/* one bit per buffer the driver may fill */
+	uint32_t free;
+	/* buffer being filled, or waited for during an overrun */
+	uint8_t index;
+	bool filling;
+	bool active;
+};
+
+static inline int adc_continuous_setup(struct adc_continuous *ctx,
+				       struct device *dev,
+				       const struct adc_continuous_cfg *cfg)
+{
+	uint8_t i;
+
+	if (!cfg->buffers || cfg->buffer_count < 2 ||
+	    cfg->buffer_count > 32 || !cfg->buffer_length ||
+	    !cfg->interval_us || !cfg->callback) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < cfg->buffer_count; i++) {
+		if (!cfg->buffers[i]) {
+			return -EINVAL;
+		}
+	}
+
+	ctx->dev = dev;
+	ctx->cfg = *cfg;
+	memset(&ctx->stats, 0, sizeof(ctx->stats));
+
+	/* the first buffer is being filled, the others wait their turn */
+	ctx->free = (uint32_t)(((uint64_t)1 << cfg->buffer_count) - 1) &
+		    ~BIT(0);
+	ctx->index = 0;
+	ctx->filling = true;
+	ctx->active = true;
+
+	return 0;
+}
+
+/* buffer to fill, NULL during an overrun */
+static inline uint8_t *adc_continuous_buffer(struct adc_continuous *ctx)
+{
+	return ctx->filling ? ctx->cfg.buffers[ctx->index] : NULL;
+}
+
+/*
+ * End an overrun once the application released the buffer sampling waits
+ * for. Returns the buffer to fill, NULL while the overrun lasts.
+ */
+static inline uint8_t *adc_continuous_resume(struct adc_continuous *ctx)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (!ctx->filling && (ctx->free & BIT(ctx->index))) {
+		ctx->free &= ~BIT(ctx->index);
+		ctx->filling = true;
+	}
+
+	irq_unlock(key);
+
+	return adc_continuous_buffer(ctx);
+}
+
+/*
+ * Hand the full buffer to the application and move to the next one of the
+ * ring. Returns the buffer to fill next, NULL if the application still
+ * holds it, which starts an overrun.
+ */
+static inline uint8_t *adc_continuous_done(struct adc_continuous *ctx)
+{
+	uint8_t *buffer = ctx->cfg.buffers[ctx->index];
+
+	ctx->stats.buffers++;
+	ctx->index = (ctx->index + 1) % ctx->cfg.buffer_count;
+	ctx->filling = false;
+
+	ctx->cfg.callback(ctx->dev, buffer, ctx->cfg.buffer_length,
+			  ctx->cfg.user_data);
+
+	if (!adc_continuous_resume(ctx)) {
+		ctx->stats.overruns++;
+		return NULL;
+	}
+
+	return adc_continuous_buffer(ctx);
+}
+
+/* samples taken during an overrun, with nowhere to store them */
+static inline void adc_continuous_lost(struct adc_continuous *ctx,
+				       uint32_t samples)
+{
+	ctx->stats.samples_lost += samples;
+}
+
+static inline int adc_continuous_release(struct adc_continuous *ctx,
+					 uint8_t *buffer)
+{
+	unsigned int key;
+	uint8_t i;
+	int ret = -EINVAL;
+
+	key = irq_lock();
+
+	for (i = 0; i < ctx->cfg.buffer_count; i++) {
+		if (ctx->cfg.buffers[i] != buffer) {
+			continue;
+		}
+
+		/* only a buffer the application holds can be released */
+		if (!(ctx->free & BIT(i)) &&
+		    !(ctx->filling && i == ctx->index)) {
+			ctx->free |= BIT(i);
+			ret = 0;
+		}
+		break;
+	}
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+static inline void adc_continuous_stats_copy(struct adc_continuous *ctx,
+					     struct adc_continuous_stats *stats)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	*stats = ctx->stats;
+	irq_unlock(key);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ADC_CONTINUOUS_H__ */
@@ -20,6 +20,11 @@
 #include "qm_adc.h"
 #include "clk.h"
 
+#if defined(CONFIG_ADC_CONTINUOUS) && defined(CONFIG_ADC_QMSI_INTERRUPT)
+#define ADC_QMSI_CONTINUOUS
+#include "adc_continuous.h"
+#endif
+
 enum {
 	ADC_STATE_IDLE,
 	ADC_STATE_BUSY,
@@ -215,10 +220,157 @@ static int adc_qmsi_read(struct device *dev, struct adc_seq_table *seq_tbl)
 }
 #endif /* CONFIG_ADC_QMSI_POLL */
 
+#ifdef ADC_QMSI_CONTINUOUS
+/* a conversion takes as many ADC clock cycles as bits, plus 2 */
+#define ADC_MIN_WINDOW	(6 + 2 * CONFIG_ADC_QMSI_SAMPLE_WIDTH + 2)
+#define ADC_MAX_WINDOW	255
+
+static struct adc_continuous cont_ctx;
+static qm_adc_xfer_t cont_xfer;
+static qm_adc_channel_t cont_channel;
+
+/* where the samples go while the application holds the next buffer */
+static qm_adc_sample_t cont_discard[QM_ADC_FIFO_LEN];
+
+/*
+ * Conversions are chained from the completion callback, the hardware
+ * keeps its sampling window between the samples of a buffer and the next
+ * conversion starts right after the last sample is read.
+ */
+static void continuous_convert(void)
+{
+	uint8_t *buffer = adc_continuous_buffer(&cont_ctx);
+
+	if (buffer) {
+		cont_xfer.samples = (qm_adc_sample_t *)buffer;
+		cont_xfer.samples_len = cont_ctx.cfg.buffer_length /
+					sizeof(qm_adc_sample_t);
+	} else {
+		cont_xfer.samples = cont_discard;
+		cont_xfer.samples_len = ARRAY_SIZE(cont_discard);
+	}
+
+	qm_adc_irq_convert(QM_ADC_0, &cont_xfer);
+}
+
+static void continuous_callback(void *data, int error,
+				qm_adc_status_t status,
+				qm_adc_cb_source_t source)
+{
+	struct adc_info *info = data;
+
+	if (!cont_ctx.active) {
+		/* stopped, the ADC is free once the last conversion ends */
+		adc_unlock(info);
+		return;
+	}
+
+	if (error) {
+		/*
+		 * the FIFO overflowed, the samples of the buffer are not
+		 * contiguous anymore: fill it again from the start
+		 */
+		cont_ctx.stats.overruns++;
+	} else if (cont_xfer.samples == cont_discard) {
+		adc_continuous_lost(&cont_ctx, ARRAY_SIZE(cont_discard));
+		adc_continuous_resume(&cont_ctx);
+	} else {
+		adc_continuous_done(&cont_ctx);
+	}
+
+	continuous_convert();
+}
+
+static int adc_qmsi_continuous_start(struct device *dev,
+				     const struct adc_continuous_cfg *config)
+{
+	struct adc_info *info = dev->driver_data;
+	uint64_t window;
+	int ret;
+
+	/* the ADC clock is the peripheral clock divided by the clock ratio */
+	window = (uint64_t)config->interval_us * sys_clock_hw_cycles_per_sec /
+		 CONFIG_ADC_QMSI_CLOCK_RATIO / USEC_PER_SEC;
+	if (window < ADC_MIN_WINDOW || window > ADC_MAX_WINDOW ||
+	    config->buffer_length % sizeof(qm_adc_sample_t)) {
+		return -EINVAL;
+	}
+
+	if (k_sem_take(&info->sem, K_NO_WAIT)) {
+		return -EBUSY;
+	}
+	info->state = ADC_STATE_BUSY;
+
+	cfg.window = window;
+	if (qm_adc_set_config(QM_ADC_0, &cfg) != 0) {
+		adc_unlock(info);
+		return -EINVAL;
+	}
+
+	ret = adc_continuous_setup(&cont_ctx, dev, config);
+	if (ret) {
+		adc_unlock(info);
+		return ret;
+	}
+
+	cont_channel = config->channel_id;
+	cont_xfer.ch = &cont_channel;
+	cont_xfer.ch_len = 1;
+	cont_xfer.callback = continuous_callback;
+	cont_xfer.callback_data = info;
+
+	continuous_convert();
+
+	return 0;
+}
+
+static int adc_qmsi_continuous_stop(struct device *dev)
+{
+	unsigned int key;
+	int ret = 0;
+
+	ARG_UNUSED(dev);
+
+	/* the conversion in progress ends on its own, see the callback */
+	key = irq_lock();
+	if (cont_ctx.active) {
+		cont_ctx.active = false;
+	} else {
+		ret = -EALREADY;
+	}
+	irq_unlock(key);
+
+	return ret;
+}
+
+static int adc_qmsi_buffer_release(struct device *dev, uint8_t *buffer)
+{
+	ARG_UNUSED(dev);
+
+	return adc_continuous_release(&cont_ctx, buffer);
+}
+
+static int adc_qmsi_continuous_stats(struct device *dev,
+				     struct adc_continuous_stats *stats)
+{
+	ARG_UNUSED(dev);
+
+	adc_continuous_stats_copy(&cont_ctx, stats);
+
+	return 0;
+}
+#endif /* ADC_QMSI_CONTINUOUS */
+
 static const struct adc_driver_api api_funcs = {
 	.enable  = adc_qmsi_enable,
 	.disable = adc_qmsi_disable,
 	.read    = adc_qmsi_read,
+#ifdef ADC_QMSI_CONTINUOUS
+	.continuous_start = adc_qmsi_continuous_start,
+	.continuous_stop = adc_qmsi_continuous_stop,
+	.buffer_release = adc_qmsi_buffer_release,
+	.continuous_stats = adc_qmsi_continuous_stats,
+#endif
 };
 
 static int adc_qmsi_init(struct device *dev)
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief ADC emulated in software
+ *
+ * Each sample is the number of samples taken before it, truncated to 16
+ * bits, so that gaps and reordering show in the data. Continuous sampling
+ * runs from a kernel timer: each expiry takes the samples due since the
+ * previous one, which keeps the sampling interval exact on average even
+ * though the timer only runs at the system tick rate.
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <adc.h>
+
+#include "adc_continuous.h"
+
+struct adc_sim_data {
+	struct adc_continuous ctx;
+	struct k_timer timer;
+	/* interval between two samples, in hardware clock cycles */
+	uint32_t interval;
+	/* when the last sample was taken */
+	uint32_t last;
+	/* samples already in the buffer being filled */
+	uint32_t offset;
+	uint16_t seq;
+};
+
+static void adc_sim_enable(struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static void adc_sim_disable(struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static int adc_sim_read(struct device *dev, struct adc_seq_table *seq_tbl)
+{
+	struct adc_sim_data *data = dev->driver_data;
+	uint16_t *samples;
+	uint32_t i, j;
+
+	if (data->ctx.active) {
+		return -EBUSY;
+	}
+
+	for (i = 0; i < seq_tbl->num_entries; i++) {
+		samples = (uint16_t *)seq_tbl->entries[i].buffer;
+
+		for (j = 0; j < seq_tbl->entries[i].buffer_length / 2; j++) {
+			samples[j] = data->seq++;
+		}
+	}
+
+	return 0;
+}
+
+static void adc_sim_sample(struct adc_sim_data *data, uint32_t count)
+{
+	struct adc_continuous *ctx = &data->ctx;
+	uint32_t per_buffer = ctx->cfg.buffer_length / 2;
+	uint16_t *samples;
+	uint32_t n;
+
+	while (count) {
+		samples = (uint16_t *)adc_continuous_resume(ctx);
+		if (!samples) {
+			/* the samples are taken all the same */
+			adc_continuous_lost(ctx, count);
+			data->seq += count;
+			return;
+		}
+
+		n = min(count, per_buffer - data->offset);
+		count -= n;
+
+		for (samples += data->offset; n; n--) {
+			*samples++ = data->seq++;
+			data->offset++;
+		}
+
+		if (data->offset == per_buffer) {
+			data->offset = 0;
+			adc_continuous_done(ctx);
+		}
+	}
+}
+
+static void adc_sim_tick(struct k_timer *timer)
+{
+	struct adc_sim_data *data = CONTAINER_OF(timer, struct adc_sim_data,
+						 timer);
+	uint32_t due;
+
+	due = (k_cycle_get_32() - data->last) / data->interval;
+	data->last += due * data->interval;
+
+	adc_sim_sample(data, due);
+}
+
+static int adc_sim_continuous_start(struct device *dev,
+				    const struct adc_continuous_cfg *cfg)
+{
+	struct adc_sim_data *data = dev->driver_data;
+	uint64_t interval;
+	int ret;
+
+	if (data->ctx.active) {
+		return -EBUSY;
+	}
+
+	interval = (uint64_t)cfg->interval_us * sys_clock_hw_cycles_per_sec /
+		   USEC_PER_SEC;
+	if (!interval || interval > UINT32_MAX || cfg->buffer_length % 2) {
+		return -EINVAL;
+	}
+
+	ret = adc_continuous_setup(&data->ctx, dev, cfg);
+	if (ret) {
+		return ret;
+	}
+
+	data->interval = interval;
+	data->offset = 0;
+	data->last = k_cycle_get_32();
+
+	k_timer_start(&data->timer, K_MSEC(1), K_MSEC(1));
+
+	return 0;
+}
+
+static int adc_sim_continuous_stop(struct device *dev)
+{
+	struct adc_sim_data *data = dev->driver_data;
+
+	if (!data->ctx.active) {
+		return -EALREADY;
+	}
+
+	k_timer_stop(&data->timer);
+	data->ctx.active = false;
+
+	return 0;
+}
+
+static int adc_sim_buffer_release(struct device *dev, uint8_t *buffer)
+{
+	struct adc_sim_data *data = dev->driver_data;
+
+	return adc_continuous_release(&data->ctx, buffer);
+}
+
+static int adc_sim_continuous_stats(struct device *dev,
+				    struct adc_continuous_stats *stats)
+{
+	struct adc_sim_data *data = dev->driver_data;
+
+	adc_continuous_stats_copy(&data->ctx, stats);
+
+	return 0;
+}
+
+static const struct adc_driver_api adc_sim_api = {
+	.enable = adc_sim_enable,
+	.disable = adc_sim_disable,
+	.read = adc_sim_read,
+	.continuous_start = adc_sim_continuous_start,
+	.continuous_stop = adc_sim_continuous_stop,
+	.buffer_release = adc_sim_buffer_release,
+	.continuous_stats = adc_sim_continuous_stats,
+};
+
+static int adc_sim_init(struct device *dev)
+{
+	struct adc_sim_data *data = dev->driver_data;
+
+	k_timer_init(&data->timer, adc_sim_tick, NULL);
+
+	return 0;
+}
+
+static struct adc_sim_data adc_sim_dev_data;
+
+DEVICE_AND_API_INIT(adc_sim, CONFIG_ADC_0_NAME, &adc_sim_init,
+		    &adc_sim_dev_data, NULL, POST_KERNEL,
+		    CONFIG_ADC_INIT_PRIORITY, &adc_sim_api);
@@ -10,7 +10,8 @@
  *
  *
  * Serial console driver.
- * Hooks into the printk and fputc (for printf) modules. Poll driven.
+ * Hooks into the printk and fputc (for printf) modules. Poll driven, or
+ * buffered and interrupt driven with CONFIG_UART_CONSOLE_BUFFERED.
  */
 
 #include <kernel.h>
@@ -20,6 +21,7 @@
 #include <stdint.h>
 #include <errno.h>
 #include <ctype.h>
+#include <string.h>
 
 #include <device.h>
 #include <init.h>
@@ -32,6 +34,7 @@
 #include <sections.h>
 #include <atomic.h>
 #include <misc/printk.h>
+#include <debug/perf_counter.h>
 
 static struct device *uart_console_dev;
 
@@ -59,6 +62,222 @@ void uart_console_out_debug_hook_install(uart_console_out_debug_hook_t *hook)
 
 #endif /* CONFIG_UART_CONSOLE_DEBUG_SERVER_HOOKS */
 
+#ifdef CONFIG_UART_CONSOLE_BUFFERED
+
+#define TX_BUF_SIZE CONFIG_UART_CONSOLE_TX_BUF_SIZE
+
+BUILD_ASSERT((TX_BUF_SIZE & (TX_BUF_SIZE - 1)) == 0);
+
+/*
+ * Characters are added at the head with interrupts locked, and taken from
+ * the tail by the transmit interrupt, or by a flush with interrupts locked.
+ */
+static uint8_t tx_buf[TX_BUF_SIZE];
+static uint32_t tx_head;
+static uint32_t tx_tail;
+
+static uint32_t tx_dropped;
+static bool tx_panic;
+
+/* given by the transmit interrupt when a writer waits for room */
+static K_SEM_DEFINE(tx_space, 0, 1);
+static bool tx_waiting;
+
+/**
+ *
+ * @brief Buffer characters for output
+ *
+ * Either all the characters are buffered, or none and they are counted as
+ * dropped, for a line feed not to lose its carriage return.
+ *
+ * @param data Characters to output
+ * @param len Number of characters
+ *
+ * @return N/A
+ */
+static void tx_put(const uint8_t *data, uint32_t len)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (TX_BUF_SIZE - (tx_head - tx_tail) < len) {
+		tx_dropped += len;
+		irq_unlock(key);
+		return;
+	}
+
+	while (len-- > 0) {
+		tx_buf[tx_head++ & (TX_BUF_SIZE - 1)] = *data++;
+	}
+
+	uart_irq_tx_enable(uart_console_dev);
+
+	irq_unlock(key);
+}
+
+/**
+ *
+ * @brief Buffer characters for output, waiting for room
+ *
+ * Buffers what fits, and waits for the transmit interrupt to make room for
+ * the rest. Must be called from a thread.
+ *
+ * @param data Characters to output
+ * @param len Number of characters
+ *
+ * @return N/A
+ */
+static void tx_put_wait(const uint8_t *data, uint32_t len)
+{
+	unsigned int key;
+	uint32_t room;
+
+	while (len) {
+		key = irq_lock();
+
+		room = TX_BUF_SIZE - (tx_head - tx_tail);
+		if (!room) {
+			tx_waiting = true;
+			irq_unlock(key);
+			k_sem_take(&tx_space, K_FOREVER);
+			continue;
+		}
+
+		room = min(room, len);
+		len -= room;
+
+		while (room-- > 0) {
+			tx_buf[tx_head++ & (TX_BUF_SIZE - 1)] = *data++;
+		}
+
+		uart_irq_tx_enable(uart_console_dev);
+
+		irq_unlock(key);
+	}
+}
+
+static void console_tx_isr(void)
+{
+	uint32_t len;
+
+	if (!uart_irq_tx_ready(uart_console_dev)) {
+		return;
+	}
+
+	/* fill the FIFO with what is buffered, up to the end of the ring */
+	len = min(tx_head - tx_tail,
+		  TX_BUF_SIZE - (tx_tail & (TX_BUF_SIZE - 1)));
+	if (len) {
+		tx_tail += uart_fifo_fill(uart_console_dev,
+					  &tx_buf[tx_tail & (TX_BUF_SIZE - 1)],
+					  len);
+	}
+
+	if (tx_waiting && tx_head - tx_tail < TX_BUF_SIZE) {
+		tx_waiting = false;
+		k_sem_give(&tx_space);
+	}
+
+	if (tx_tail == tx_head) {
+		uart_irq_tx_disable(uart_console_dev);
+	}
+}
+
+void uart_console_flush(void)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	uart_irq_tx_disable(uart_console_dev);
+
+	while (tx_tail != tx_head) {
+		uart_poll_out(uart_console_dev,
+			      tx_buf[tx_tail++ & (TX_BUF_SIZE - 1)]);
+	}
+
+	irq_unlock(key);
+}
+
+void uart_console_panic(void)
+{
+	tx_panic = true;
+
+	uart_console_flush();
+}
+
+uint32_t uart_console_dropped(void)
+{
+	return tx_dropped;
+}
+
+PERF_COUNTER_EXPORT(uart_console_dropped, uart_console_dropped);
+
+void uart_console_write(const char *data, size_t len)
+{
+	void (*put)(const uint8_t *data, uint32_t len);
+	const char *end = data + len;
+	const char *lf;
+
+	if (tx_panic) {
+		for (; data < end; data++) {
+			if (*data == '\n') {
+				uart_poll_out(uart_console_dev, '\r');
+			}
+			uart_poll_out(uart_console_dev, *data);
+		}
+		return;
+	}
+
+	/* an interrupt can not wait, the characters are dropped instead */
+	put = k_is_in_isr() ? tx_put : tx_put_wait;
+
+	while (data < end) {
+		lf = memchr(data, '\n', end - data);
+		if (!lf) {
+			lf = end;
+		}
+
+		put((const uint8_t *)data, lf - data);
+
+		if (lf < end) {
+			put((const uint8_t *)"\r\n", 2);
+		}
+
+		data = lf + 1;
+	}
+}
+
+#if !defined(CONFIG_CONSOLE_HANDLER)
+static void uart_console_isr(struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	while (uart_irq_update(uart_console_dev) &&
+	       uart_irq_is_pending(uart_console_dev)) {
+		console_tx_isr();
+	}
+}
+#endif
+
+/* echo input through the buffer, not to overtake buffered output */
+static inline void console_echo(uint8_t c)
+{
+	if (tx_panic) {
+		uart_poll_out(uart_console_dev, c);
+	} else {
+		tx_put(&c, 1);
+	}
+}
+
+#else
+static inline void console_echo(uint8_t c)
+{
+	uart_poll_out(uart_console_dev, c);
+}
+#endif /* CONFIG_UART_CONSOLE_BUFFERED */
+
 #if 0 /* NOTUSED */
 /**
  *
@@ -103,6 +322,20 @@ static int console_out(int c)
 
 #endif /* CONFIG_UART_CONSOLE_DEBUG_SERVER_HOOKS */
 
+#ifdef CONFIG_UART_CONSOLE_BUFFERED
+	if (!tx_panic) {
+		uint8_t crlf[2] = { '\r', c };
+
+		if ('\n' == c) {
+			tx_put(crlf, 2);
+		} else {
+			tx_put(&crlf[1], 1);
+		}
+
+		return c;
+	}
+#endif
+
 	if ('\n' == c) {
 		uart_poll_out(uart_console_dev, '\r');
 	}
@@ -188,7 +421,7 @@ static void insert_char(char *pos, char c, uint8_t end)
 	char tmp;
 
 	/* Echo back to console */
-	uart_poll_out(uart_console_dev, c);
+	console_echo(c);
 
 	if (end == 0) {
 		*pos = c;
@@ -201,7 +434,7 @@ static void insert_char(char *pos, char c, uint8_t end)
 	cursor_save();
 
 	while (end-- > 0) {
-		uart_poll_out(uart_console_dev, tmp);
+		console_echo(tmp);
 		c = *pos;
 		*(pos++) = tmp;
 		tmp = c;
@@ -213,11 +446,11 @@ static void insert_char(char *pos, char c, uint8_t end)
 
 static void del_char(char *pos, uint8_t end)
 {
-	uart_poll_out(uart_console_dev, '\b');
+	console_echo('\b');
 
 	if (end == 0) {
-		uart_poll_out(uart_console_dev, ' ');
-		uart_poll_out(uart_console_dev, '\b');
+		console_echo(' ');
+		console_echo('\b');
 		return;
 	}
 
@@ -225,10 +458,10 @@ static void del_char(char *pos, uint8_t end)
 
 	while (end-- > 0) {
 		*pos = *(pos + 1);
-		uart_poll_out(uart_console_dev, *(pos++));
+		console_echo(*(pos++));
 	}
 
-	uart_poll_out(uart_console_dev, ' ');
+	console_echo(' ');
 
 	/* Move cursor back to right place */
 	cursor_restore();
@@ -345,6 +578,10 @@ void uart_console_isr(struct device *unused)
 		uint8_t byte;
 		int rx;
 
+#ifdef CONFIG_UART_CONSOLE_BUFFERED
+		console_tx_isr();
+#endif
+
 		if (!uart_irq_rx_ready(uart_console_dev)) {
 			continue;
 		}
@@ -402,8 +639,8 @@ void uart_console_isr(struct device *unused)
 				break;
 			case '\r':
 				cmd->line[cur + end] = '\0';
-				uart_poll_out(uart_console_dev, '\r');
-				uart_poll_out(uart_console_dev, '\n');
+				console_echo('\r');
+				console_echo('\n');
 				cur = 0;
 				end = 0;
 				k_fifo_put(lines_queue, cmd);
@@ -433,9 +670,12 @@ static void console_input_init(void)
 	uint8_t c;
 
 	uart_irq_rx_disable(uart_console_dev);
+	/* a buffered console installed the ISR at init, for its output */
+#ifndef CONFIG_UART_CONSOLE_BUFFERED
 	uart_irq_tx_disable(uart_console_dev);
 
 	uart_irq_callback_set(uart_console_dev, uart_console_isr);
+#endif
 
 	/* Drain the fifo */
 	while (uart_irq_rx_ready(uart_console_dev)) {
@@ -502,6 +742,11 @@ static int uart_console_init(struct device *arg)
 	k_busy_wait(1000000);
 #endif
 
+#ifdef CONFIG_UART_CONSOLE_BUFFERED
+	uart_irq_tx_disable(uart_console_dev);
+	uart_irq_callback_set(uart_console_dev, uart_console_isr);
+#endif
+
 	uart_console_hook_install();
 
 	return 0;
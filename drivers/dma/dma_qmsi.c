@@ -33,6 +33,28 @@ struct dma_qmsi_context {
 	struct device *dev;
 };
 
+/*
+ * Blocks chains and cyclic transfers use the linked list modes, with one
+ * single item list per block so that every block gets a callback.
+ *
+ * Block sizes are in bytes, as in the DMA API, and only converted to the
+ * source transfer width items QMSI and the controller count when handed
+ * to QMSI.
+ */
+struct dma_qmsi_chain {
+	qm_dma_linked_list_item_t lli[CONFIG_DMA_QMSI_BLOCK_COUNT];
+	uint32_t block_size[CONFIG_DMA_QMSI_BLOCK_COUNT];
+	/* source transfer width, in bytes */
+	uint8_t source_width;
+	/* linked list blocks, 0 in single block mode */
+	uint8_t count;
+	/* block being transferred */
+	uint8_t index;
+	uint8_t block_callback : 1;
+	/* a single block split in two to report its first half */
+	uint8_t halves : 1;
+};
+
 struct dma_qmsi_driver_data {
 	void (*transfer[QM_DMA_CHANNEL_NUM])(struct device *dev, void *data);
 	void (*error[QM_DMA_CHANNEL_NUM])(struct device *dev, void *data);
@@ -44,6 +66,7 @@ struct dma_qmsi_driver_data {
 	void (*dma_user_callback[QM_DMA_CHANNEL_NUM])(struct device *dev,
 						      uint32_t channel_id,
 						      int error_code);
+	struct dma_qmsi_chain chain[QM_DMA_CHANNEL_NUM];
 };
 
 
@@ -75,8 +98,31 @@ static void dma_drv_callback(void *callback_context, uint32_t len,
 	struct dma_qmsi_driver_data *data;
 	uint32_t channel;
 
+	struct dma_qmsi_chain *chain;
+	bool last;
+
 	channel = context->index;
 	data = context->dev->driver_data;
+	chain = &data->chain[channel];
+
+	if (!chain->count || error_code != 0) {
+		data->dma_user_callback[channel](context->dev, channel,
+						 error_code);
+		return;
+	}
+
+	last = (chain->index + 1 == chain->count);
+	chain->index = last ? 0 : chain->index + 1;
+
+	if (last) {
+		error_code = DMA_STATUS_COMPLETE;
+	} else if (chain->halves) {
+		error_code = DMA_STATUS_HALF_COMPLETE;
+	} else if (chain->block_callback) {
+		error_code = DMA_STATUS_BLOCK;
+	} else {
+		return;
+	}
 
 	data->dma_user_callback[channel](context->dev, channel, error_code);
 }
@@ -190,17 +236,60 @@ static int bst_index(uint32_t num_units, uint32_t *index)
 	return 0;
 }
 
+static int dma_qmsi_chain_config(struct device *dev, uint32_t channel,
+				 struct dma_config *config)
+{
+	const struct dma_qmsi_config_info *info = dev->config->config_info;
+	struct dma_qmsi_driver_data *data = dev->driver_data;
+	struct dma_qmsi_chain *chain = &data->chain[channel];
+	struct dma_block_config *block = config->head_block;
+	qm_dma_multi_transfer_t multi = { 0 };
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < chain->count; i++) {
+		multi.source_address = (uint32_t *)block->source_address;
+		multi.destination_address = (uint32_t *)block->dest_address;
+		multi.block_size = chain->block_size[i] / chain->source_width;
+		multi.num_blocks = 1;
+		multi.linked_list_first = &chain->lli[i];
+
+		if (chain->halves && i == 1) {
+			multi.source_address = (uint32_t *)
+				(block->source_address + chain->block_size[0]);
+			multi.destination_address = (uint32_t *)
+				(block->dest_address + chain->block_size[0]);
+		}
+
+		ret = qm_dma_multi_transfer_set_config(info->instance,
+						       channel, &multi);
+		if (ret != 0) {
+			return ret;
+		}
+
+		if (!chain->halves) {
+			block = block->next_block;
+		}
+	}
+
+	return 0;
+}
+
 static int dma_qmsi_chan_config(struct device *dev, uint32_t channel,
 				struct dma_config *config)
 {
 	const struct dma_qmsi_config_info *info = dev->config->config_info;
 	struct dma_qmsi_driver_data *data = dev->driver_data;
+	struct dma_qmsi_chain *chain = &data->chain[channel];
 	qm_dma_transfer_t qmsi_transfer_cfg = { 0 };
 	qm_dma_channel_config_t qmsi_cfg = { 0 };
+	struct dma_block_config *block;
 	uint32_t temp = 0;
+	uint32_t i;
 	int ret = 0;
 
-	if (config->block_count != 1) {
+	if (config->block_count == 0 ||
+	    config->block_count > CONFIG_DMA_QMSI_BLOCK_COUNT) {
 		return -ENOTSUP;
 	}
 
@@ -233,8 +322,55 @@ static int dma_qmsi_chan_config(struct device *dev, uint32_t channel,
 	}
 	qmsi_cfg.source_burst_length = (qm_dma_burst_length_t) temp;
 
-	/* TODO: add support for using other DMA transfer types. */
-	qmsi_cfg.transfer_type = QM_DMA_TYPE_SINGLE;
+	/* the controller moves whole items of both widths */
+	block = config->head_block;
+	for (i = 0; i < config->block_count; i++) {
+		if (!block || !block->block_size ||
+		    block->block_size % config->source_data_size ||
+		    block->block_size % config->dest_data_size) {
+			return -EINVAL;
+		}
+
+		block = block->next_block;
+	}
+
+	chain->index = 0;
+	chain->source_width = config->source_data_size;
+	chain->block_callback = config->complete_callback_en;
+	chain->halves = config->half_complete_callback_en &&
+			config->block_count == 1;
+
+	if (chain->halves) {
+		/* split on an item boundary of both widths */
+		temp = max(config->source_data_size, config->dest_data_size);
+		if (config->head_block->block_size < 2 * temp) {
+			return -EINVAL;
+		}
+
+		chain->count = 2;
+		chain->block_size[0] = ROUND_DOWN(
+			config->head_block->block_size / 2, temp);
+		chain->block_size[1] = config->head_block->block_size -
+				       chain->block_size[0];
+	} else if (config->block_count > 1 || config->cyclic) {
+		chain->count = config->block_count;
+		block = config->head_block;
+		for (i = 0; i < chain->count; i++) {
+			chain->block_size[i] = block->block_size;
+			block = block->next_block;
+		}
+	} else {
+		chain->count = 0;
+		chain->block_size[0] = config->head_block->block_size;
+	}
+
+	if (!chain->count) {
+		qmsi_cfg.transfer_type = QM_DMA_TYPE_SINGLE;
+	} else if (config->cyclic) {
+		qmsi_cfg.transfer_type = QM_DMA_TYPE_MULTI_LL_CIRCULAR;
+	} else {
+		qmsi_cfg.transfer_type = QM_DMA_TYPE_MULTI_LL;
+	}
 
 	data->dma_user_callback[channel] = config->dma_callback;
 
@@ -249,7 +385,12 @@ static int dma_qmsi_chan_config(struct device *dev, uint32_t channel,
 		return ret;
 	}
 
-	qmsi_transfer_cfg.block_size = config->head_block->block_size;
+	if (chain->count) {
+		return dma_qmsi_chain_config(dev, channel, config);
+	}
+
+	qmsi_transfer_cfg.block_size = config->head_block->block_size /
+				       config->source_data_size;
 	qmsi_transfer_cfg.source_address = (uint32_t *)
 					   config->head_block->source_address;
 	qmsi_transfer_cfg.destination_address = (uint32_t *)
@@ -293,10 +434,51 @@ static int dma_qmsi_transfer_stop(struct device *dev, uint32_t channel)
 static int dma_qmsi_stop(struct device *dev, uint32_t channel)
 {
 	const struct dma_qmsi_config_info *info = dev->config->config_info;
+	struct dma_qmsi_driver_data *data = dev->driver_data;
+
+	/* the callback of the termination is a plain completion */
+	data->chain[channel].count = 0;
 
 	return qm_dma_transfer_terminate(info->instance, channel);
 }
 
+static int dma_qmsi_get_status(struct device *dev, uint32_t channel,
+			       struct dma_status *status)
+{
+	const struct dma_qmsi_config_info *info = dev->config->config_info;
+	struct dma_qmsi_driver_data *data = dev->driver_data;
+	struct dma_qmsi_chain *chain = &data->chain[channel];
+	volatile qm_dma_chan_reg_t *chan_reg;
+	uint32_t done, pending;
+	uint32_t i;
+
+	if (channel >= QM_DMA_CHANNEL_NUM) {
+		return -EINVAL;
+	}
+
+	chan_reg = &QM_DMA[info->instance]->chan_reg[channel];
+
+	status->busy = !!(QM_DMA[info->instance]->misc_reg.chan_en_low &
+			  BIT(channel));
+	if (!status->busy) {
+		status->pending_length = 0;
+		return 0;
+	}
+
+	/* the hardware counts the source items already read */
+	done = ((chan_reg->ctrl_high & QM_DMA_CTL_H_BLOCK_TS_MASK) >>
+		QM_DMA_CTL_H_BLOCK_TS_OFFSET) * chain->source_width;
+	pending = chain->block_size[chain->index] - done;
+
+	for (i = chain->index + 1; i < chain->count; i++) {
+		pending += chain->block_size[i];
+	}
+
+	status->pending_length = pending;
+
+	return 0;
+}
+
 static const struct dma_driver_api dma_funcs = {
 	.channel_config = dma_qmsi_channel_config,
 	.transfer_config = dma_qmsi_transfer_config,
@@ -304,7 +486,8 @@ static const struct dma_driver_api dma_funcs = {
 	.transfer_stop = dma_qmsi_transfer_stop,
 	.config = dma_qmsi_chan_config,
 	.start = dma_qmsi_start,
-	.stop = dma_qmsi_stop
+	.stop = dma_qmsi_stop,
+	.get_status = dma_qmsi_get_status
 };
 
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
@@ -12,7 +12,7 @@
 #include <dma.h>
 #include <errno.h>
 #include <init.h>
-#include <misc/sys_log.h>
+#include <logging/sys_log.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -51,6 +51,18 @@ struct dma_stm32_chan {
 	void (*dma_transfer)(struct device *dev, void *data);
 	void (*dma_error)(struct device *dev, void *data);
 	void *callback_data;
+
+	/* Set by dma_config(), NULL for the legacy API */
+	void (*dma_callback)(struct device *dev, uint32_t channel,
+			     int error_code);
+	/* Block being transferred, others are chained from the ISR */
+	struct dma_block_config *head;
+	struct dma_block_config *block;
+	uint32_t block_index;
+	uint32_t block_count;
+	/* Bytes per peripheral data item, the unit of SNDTR */
+	uint32_t data_size;
+	bool block_callback;
 };
 
 static struct dma_stm32_device {
@@ -207,6 +219,109 @@ static void dma_stm32_irq_clear(struct dma_stm32_device *ddata,
 	}
 }
 
+/* the chain ends after block_count blocks, whatever next_block says */
+static struct dma_block_config *dma_stm32_next(struct dma_stm32_chan *chan)
+{
+	return (chan->block_index + 1 < chan->block_count) ?
+	       chan->block->next_block : NULL;
+}
+
+static void dma_stm32_load_block(struct dma_stm32_chan *chan,
+				 struct dma_block_config *block,
+				 uint32_t index)
+{
+	struct dma_stm32_chan_reg *regs = &chan->regs;
+
+	chan->block = block;
+	chan->block_index = index;
+
+	if (chan->direction == DMA_STM32_MEM_TO_DEV) {
+		regs->spar  = block->dest_address;
+		regs->sm0ar = block->source_address;
+	} else {
+		regs->spar  = block->source_address;
+		regs->sm0ar = block->dest_address;
+	}
+
+	/* Double buffer mode: the second block is the other memory target */
+	if ((regs->scr & DMA_STM32_SCR_DBM) && dma_stm32_next(chan)) {
+		regs->sm1ar = (chan->direction == DMA_STM32_MEM_TO_DEV) ?
+			      block->next_block->source_address :
+			      block->next_block->dest_address;
+	}
+
+	regs->sndtr = block->block_size / chan->data_size;
+}
+
+static void dma_stm32_irq_notify(struct dma_stm32_device *ddata,
+				 struct dma_stm32_chan *chan,
+				 uint32_t irqstatus, uint32_t config)
+{
+	uint32_t channel = chan->id;
+	int status;
+
+	if (irqstatus & (DMA_STM32_TEI | DMA_STM32_DMEI)) {
+		SYS_LOG_ERR("Internal error: IRQ status: 0x%x\n", irqstatus);
+		dma_stm32_irq_clear(ddata, channel, irqstatus);
+		dma_stm32_write(ddata, DMA_STM32_SCR(channel),
+				config & ~DMA_STM32_SCR_EN);
+		chan->busy = false;
+
+		chan->dma_callback(chan->dev, channel, -EIO);
+		return;
+	}
+
+	if ((irqstatus & DMA_STM32_HTI) && (config & DMA_STM32_SCR_HTIE)) {
+		dma_stm32_irq_clear(ddata, channel, DMA_STM32_HTI);
+
+		chan->dma_callback(chan->dev, channel,
+				   DMA_STATUS_HALF_COMPLETE);
+	}
+
+	if (!(irqstatus & DMA_STM32_TCI)) {
+		dma_stm32_irq_clear(ddata, channel,
+				    irqstatus & ~DMA_STM32_HTI);
+		return;
+	}
+
+	dma_stm32_irq_clear(ddata, channel, DMA_STM32_TCI);
+
+	if (config & DMA_STM32_SCR_DBM) {
+		/* CT already points to the buffer now being transferred */
+		if (!(config & DMA_STM32_SCR_CT)) {
+			status = DMA_STATUS_COMPLETE;
+		} else if (chan->block_callback) {
+			status = DMA_STATUS_BLOCK;
+		} else {
+			return;
+		}
+	} else if (config & DMA_STM32_SCR_CIRC) {
+		status = DMA_STATUS_COMPLETE;
+	} else if (dma_stm32_next(chan)) {
+		/* The stream stopped at the end of the block, chain the next */
+		dma_stm32_load_block(chan, dma_stm32_next(chan),
+				     chan->block_index + 1);
+		dma_stm32_write(ddata, DMA_STM32_SPAR(channel),
+				chan->regs.spar);
+		dma_stm32_write(ddata, DMA_STM32_SM0AR(channel),
+				chan->regs.sm0ar);
+		dma_stm32_write(ddata, DMA_STM32_SNDTR(channel),
+				chan->regs.sndtr);
+		dma_stm32_write(ddata, DMA_STM32_SCR(channel),
+				chan->regs.scr | DMA_STM32_SCR_EN);
+
+		if (!chan->block_callback) {
+			return;
+		}
+		status = DMA_STATUS_BLOCK;
+	} else {
+		chan->busy = false;
+		status = DMA_STATUS_COMPLETE;
+	}
+
+	chan->dma_callback(chan->dev, channel, status);
+}
+
 static void dma_stm32_irq_handler(void *arg, uint32_t channel)
 {
 	struct device *dev = arg;
@@ -218,6 +333,11 @@ static void dma_stm32_irq_handler(void *arg, uint32_t channel)
 	config = dma_stm32_read(ddata, DMA_STM32_SCR(channel));
 	sfcr = dma_stm32_read(ddata, DMA_STM32_SFCR(channel));
 
+	if (chan->dma_callback) {
+		dma_stm32_irq_notify(ddata, chan, irqstatus, config);
+		return;
+	}
+
 	/* Silently ignore spurious transfer half complete IRQ */
 	if (irqstatus & DMA_STM32_HTI) {
 		dma_stm32_irq_clear(ddata, channel, DMA_STM32_HTI);
@@ -255,8 +375,12 @@ static int dma_stm32_disable_chan(struct dma_stm32_device *ddata,
 		dma_stm32_write(ddata, DMA_STM32_SCR(channel),
 				config &= ~DMA_STM32_SCR_EN);
 
-		/* After trying for 5 seconds, give up */
-		k_sleep(K_SECONDS(5));
+		/*
+		 * The stream stops once its current data item is done,
+		 * after trying for 5 milliseconds, give up. Busy wait, this
+		 * runs from the DMA callbacks too.
+		 */
+		k_busy_wait(50);
 		if (count++ > (5 * 1000) / 50) {
 			SYS_LOG_ERR("DMA error: Channel in use\n");
 			return -EBUSY;
@@ -310,6 +434,7 @@ static int dma_stm32_channel_config(struct device *dev, uint32_t channel,
 	}
 
 	chan->busy	    = true;
+	chan->dma_callback  = NULL;
 	chan->dma_error     = config->dma_error;
 	chan->dma_transfer  = config->dma_transfer;
 	chan->callback_data = config->callback_data;
@@ -362,6 +487,307 @@ static int dma_stm32_transfer_start(struct device *dev, uint32_t channel)
 	return 0;
 }
 
+static int dma_stm32_size(uint32_t bytes, uint32_t *size)
+{
+	switch (bytes) {
+	case 1:
+		*size = 0;
+		break;
+	case 2:
+		*size = 1;
+		break;
+	case 4:
+		*size = 2;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int dma_stm32_burst(uint32_t units, uint32_t *burst)
+{
+	switch (units) {
+	case 0:
+	case 1:
+		*burst = 0;
+		break;
+	case 4:
+		*burst = 1;
+		break;
+	case 8:
+		*burst = 2;
+		break;
+	case 16:
+		*burst = 3;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int dma_stm32_inc(uint32_t addr_adj, uint32_t inc, uint32_t *scr)
+{
+	switch (addr_adj) {
+	case 0:
+		*scr |= inc;
+		return 0;
+	case 2:
+		return 0;
+	default:
+		/* the streams cannot decrement addresses */
+		return -ENOTSUP;
+	}
+}
+
+static int dma_stm32_config(struct device *dev, uint32_t id,
+			    struct dma_config *config)
+{
+	struct dma_stm32_device *ddata = dev->driver_data;
+	struct dma_stm32_chan *chan;
+	struct dma_stm32_chan_reg *regs;
+	struct dma_block_config *block = config->head_block;
+	uint32_t psize, msize, pburst, mburst;
+	uint32_t pdata, mdata, padj, madj;
+	struct dma_block_config *b;
+	uint32_t i;
+	bool fifo;
+	int ret;
+
+	if (id >= DMA_STM32_MAX_CHANNELS || !block || !config->block_count ||
+	    !config->dma_callback) {
+		return -EINVAL;
+	}
+
+	chan = &ddata->chan[id];
+	regs = &chan->regs;
+
+	if (chan->busy) {
+		return -EBUSY;
+	}
+
+	switch (config->channel_direction) {
+	case MEMORY_TO_MEMORY:
+		if (!ddata->mem2mem) {
+			SYS_LOG_ERR("%s does not support mem-to-mem transfers\n",
+				    dev->config->name);
+			return -EINVAL;
+		}
+		chan->direction = DMA_STM32_MEM_TO_MEM;
+		break;
+	case MEMORY_TO_PERIPHERAL:
+		chan->direction = DMA_STM32_MEM_TO_DEV;
+		break;
+	case PERIPHERAL_TO_MEMORY:
+		chan->direction = DMA_STM32_DEV_TO_MEM;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/*
+	 * Cyclic transfers use the circular mode for one block and the
+	 * double buffer mode for two, neither exist from memory to memory.
+	 */
+	if (config->cyclic) {
+		if (chan->direction == DMA_STM32_MEM_TO_MEM ||
+		    config->block_count > 2) {
+			return -ENOTSUP;
+		}
+
+		if (config->block_count == 2 && (!block->next_block ||
+		    block->block_size != block->next_block->block_size)) {
+			return -EINVAL;
+		}
+	}
+
+	/* The peripheral side is the source from memory to memory */
+	if (chan->direction == DMA_STM32_MEM_TO_DEV) {
+		pdata = config->dest_data_size;
+		mdata = config->source_data_size;
+		padj = block->dest_addr_adj;
+		madj = block->source_addr_adj;
+		ret = dma_stm32_burst(config->dest_burst_length, &pburst);
+		ret |= dma_stm32_burst(config->source_burst_length, &mburst);
+	} else {
+		pdata = config->source_data_size;
+		mdata = config->dest_data_size;
+		padj = block->source_addr_adj;
+		madj = block->dest_addr_adj;
+		ret = dma_stm32_burst(config->source_burst_length, &pburst);
+		ret |= dma_stm32_burst(config->dest_burst_length, &mburst);
+	}
+
+	ret |= dma_stm32_size(pdata, &psize);
+	ret |= dma_stm32_size(mdata, &msize);
+	if (ret) {
+		return -EINVAL;
+	}
+
+	for (i = 0, b = block; i < config->block_count;
+	     i++, b = b->next_block) {
+		if (!b || b->block_size % pdata ||
+		    b->block_size / pdata > DMA_STM32_MAX_DATA_ITEMS) {
+			return -EINVAL;
+		}
+	}
+
+	memset(regs, 0, sizeof(struct dma_stm32_chan_reg));
+
+	regs->scr = DMA_STM32_SCR_DIR(chan->direction) |
+		DMA_STM32_SCR_PSIZE(psize) |
+		DMA_STM32_SCR_MSIZE(msize) |
+		DMA_STM32_SCR_PBURST(pburst) |
+		DMA_STM32_SCR_MBURST(mburst) |
+		DMA_STM32_SCR_PL(config->channel_priority) |
+		DMA_STM32_SCR_REQ(config->dma_slot) |
+		DMA_STM32_SCR_TCIE |		/* Transfer comp IRQ enable */
+		DMA_STM32_SCR_TEIE;		/* Transfer error IRQ enable */
+
+	ret = dma_stm32_inc(padj, DMA_STM32_SCR_PINC, &regs->scr);
+	ret |= dma_stm32_inc(madj, DMA_STM32_SCR_MINC, &regs->scr);
+	if (ret) {
+		return -ENOTSUP;
+	}
+
+	if (config->cyclic) {
+		regs->scr |= (config->block_count == 2) ?
+			     DMA_STM32_SCR_DBM : DMA_STM32_SCR_CIRC;
+	}
+
+	if (config->half_complete_callback_en) {
+		regs->scr |= DMA_STM32_SCR_HTIE;
+	}
+
+	/* The FIFO packs data and serves bursts, mem-to-mem requires it */
+	fifo = chan->direction == DMA_STM32_MEM_TO_MEM || psize != msize ||
+	       pburst || mburst;
+	if (fifo) {
+		regs->sfcr = DMA_STM32_SFCR_DMDIS |
+			DMA_STM32_SFCR_FTH(DMA_STM32_FIFO_THRESHOLD_FULL);
+	} else {
+		regs->scr |= DMA_STM32_SCR_DMEIE;
+	}
+
+	chan->data_size = pdata;
+	chan->block_callback = config->complete_callback_en;
+	chan->dma_callback = config->dma_callback;
+	chan->head = block;
+	chan->block_count = config->block_count;
+
+	dma_stm32_load_block(chan, block, 0);
+
+	return 0;
+}
+
+static int dma_stm32_start(struct device *dev, uint32_t id)
+{
+	struct dma_stm32_device *ddata = dev->driver_data;
+	struct dma_stm32_chan *chan;
+	int ret;
+
+	if (id >= DMA_STM32_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &ddata->chan[id];
+	if (!chan->dma_callback) {
+		return -EINVAL;
+	}
+
+	if (chan->busy) {
+		return -EBUSY;
+	}
+
+	/* Restart from the head block after a chain */
+	dma_stm32_load_block(chan, chan->head, 0);
+	chan->busy = true;
+
+	ret = dma_stm32_transfer_start(dev, id);
+	if (ret) {
+		chan->busy = false;
+	}
+
+	return ret;
+}
+
+static int dma_stm32_stop(struct device *dev, uint32_t id)
+{
+	struct dma_stm32_device *ddata = dev->driver_data;
+	struct dma_stm32_chan *chan;
+	uint32_t irqstatus;
+	int ret;
+
+	if (id >= DMA_STM32_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &ddata->chan[id];
+
+	/* No more interrupts, then wait for the stream to stop */
+	dma_stm32_write(ddata, DMA_STM32_SCR(id),
+			dma_stm32_read(ddata, DMA_STM32_SCR(id)) &
+			~(DMA_STM32_SCR_IRQ_MASK | DMA_STM32_SCR_HTIE));
+
+	ret = dma_stm32_disable_chan(ddata, id);
+	if (ret) {
+		return ret;
+	}
+
+	irqstatus = dma_stm32_irq_status(ddata, id);
+	if (irqstatus) {
+		dma_stm32_irq_clear(ddata, id, irqstatus);
+	}
+
+	chan->busy = false;
+
+	return 0;
+}
+
+static int dma_stm32_get_status(struct device *dev, uint32_t id,
+				struct dma_status *status)
+{
+	struct dma_stm32_device *ddata = dev->driver_data;
+	struct dma_stm32_chan *chan;
+	struct dma_block_config *block;
+	uint32_t scr;
+	uint32_t i;
+
+	if (id >= DMA_STM32_MAX_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &ddata->chan[id];
+	scr = dma_stm32_read(ddata, DMA_STM32_SCR(id));
+
+	status->busy = chan->busy && (scr & DMA_STM32_SCR_EN);
+	if (!status->busy) {
+		status->pending_length = 0;
+		return 0;
+	}
+
+	status->pending_length = dma_stm32_read(ddata, DMA_STM32_SNDTR(id)) *
+				 chan->data_size;
+
+	/* The blocks left in a chain, or the second double buffer target */
+	if (scr & DMA_STM32_SCR_DBM) {
+		if (!(scr & DMA_STM32_SCR_CT)) {
+			status->pending_length += chan->head->block_size;
+		}
+	} else if (!(scr & DMA_STM32_SCR_CIRC)) {
+		block = chan->block;
+		for (i = chan->block_index + 1; i < chan->block_count; i++) {
+			block = block->next_block;
+			status->pending_length += block->block_size;
+		}
+	}
+
+	return 0;
+}
+
 static int dma_stm32_init(struct device *dev)
 {
 	struct dma_stm32_device *ddata = dev->driver_data;
@@ -391,6 +817,10 @@ static const struct dma_driver_api dma_funcs = {
 	.channel_config  = dma_stm32_channel_config,
 	.transfer_config = dma_stm32_transfer_config,
 	.transfer_start  = dma_stm32_transfer_start,
+	.config		 = dma_stm32_config,
+	.start		 = dma_stm32_start,
+	.stop		 = dma_stm32_stop,
+	.get_status	 = dma_stm32_get_status,
 };
 
 const struct dma_stm32_config dma_stm32_1_cdata = {
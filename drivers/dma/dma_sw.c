@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Memory to memory DMA controller emulated in software
+ *
+ * A thread of its own copies the blocks, one block per work item, so that
+ * transfers complete asynchronously and the callbacks come in the order a
+ * DMA controller would issue them, including for block chains and cyclic
+ * transfers.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <dma.h>
+
+#define ADDR_ADJ_INCREMENT	0
+#define ADDR_ADJ_NO_CHANGE	2
+
+struct dma_sw_chan {
+	struct k_work work;
+	struct device *dev;
+	uint32_t id;
+
+	struct dma_config config;
+	struct dma_block_config *block;
+	uint32_t index;
+	/* bytes of the current block already copied */
+	uint32_t offset;
+	bool configured;
+	bool busy;
+};
+
+struct dma_sw_data {
+	struct k_work_q work_q;
+	struct dma_sw_chan chan[CONFIG_DMA_SW_CHANNELS];
+};
+
+static char __stack dma_sw_stack[CONFIG_DMA_SW_THREAD_STACK_SIZE];
+
+/* the chain ends after block_count blocks, whatever next_block says */
+static struct dma_block_config *dma_sw_next(struct dma_sw_chan *chan,
+					    struct dma_block_config *block,
+					    uint32_t index)
+{
+	return (index + 1 < chan->config.block_count) ?
+	       block->next_block : NULL;
+}
+
+static void dma_sw_copy(struct dma_sw_chan *chan, uint32_t len)
+{
+	struct dma_block_config *block = chan->block;
+	uint32_t size = chan->config.source_data_size;
+	uint8_t *src = (uint8_t *)block->source_address;
+	uint8_t *dst = (uint8_t *)block->dest_address;
+	uint32_t i;
+
+	if (block->source_addr_adj == ADDR_ADJ_INCREMENT) {
+		src += chan->offset;
+	}
+
+	if (block->dest_addr_adj == ADDR_ADJ_INCREMENT) {
+		dst += chan->offset;
+	}
+
+	if (block->source_addr_adj == ADDR_ADJ_INCREMENT &&
+	    block->dest_addr_adj == ADDR_ADJ_INCREMENT) {
+		memcpy(dst, src, len);
+		return;
+	}
+
+	/* a fixed address is a register, access it one item at a time */
+	for (i = 0; i < len; i += size) {
+		switch (size) {
+		case 1:
+			*(volatile uint8_t *)dst = *(volatile uint8_t *)src;
+			break;
+		case 2:
+			*(volatile uint16_t *)dst = *(volatile uint16_t *)src;
+			break;
+		default:
+			*(volatile uint32_t *)dst = *(volatile uint32_t *)src;
+			break;
+		}
+
+		if (block->source_addr_adj == ADDR_ADJ_INCREMENT) {
+			src += size;
+		}
+
+		if (block->dest_addr_adj == ADDR_ADJ_INCREMENT) {
+			dst += size;
+		}
+	}
+}
+
+static void dma_sw_work(struct k_work *work)
+{
+	struct dma_sw_chan *chan = CONTAINER_OF(work, struct dma_sw_chan,
+						work);
+	struct dma_sw_data *data = chan->dev->driver_data;
+	struct dma_block_config *block;
+	uint32_t len, half;
+	unsigned int key;
+	int status;
+
+	key = irq_lock();
+
+	if (!chan->busy) {
+		irq_unlock(key);
+		return;
+	}
+
+	block = chan->block;
+	len = block->block_size - chan->offset;
+
+	/* stop half way through the block to report it */
+	half = block->block_size / 2;
+	if (chan->config.half_complete_callback_en && chan->offset < half) {
+		len = half - chan->offset;
+	}
+
+	irq_unlock(key);
+
+	dma_sw_copy(chan, len);
+
+	key = irq_lock();
+
+	/* stopped while copying */
+	if (!chan->busy) {
+		irq_unlock(key);
+		return;
+	}
+
+	chan->offset += len;
+
+	if (chan->offset < block->block_size) {
+		status = DMA_STATUS_HALF_COMPLETE;
+	} else if (dma_sw_next(chan, block, chan->index)) {
+		chan->block = block->next_block;
+		chan->index++;
+		chan->offset = 0;
+		status = chan->config.complete_callback_en ?
+			 DMA_STATUS_BLOCK : -1;
+	} else {
+		chan->block = chan->config.head_block;
+		chan->index = 0;
+		chan->offset = 0;
+		chan->busy = chan->config.cyclic;
+		status = DMA_STATUS_COMPLETE;
+	}
+
+	if (chan->busy) {
+		k_work_submit_to_queue(&data->work_q, &chan->work);
+	}
+
+	irq_unlock(key);
+
+	if (status >= 0 && chan->config.dma_callback) {
+		chan->config.dma_callback(chan->dev, chan->id, status);
+	}
+}
+
+static int dma_sw_config(struct device *dev, uint32_t channel,
+			 struct dma_config *config)
+{
+	struct dma_sw_data *data = dev->driver_data;
+	struct dma_sw_chan *chan;
+	struct dma_block_config *block;
+	uint32_t size = config->source_data_size;
+	uint32_t i;
+
+	if (channel >= CONFIG_DMA_SW_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &data->chan[channel];
+
+	if (chan->busy) {
+		return -EBUSY;
+	}
+
+	if (config->channel_direction != MEMORY_TO_MEMORY) {
+		return -ENOTSUP;
+	}
+
+	if (size != config->dest_data_size ||
+	    (size != 1 && size != 2 && size != 4)) {
+		return -EINVAL;
+	}
+
+	if (!config->block_count || !config->head_block) {
+		return -EINVAL;
+	}
+
+	block = config->head_block;
+	for (i = 0; i < config->block_count; i++) {
+		if (!block || !block->block_size || block->block_size % size) {
+			return -EINVAL;
+		}
+
+		if ((block->source_addr_adj != ADDR_ADJ_INCREMENT &&
+		     block->source_addr_adj != ADDR_ADJ_NO_CHANGE) ||
+		    (block->dest_addr_adj != ADDR_ADJ_INCREMENT &&
+		     block->dest_addr_adj != ADDR_ADJ_NO_CHANGE)) {
+			return -ENOTSUP;
+		}
+
+		block = block->next_block;
+	}
+
+	/* the half way point must fall on an item */
+	if (config->half_complete_callback_en &&
+	    (config->head_block->block_size / 2) % size) {
+		return -EINVAL;
+	}
+
+	chan->config = *config;
+	chan->configured = true;
+
+	return 0;
+}
+
+static int dma_sw_start(struct device *dev, uint32_t channel)
+{
+	struct dma_sw_data *data = dev->driver_data;
+	struct dma_sw_chan *chan;
+	unsigned int key;
+	int ret = 0;
+
+	if (channel >= CONFIG_DMA_SW_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &data->chan[channel];
+
+	key = irq_lock();
+
+	if (!chan->configured) {
+		ret = -EINVAL;
+	} else if (chan->busy) {
+		ret = -EBUSY;
+	} else {
+		chan->block = chan->config.head_block;
+		chan->index = 0;
+		chan->offset = 0;
+		chan->busy = true;
+		k_work_submit_to_queue(&data->work_q, &chan->work);
+	}
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+static int dma_sw_stop(struct device *dev, uint32_t channel)
+{
+	struct dma_sw_data *data = dev->driver_data;
+	unsigned int key;
+
+	if (channel >= CONFIG_DMA_SW_CHANNELS) {
+		return -EINVAL;
+	}
+
+	/* a pending work item finds the channel idle and does nothing */
+	key = irq_lock();
+	data->chan[channel].busy = false;
+	irq_unlock(key);
+
+	return 0;
+}
+
+static int dma_sw_get_status(struct device *dev, uint32_t channel,
+			     struct dma_status *status)
+{
+	struct dma_sw_data *data = dev->driver_data;
+	struct dma_sw_chan *chan;
+	struct dma_block_config *block;
+	unsigned int key;
+	uint32_t i;
+
+	if (channel >= CONFIG_DMA_SW_CHANNELS) {
+		return -EINVAL;
+	}
+
+	chan = &data->chan[channel];
+
+	key = irq_lock();
+
+	status->busy = chan->busy;
+	status->pending_length = 0;
+
+	if (chan->busy) {
+		status->pending_length = chan->block->block_size -
+					 chan->offset;
+
+		block = chan->block;
+		for (i = chan->index;
+		     (block = dma_sw_next(chan, block, i)) != NULL; i++) {
+			status->pending_length += block->block_size;
+		}
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+static const struct dma_driver_api dma_sw_api = {
+	.config = dma_sw_config,
+	.start = dma_sw_start,
+	.stop = dma_sw_stop,
+	.get_status = dma_sw_get_status,
+};
+
+static int dma_sw_init(struct device *dev)
+{
+	struct dma_sw_data *data = dev->driver_data;
+	uint32_t i;
+
+	for (i = 0; i < CONFIG_DMA_SW_CHANNELS; i++) {
+		data->chan[i].dev = dev;
+		data->chan[i].id = i;
+		k_work_init(&data->chan[i].work, dma_sw_work);
+	}
+
+	k_work_q_start(&data->work_q, dma_sw_stack, sizeof(dma_sw_stack),
+		       CONFIG_DMA_SW_THREAD_PRIORITY);
+
+	return 0;
+}
+
+static struct dma_sw_data dma_sw_dev_data;
+
+DEVICE_AND_API_INIT(dma_sw, CONFIG_DMA_SW_DEV_NAME, &dma_sw_init,
+		    &dma_sw_dev_data, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &dma_sw_api);
@@ -36,8 +36,14 @@ static int eth_enc28j60_soft_reset(struct device *dev)
 static void eth_enc28j60_set_bank(struct device *dev, uint16_t reg_addr)
 {
 	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint8_t bank = (reg_addr >> 8) & 0x0F;
 	uint8_t tx_buf[2];
 
+	/* Save the two transactions when the bank is already selected */
+	if (bank == context->bank) {
+		return;
+	}
+
 	k_sem_take(&context->spi_sem, K_FOREVER);
 
 	tx_buf[0] = ENC28J60_SPI_RCR | ENC28J60_REG_ECON1;
@@ -46,9 +52,10 @@ static void eth_enc28j60_set_bank(struct device *dev, uint16_t reg_addr)
 	spi_transceive(context->spi, tx_buf, 2, tx_buf, 2);
 
 	tx_buf[0] = ENC28J60_SPI_WCR | ENC28J60_REG_ECON1;
-	tx_buf[1] = (tx_buf[1] & 0xFC) | ((reg_addr >> 8) & 0x0F);
+	tx_buf[1] = (tx_buf[1] & 0xFC) | bank;
 
 	spi_write(context->spi, tx_buf, 2);
+	context->bank = bank;
 
 	k_sem_give(&context->spi_sem);
 }
@@ -125,8 +132,9 @@ static void eth_enc28j60_clear_eth_reg(struct device *dev, uint16_t reg_addr,
 	k_sem_give(&context->spi_sem);
 }
 
-static void eth_enc28j60_write_mem(struct device *dev, uint8_t *data_buffer,
-				   uint16_t buf_len)
+static void eth_enc28j60_write_mem_chunks(struct device *dev,
+					  uint8_t *data_buffer,
+					  uint16_t buf_len)
 {
 	struct eth_enc28j60_runtime *context = dev->driver_data;
 	uint8_t *index_buf;
@@ -156,8 +164,9 @@ static void eth_enc28j60_write_mem(struct device *dev, uint8_t *data_buffer,
 	k_sem_give(&context->spi_sem);
 }
 
-static void eth_enc28j60_read_mem(struct device *dev, uint8_t *data_buffer,
-				  uint16_t buf_len)
+static void eth_enc28j60_read_mem_chunks(struct device *dev,
+					 uint8_t *data_buffer,
+					 uint16_t buf_len)
 {
 	struct eth_enc28j60_runtime *context = dev->driver_data;
 	uint16_t num_segments;
@@ -194,6 +203,75 @@ static void eth_enc28j60_read_mem(struct device *dev, uint8_t *data_buffer,
 	k_sem_give(&context->spi_sem);
 }
 
+/* Write the buffers of @a bufs to the buffer memory in a single SPI
+ * transaction, the first entry is reserved for the opcode. Drivers without
+ * buffer set support get one transaction per buffer, through the bounce
+ * buffer.
+ */
+static void eth_enc28j60_write_mem_bufs(struct device *dev,
+					struct spi_buf *bufs, size_t count)
+{
+	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint8_t opcode = ENC28J60_SPI_WBM;
+	int ret;
+
+	bufs[0].buf = &opcode;
+	bufs[0].len = 1;
+
+	k_sem_take(&context->spi_sem, K_FOREVER);
+	ret = spi_transceive_bufs(context->spi, NULL, bufs, count, NULL, 0);
+	k_sem_give(&context->spi_sem);
+
+	if (ret != -ENOTSUP) {
+		return;
+	}
+
+	for (size_t i = 1; i < count; i++) {
+		eth_enc28j60_write_mem_chunks(dev, bufs[i].buf, bufs[i].len);
+	}
+}
+
+/* Read the buffer memory into the buffers of @a bufs in a single SPI
+ * transaction, the first entry is reserved for the opcode. The bytes
+ * of a NULL buffer are skipped.
+ */
+static void eth_enc28j60_read_mem_bufs(struct device *dev,
+				       struct spi_buf *bufs, size_t count)
+{
+	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint8_t opcode = ENC28J60_SPI_RBM;
+	const struct spi_buf tx_buf = {
+		.buf = &opcode,
+		.len = 1,
+	};
+	int ret;
+
+	bufs[0].buf = NULL;
+	bufs[0].len = 1;
+
+	k_sem_take(&context->spi_sem, K_FOREVER);
+	ret = spi_transceive_bufs(context->spi, NULL, &tx_buf, 1, bufs, count);
+	k_sem_give(&context->spi_sem);
+
+	if (ret != -ENOTSUP) {
+		return;
+	}
+
+	for (size_t i = 1; i < count; i++) {
+		eth_enc28j60_read_mem_chunks(dev, bufs[i].buf, bufs[i].len);
+	}
+}
+
+static void eth_enc28j60_read_mem(struct device *dev, uint8_t *data_buffer,
+				  uint16_t buf_len)
+{
+	struct spi_buf bufs[2] = {
+		[1] = { .buf = data_buffer, .len = buf_len },
+	};
+
+	eth_enc28j60_read_mem_bufs(dev, bufs, ARRAY_SIZE(bufs));
+}
+
 static void eth_enc28j60_write_phy(struct device *dev, uint16_t reg_addr,
 				   int16_t data)
 {
@@ -428,11 +506,13 @@ static int eth_enc28j60_tx(struct device *dev, struct net_buf *buf,
 			   uint16_t len)
 {
 	struct eth_enc28j60_runtime *context = dev->driver_data;
+	struct spi_buf *bufs = context->spi_bufs;
 	uint16_t tx_bufaddr = ENC28J60_TXSTART;
 	bool first_frag = true;
 	uint8_t per_packet_control;
 	uint16_t tx_bufaddr_end;
 	struct net_buf *frag;
+	size_t count;
 	uint8_t tx_end;
 
 	k_sem_take(&context->tx_rx_sem, K_FOREVER);
@@ -457,26 +537,35 @@ static int eth_enc28j60_tx(struct device *dev, struct net_buf *buf,
 	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXSTL, tx_bufaddr & 0xFF);
 	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXSTH, tx_bufaddr >> 8);
 
-	/* Write the data into the buffer */
+	/* Write the data into the buffer, straight from the fragments. The
+	 * write pointer autoincrements, a frame with more fragments than a
+	 * transaction holds simply continues in the next one.
+	 */
 	per_packet_control = ENC28J60_PPCTL_BYTE;
-	eth_enc28j60_write_mem(dev, &per_packet_control, 1);
+	bufs[1].buf = &per_packet_control;
+	bufs[1].len = 1;
+	count = 2;
 
 	for (frag = buf->frags; frag; frag = frag->frags) {
-		uint8_t *data_ptr;
-		uint16_t data_len;
+		if (count == ENC28J60_SPI_BUFS) {
+			eth_enc28j60_write_mem_bufs(dev, bufs, count);
+			count = 1;
+		}
 
 		if (first_frag) {
-			data_ptr = net_nbuf_ll(buf);
-			data_len = net_nbuf_ll_reserve(buf) + frag->len;
+			bufs[count].buf = net_nbuf_ll(buf);
+			bufs[count].len = net_nbuf_ll_reserve(buf) + frag->len;
 			first_frag = false;
 		} else {
-			data_ptr = frag->data;
-			data_len = frag->len;
+			bufs[count].buf = frag->data;
+			bufs[count].len = frag->len;
 		}
 
-		eth_enc28j60_write_mem(dev, data_ptr, data_len);
+		count++;
 	}
 
+	eth_enc28j60_write_mem_bufs(dev, bufs, count);
+
 	tx_bufaddr_end = tx_bufaddr + len;
 	eth_enc28j60_write_reg(dev, ENC28J60_REG_ETXNDL,
 			       tx_bufaddr_end & 0xFF);
@@ -505,124 +594,159 @@ static int eth_enc28j60_tx(struct device *dev, struct net_buf *buf,
 	return 0;
 }
 
-static int eth_enc28j60_rx(struct device *dev)
+/* Read the frame at the read pointer, straight into the fragments of a
+ * new buffer, and hand it to the IP stack. Returns the address of the
+ * next packet.
+ */
+static uint16_t eth_enc28j60_rx_frame(struct device *dev)
 {
 	const struct eth_enc28j60_config *config = dev->config->config_info;
 	struct eth_enc28j60_runtime *context = dev->driver_data;
+	struct spi_buf *bufs = context->spi_bufs;
+	struct net_buf *last_frag;
+	struct net_buf *pkt_buf;
+	struct net_buf *buf;
+	uint16_t next_packet;
 	uint16_t lengthfr;
-	uint8_t counter;
+	uint16_t frm_len;
+	uint8_t np[2];
+	size_t count;
 
-	/* Errata 6. The Receive Packet Pending Interrupt Flag (EIR.PKTIF)
-	 * does not reliably/accurately report the status of pending packet.
-	 * Use EPKTCNT register instead.
-	*/
+	/* Read address for next packet and reception status vector */
+	bufs[1].buf = np;
+	bufs[1].len = sizeof(np);
+	bufs[2].buf = context->rx_rsv;
+	bufs[2].len = RSV_SIZE;
+	eth_enc28j60_read_mem_bufs(dev, bufs, 3);
 
-	SYS_LOG_DBG("");
+	next_packet = np[0] | (uint16_t)np[1] << 8;
 
-	k_sem_take(&context->tx_rx_sem, K_FOREVER);
+	/* Errata 14. Even values in ERXRDPT
+	 * may corrupt receive buffer.
+	 */
+	if (next_packet == 0) {
+		next_packet = ENC28J60_RXEND;
+	} else if (!(next_packet & 0x01)) {
+		next_packet--;
+	}
+
+	/* Get the frame length from the rx status vector,
+	 * minus CRC size at the end which is always present
+	 */
+	lengthfr = ((context->rx_rsv[1] << 8) | context->rx_rsv[0]) -
+		   ENC28J60_CRC_SIZE;
+	frm_len = lengthfr;
+
+	if (frm_len > ENC28J60_FRAME_MAX) {
+		SYS_LOG_ERR("Invalid frame length %u", frm_len);
+
+		/* Resume reading at the next packet */
+		eth_enc28j60_set_bank(dev, ENC28J60_REG_ERDPTL);
+		eth_enc28j60_write_reg(dev, ENC28J60_REG_ERDPTL, np[0]);
+		eth_enc28j60_write_reg(dev, ENC28J60_REG_ERDPTH, np[1]);
+
+		return next_packet;
+	}
+
+	/* Get the frame from the buffer */
+	buf = net_nbuf_get_reserve_rx(0, config->timeout);
+	if (!buf) {
+		SYS_LOG_ERR("Could not allocate rx buffer");
+		goto drop;
+	}
+
+	last_frag = buf;
+	count = 1;
 
 	do {
-		struct net_buf *last_frag;
-		struct net_buf *pkt_buf = NULL;
-		uint16_t frm_len = 0;
-		struct net_buf *buf;
-		uint16_t next_packet;
-		uint8_t np[2];
-
-		/* Read address for next packet */
-		eth_enc28j60_read_mem(dev, np, 2);
-		next_packet = np[0] | (uint16_t)np[1] << 8;
-
-		/* Errata 14. Even values in ERXRDPT
-		 * may corrupt receive buffer.
-		 */
-		if (next_packet == 0) {
-			next_packet = ENC28J60_RXEND;
-		} else if (!(next_packet & 0x01)) {
-			next_packet--;
-		}
+		size_t spi_frame_len;
 
-		/* Read reception status vector */
-		eth_enc28j60_read_mem(dev, context->rx_rsv, 4);
+		/* Reserve a data frag to receive the frame */
+		pkt_buf = net_nbuf_get_frag(buf, config->timeout);
+		if (!pkt_buf) {
+			SYS_LOG_ERR("Could not allocate data buffer");
+			net_buf_unref(buf);
 
-		/* Get the frame length from the rx status vector,
-		 * minus CRC size at the end which is always present
-		 */
-		frm_len = (context->rx_rsv[1] << 8) | (context->rx_rsv[0] - 4);
-		lengthfr = frm_len;
-
-		/* Get the frame from the buffer */
-		buf = net_nbuf_get_reserve_rx(0, config->timeout);
-		if (!buf) {
-			SYS_LOG_ERR("Could not allocate rx buffer");
-			goto done;
+			goto drop;
 		}
 
-		last_frag = buf;
+		net_buf_frag_insert(last_frag, pkt_buf);
+		last_frag = pkt_buf;
 
-		do {
-			size_t frag_len;
-			uint8_t *data_ptr;
-			size_t spi_frame_len;
+		/* Review the space available for the new frag */
+		spi_frame_len = min(net_buf_tailroom(pkt_buf), frm_len);
+
+		bufs[count].buf = net_buf_add(pkt_buf, spi_frame_len);
+		bufs[count].len = spi_frame_len;
+		count++;
+
+		frm_len -= spi_frame_len;
+	} while (frm_len > 0);
 
-			/* Reserve a data frag to receive the frame */
-			pkt_buf = net_nbuf_get_frag(buf, config->timeout);
-			if (!pkt_buf) {
-				SYS_LOG_ERR("Could not allocate data buffer");
-				net_buf_unref(buf);
+	/* Let's pop the useless CRC, and the padding byte introduced by
+	 * the device when the frame length is odd, in the same transaction
+	 */
+	bufs[count].buf = NULL;
+	bufs[count].len = ENC28J60_CRC_SIZE + (lengthfr & 0x01);
+	count++;
+
+	eth_enc28j60_read_mem_bufs(dev, bufs, count);
 
-				goto done;
-			}
+	/* Feed buffer frame to IP stack */
+	SYS_LOG_DBG("Received packet of length %u", lengthfr);
+	net_recv_data(context->iface, buf);
 
-			net_buf_frag_insert(last_frag, pkt_buf);
-			data_ptr = pkt_buf->data;
+	return next_packet;
 
-			last_frag = pkt_buf;
+drop:
+	/* Skip the frame, the next one starts right after it */
+	eth_enc28j60_read_mem(dev, NULL, lengthfr + ENC28J60_CRC_SIZE +
+			      (lengthfr & 0x01));
 
-			/* Review the space available for the new frag */
-			frag_len = net_buf_tailroom(pkt_buf);
+	return next_packet;
+}
 
-			if (frm_len > frag_len) {
-				spi_frame_len = frag_len;
-			} else {
-				spi_frame_len = frm_len;
-			}
+static int eth_enc28j60_rx(struct device *dev)
+{
+	struct eth_enc28j60_runtime *context = dev->driver_data;
+	uint16_t next_packet;
+	uint8_t counter;
+
+	/* Errata 6. The Receive Packet Pending Interrupt Flag (EIR.PKTIF)
+	 * does not reliably/accurately report the status of pending packet.
+	 * Use EPKTCNT register instead.
+	*/
 
-			eth_enc28j60_read_mem(dev, data_ptr, spi_frame_len);
+	SYS_LOG_DBG("");
 
-			net_buf_add(pkt_buf, spi_frame_len);
+	k_sem_take(&context->tx_rx_sem, K_FOREVER);
 
-			/* One fragment has been written via SPI */
-			frm_len -= spi_frame_len;
-		} while (frm_len > 0);
+	eth_enc28j60_set_bank(dev, ENC28J60_REG_EPKTCNT);
+	eth_enc28j60_read_reg(dev, ENC28J60_REG_EPKTCNT, &counter);
 
-		/* Let's pop the useless CRC */
-		eth_enc28j60_read_mem(dev, NULL, 4);
+	/* Drain all the packets pending, the read pointer autoincrements
+	 * from one packet to the next.
+	 */
+	while (counter) {
+		do {
+			next_packet = eth_enc28j60_rx_frame(dev);
 
-		/* Pops one padding byte from spi circular buffer
-		 * introduced by the device when the frame length is odd
-		 */
-		if (lengthfr & 0x01) {
-			eth_enc28j60_read_mem(dev, NULL, 1);
-		}
+			/* Decrement rx counter */
+			eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_ECON2,
+						 ENC28J60_BIT_ECON2_PKTDEC);
+		} while (--counter);
 
-		/* Feed buffer frame to IP stack */
-		SYS_LOG_DBG("Received packet of length %u", lengthfr);
-		net_recv_data(context->iface, buf);
-done:
-		/* Free buffer memory and decrement rx counter */
+		/* Free buffer memory of the whole batch */
 		eth_enc28j60_set_bank(dev, ENC28J60_REG_ERXRDPTL);
 		eth_enc28j60_write_reg(dev, ENC28J60_REG_ERXRDPTL,
 				       next_packet & 0xFF);
 		eth_enc28j60_write_reg(dev, ENC28J60_REG_ERXRDPTH,
 				       next_packet >> 8);
-		eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_ECON2,
-					 ENC28J60_BIT_ECON2_PKTDEC);
 
 		/* Check if there are frames to clean from the buffer */
 		eth_enc28j60_set_bank(dev, ENC28J60_REG_EPKTCNT);
 		eth_enc28j60_read_reg(dev, ENC28J60_REG_EPKTCNT, &counter);
-	} while (counter);
+	}
 
 	k_sem_give(&context->tx_rx_sem);
 
@@ -642,6 +766,13 @@ static void enc28j60_thread_main(void *arg1, void *unused1, void *unused2)
 
 	while (1) {
 		k_sem_take(&context->int_sem, K_FOREVER);
+
+		/* The interrupt line stays asserted while packets are
+		 * pending, mask it so that packets received in the meantime
+		 * raise a new edge once it is unmasked.
+		 */
+		eth_enc28j60_clear_eth_reg(dev, ENC28J60_REG_EIE,
+					   ENC28J60_BIT_EIE_INTIE);
 		eth_enc28j60_read_reg(dev, ENC28J60_REG_EIR, &int_stat);
 
 		if (int_stat & ENC28J60_BIT_EIR_PKTIF) {
@@ -651,6 +782,9 @@ static void enc28j60_thread_main(void *arg1, void *unused1, void *unused2)
 						   ENC28J60_BIT_EIR_PKTIF
 						   | ENC28J60_BIT_EIR_RXERIF);
 		}
+
+		eth_enc28j60_set_eth_reg(dev, ENC28J60_REG_EIE,
+					 ENC28J60_BIT_EIE_INTIE);
 	}
 }
 
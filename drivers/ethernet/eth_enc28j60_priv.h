@@ -7,6 +7,7 @@
 
 #include <kernel.h>
 #include <gpio.h>
+#include <spi.h>
 
 #ifndef _ENC28J60_
 #define _ENC28J60_
@@ -213,6 +214,17 @@
 
 #define MAX_BUFFER_LENGTH 128
 
+/* Largest frame accepted, MAMXFL reset value */
+#define ENC28J60_FRAME_MAX 1536
+/* CRC at the end of each received frame */
+#define ENC28J60_CRC_SIZE 4
+
+/* Buffers of a single buffer memory SPI transaction: the opcode, the
+ * fragments of a frame and the per packet control byte or the trailer
+ */
+#define ENC28J60_SPI_BUFS \
+	(ceiling_fraction(ENC28J60_FRAME_MAX, CONFIG_NET_NBUF_DATA_SIZE) + 3)
+
 struct eth_enc28j60_config {
 	const char *gpio_port;
 	uint8_t gpio_pin;
@@ -230,6 +242,9 @@ struct eth_enc28j60_runtime {
 	struct device *spi;
 	struct gpio_callback gpio_cb;
 	uint8_t mem_buf[MAX_BUFFER_LENGTH + 1];
+	struct spi_buf spi_bufs[ENC28J60_SPI_BUFS];
+	/* bank selected in ECON1 */
+	uint8_t bank;
 	uint8_t  tx_tsv[TSV_SIZE];
 	uint8_t  rx_rsv[RSV_SIZE];
 	struct k_sem tx_rx_sem;
@@ -6,10 +6,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-/* Driver Limitations:
+/* Received frames are copied once, from the receive buffers of the MCUX
+ * driver straight into net_buf data fragments, and transmitted frames are
+ * gathered from their fragments straight into the transmit buffer of the
+ * MCUX driver. The ENET DMA requires 16 byte aligned receive buffers of a
+ * single size, which net_buf data fragments are not, so the descriptors
+ * cannot point at the fragments themselves.
  *
- * There is no statistics collection for either normal operation or
- * error behaviour.
+ * Received frames are processed by a work item on the system workqueue.
+ * The RX interrupt is masked until the work drained the receive ring, at
+ * most CONFIG_ETH_MCUX_RX_BUDGET frames per pass, so that a burst of
+ * frames costs a single interrupt. Ring statistics are kept in
+ * struct eth_mcux_stats.
  */
 
 #define SYS_LOG_DOMAIN "dev/eth_mcux"
@@ -18,6 +26,8 @@
 
 #include <board.h>
 #include <device.h>
+#include <errno.h>
+#include <string.h>
 #include <misc/util.h>
 #include <kernel.h>
 #include <net/nbuf.h>
@@ -58,10 +68,31 @@ static const char *phy_state_name(enum eth_mcux_phy_state state)
 	return name[state];
 }
 
+struct eth_mcux_stats {
+	/* frames handed to the networking stack */
+	uint32_t rx_frames;
+	uint32_t rx_bytes;
+	/* frames received with errors, or dropped for lack of net_buf */
+	uint32_t rx_errors;
+	uint32_t rx_dropped;
+	/* passes of the RX work, and those which used up their budget */
+	uint32_t rx_polls;
+	uint32_t rx_budget_exhausted;
+	uint32_t tx_frames;
+	uint32_t tx_bytes;
+	/* frames which had to wait for a free transmit buffer */
+	uint32_t tx_ring_full;
+};
+
 struct eth_context {
 	struct net_if *iface;
 	enet_handle_t enet_handle;
 	struct k_sem tx_buf_sem;
+	/* oldest transmit descriptor not reclaimed yet */
+	volatile enet_tx_bd_struct_t *tx_bd_dirty;
+	uint8_t tx_pending;
+	struct k_work rx_work;
+	struct eth_mcux_stats stats;
 	enum eth_mcux_phy_state phy_state;
 	bool enabled;
 	bool link_up;
@@ -70,25 +101,12 @@ struct eth_context {
 	uint8_t mac_addr[6];
 	struct k_work phy_work;
 	struct k_delayed_work delayed_phy_work;
-	/* TODO: FIXME. This Ethernet frame sized buffer is used for
-	 * interfacing with MCUX. How it works is that hardware uses
-	 * DMA scatter buffers to receive a frame, and then public
-	 * MCUX call gathers them into this buffer (there's no other
-	 * public interface). All this happens only for this driver
-	 * to scatter this buffer again into Zephyr fragment buffers.
-	 * This is not efficient, but proper resolution of this issue
-	 * depends on introduction of zero-copy networking support
-	 * in Zephyr, and adding needed interface to MCUX (or
-	 * bypassing it and writing a more complex driver working
-	 * directly with hardware).
-	 */
-	uint8_t frame_buf[1500];
 };
 
 static void eth_0_config_func(void);
 
 static enet_rx_bd_struct_t __aligned(ENET_BUFF_ALIGNMENT)
-rx_buffer_desc[CONFIG_ETH_MCUX_TX_BUFFERS];
+rx_buffer_desc[CONFIG_ETH_MCUX_RX_BUFFERS];
 
 static enet_tx_bd_struct_t __aligned(ENET_BUFF_ALIGNMENT)
 tx_buffer_desc[CONFIG_ETH_MCUX_TX_BUFFERS];
@@ -309,26 +327,34 @@ static void eth_mcux_delayed_phy_work(struct k_work *item)
 static int eth_tx(struct net_if *iface, struct net_buf *buf)
 {
 	struct eth_context *context = iface->dev->driver_data;
+	enet_handle_t *handle = &context->enet_handle;
+	volatile enet_tx_bd_struct_t *bd;
 	const struct net_buf *frag;
 	uint8_t *dst;
-	status_t status;
 	unsigned int imask;
 
 	uint16_t total_len = net_nbuf_ll_reserve(buf) + net_buf_frags_len(buf);
 
-	k_sem_take(&context->tx_buf_sem, K_FOREVER);
+	if (total_len > handle->txBuffSizeAlign) {
+		SYS_LOG_ERR("frame too large (%d)", total_len);
+		return -EMSGSIZE;
+	}
+
+	if (k_sem_take(&context->tx_buf_sem, K_NO_WAIT)) {
+		context->stats.tx_ring_full++;
+		k_sem_take(&context->tx_buf_sem, K_FOREVER);
+	}
 
-	/* As context->frame_buf is shared resource used by both eth_tx
-	 * and eth_rx, we need to protect it with irq_lock.
+	/* The semaphore guarantees the current transmit buffer is free,
+	 * only this function moves it forward.
 	 */
-	imask = irq_lock();
+	bd = handle->txBdCurrent;
 
-	/* Gather fragment buffers into flat Ethernet frame buffer
-	 * which can be fed to MCUX Ethernet functions. First
-	 * fragment is special - it contains link layer (Ethernet
-	 * in our case) headers and must be treated specially.
+	/* Gather fragment buffers straight into the transmit buffer. First
+	 * fragment is special - it contains link layer (Ethernet in our
+	 * case) headers and must be treated specially.
 	 */
-	dst = context->frame_buf;
+	dst = bd->buffer;
 	memcpy(dst, net_nbuf_ll(buf),
 	       net_nbuf_ll_reserve(buf) + buf->frags->len);
 	dst += net_nbuf_ll_reserve(buf) + buf->frags->len;
@@ -341,84 +367,71 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 		frag = frag->frags;
 	}
 
-	status = ENET_SendFrame(ENET, &context->enet_handle, context->frame_buf,
-				total_len);
+	/* The transmit interrupt reclaims the descriptors */
+	imask = irq_lock();
 
-	irq_unlock(imask);
+	bd->length = total_len;
+	bd->control |= (ENET_BUFFDESCRIPTOR_TX_READY_MASK |
+			ENET_BUFFDESCRIPTOR_TX_LAST_MASK);
 
-	if (status) {
-		SYS_LOG_ERR("ENET_SendFrame error: %d\n", status);
-		return -1;
+	if (bd->control & ENET_BUFFDESCRIPTOR_TX_WRAP_MASK) {
+		handle->txBdCurrent = handle->txBdBase;
+	} else {
+		handle->txBdCurrent++;
 	}
 
+	context->tx_pending++;
+	context->stats.tx_frames++;
+	context->stats.tx_bytes += total_len;
+
+	irq_unlock(imask);
+
+	ENET->TDAR = ENET_TDAR_TDAR_MASK;
+
 	net_nbuf_unref(buf);
 	return 0;
 }
 
-static void eth_rx(struct device *iface)
+static void eth_tx_reclaim(struct eth_context *context)
 {
-	struct eth_context *context = iface->driver_data;
-	struct net_buf *buf, *prev_frag;
-	const uint8_t *src;
-	uint32_t frame_length = 0;
-	status_t status;
-	unsigned int imask;
-
-	status = ENET_GetRxFrameSize(&context->enet_handle, &frame_length);
-	if (status) {
-		enet_data_error_stats_t error_stats;
-
-		SYS_LOG_ERR("ENET_GetRxFrameSize return: %d", status);
+	enet_handle_t *handle = &context->enet_handle;
+
+	/* One interrupt may stand for several frames sent */
+	while (context->tx_pending &&
+	       !(context->tx_bd_dirty->control &
+		 ENET_BUFFDESCRIPTOR_TX_READY_MASK)) {
+		if (context->tx_bd_dirty->control &
+		    ENET_BUFFDESCRIPTOR_TX_WRAP_MASK) {
+			context->tx_bd_dirty = handle->txBdBase;
+		} else {
+			context->tx_bd_dirty++;
+		}
 
-		ENET_GetRxErrBeforeReadFrame(&context->enet_handle,
-					     &error_stats);
-		/* Flush the current read buffer.  This operation can
-		 * only report failure if there is no frame to flush,
-		 * which cannot happen in this context.
-		 */
-		status = ENET_ReadFrame(ENET, &context->enet_handle, NULL, 0);
-		assert(status == kStatus_Success);
-		return;
+		context->tx_pending--;
+		k_sem_give(&context->tx_buf_sem);
 	}
+}
+
+/* Copy the frame of frame_length bytes starting at the current receive
+ * descriptor into net_buf fragments. The descriptors are left untouched.
+ */
+static struct net_buf *eth_rx_frame_get(struct eth_context *context,
+					uint32_t frame_length)
+{
+	enet_handle_t *handle = &context->enet_handle;
+	volatile enet_rx_bd_struct_t *bd = handle->rxBdCurrent;
+	uint32_t offset = 0;
+	struct net_buf *buf, *prev_frag;
 
 	buf = net_nbuf_get_reserve_rx(0, K_NO_WAIT);
 	if (!buf) {
 		/* We failed to get a receive buffer.  We don't add
 		 * any further logging here because the allocator
 		 * issued a diagnostic when it failed to allocate.
-		 *
-		 * Flush the current read buffer.  This operation can
-		 * only report failure if there is no frame to flush,
-		 * which cannot happen in this context.
 		 */
-		status = ENET_ReadFrame(ENET, &context->enet_handle, NULL, 0);
-		assert(status == kStatus_Success);
-		return;
-	}
-
-	if (sizeof(context->frame_buf) < frame_length) {
-		SYS_LOG_ERR("frame too large (%d)\n", frame_length);
-		net_nbuf_unref(buf);
-		status = ENET_ReadFrame(ENET, &context->enet_handle, NULL, 0);
-		assert(status == kStatus_Success);
-		return;
-	}
-
-	/* As context->frame_buf is shared resource used by both eth_tx
-	 * and eth_rx, we need to protect it with irq_lock.
-	 */
-	imask = irq_lock();
-
-	status = ENET_ReadFrame(ENET, &context->enet_handle,
-				context->frame_buf, frame_length);
-	if (status) {
-		irq_unlock(imask);
-		SYS_LOG_ERR("ENET_ReadFrame failed: %d\n", status);
-		net_nbuf_unref(buf);
-		return;
+		return NULL;
 	}
 
-	src = context->frame_buf;
 	prev_frag = buf;
 	do {
 		struct net_buf *pkt_buf;
@@ -426,29 +439,119 @@ static void eth_rx(struct device *iface)
 
 		pkt_buf = net_nbuf_get_frag(buf, K_NO_WAIT);
 		if (!pkt_buf) {
-			irq_unlock(imask);
 			SYS_LOG_ERR("Failed to get fragment buf\n");
 			net_nbuf_unref(buf);
-			assert(status == kStatus_Success);
-			return;
+			return NULL;
 		}
 
 		net_buf_frag_insert(prev_frag, pkt_buf);
 		prev_frag = pkt_buf;
-		frag_len = net_buf_tailroom(pkt_buf);
-		if (frag_len > frame_length) {
-			frag_len = frame_length;
-		}
 
-		memcpy(pkt_buf->data, src, frag_len);
-		net_buf_add(pkt_buf, frag_len);
-		src += frag_len;
-		frame_length -= frag_len;
+		/* A fragment may span several receive buffers */
+		while (net_buf_tailroom(pkt_buf) && frame_length) {
+			if (offset == handle->rxBuffSizeAlign) {
+				if (bd->control &
+				    ENET_BUFFDESCRIPTOR_RX_WRAP_MASK) {
+					bd = handle->rxBdBase;
+				} else {
+					bd++;
+				}
+				offset = 0;
+			}
+
+			frag_len = min(net_buf_tailroom(pkt_buf),
+				       handle->rxBuffSizeAlign - offset);
+			if (frag_len > frame_length) {
+				frag_len = frame_length;
+			}
+
+			memcpy(net_buf_add(pkt_buf, frag_len),
+			       bd->buffer + offset, frag_len);
+			offset += frag_len;
+			frame_length -= frag_len;
+		}
 	} while (frame_length > 0);
 
-	irq_unlock(imask);
+	return buf;
+}
+
+/* Hand the frame at the current receive descriptor to the networking
+ * stack. Returns false when no complete frame is waiting.
+ */
+static bool eth_rx(struct eth_context *context)
+{
+	struct net_buf *buf = NULL;
+	uint32_t frame_length = 0;
+	status_t status;
+
+	status = ENET_GetRxFrameSize(&context->enet_handle, &frame_length);
+	if (status == kStatus_ENET_RxFrameEmpty) {
+		return false;
+	}
+
+	if (status) {
+		enet_data_error_stats_t error_stats;
+
+		SYS_LOG_ERR("ENET_GetRxFrameSize return: %d", status);
+
+		ENET_GetRxErrBeforeReadFrame(&context->enet_handle,
+					     &error_stats);
+		context->stats.rx_errors++;
+	} else {
+		buf = eth_rx_frame_get(context, frame_length);
+		if (!buf) {
+			context->stats.rx_dropped++;
+		}
+	}
+
+	/* Give the receive buffers of the frame back to the hardware.  This
+	 * operation can only report failure if there is no frame to flush,
+	 * which cannot happen in this context.
+	 */
+	status = ENET_ReadFrame(ENET, &context->enet_handle, NULL, 0);
+	assert(status == kStatus_Success);
+
+	if (buf) {
+		context->stats.rx_frames++;
+		context->stats.rx_bytes += frame_length;
+
+		net_recv_data(context->iface, buf);
+	}
 
-	net_recv_data(context->iface, buf);
+	return true;
+}
+
+static void eth_mcux_rx_work(struct k_work *item)
+{
+	struct eth_context *context =
+		CONTAINER_OF(item, struct eth_context, rx_work);
+	unsigned int budget = CONFIG_ETH_MCUX_RX_BUDGET;
+	uint32_t frame_length;
+
+	context->stats.rx_polls++;
+
+	while (budget && eth_rx(context)) {
+		budget--;
+	}
+
+	if (!budget) {
+		/* Let the other work items run before polling again */
+		context->stats.rx_budget_exhausted++;
+		k_work_submit(item);
+		return;
+	}
+
+	ENET_ClearInterruptStatus(ENET, kENET_RxFrameInterrupt);
+	ENET_EnableInterrupts(ENET, kENET_RxFrameInterrupt);
+
+	/* A frame received before the interrupt status was cleared would
+	 * not raise the interrupt.
+	 */
+	if (ENET_GetRxFrameSize(&context->enet_handle, &frame_length) !=
+	    kStatus_ENET_RxFrameEmpty) {
+		ENET_DisableInterrupts(ENET, kENET_RxFrameInterrupt);
+		k_work_submit(item);
+	}
 }
 
 static void eth_callback(ENET_Type *base, enet_handle_t *handle,
@@ -459,11 +562,13 @@ static void eth_callback(ENET_Type *base, enet_handle_t *handle,
 
 	switch (event) {
 	case kENET_RxEvent:
-		eth_rx(iface);
+		/* Poll the receive ring until it is drained */
+		ENET_DisableInterrupts(ENET, kENET_RxFrameInterrupt);
+		k_work_submit(&context->rx_work);
 		break;
 	case kENET_TxEvent:
-		/* Free the TX buffer. */
-		k_sem_give(&context->tx_buf_sem);
+		/* Free the TX buffers. */
+		eth_tx_reclaim(context);
 		break;
 	case kENET_ErrEvent:
 		/* Error event: BABR/BABT/EBERR/LC/RL/UN/PLR.  */
@@ -514,6 +619,7 @@ static int eth_0_init(struct device *dev)
 
 	k_sem_init(&context->tx_buf_sem,
 		   CONFIG_ETH_MCUX_TX_BUFFERS, CONFIG_ETH_MCUX_TX_BUFFERS);
+	k_work_init(&context->rx_work, eth_mcux_rx_work);
 	k_work_init(&context->phy_work, eth_mcux_phy_work);
 	k_delayed_work_init(&context->delayed_phy_work,
 			    eth_mcux_delayed_phy_work);
@@ -547,6 +653,8 @@ static int eth_0_init(struct device *dev)
 		  context->mac_addr,
 		  sys_clock);
 
+	context->tx_bd_dirty = context->enet_handle.txBdBase;
+
 	ENET_SetSMI(ENET, sys_clock, false);
 
 	SYS_LOG_DBG("MAC %02x:%02x:%02x:%02x:%02x:%02x",
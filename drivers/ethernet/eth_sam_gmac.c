@@ -11,9 +11,15 @@
  * buffers during the initialization phase. This driver has to be initialized
  * after the higher layer networking stack is.
  *
+ * Received frames are processed by a work item on the system workqueue
+ * rather than in the ISR. The ISR masks RX interrupts and submits the work,
+ * which hands at most CONFIG_ETH_SAM_GMAC_RX_BUDGET frames to the stack per
+ * pass and resubmits itself while frames remain, so that a burst of frames
+ * costs a single interrupt. RX interrupts are unmasked once the ring is
+ * drained. Per queue ring statistics are kept in struct gmac_queue.
+ *
  * Limitations:
  * - one shot PHY setup, no support for PHY disconnect/reconnect
- * - no statistics collection
  * - no support for devices with DCache enabled due to missing non-cacheable
  *   RAM regions in Zephyr.
  */
@@ -28,6 +34,7 @@
 #include <misc/util.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <string.h>
 #include <net/nbuf.h>
 #include <net/net_if.h>
 #include <soc.h>
@@ -123,9 +130,10 @@ static void free_rx_bufs(struct ring_buf *rx_nbuf_list)
 	struct net_buf *buf;
 
 	for (int i = 0; i < rx_nbuf_list->len; i++) {
-		buf = (struct net_buf *)rx_nbuf_list->buf;
+		buf = (struct net_buf *)rx_nbuf_list->buf[i];
 		if (buf) {
 			net_buf_unref(buf);
+			rx_nbuf_list->buf[i] = 0;
 		}
 	}
 }
@@ -218,22 +226,22 @@ static void tx_completed(Gmac *gmac, struct gmac_queue *queue)
 	struct gmac_desc *tx_desc;
 	struct net_buf *buf;
 
-	__ASSERT(tx_desc_list->buf[tx_desc_list->tail].w1 & GMAC_TXW1_USED,
-		 "first buffer of a frame is not marked as own by GMAC");
-
-	while (tx_desc_list->tail != tx_desc_list->head) {
-
-		tx_desc = &tx_desc_list->buf[tx_desc_list->tail];
-		MODULO_INC(tx_desc_list->tail, tx_desc_list->len);
-
-		if (tx_desc->w1 & GMAC_TXW1_LASTBUFFER) {
-			/* Release net buffer to the buffer pool */
-			buf = UINT_TO_POINTER(ring_buf_get(&queue->tx_frames));
-			net_buf_unref(buf);
-			SYS_LOG_DBG("Dropping buf %p", buf);
-
-			break;
-		}
+	/* Several frames may have been sent since the last interrupt. GMAC
+	 * sets the used bit of the first buffer of a frame once the frame is
+	 * sent.
+	 */
+	while (tx_desc_list->tail != tx_desc_list->head &&
+	       (tx_desc_list->buf[tx_desc_list->tail].w1 & GMAC_TXW1_USED)) {
+		do {
+			tx_desc = &tx_desc_list->buf[tx_desc_list->tail];
+			MODULO_INC(tx_desc_list->tail, tx_desc_list->len);
+			k_sem_give(&queue->tx_desc_sem);
+		} while (!(tx_desc->w1 & GMAC_TXW1_LASTBUFFER));
+
+		/* Release net buffer to the buffer pool */
+		buf = UINT_TO_POINTER(ring_buf_get(&queue->tx_frames));
+		net_buf_unref(buf);
+		SYS_LOG_DBG("Dropping buf %p", buf);
 	}
 }
 
@@ -242,11 +250,25 @@ static void tx_completed(Gmac *gmac, struct gmac_queue *queue)
  */
 static void tx_error_handler(Gmac *gmac, struct gmac_queue *queue)
 {
+	struct gmac_desc_list *tx_desc_list = &queue->tx_desc_list;
+	struct net_buf *buf;
+
 	queue->err_tx_flushed_count++;
 
 	/* Stop transmission, clean transmit pipeline and control registers */
 	gmac->GMAC_NCR &= ~GMAC_NCR_TXEN;
 
+	/* Abandon the frames still queued */
+	while (tx_desc_list->tail != tx_desc_list->head) {
+		MODULO_INC(tx_desc_list->tail, tx_desc_list->len);
+		k_sem_give(&queue->tx_desc_sem);
+	}
+
+	while (queue->tx_frames.tail != queue->tx_frames.head) {
+		buf = UINT_TO_POINTER(ring_buf_get(&queue->tx_frames));
+		net_buf_unref(buf);
+	}
+
 	tx_descriptors_init(gmac, queue);
 
 	/* Restart transmission */
@@ -379,6 +401,10 @@ static int queue_init(Gmac *gmac, struct gmac_queue *queue)
 
 	tx_descriptors_init(gmac, queue);
 
+	/* One descriptor always stays used to stop the transmit DMA */
+	k_sem_init(&queue->tx_desc_sem, queue->tx_desc_list.len - 1,
+		   queue->tx_desc_list.len - 1);
+
 	/* Set Receive Buffer Queue Pointer Register */
 	gmac->GMAC_RBQB = (uint32_t)queue->rx_desc_list.buf;
 	/* Set Transmit Buffer Queue Pointer Register */
@@ -403,6 +429,7 @@ static int queue_init(Gmac *gmac, struct gmac_queue *queue)
 	queue->err_rx_frames_dropped = 0;
 	queue->err_rx_flushed_count = 0;
 	queue->err_tx_flushed_count = 0;
+	memset(&queue->stats, 0, sizeof(queue->stats));
 
 	SYS_LOG_INF("Queue %d activated", queue->que_idx);
 
@@ -439,22 +466,16 @@ static int priority_queue_init_as_idle(Gmac *gmac, struct gmac_queue *queue)
 	return 0;
 }
 
-static struct net_buf *frame_get(struct gmac_queue *queue)
+/*
+ * Check if there exists a complete frame in RX descriptor list
+ */
+static bool frame_ready(struct gmac_queue *queue)
 {
 	struct gmac_desc_list *rx_desc_list = &queue->rx_desc_list;
 	struct gmac_desc *rx_desc;
-	struct ring_buf *rx_nbuf_list = &queue->rx_nbuf_list;
-	struct net_buf *rx_frame;
 	bool frame_is_complete;
-	struct net_buf *prev_frag;
-	struct net_buf *frag;
-	struct net_buf *new_frag;
-	uint8_t *frag_data;
-	uint32_t frag_len;
-	uint32_t frame_len = 0;
 	uint16_t tail;
 
-	/* Check if there exists a complete frame in RX descriptor list */
 	tail = rx_desc_list->tail;
 	rx_desc = &rx_desc_list->buf[tail];
 	frame_is_complete = false;
@@ -463,14 +484,37 @@ static struct net_buf *frame_get(struct gmac_queue *queue)
 		MODULO_INC(tail, rx_desc_list->len);
 		rx_desc = &rx_desc_list->buf[tail];
 	}
+
 	/* Frame which is not complete can be dropped by GMAC. Do not process
 	 * it, even partially.
 	 */
-	if (!frame_is_complete) {
-		return NULL;
-	}
+	return frame_is_complete;
+}
+
+/*
+ * Take the complete frame at the tail of the RX descriptor list, replacing
+ * its data net buffers in the descriptors with new ones. Returns NULL when
+ * the frame had to be dropped.
+ */
+static struct net_buf *frame_get(struct gmac_queue *queue)
+{
+	struct gmac_desc_list *rx_desc_list = &queue->rx_desc_list;
+	struct gmac_desc *rx_desc;
+	struct ring_buf *rx_nbuf_list = &queue->rx_nbuf_list;
+	struct net_buf *rx_frame;
+	bool frame_is_complete;
+	struct net_buf *prev_frag;
+	struct net_buf *frag;
+	struct net_buf *new_frag;
+	uint8_t *frag_data;
+	uint32_t frag_len;
+	uint32_t frame_len = 0;
+	uint16_t tail;
 
 	rx_frame = net_nbuf_get_reserve_rx(0, K_NO_WAIT);
+	if (rx_frame == NULL) {
+		queue->err_rx_frames_dropped++;
+	}
 
 	/* Process a frame */
 	prev_frag = rx_frame;
@@ -509,7 +553,7 @@ static struct net_buf *frame_get(struct gmac_queue *queue)
 			DCACHE_INVALIDATE(frag_data, frag_len);
 
 			/* Get a new data net buffer from the buffer pool */
-			new_frag = net_nbuf_get_frag(buf, K_NO_WAIT);
+			new_frag = net_nbuf_get_frag(rx_frame, K_NO_WAIT);
 			if (new_frag == NULL) {
 				queue->err_rx_frames_dropped++;
 				net_buf_unref(rx_frame);
@@ -545,22 +589,62 @@ static struct net_buf *frame_get(struct gmac_queue *queue)
 	return rx_frame;
 }
 
-static void eth_rx(struct gmac_queue *queue)
+static void eth_rx_work(struct k_work *item)
 {
+	struct gmac_queue *queue = CONTAINER_OF(item, struct gmac_queue,
+						rx_work);
 	struct eth_sam_dev_data *dev_data =
 		CONTAINER_OF(queue, struct eth_sam_dev_data, queue_list);
+	Gmac *gmac = DEV_CFG(dev_data->dev)->regs;
 	struct net_buf *rx_frame;
+	unsigned int budget = CONFIG_ETH_SAM_GMAC_RX_BUDGET;
+	unsigned int key;
+
+	queue->stats.rx_polls++;
+
+	if (queue->rx_error) {
+		queue->rx_error = false;
+
+		/* The ISR shares the Network Control Register */
+		key = irq_lock();
+		rx_error_handler(gmac, queue);
+		irq_unlock(key);
+	}
 
-	/* More than one frame could have been received by GMAC, get all
+	/* More than one frame could have been received by GMAC, get the
 	 * complete frames stored in the GMAC RX descriptor list.
 	 */
-	rx_frame = frame_get(queue);
-	while (rx_frame) {
+	while (budget && frame_ready(queue)) {
+		budget--;
+
+		rx_frame = frame_get(queue);
+		if (!rx_frame) {
+			continue;
+		}
+
 		SYS_LOG_DBG("ETH rx");
 
+		queue->stats.rx_frames++;
+		queue->stats.rx_bytes += net_buf_frags_len(rx_frame);
+
 		net_recv_data(dev_data->iface, rx_frame);
+	}
 
-		rx_frame = frame_get(queue);
+	if (!budget) {
+		/* Let the other work items run before polling again */
+		queue->stats.rx_budget_exhausted++;
+		k_work_submit(item);
+		return;
+	}
+
+	gmac->GMAC_IER = GMAC_INT_RX_FLAGS;
+
+	/* The status of a frame completed while RX interrupts were masked
+	 * may have been cleared by the ISR handling TX.
+	 */
+	if (frame_ready(queue)) {
+		gmac->GMAC_IDR = GMAC_INT_RX_FLAGS;
+		k_work_submit(item);
 	}
 }
 
@@ -573,15 +657,38 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 	struct gmac_queue *queue = &dev_data->queue_list[0];
 	struct gmac_desc_list *tx_desc_list = &queue->tx_desc_list;
 	struct gmac_desc *tx_desc;
+	struct gmac_desc *tx_first_desc;
 	struct net_buf *frag;
 	uint8_t *frag_data;
 	uint16_t frag_len;
+	uint16_t frag_count = 0;
+	uint16_t frame_len;
+	uint16_t head;
+	unsigned int key;
 
 	__ASSERT(buf, "buf pointer is NULL");
 	__ASSERT(buf->frags, "Frame data missing");
 
 	SYS_LOG_DBG("ETH tx");
 
+	frame_len = net_nbuf_ll_reserve(buf) + net_buf_frags_len(buf);
+
+	/* Each fragment is sent from its own descriptor */
+	for (frag = buf->frags; frag; frag = frag->frags) {
+		frag_count++;
+	}
+
+	__ASSERT(frag_count < tx_desc_list->len,
+		 "Frame has more fragments than TX descriptors");
+
+	if (k_sem_count_get(&queue->tx_desc_sem) < frag_count) {
+		queue->stats.tx_ring_full++;
+	}
+
+	for (int i = 0; i < frag_count; i++) {
+		k_sem_take(&queue->tx_desc_sem, K_FOREVER);
+	}
+
 	/* First fragment is special - it contains link layer (Ethernet
 	 * in our case) header.
 	 */
@@ -601,11 +708,15 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 	frag = buf->frags;
 #endif
 
+	/* The ISR only sees the frame once it is complete */
+	head = tx_desc_list->head;
+	tx_first_desc = &tx_desc_list->buf[head];
+
 	while (frag) {
 		/* Assure cache coherency before DMA read operation */
 		DCACHE_CLEAN(frag_data, frag_len);
 
-		tx_desc = &tx_desc_list->buf[tx_desc_list->head];
+		tx_desc = &tx_desc_list->buf[head];
 
 		/* Update buffer descriptor address word */
 		tx_desc->w0 = (uint32_t)frag_data;
@@ -613,35 +724,53 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 		 * word to avoid race condition.
 		 */
 		__DMB();  /* data memory barrier */
-		/* Update buffer descriptor status word (clear used bit) */
+		/* Update buffer descriptor status word (clear used bit, except
+		 * on the first buffer, the frame is handed over to GMAC once
+		 * complete).
+		 */
 		tx_desc->w1 =
 			  (frag_len & GMAC_TXW1_LEN)
 			| (!frag->frags ? GMAC_TXW1_LASTBUFFER : 0)
-			| (tx_desc_list->head == tx_desc_list->len - 1
-			   ? GMAC_TXW1_WRAP : 0);
+			| (head == tx_desc_list->len - 1 ? GMAC_TXW1_WRAP : 0)
+			| (tx_desc == tx_first_desc ? GMAC_TXW1_USED : 0);
 
 		/* Update descriptor position */
-		MODULO_INC(tx_desc_list->head, tx_desc_list->len);
+		MODULO_INC(head, tx_desc_list->len);
 
-		__ASSERT(tx_desc_list->head != tx_desc_list->tail,
-			 "tx_desc_list overflow");
+		__ASSERT(head != tx_desc_list->tail, "tx_desc_list overflow");
 
 		/* Continue with the rest of fragments (only data) */
 		frag = frag->frags;
-		frag_data = frag->data;
-		frag_len = frag->len;
+		if (frag) {
+			frag_data = frag->data;
+			frag_len = frag->len;
+		}
 	}
 
 	/* Ensure the descriptor following the last one is marked as used */
-	tx_desc = &tx_desc_list->buf[tx_desc_list->head];
+	tx_desc = &tx_desc_list->buf[head];
 	tx_desc->w1 |= GMAC_TXW1_USED;
 
+	key = irq_lock();
+
 	/* Account for a sent frame */
 	ring_buf_put(&queue->tx_frames, POINTER_TO_UINT(buf));
+	tx_desc_list->head = head;
+
+	/* Guarantee that the whole frame is described before GMAC may read
+	 * its first buffer.
+	 */
+	__DMB();  /* data memory barrier */
+	tx_first_desc->w1 &= ~GMAC_TXW1_USED;
 
 	/* Start transmission */
 	gmac->GMAC_NCR |= GMAC_NCR_TSTART;
 
+	queue->stats.tx_frames++;
+	queue->stats.tx_bytes += frame_len;
+
+	irq_unlock(key);
+
 	return 0;
 }
 
@@ -658,14 +787,17 @@ static void queue0_isr(void *arg)
 	isr = gmac->GMAC_ISR;
 	SYS_LOG_DBG("GMAC_ISR=0x%08x", isr);
 
-	/* RX packet */
-	if (isr & GMAC_INT_RX_ERR_BITS) {
-		rx_error_handler(gmac, queue);
-	} else if (isr & GMAC_ISR_RCOMP) {
+	/* RX packet, processed by the RX work with RX interrupts masked */
+	if (isr & GMAC_INT_RX_FLAGS) {
+		if (isr & GMAC_INT_RX_ERR_BITS) {
+			queue->rx_error = true;
+		}
+
 		SYS_LOG_DBG("rx.w1=0x%08x, tail=%d",
 			    queue->rx_desc_list.buf[queue->rx_desc_list.tail].w1,
 			    queue->rx_desc_list.tail);
-		eth_rx(queue);
+		gmac->GMAC_IDR = GMAC_INT_RX_FLAGS;
+		k_work_submit(&queue->rx_work);
 	}
 
 	/* TX packet */
@@ -691,6 +823,9 @@ static int eth_initialize(struct device *dev)
 	uint32_t gmac_ncfgr_val;
 	int result;
 
+	dev_data->dev = dev;
+	k_work_init(&dev_data->queue_list[0].rx_work, eth_rx_work);
+
 	cfg->config_func();
 
 	/* Enable GMAC module's clock */
@@ -11,6 +11,7 @@
 #define _ETH_SAM_GMAC_PRIV_H_
 
 #include <stdint.h>
+#include <kernel.h>
 
 #define GMAC_MTU 1500
 #define GMAC_FRAME_SIZE_MAX (GMAC_MTU + 18)
@@ -114,8 +115,10 @@
 		(GMAC_IER_RXUBR | GMAC_IER_ROVR)
 #define GMAC_INT_TX_ERR_BITS \
 		(GMAC_IER_TUR | GMAC_IER_RLEX | GMAC_IER_TFC)
+#define GMAC_INT_RX_FLAGS \
+		(GMAC_IER_RCOMP | GMAC_INT_RX_ERR_BITS)
 #define GMAC_INT_EN_FLAGS \
-		(GMAC_IER_RCOMP | GMAC_INT_RX_ERR_BITS | \
+		(GMAC_INT_RX_FLAGS | \
 		 GMAC_IER_TCOMP | GMAC_INT_TX_ERR_BITS | GMAC_IER_HRESP)
 
 /** List of GMAC queues */
@@ -147,6 +150,22 @@ struct gmac_desc_list {
 	uint16_t tail;
 };
 
+/** RX/TX ring statistics */
+struct gmac_ring_stats {
+	/** Frames handed to the networking stack */
+	uint32_t rx_frames;
+	uint32_t rx_bytes;
+	/** Passes of the RX poll work, one per interrupt at low load */
+	uint32_t rx_polls;
+	/** Passes which used up their budget with frames left in the ring */
+	uint32_t rx_budget_exhausted;
+	/** Frames queued for transmission */
+	uint32_t tx_frames;
+	uint32_t tx_bytes;
+	/** Frames which had to wait for free TX descriptors */
+	uint32_t tx_ring_full;
+};
+
 /** GMAC Queue data */
 struct gmac_queue {
 	struct gmac_desc_list rx_desc_list;
@@ -155,6 +174,15 @@ struct gmac_queue {
 	struct ring_buf rx_nbuf_list;
 	struct ring_buf tx_frames;
 
+	/** Free TX descriptors */
+	struct k_sem tx_desc_sem;
+	/** Deferred RX processing, RX interrupts are masked while pending */
+	struct k_work rx_work;
+	/** RX error reported by the ISR, handled by the RX work */
+	volatile bool rx_error;
+
+	struct gmac_ring_stats stats;
+
 	/** Number of RX frames dropped by the driver */
 	volatile uint32_t err_rx_frames_dropped;
 	/** Number of times receive queue was flushed */
@@ -177,6 +205,7 @@ struct eth_sam_dev_cfg {
 
 /* Device run time data */
 struct eth_sam_dev_data {
+	struct device *dev;
 	struct net_if *iface;
 	uint8_t mac_addr[6];
 	struct gmac_queue queue_list[GMAC_QUEUE_NO];
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief RAM backed NOR flash simulator
+ *
+ * Emulates a NOR flash in RAM: erases set whole erase units to 0xff,
+ * writes can only clear bits and both require write protection to be
+ * disabled. Optional busy-wait delays approximate the timing of a real
+ * part, so that storage code can be exercised and benchmarked on boards
+ * without flash, such as QEMU.
+ */
+
+#include <errno.h>
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <flash.h>
+#include <string.h>
+
+#define SIM_SIZE	CONFIG_FLASH_SIMULATOR_SIZE
+#define SIM_ERASE_UNIT	CONFIG_FLASH_SIMULATOR_ERASE_UNIT
+#define SIM_WRITE_UNIT	CONFIG_FLASH_SIMULATOR_WRITE_UNIT
+#define SIM_ERASE_VALUE	0xff
+
+struct flash_sim_data {
+	uint8_t mem[SIM_SIZE];
+	bool write_protected;
+};
+
+static struct flash_sim_data flash_sim_data;
+
+static bool flash_sim_range_is_valid(off_t offset, size_t len)
+{
+	return (offset >= 0) && (len <= SIM_SIZE) && (offset <= SIM_SIZE - len);
+}
+
+static int flash_sim_read(struct device *dev, off_t offset, void *data,
+			  size_t len)
+{
+	struct flash_sim_data *sim = dev->driver_data;
+
+	if (!flash_sim_range_is_valid(offset, len)) {
+		return -EINVAL;
+	}
+
+	memcpy(data, sim->mem + offset, len);
+
+	return 0;
+}
+
+static int flash_sim_write(struct device *dev, off_t offset,
+			   const void *data, size_t len)
+{
+	struct flash_sim_data *sim = dev->driver_data;
+	const uint8_t *src = data;
+	size_t i;
+
+	if (!flash_sim_range_is_valid(offset, len) ||
+	    (offset % SIM_WRITE_UNIT) || (len % SIM_WRITE_UNIT)) {
+		return -EINVAL;
+	}
+
+	if (sim->write_protected) {
+		return -EACCES;
+	}
+
+	/* programming can only clear bits */
+	for (i = 0; i < len; i++) {
+		sim->mem[offset + i] &= src[i];
+	}
+
+	if (CONFIG_FLASH_SIMULATOR_WRITE_DELAY_US) {
+		k_busy_wait(CONFIG_FLASH_SIMULATOR_WRITE_DELAY_US *
+			    (len / SIM_WRITE_UNIT));
+	}
+
+	return 0;
+}
+
+static int flash_sim_erase(struct device *dev, off_t offset, size_t len)
+{
+	struct flash_sim_data *sim = dev->driver_data;
+
+	if (!flash_sim_range_is_valid(offset, len) ||
+	    (offset % SIM_ERASE_UNIT) || (len % SIM_ERASE_UNIT)) {
+		return -EINVAL;
+	}
+
+	if (sim->write_protected) {
+		return -EACCES;
+	}
+
+	memset(sim->mem + offset, SIM_ERASE_VALUE, len);
+
+	if (CONFIG_FLASH_SIMULATOR_ERASE_DELAY_US) {
+		k_busy_wait(CONFIG_FLASH_SIMULATOR_ERASE_DELAY_US *
+			    (len / SIM_ERASE_UNIT));
+	}
+
+	return 0;
+}
+
+static int flash_sim_write_protection(struct device *dev, bool enable)
+{
+	struct flash_sim_data *sim = dev->driver_data;
+
+	sim->write_protected = enable;
+
+	return 0;
+}
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static const struct flash_pages_layout flash_sim_pages_layout = {
+	.pages_count = SIM_SIZE / SIM_ERASE_UNIT,
+	.pages_size = SIM_ERASE_UNIT,
+};
+
+static void flash_sim_page_layout(struct device *dev,
+				  const struct flash_pages_layout **layout,
+				  size_t *layout_size)
+{
+	*layout = &flash_sim_pages_layout;
+	*layout_size = 1;
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
+static const struct flash_driver_api flash_sim_api = {
+	.read = flash_sim_read,
+	.write = flash_sim_write,
+	.erase = flash_sim_erase,
+	.write_protection = flash_sim_write_protection,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = flash_sim_page_layout,
+#endif
+	.write_block_size = SIM_WRITE_UNIT,
+	.erase_value = SIM_ERASE_VALUE,
+};
+
+static int flash_sim_init(struct device *dev)
+{
+	struct flash_sim_data *sim = dev->driver_data;
+
+	memset(sim->mem, SIM_ERASE_VALUE, sizeof(sim->mem));
+	sim->write_protected = true;
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(flash_simulator, CONFIG_FLASH_SIMULATOR_DEV_NAME,
+		    flash_sim_init, &flash_sim_data, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &flash_sim_api);
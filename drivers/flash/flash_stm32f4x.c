@@ -238,6 +238,69 @@ static int flash_stm32f4x_write_protection(struct device *dev, bool enable)
 	return rc;
 }
 
+static int flash_stm32f4x_write_pages(struct device *dev, off_t offset,
+				      const void *data, size_t len)
+{
+	struct flash_priv *p = dev->driver_data;
+	struct stm32f4x_flash *regs = p->regs;
+	bool locked;
+	int rc = 0;
+	int i;
+
+	if (!valid_range(offset, len)) {
+		return -EINVAL;
+	}
+
+	if (!len) {
+		return 0;
+	}
+
+	k_sem_take(&p->sem, K_FOREVER);
+
+	/* unlock once for the whole buffer and restore the previous state */
+	locked = regs->ctrl & FLASH_CR_LOCK;
+	if (locked) {
+		regs->key = FLASH_KEY1;
+		regs->key = FLASH_KEY2;
+	}
+
+	for (i = 0; i < len; i++, offset++) {
+		rc = write_byte(offset, ((const uint8_t *) data)[i], regs);
+		if (rc < 0) {
+			break;
+		}
+	}
+
+	if (locked) {
+		wait_flash_idle(regs);
+		regs->ctrl |= FLASH_CR_LOCK;
+	}
+
+	k_sem_give(&p->sem);
+
+	return rc;
+}
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static const struct flash_pages_layout flash_stm32f4x_pages_layout[] = {
+	{ .pages_count = 4, .pages_size = KB(16) },
+	{ .pages_count = 1, .pages_size = KB(64) },
+#ifdef CONFIG_SOC_STM32F401XE
+	{ .pages_count = 3, .pages_size = KB(128) },
+#else
+	{ .pages_count = 2, .pages_size = KB(128) },
+#endif
+};
+
+static void flash_stm32f4x_page_layout(struct device *dev,
+				       const struct flash_pages_layout **layout,
+				       size_t *layout_size)
+{
+	*layout = flash_stm32f4x_pages_layout;
+	*layout_size = ARRAY_SIZE(flash_stm32f4x_pages_layout);
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static struct flash_priv flash_data = {
 	.regs = (struct stm32f4x_flash *) FLASH_R_BASE,
 };
@@ -247,6 +310,12 @@ static const struct flash_driver_api flash_stm32f4x_api = {
 	.erase = flash_stm32f4x_erase,
 	.write = flash_stm32f4x_write,
 	.read = flash_stm32f4x_read,
+	.write_pages = flash_stm32f4x_write_pages,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = flash_stm32f4x_page_layout,
+#endif
+	.write_block_size = 1,
+	.erase_value = 0xff,
 };
 
 static int stm32f4x_flash_init(struct device *dev)
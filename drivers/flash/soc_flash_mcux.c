@@ -92,6 +92,10 @@ static const struct flash_driver_api flash_mcux_api = {
 	.erase = flash_mcux_erase,
 	.write = flash_mcux_write,
 	.read = flash_mcux_read,
+	/* no write protection to toggle, program straight away */
+	.write_pages = flash_mcux_write,
+	.write_block_size = FSL_FEATURE_FLASH_PFLASH_BLOCK_WRITE_UNIT_SIZE,
+	.erase_value = 0xff,
 };
 
 static int flash_mcux_init(struct device *dev)
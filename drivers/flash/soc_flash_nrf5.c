@@ -154,15 +154,54 @@ static int flash_nrf5_write_protection(struct device *dev, bool enable)
 	return 0;
 }
 
+static int flash_nrf5_write_pages(struct device *dev, off_t addr,
+				  const void *data, size_t len)
+{
+	int rc;
+
+	/* The NVMC programs words directly, there is no page buffer to
+	 * fill: keep writes enabled across the whole buffer instead of
+	 * having the caller toggle protection around each chunk.
+	 */
+	flash_nrf5_write_protection(dev, false);
+	rc = flash_nrf5_write(dev, addr, data, len);
+	flash_nrf5_write_protection(dev, true);
+
+	return rc;
+}
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static struct flash_pages_layout dev_layout;
+
+static void flash_nrf5_pages_layout(struct device *dev,
+				    const struct flash_pages_layout **layout,
+				    size_t *layout_size)
+{
+	*layout = &dev_layout;
+	*layout_size = 1;
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static const struct flash_driver_api flash_nrf5_api = {
 	.read = flash_nrf5_read,
 	.write = flash_nrf5_write,
 	.erase = flash_nrf5_erase,
 	.write_protection = flash_nrf5_write_protection,
+	.write_pages = flash_nrf5_write_pages,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = flash_nrf5_pages_layout,
+#endif
+	.write_block_size = sizeof(uint32_t),
+	.erase_value = 0xff,
 };
 
 static int nrf5_flash_init(struct device *dev)
 {
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	dev_layout.pages_count = NRF_FICR->CODESIZE;
+	dev_layout.pages_size = NRF_FICR->CODEPAGESIZE;
+#endif
+
 	dev->driver_api = &flash_nrf5_api;
 
 	return 0;
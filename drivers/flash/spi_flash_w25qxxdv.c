@@ -13,6 +13,14 @@
 #include "spi_flash_w25qxxdv_defs.h"
 #include "spi_flash_w25qxxdv.h"
 
+#if defined(CONFIG_SPI_FLASH_W25QXXDV_FAST_READ)
+#define W25QXXDV_READ_CMD        W25QXXDV_CMD_FASTREAD
+#define W25QXXDV_READ_HDR_LEN    (W25QXXDV_LEN_CMD_ADDRESS + W25QXXDV_LEN_DUMMY)
+#else
+#define W25QXXDV_READ_CMD        W25QXXDV_CMD_READ
+#define W25QXXDV_READ_HDR_LEN    W25QXXDV_LEN_CMD_ADDRESS
+#endif
+
 static inline int spi_flash_wb_id(struct device *dev)
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
@@ -73,7 +81,11 @@ static int spi_flash_wb_reg_read(struct device *dev, uint8_t *data)
 	return 0;
 }
 
-static inline void wait_for_flash_idle(struct device *dev)
+/* Poll the status register until the pending program or erase completes.
+ * The calling thread sleeps poll_ms milliseconds between two polls, or
+ * merely yields if poll_ms is 0.
+ */
+static inline void wait_for_flash_idle(struct device *dev, int32_t poll_ms)
 {
 	uint8_t buf[2];
 
@@ -81,6 +93,12 @@ static inline void wait_for_flash_idle(struct device *dev)
 	spi_flash_wb_reg_read(dev, buf);
 
 	while (buf[1] & W25QXXDV_WIP_BIT) {
+		if (poll_ms) {
+			k_sleep(poll_ms);
+		} else {
+			k_yield();
+		}
+
 		buf[0] = W25QXXDV_CMD_RDSR;
 		spi_flash_wb_reg_read(dev, buf);
 	}
@@ -91,7 +109,7 @@ static int spi_flash_wb_reg_write(struct device *dev, uint8_t *data)
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t buf;
 
-	wait_for_flash_idle(dev);
+	wait_for_flash_idle(dev, 0);
 
 	if (spi_transceive(driver_data->spi, data, 1,
 			   &buf /*dummy */, 1) != 0) {
@@ -106,8 +124,11 @@ static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t *buf = driver_data->buf;
+	uint8_t *dst = data;
+	size_t chunk;
 
-	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
+	if ((offset < 0) ||
+	    ((offset + len) > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE)) {
 		return -ENODEV;
 	}
 
@@ -118,25 +139,61 @@ static int spi_flash_wb_read(struct device *dev, off_t offset, void *data,
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
+	wait_for_flash_idle(dev, 0);
 
-	buf[0] = W25QXXDV_CMD_READ;
+	/* Reads are not bound to pages, the request is only split to fit
+	 * in the driver buffer.
+	 */
+	while (len) {
+		chunk = min(len, CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN);
+
+		buf[0] = W25QXXDV_READ_CMD;
+		buf[1] = (uint8_t) (offset >> 16);
+		buf[2] = (uint8_t) (offset >> 8);
+		buf[3] = (uint8_t) offset;
+
+		/* clears the dummy byte as well, if any */
+		memset(buf + W25QXXDV_LEN_CMD_ADDRESS, 0,
+		       chunk + W25QXXDV_READ_HDR_LEN - W25QXXDV_LEN_CMD_ADDRESS);
+
+		if (spi_transceive(driver_data->spi,
+				   buf, chunk + W25QXXDV_READ_HDR_LEN,
+				   buf, chunk + W25QXXDV_READ_HDR_LEN) != 0) {
+			k_sem_give(&driver_data->sem);
+			return -EIO;
+		}
+
+		memcpy(dst, buf + W25QXXDV_READ_HDR_LEN, chunk);
+
+		offset += chunk;
+		dst += chunk;
+		len -= chunk;
+	}
+
+	k_sem_give(&driver_data->sem);
+
+	return 0;
+}
+
+static int spi_flash_wb_program_page(struct device *dev, off_t offset,
+				     const void *data, size_t len)
+{
+	struct spi_flash_data *const driver_data = dev->driver_data;
+	uint8_t *buf = driver_data->buf;
+
+	wait_for_flash_idle(dev, 0);
+
+	buf[0] = W25QXXDV_CMD_PP;
 	buf[1] = (uint8_t) (offset >> 16);
 	buf[2] = (uint8_t) (offset >> 8);
 	buf[3] = (uint8_t) offset;
 
-	memset(buf + W25QXXDV_LEN_CMD_ADDRESS, 0, len);
+	memcpy(buf + W25QXXDV_LEN_CMD_ADDRESS, data, len);
 
-	if (spi_transceive(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS,
-			   buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
-		k_sem_give(&driver_data->sem);
+	if (spi_write(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
 		return -EIO;
 	}
 
-	memcpy(data, buf + W25QXXDV_LEN_CMD_ADDRESS, len);
-
-	k_sem_give(&driver_data->sem);
-
 	return 0;
 }
 
@@ -145,6 +202,7 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 {
 	struct spi_flash_data *const driver_data = dev->driver_data;
 	uint8_t *buf = driver_data->buf;
+	int ret;
 
 	if (len > CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN || offset < 0) {
 		return -ENOTSUP;
@@ -157,7 +215,7 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
+	wait_for_flash_idle(dev, 0);
 
 	buf[0] = W25QXXDV_CMD_RDSR;
 	spi_flash_wb_reg_read(dev, buf);
@@ -167,27 +225,65 @@ static int spi_flash_wb_write(struct device *dev, off_t offset,
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
-
-	buf[0] = W25QXXDV_CMD_PP;
-	buf[1] = (uint8_t) (offset >> 16);
-	buf[2] = (uint8_t) (offset >> 8);
-	buf[3] = (uint8_t) offset;
-
-	memcpy(buf + W25QXXDV_LEN_CMD_ADDRESS, data, len);
-
 	/* Assume write protection has been disabled. Note that w25qxxdv
 	 * flash automatically turns on write protection at the completion
 	 * of each write or erase transaction.
 	 */
-	if (spi_write(driver_data->spi, buf, len + W25QXXDV_LEN_CMD_ADDRESS) != 0) {
+	ret = spi_flash_wb_program_page(dev, offset, data, len);
+
+	k_sem_give(&driver_data->sem);
+
+	return ret;
+}
+
+static int spi_flash_wb_write_pages(struct device *dev, off_t offset,
+				    const void *data, size_t len)
+{
+	struct spi_flash_data *const driver_data = dev->driver_data;
+	const uint8_t *src = data;
+	uint8_t cmd;
+	size_t chunk;
+	int ret = 0;
+
+	if ((offset < 0) ||
+	    ((offset + len) > CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE)) {
+		return -ENODEV;
+	}
+
+	k_sem_take(&driver_data->sem, K_FOREVER);
+
+	if (spi_flash_wb_config(dev) != 0) {
 		k_sem_give(&driver_data->sem);
 		return -EIO;
 	}
 
+	while (len && !ret) {
+		/* a page program must not cross a page boundary, it would
+		 * wrap around to the start of the same page
+		 */
+		chunk = W25QXXDV_PAGE_SIZE - (offset & (W25QXXDV_PAGE_SIZE - 1));
+		chunk = min(chunk, len);
+		chunk = min(chunk, CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN);
+
+		/* the write enable latch is cleared after each program */
+		cmd = W25QXXDV_CMD_WREN;
+		ret = spi_flash_wb_reg_write(dev, &cmd);
+		if (ret) {
+			break;
+		}
+
+		ret = spi_flash_wb_program_page(dev, offset, src, chunk);
+
+		offset += chunk;
+		src += chunk;
+		len -= chunk;
+	}
+
+	wait_for_flash_idle(dev, 0);
+
 	k_sem_give(&driver_data->sem);
 
-	return 0;
+	return ret;
 }
 
 static int spi_flash_wb_write_protection_set(struct device *dev, bool enable)
@@ -202,7 +298,7 @@ static int spi_flash_wb_write_protection_set(struct device *dev, bool enable)
 		return -EIO;
 	}
 
-	wait_for_flash_idle(dev);
+	wait_for_flash_idle(dev, 0);
 
 	if (enable) {
 		buf = W25QXXDV_CMD_WRDI;
@@ -232,13 +328,13 @@ static inline int spi_flash_wb_erase_internal(struct device *dev,
 		return -ENOTSUP;
 	}
 
-	wait_for_flash_idle(dev);
+	wait_for_flash_idle(dev, 0);
 
 	/* write enable */
 	buf[0] = W25QXXDV_CMD_WREN;
 	spi_flash_wb_reg_write(dev, buf);
 
-	wait_for_flash_idle(dev);
+	wait_for_flash_idle(dev, 0);
 
 	switch (size) {
 	case W25QXXDV_SECTOR_SIZE:
@@ -271,7 +367,14 @@ static inline int spi_flash_wb_erase_internal(struct device *dev,
 	 * flash automatically turns on write protection at the completion
 	 * of each write or erase transaction.
 	 */
-	return spi_write(driver_data->spi, buf, len);
+	if (spi_write(driver_data->spi, buf, len) != 0) {
+		return -EIO;
+	}
+
+	/* erases take tens of milliseconds at best, sleep while polling */
+	wait_for_flash_idle(dev, CONFIG_SPI_FLASH_W25QXXDV_ERASE_POLL_INTERVAL);
+
+	return 0;
 }
 
 static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
@@ -309,7 +412,11 @@ static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
 			break;
 		}
 
-		if (size_remaining >= W25QXXDV_BLOCK_SIZE) {
+		/* a block erase clears the whole block around new_offset,
+		 * only use it when the range covers an aligned block
+		 */
+		if ((size_remaining >= W25QXXDV_BLOCK_SIZE) &&
+		    !(new_offset & (W25QXXDV_BLOCK_SIZE - 1))) {
 			ret = spi_flash_wb_erase_internal(dev, new_offset,
 							  W25QXXDV_BLOCK_SIZE);
 			new_offset += W25QXXDV_BLOCK_SIZE;
@@ -317,7 +424,8 @@ static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
 			continue;
 		}
 
-		if (size_remaining >= W25QXXDV_BLOCK32K_SIZE) {
+		if ((size_remaining >= W25QXXDV_BLOCK32K_SIZE) &&
+		    !(new_offset & (W25QXXDV_BLOCK32K_SIZE - 1))) {
 			ret = spi_flash_wb_erase_internal(dev, new_offset,
 							  W25QXXDV_BLOCK32K_SIZE);
 			new_offset += W25QXXDV_BLOCK32K_SIZE;
@@ -339,11 +447,33 @@ static int spi_flash_wb_erase(struct device *dev, off_t offset, size_t size)
 	return ret;
 }
 
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static const struct flash_pages_layout spi_flash_pages_layout = {
+	.pages_count = CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE /
+		       W25QXXDV_SECTOR_SIZE,
+	.pages_size = W25QXXDV_SECTOR_SIZE,
+};
+
+static void spi_flash_wb_pages_layout(struct device *dev,
+				      const struct flash_pages_layout **layout,
+				      size_t *layout_size)
+{
+	*layout = &spi_flash_pages_layout;
+	*layout_size = 1;
+}
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 static const struct flash_driver_api spi_flash_api = {
 	.read = spi_flash_wb_read,
 	.write = spi_flash_wb_write,
 	.erase = spi_flash_wb_erase,
 	.write_protection = spi_flash_wb_write_protection_set,
+	.write_pages = spi_flash_wb_write_pages,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = spi_flash_wb_pages_layout,
+#endif
+	.write_block_size = 1,
+	.erase_value = 0xff,
 };
 
 static int spi_flash_init(struct device *dev)
@@ -17,7 +17,7 @@
 struct spi_flash_data {
 	struct device *spi;
 	uint8_t buf[CONFIG_SPI_FLASH_W25QXXDV_MAX_DATA_LEN +
-		    W25QXXDV_LEN_CMD_ADDRESS];
+		    W25QXXDV_LEN_CMD_ADDRESS + W25QXXDV_LEN_DUMMY];
 	struct k_sem sem;
 };
 
@@ -40,6 +40,7 @@
 #define W25QXXDV_ADDRESS_WIDTH        (3)
 #define W25QXXDV_LEN_CMD_ADDRESS      (4)
 #define W25QXXDV_LEN_CMD_AND_ID       (4)
+#define W25QXXDV_LEN_DUMMY            (1)
 
 /* relevant status register bits */
 #define W25QXXDV_WIP_BIT         (0x1 << 0)
@@ -53,6 +54,9 @@
 #define W25QXXDV_SECR_EFAIL_BIT  (0x1 << 6)
 #define W25QXXDV_SECR_PFAIL_BIT  (0x1 << 5)
 
+/* program page size */
+#define W25QXXDV_PAGE_SIZE       (0x100)
+
 /* supported erase size */
 #define W25QXXDV_SECTOR_SIZE     (0x1000)
 #define W25QXXDV_BLOCK32K_SIZE   (0x8000)
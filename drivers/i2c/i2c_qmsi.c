@@ -5,6 +5,7 @@
  */
 
 #include <errno.h>
+#include <string.h>
 
 #include <device.h>
 #include <i2c.h>
@@ -15,6 +16,7 @@
 #include "qm_isr.h"
 #include "clk.h"
 #include "soc.h"
+#include "i2c_queue.h"
 
 /* Convenient macros to get the controller instance and the driver data. */
 #define GET_CONTROLLER_INSTANCE(dev) \
@@ -32,8 +34,10 @@ struct i2c_qmsi_config_info {
 static int i2c_qmsi_init(struct device *dev);
 
 struct i2c_qmsi_driver_data {
-	struct k_sem device_sync_sem;
+	struct i2c_queue queue;
+	qm_i2c_transfer_t xfer;
 	int transfer_status;
+	bool transfer_done;
 	struct k_sem sem;
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	uint32_t device_power_state;
@@ -190,17 +194,81 @@ static void transfer_complete(void *data, int rc, qm_i2c_status_t status,
 	struct device *dev = (struct device *) data;
 	struct i2c_qmsi_driver_data *driver_data;
 
+	/* the next message is started by i2c_qmsi_isr() */
 	driver_data = GET_DRIVER_DATA(dev);
 	driver_data->transfer_status = rc;
-	k_sem_give(&driver_data->device_sync_sem);
+	driver_data->transfer_done = true;
+}
+
+static void i2c_qmsi_start(struct device *dev, struct i2c_msg *msg)
+{
+	struct i2c_qmsi_driver_data *driver_data = GET_DRIVER_DATA(dev);
+	qm_i2c_transfer_t *xfer = &driver_data->xfer;
+
+	for (; msg; msg = i2c_queue_next(&driver_data->queue, -EIO)) {
+		memset(xfer, 0, sizeof(*xfer));
+
+		if ((msg->flags & I2C_MSG_RW_MASK) == I2C_MSG_WRITE) {
+			xfer->tx = msg->buf;
+			xfer->tx_len = msg->len;
+		} else {
+			xfer->rx = msg->buf;
+			xfer->rx_len = msg->len;
+		}
+
+		xfer->callback = transfer_complete;
+		xfer->callback_data = dev;
+		xfer->stop = (msg->flags & I2C_MSG_STOP) == I2C_MSG_STOP;
+
+		if (qm_i2c_master_irq_transfer(GET_CONTROLLER_INSTANCE(dev),
+					       xfer,
+					       i2c_queue_addr(
+						       &driver_data->queue))
+		    == 0) {
+			return;
+		}
+	}
+
+	device_busy_clear(dev);
+}
+
+/*
+ * The QMSI handler still uses the transfer after calling back, the next
+ * message can only be started once it returns.
+ */
+static void i2c_qmsi_isr(void *arg)
+{
+	struct device *dev = arg;
+	struct i2c_qmsi_driver_data *driver_data = GET_DRIVER_DATA(dev);
+	struct i2c_msg *msg;
+
+	if (GET_CONTROLLER_INSTANCE(dev) == QM_I2C_0) {
+		qm_i2c_0_irq_isr(NULL);
+	}
+#ifdef CONFIG_I2C_1
+	else {
+		qm_i2c_1_irq_isr(NULL);
+	}
+#endif
+
+	if (!driver_data->transfer_done) {
+		return;
+	}
+
+	driver_data->transfer_done = false;
+	msg = i2c_queue_next(&driver_data->queue,
+			     driver_data->transfer_status ? -EIO : 0);
+	if (msg) {
+		i2c_qmsi_start(dev, msg);
+	} else {
+		device_busy_clear(dev);
+	}
 }
 
 static int i2c_qmsi_transfer(struct device *dev, struct i2c_msg *msgs,
 			     uint8_t num_msgs, uint16_t addr)
 {
 	struct i2c_qmsi_driver_data *driver_data = GET_DRIVER_DATA(dev);
-	qm_i2c_t instance = GET_CONTROLLER_INSTANCE(dev);
-	int rc;
 
 	__ASSERT_NO_MSG(msgs);
 	if (!num_msgs) {
@@ -209,48 +277,34 @@ static int i2c_qmsi_transfer(struct device *dev, struct i2c_msg *msgs,
 
 	device_busy_set(dev);
 
-	for (int i = 0; i < num_msgs; i++) {
-		uint8_t op =  msgs[i].flags & I2C_MSG_RW_MASK;
-		bool stop = (msgs[i].flags & I2C_MSG_STOP) == I2C_MSG_STOP;
-		qm_i2c_transfer_t xfer = { 0 };
-		if (op == I2C_MSG_WRITE) {
-			xfer.tx = msgs[i].buf;
-			xfer.tx_len = msgs[i].len;
-		} else {
-			xfer.rx = msgs[i].buf;
-			xfer.rx_len = msgs[i].len;
-		}
-
-		xfer.callback = transfer_complete;
-		xfer.callback_data = dev;
-		xfer.stop = stop;
-
-		k_sem_take(&driver_data->sem, K_FOREVER);
-		rc = qm_i2c_master_irq_transfer(instance, &xfer, addr);
-		k_sem_give(&driver_data->sem);
-
-		if (rc != 0) {
-			device_busy_clear(dev);
-			return -EIO;
-		}
+	return i2c_queue_transfer(&driver_data->queue, dev, msgs, num_msgs,
+				  addr, i2c_qmsi_start);
+}
 
-		/* Block current thread until the I2C transfer completes. */
-		k_sem_take(&driver_data->device_sync_sem, K_FOREVER);
+#ifdef CONFIG_I2C_ASYNC
+static int i2c_qmsi_transfer_async(struct device *dev,
+				   struct i2c_transaction *txn)
+{
+	struct i2c_qmsi_driver_data *driver_data = GET_DRIVER_DATA(dev);
+	struct i2c_msg *msg;
+	int ret;
 
-		if (driver_data->transfer_status != 0) {
-			device_busy_clear(dev);
-			return -EIO;
-		}
+	msg = i2c_queue_submit(&driver_data->queue, txn, &ret);
+	if (msg) {
+		device_busy_set(dev);
+		i2c_qmsi_start(dev, msg);
 	}
 
-	device_busy_clear(dev);
-
-	return 0;
+	return ret;
 }
+#endif
 
 static const struct i2c_driver_api api = {
 	.configure = i2c_qmsi_configure,
 	.transfer = i2c_qmsi_transfer,
+#ifdef CONFIG_I2C_ASYNC
+	.transfer_async = i2c_qmsi_transfer_async,
+#endif
 };
 
 static int i2c_qmsi_init(struct device *dev)
@@ -260,27 +314,29 @@ static int i2c_qmsi_init(struct device *dev)
 	qm_i2c_t instance = GET_CONTROLLER_INSTANCE(dev);
 	int err;
 
-	k_sem_init(&driver_data->device_sync_sem, 0, UINT_MAX);
+	i2c_queue_init(&driver_data->queue);
 	k_sem_init(&driver_data->sem, 0, UINT_MAX);
 	k_sem_give(&driver_data->sem);
 
 	switch (instance) {
+#ifdef CONFIG_I2C_0
 	case QM_I2C_0:
 		/* Register interrupt handler, unmask IRQ and route it
 		 * to Lakemont core.
 		 */
 		IRQ_CONNECT(IRQ_GET_NUMBER(QM_IRQ_I2C_0_INT),
-			    CONFIG_I2C_0_IRQ_PRI, qm_i2c_0_irq_isr, NULL,
+			    CONFIG_I2C_0_IRQ_PRI, i2c_qmsi_isr, DEVICE_GET(i2c_0),
 			    (IOAPIC_LEVEL | IOAPIC_HIGH));
 		irq_enable(IRQ_GET_NUMBER(QM_IRQ_I2C_0_INT));
 		QM_IR_UNMASK_INTERRUPTS(
 				QM_INTERRUPT_ROUTER->i2c_master_0_int_mask);
 		break;
+#endif /* CONFIG_I2C_0 */
 
 #ifdef CONFIG_I2C_1
 	case QM_I2C_1:
 		IRQ_CONNECT(IRQ_GET_NUMBER(QM_IRQ_I2C_1_INT),
-			    CONFIG_I2C_1_IRQ_PRI, qm_i2c_1_irq_isr, NULL,
+			    CONFIG_I2C_1_IRQ_PRI, i2c_qmsi_isr, DEVICE_GET(i2c_1),
 			    (IOAPIC_LEVEL | IOAPIC_HIGH));
 		irq_enable(IRQ_GET_NUMBER(QM_IRQ_I2C_1_INT));
 		QM_IR_UNMASK_INTERRUPTS(
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Private API for I2C drivers: transfer queue
+ *
+ * Transfers of a bus are queued in order, synchronous ones included. The
+ * driver performs the messages of the transfer at the head of the queue
+ * and reports the end of each one from its ISR, which hands it the next
+ * message to start, of the same transfer or of the next one, so that the
+ * bus never waits for a thread between two queued transfers.
+ */
+
+#ifndef __I2C_QUEUE_H__
+#define __I2C_QUEUE_H__
+
+#include <kernel.h>
+#include <i2c.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct i2c_queue {
+	/* one synchronous caller at a time */
+	struct k_sem lock;
+	struct k_sem sync;
+	int status;
+
+	/* transfers waiting for the one in progress */
+	sys_slist_t pending;
+	struct i2c_transaction *current;
+	/* message of the current transfer in progress */
+	uint8_t msg;
+};
+
+static inline void i2c_queue_init(struct i2c_queue *queue)
+{
+	k_sem_init(&queue->lock, 1, 1);
+	k_sem_init(&queue->sync, 0, UINT_MAX);
+	sys_slist_init(&queue->pending);
+	queue->current = NULL;
+}
+
+static inline void _i2c_queue_complete(struct i2c_queue *queue,
+				       struct i2c_transaction *txn,
+				       int status)
+{
+#ifdef CONFIG_I2C_ASYNC
+	if (txn->signal) {
+		k_poll_signal(txn->signal, status);
+		return;
+	}
+#endif
+
+	queue->status = status;
+	k_sem_give(&queue->sync);
+}
+
+static inline bool _i2c_queue_has(struct i2c_queue *queue,
+				  struct i2c_transaction *txn)
+{
+	sys_snode_t *node;
+
+	if (queue->current == txn) {
+		return true;
+	}
+
+	SYS_SLIST_FOR_EACH_NODE(&queue->pending, node) {
+		if (node == &txn->node) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Queue a transfer. Returns the first message to start when the bus was
+ * idle, NULL when the transfer waits in the queue or has no message, in
+ * which case it is already complete. Returns -EBUSY through @a ret when
+ * the transfer is already queued.
+ */
+static inline struct i2c_msg *i2c_queue_submit(struct i2c_queue *queue,
+					       struct i2c_transaction *txn,
+					       int *ret)
+{
+	struct i2c_msg *msg = NULL;
+	unsigned int key;
+
+	*ret = 0;
+
+	if (!txn->num_msgs) {
+		_i2c_queue_complete(queue, txn, 0);
+		return NULL;
+	}
+
+	key = irq_lock();
+
+	if (_i2c_queue_has(queue, txn)) {
+		*ret = -EBUSY;
+	} else if (queue->current) {
+		sys_slist_append(&queue->pending, &txn->node);
+	} else {
+		queue->current = txn;
+		queue->msg = 0;
+		msg = txn->msgs;
+	}
+
+	irq_unlock(key);
+
+	return msg;
+}
+
+/* Address of the target device of the message in progress. */
+static inline uint16_t i2c_queue_addr(struct i2c_queue *queue)
+{
+	return queue->current->addr;
+}
+
+/*
+ * Report the end of the message in progress, with its result. A failed
+ * message ends its transfer. Returns the next message to start, NULL once
+ * the queue is empty.
+ */
+static inline struct i2c_msg *i2c_queue_next(struct i2c_queue *queue,
+					     int status)
+{
+	struct i2c_transaction *txn = queue->current;
+	sys_snode_t *node;
+	unsigned int key;
+
+	if (!status && ++queue->msg < txn->num_msgs) {
+		return &txn->msgs[queue->msg];
+	}
+
+	key = irq_lock();
+
+	node = sys_slist_get(&queue->pending);
+	queue->current = node ? CONTAINER_OF(node, struct i2c_transaction,
+					      node) : NULL;
+	queue->msg = 0;
+
+	irq_unlock(key);
+
+	_i2c_queue_complete(queue, txn, status);
+
+	return queue->current ? queue->current->msgs : NULL;
+}
+
+/*
+ * Queue a transfer and wait for its end, as i2c_transfer() does. The
+ * driver starts @a msg with @a start when the bus was idle.
+ */
+static inline int i2c_queue_transfer(struct i2c_queue *queue,
+				     struct device *dev,
+				     struct i2c_msg *msgs, uint8_t num_msgs,
+				     uint16_t addr,
+				     void (*start)(struct device *dev,
+						   struct i2c_msg *msg))
+{
+	struct i2c_transaction txn = {
+		.msgs = msgs,
+		.num_msgs = num_msgs,
+		.addr = addr,
+		.signal = NULL,
+	};
+	struct i2c_msg *msg;
+	int ret;
+
+	k_sem_take(&queue->lock, K_FOREVER);
+
+	msg = i2c_queue_submit(queue, &txn, &ret);
+	if (msg) {
+		start(dev, msg);
+	}
+
+	k_sem_take(&queue->sync, K_FOREVER);
+	ret = queue->status;
+
+	k_sem_give(&queue->lock);
+
+	return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __I2C_QUEUE_H__ */
@@ -161,7 +161,8 @@ static const struct sensor_driver_api bme280_api_funcs = {
 
 static int bme280_read_compensation(struct bme280_data *data)
 {
-	uint16_t buf[12];
+	/* dig_h1 follows the temperature and pressure words */
+	uint16_t buf[13];
 	uint8_t hbuf[7];
 	int err = 0;
 
@@ -188,13 +189,7 @@ static int bme280_read_compensation(struct bme280_data *data)
 	data->dig_p9 = sys_le16_to_cpu(buf[11]);
 
 	if (data->chip_id == BME280_CHIP_ID) {
-		err = i2c_reg_read_byte(data->i2c_master, data->i2c_slave_addr,
-					BME280_REG_HUM_COMP_PART1,
-					&data->dig_h1);
-
-		if (err < 0) {
-			return err;
-		}
+		data->dig_h1 = sys_le16_to_cpu(buf[12]) >> 8;
 
 		err = i2c_burst_read(data->i2c_master, data->i2c_slave_addr,
 				     BME280_REG_HUM_COMP_PART2, hbuf, 7);
@@ -216,6 +211,8 @@ static int bme280_read_compensation(struct bme280_data *data)
 static int bme280_chip_init(struct device *dev)
 {
 	struct bme280_data *data = (struct bme280_data *) dev->driver_data;
+	uint8_t cfg[6];
+	int len = 0;
 
 	int err = i2c_reg_read_byte(data->i2c_master, data->i2c_slave_addr,
 				    BME280_REG_ID, &data->chip_id);
@@ -240,17 +237,22 @@ static int bme280_chip_init(struct device *dev)
 		return err;
 	}
 
+	/*
+	 * Writes are register address and value pairs, so that the
+	 * registers are all set in one transfer. CTRL_HUM only takes effect
+	 * once CTRL_MEAS is written.
+	 */
 	if (data->chip_id == BME280_CHIP_ID) {
-		i2c_reg_write_byte(data->i2c_master, data->i2c_slave_addr,
-				   BME280_REG_CTRL_HUM, BME280_HUMIDITY_OVER);
+		cfg[len++] = BME280_REG_CTRL_HUM;
+		cfg[len++] = BME280_HUMIDITY_OVER;
 	}
 
-	i2c_reg_write_byte(data->i2c_master, data->i2c_slave_addr,
-			   BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS_VAL);
-	i2c_reg_write_byte(data->i2c_master, data->i2c_slave_addr,
-			   BME280_REG_CONFIG, BME280_CONFIG_VAL);
+	cfg[len++] = BME280_REG_CTRL_MEAS;
+	cfg[len++] = BME280_CTRL_MEAS_VAL;
+	cfg[len++] = BME280_REG_CONFIG;
+	cfg[len++] = BME280_CONFIG_VAL;
 
-	return 0;
+	return i2c_write(data->i2c_master, cfg, len, data->i2c_slave_addr);
 }
 
 int bme280_init(struct device *dev)
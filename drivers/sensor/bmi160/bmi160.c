@@ -609,9 +609,28 @@ static int bmi160_gyr_config(struct device *dev, enum sensor_channel chan,
 }
 #endif /* !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND) */
 
+#ifdef CONFIG_BMI160_FIFO
+static int bmi160_fifo_wm_set(struct device *dev, int frames)
+{
+	int wm = frames * BMI160_SAMPLE_SIZE / BMI160_FIFO_WM_UNIT;
+
+	if (frames < 1 || wm > 0xFF) {
+		return -EINVAL;
+	}
+
+	return bmi160_byte_write(dev, BMI160_REG_FIFO_CONFIG0, wm);
+}
+#endif
+
 static int bmi160_attr_set(struct device *dev, enum sensor_channel chan,
 		    enum sensor_attribute attr, const struct sensor_value *val)
 {
+#ifdef CONFIG_BMI160_FIFO
+	if (attr == SENSOR_ATTR_FIFO_WATERMARK) {
+		return bmi160_fifo_wm_set(dev, val->val1);
+	}
+#endif
+
 	switch (chan) {
 #if !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
 	case SENSOR_CHAN_GYRO_X:
@@ -803,6 +822,177 @@ static int bmi160_channel_get(struct device *dev,
 	return 0;
 }
 
+#ifdef CONFIG_BMI160_FIFO
+/*
+ * Read the FIFO in a single transaction, which unlike bmi160_transceive()
+ * is not limited to 255 bytes.
+ */
+static int bmi160_fifo_data_read(struct device *dev, size_t len)
+{
+	const struct bmi160_device_config *dev_cfg = dev->config->config_info;
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+	struct spi_config spi_cfg = {
+		.config = SPI_WORD(8),
+		.max_sys_freq = dev_cfg->spi_freq,
+	};
+	uint8_t cmd = BMI160_REG_FIFO_DATA | (1 << 7);
+	const struct spi_buf tx_buf = { .buf = &cmd, .len = 1 };
+	const struct spi_buf rx_buf = { .buf = bmi160->fifo_buf,
+					.len = len + BMI160_DATA_OFS };
+
+	if (spi_slave_select(bmi160->spi, dev_cfg->spi_slave) < 0) {
+		SYS_LOG_DBG("Cannot select slave.");
+		return -EIO;
+	}
+
+	return spi_transceive_bufs(bmi160->spi, &spi_cfg, &tx_buf, 1,
+				   &rx_buf, 1);
+}
+
+/* sampling period of the FIFO frames, in hardware clock cycles */
+static int bmi160_fifo_period(struct device *dev, uint32_t *period)
+{
+	uint8_t odr;
+
+#if !defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
+	if (bmi160_byte_read(dev, BMI160_REG_ACC_CONF, &odr) < 0) {
+		return -EIO;
+	}
+
+	odr &= BMI160_ACC_CONF_ODR_MASK;
+#else
+	if (bmi160_byte_read(dev, BMI160_REG_GYR_CONF, &odr) < 0) {
+		return -EIO;
+	}
+
+	odr &= BMI160_GYR_CONF_ODR_MASK;
+#endif
+
+	/* freq = 100 Hz * 2^(odr - 8) */
+	if (odr <= BMI160_ODR_100) {
+		*period = (uint64_t)sys_clock_hw_cycles_per_sec *
+			  (1 << (BMI160_ODR_100 - odr)) / 100;
+	} else {
+		*period = sys_clock_hw_cycles_per_sec /
+			  (100 << (odr - BMI160_ODR_100));
+	}
+
+	return 0;
+}
+
+static int bmi160_fifo_read(struct device *dev, struct sensor_frame *frames,
+			    size_t max_frames)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+	uint8_t *buf = bmi160->fifo_buf + BMI160_DATA_OFS;
+	uint32_t now, period;
+	uint16_t fifo_len;
+	size_t level, count, i, j;
+
+	if (bmi160_word_read(dev, BMI160_REG_FIFO_LENGTH0, &fifo_len) < 0 ||
+	    bmi160_fifo_period(dev, &period) < 0) {
+		return -EIO;
+	}
+
+	level = (fifo_len & BMI160_FIFO_LENGTH_MASK) / BMI160_SAMPLE_SIZE;
+	count = min(level, max_frames);
+	count = min(count, CONFIG_BMI160_FIFO_BURST_FRAMES);
+	if (count == 0) {
+		return 0;
+	}
+
+	now = k_cycle_get_32();
+
+	if (bmi160_fifo_data_read(dev, count * BMI160_SAMPLE_SIZE) < 0) {
+		return -EIO;
+	}
+
+	/* the newest frame of the FIFO was sampled right before the read */
+	for (i = 0; i < count; i++) {
+		frames[i].timestamp = now - (level - 1 - i) * period;
+
+		for (j = 0; j < BMI160_SAMPLE_SIZE / 2; j++, buf += 2) {
+			frames[i].data[j] = sys_get_le16(buf);
+		}
+	}
+
+	return count;
+}
+
+static int bmi160_frames_decode(struct device *dev, enum sensor_channel chan,
+				const struct sensor_frame *frames,
+				size_t count, struct sensor_value *val)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+	uint16_t scale;
+	size_t i;
+	int ofs, axes, j;
+
+	switch (chan) {
+#if !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+	case SENSOR_CHAN_GYRO_X:
+	case SENSOR_CHAN_GYRO_Y:
+	case SENSOR_CHAN_GYRO_Z:
+	case SENSOR_CHAN_GYRO_XYZ:
+		scale = bmi160->scale.gyr;
+		ofs = chan - SENSOR_CHAN_GYRO_X;
+		break;
+#endif
+#if !defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
+	case SENSOR_CHAN_ACCEL_X:
+	case SENSOR_CHAN_ACCEL_Y:
+	case SENSOR_CHAN_ACCEL_Z:
+	case SENSOR_CHAN_ACCEL_XYZ:
+		scale = bmi160->scale.acc;
+		ofs = BMI160_FRAME_ACC_OFS + chan - SENSOR_CHAN_ACCEL_X;
+		break;
+#endif
+	default:
+		SYS_LOG_DBG("Channel not supported.");
+		return -ENOTSUP;
+	}
+
+	/* the _XYZ channels follow the Z channels */
+	axes = 1;
+	if (chan == SENSOR_CHAN_ACCEL_XYZ || chan == SENSOR_CHAN_GYRO_XYZ) {
+		ofs -= 3;
+		axes = 3;
+	}
+
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < axes; j++, val++) {
+			bmi160_to_fixed_point(frames[i].data[ofs + j], scale,
+					      val);
+		}
+	}
+
+	return 0;
+}
+
+static int bmi160_fifo_init(struct device *dev)
+{
+	uint8_t fifo_en = 0;
+
+#if !defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
+	fifo_en |= BMI160_FIFO_ACC_EN;
+#endif
+#if !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+	fifo_en |= BMI160_FIFO_GYR_EN;
+#endif
+
+	if (bmi160_fifo_wm_set(dev, CONFIG_BMI160_FIFO_WATERMARK) < 0) {
+		return -EIO;
+	}
+
+	/* headerless mode, the frames only hold the samples */
+	if (bmi160_byte_write(dev, BMI160_REG_FIFO_CONFIG1, fifo_en) < 0) {
+		return -EIO;
+	}
+
+	return bmi160_byte_write(dev, BMI160_REG_CMD, BMI160_CMD_FIFO_FLUSH);
+}
+#endif /* CONFIG_BMI160_FIFO */
+
 static const struct sensor_driver_api bmi160_api = {
 	.attr_set = bmi160_attr_set,
 #ifdef CONFIG_BMI160_TRIGGER
@@ -810,6 +1000,10 @@ static const struct sensor_driver_api bmi160_api = {
 #endif
 	.sample_fetch = bmi160_sample_fetch,
 	.channel_get = bmi160_channel_get,
+#ifdef CONFIG_BMI160_FIFO
+	.fifo_read = bmi160_fifo_read,
+	.frames_decode = bmi160_frames_decode,
+#endif
 };
 
 int bmi160_init(struct device *dev)
@@ -907,6 +1101,13 @@ int bmi160_init(struct device *dev)
 		return -EIO;
 	}
 
+#ifdef CONFIG_BMI160_FIFO
+	if (bmi160_fifo_init(dev) < 0) {
+		SYS_LOG_DBG("Failed to set up the FIFO.");
+		return -EIO;
+	}
+#endif
+
 #ifdef CONFIG_BMI160_TRIGGER
 	if (bmi160_trigger_mode_init(dev) < 0) {
 		SYS_LOG_DBG("Cannot set up trigger mode.");
@@ -193,6 +193,18 @@
 #define BMI160_CMD_PMU_GYR		0x14
 #define BMI160_CMD_PMU_MAG		0x18
 #define BMI160_CMD_SOFT_RESET		0xB6
+#define BMI160_CMD_FIFO_FLUSH		0xB0
+
+/* BMI160_REG_FIFO_LENGTH0 */
+#define BMI160_FIFO_LENGTH_MASK		0x7FF
+
+/* BMI160_REG_FIFO_CONFIG1 */
+#define BMI160_FIFO_GYR_EN		BIT(7)
+#define BMI160_FIFO_ACC_EN		BIT(6)
+#define BMI160_FIFO_HEADER_EN		BIT(4)
+
+/* the watermark is set in units of 4 bytes */
+#define BMI160_FIFO_WM_UNIT		4
 
 /* BMI160_REG_FOC_CONF */
 #define BMI160_FOC_ACC_Z_POS		0
@@ -425,6 +437,17 @@ union bmi160_sample {
 	} __packed;
 };
 
+/* headerless FIFO frames have the same layout as the data registers */
+#if !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
+#	define BMI160_FRAME_ACC_OFS		3
+#else
+#	define BMI160_FRAME_ACC_OFS		0
+#endif
+
+/* one dummy byte ahead of the frames, needed by SPI */
+#define BMI160_FIFO_BUF_SIZE \
+	(CONFIG_BMI160_FIFO_BURST_FRAMES * BMI160_SAMPLE_SIZE + 1)
+
 struct bmi160_scale {
 	uint16_t acc; /* micro m/s^2/lsb */
 	uint16_t gyr; /* micro radians/s/lsb */
@@ -440,6 +463,10 @@ struct bmi160_device_data {
 	union bmi160_sample sample;
 	struct bmi160_scale scale;
 
+#ifdef CONFIG_BMI160_FIFO
+	uint8_t fifo_buf[BMI160_FIFO_BUF_SIZE];
+#endif
+
 #ifdef CONFIG_BMI160_TRIGGER_OWN_THREAD
 	struct k_sem sem;
 #endif
@@ -457,6 +484,10 @@ struct bmi160_device_data {
 #if !defined(CONFIG_BMI160_GYRO_PMU_SUSPEND)
 	sensor_trigger_handler_t handler_drdy_gyr;
 #endif
+#ifdef CONFIG_BMI160_FIFO
+	sensor_trigger_handler_t handler_fifo_wm;
+	struct sensor_trigger fifo_wm_trigger;
+#endif
 #endif /* CONFIG_BMI160_TRIGGER */
 };
 
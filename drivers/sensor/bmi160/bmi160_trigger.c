@@ -46,6 +46,17 @@ static void bmi160_handle_drdy(struct device *dev, uint8_t status)
 #endif
 }
 
+#ifdef CONFIG_BMI160_FIFO
+static void bmi160_handle_fifo_wm(struct device *dev)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+
+	if (bmi160->handler_fifo_wm) {
+		bmi160->handler_fifo_wm(dev, &bmi160->fifo_wm_trigger);
+	}
+}
+#endif
+
 static void bmi160_handle_interrupts(void *arg)
 {
 	struct device *dev = (struct device *)arg;
@@ -74,6 +85,12 @@ static void bmi160_handle_interrupts(void *arg)
 		bmi160_handle_drdy(dev, buf.status);
 	}
 
+#ifdef CONFIG_BMI160_FIFO
+	if (buf.int_status[1] & BMI160_INT_STATUS1_FWM) {
+		bmi160_handle_fifo_wm(dev);
+	}
+#endif
+
 }
 
 #ifdef CONFIG_BMI160_TRIGGER_OWN_THREAD
@@ -156,6 +173,25 @@ static int bmi160_trigger_drdy_set(struct device *dev,
 	return 0;
 }
 
+#ifdef CONFIG_BMI160_FIFO
+static int bmi160_trigger_fifo_wm_set(struct device *dev,
+				      const struct sensor_trigger *trig,
+				      sensor_trigger_handler_t handler)
+{
+	struct bmi160_device_data *bmi160 = dev->driver_data;
+
+	bmi160->handler_fifo_wm = handler;
+	bmi160->fifo_wm_trigger = *trig;
+
+	if (bmi160_reg_update(dev, BMI160_REG_INT_EN1, BMI160_INT_FWM_EN,
+			      handler ? BMI160_INT_FWM_EN : 0) < 0) {
+		return -EIO;
+	}
+
+	return 0;
+}
+#endif
+
 #if !defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
 static int bmi160_trigger_anym_set(struct device *dev,
 				   sensor_trigger_handler_t handler)
@@ -253,6 +289,12 @@ int bmi160_trigger_set(struct device *dev,
 		       const struct sensor_trigger *trig,
 		       sensor_trigger_handler_t handler)
 {
+#ifdef CONFIG_BMI160_FIFO
+	/* the FIFO holds the frames of both sensors */
+	if (trig->type == SENSOR_TRIG_FIFO_WATERMARK) {
+		return bmi160_trigger_fifo_wm_set(dev, trig, handler);
+	}
+#endif
 #if !defined(CONFIG_BMI160_ACCEL_PMU_SUSPEND)
 	if (trig->chan == SENSOR_CHAN_ACCEL_XYZ) {
 		return bmi160_trigger_set_acc(dev, trig, handler);
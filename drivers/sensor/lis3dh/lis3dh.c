@@ -61,7 +61,8 @@ int lis3dh_sample_fetch(struct device *dev, enum sensor_channel chan)
 	 * a burst read can be used to read all the samples
 	 */
 	if (i2c_burst_read(drv_data->i2c, LIS3DH_I2C_ADDRESS,
-			   LIS3DH_REG_ACCEL_X_LSB, buf, 6) < 0) {
+			   LIS3DH_REG_ACCEL_X_LSB | LIS3DH_AUTOINCREMENT_ADDR,
+			   buf, 6) < 0) {
 		SYS_LOG_DBG("Could not read accel axis data");
 		return -EIO;
 	}
@@ -73,12 +74,147 @@ int lis3dh_sample_fetch(struct device *dev, enum sensor_channel chan)
 	return 0;
 }
 
+#ifdef CONFIG_LIS3DH_FIFO
+static int lis3dh_set_fifo_watermark(struct device *dev, int frames)
+{
+	struct lis3dh_data *drv_data = dev->driver_data;
+
+	if (frames < 1 || frames > LIS3DH_FIFO_SIZE) {
+		return -EINVAL;
+	}
+
+	/* the watermark flag is raised once the FIFO holds more than FTH */
+	if (i2c_reg_write_byte(drv_data->i2c, LIS3DH_I2C_ADDRESS,
+			       LIS3DH_REG_FIFO_CTRL, LIS3DH_FIFO_MODE_STREAM |
+			       ((frames - 1) & LIS3DH_FIFO_FTH_MASK)) < 0) {
+		SYS_LOG_DBG("Failed to set FIFO watermark.");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int lis3dh_attr_set(struct device *dev, enum sensor_channel chan,
+			   enum sensor_attribute attr,
+			   const struct sensor_value *val)
+{
+	if (attr != SENSOR_ATTR_FIFO_WATERMARK) {
+		return -ENOTSUP;
+	}
+
+	return lis3dh_set_fifo_watermark(dev, val->val1);
+}
+
+static int lis3dh_fifo_read(struct device *dev, struct sensor_frame *frames,
+			    size_t max_frames)
+{
+	struct lis3dh_data *drv_data = dev->driver_data;
+	uint32_t now, period;
+	uint8_t *buf = drv_data->fifo_buf;
+	uint8_t src;
+	size_t level, count, i;
+
+	if (i2c_reg_read_byte(drv_data->i2c, LIS3DH_I2C_ADDRESS,
+			      LIS3DH_REG_FIFO_SRC, &src) < 0) {
+		SYS_LOG_DBG("Could not read FIFO status");
+		return -EIO;
+	}
+
+	level = (src & LIS3DH_FIFO_OVRN_BIT) ?
+		LIS3DH_FIFO_SIZE : (src & LIS3DH_FIFO_FSS_MASK);
+	count = min(level, max_frames);
+	if (count == 0) {
+		return 0;
+	}
+
+	now = k_cycle_get_32();
+
+	/*
+	 * in FIFO mode the address wraps from the Z axis MSB back to the
+	 * X axis LSB, so one burst drains all the frames
+	 */
+	if (i2c_burst_read(drv_data->i2c, LIS3DH_I2C_ADDRESS,
+			   LIS3DH_REG_ACCEL_X_LSB | LIS3DH_AUTOINCREMENT_ADDR,
+			   buf, count * LIS3DH_FRAME_SIZE) < 0) {
+		SYS_LOG_DBG("Could not read FIFO data");
+		return -EIO;
+	}
+
+	/* the newest frame of the FIFO was sampled right before the read */
+	period = sys_clock_hw_cycles_per_sec / LIS3DH_ODR_HZ;
+
+	for (i = 0; i < count; i++, buf += LIS3DH_FRAME_SIZE) {
+		frames[i].timestamp = now - (level - 1 - i) * period;
+		frames[i].data[0] = (buf[1] << 8) | buf[0];
+		frames[i].data[1] = (buf[3] << 8) | buf[2];
+		frames[i].data[2] = (buf[5] << 8) | buf[4];
+	}
+
+	return count;
+}
+
+static int lis3dh_frames_decode(struct device *dev, enum sensor_channel chan,
+				const struct sensor_frame *frames,
+				size_t count, struct sensor_value *val)
+{
+	size_t i;
+	int axis;
+
+	ARG_UNUSED(dev);
+
+	if (chan == SENSOR_CHAN_ACCEL_XYZ) {
+		for (i = 0; i < count; i++, val += 3) {
+			lis3dh_convert(val, frames[i].data[0]);
+			lis3dh_convert(val + 1, frames[i].data[1]);
+			lis3dh_convert(val + 2, frames[i].data[2]);
+		}
+
+		return 0;
+	}
+
+	if (chan == SENSOR_CHAN_ACCEL_X) {
+		axis = 0;
+	} else if (chan == SENSOR_CHAN_ACCEL_Y) {
+		axis = 1;
+	} else if (chan == SENSOR_CHAN_ACCEL_Z) {
+		axis = 2;
+	} else {
+		return -ENOTSUP;
+	}
+
+	for (i = 0; i < count; i++) {
+		lis3dh_convert(val + i, frames[i].data[axis]);
+	}
+
+	return 0;
+}
+
+static int lis3dh_init_fifo(struct device *dev)
+{
+	struct lis3dh_data *drv_data = dev->driver_data;
+
+	if (lis3dh_set_fifo_watermark(dev, CONFIG_LIS3DH_FIFO_WATERMARK) < 0) {
+		return -EIO;
+	}
+
+	return i2c_reg_write_byte(drv_data->i2c, LIS3DH_I2C_ADDRESS,
+				  LIS3DH_REG_CTRL5, LIS3DH_FIFO_EN_BIT);
+}
+#endif /* CONFIG_LIS3DH_FIFO */
+
 static const struct sensor_driver_api lis3dh_driver_api = {
+#if CONFIG_LIS3DH_FIFO
+	.attr_set = lis3dh_attr_set,
+#endif
 #if CONFIG_LIS3DH_TRIGGER
 	.trigger_set = lis3dh_trigger_set,
 #endif
 	.sample_fetch = lis3dh_sample_fetch,
 	.channel_get = lis3dh_channel_get,
+#if CONFIG_LIS3DH_FIFO
+	.fifo_read = lis3dh_fifo_read,
+	.frames_decode = lis3dh_frames_decode,
+#endif
 };
 
 int lis3dh_init(struct device *dev)
@@ -106,6 +242,13 @@ int lis3dh_init(struct device *dev)
 		return -EIO;
 	}
 
+#ifdef CONFIG_LIS3DH_FIFO
+	if (lis3dh_init_fifo(dev) < 0) {
+		SYS_LOG_DBG("Failed to enable FIFO.");
+		return -EIO;
+	}
+#endif
+
 #ifdef CONFIG_LIS3DH_TRIGGER
 	if (lis3dh_init_interrupt(dev) < 0) {
 		SYS_LOG_DBG("Failed to initialize interrupts.");
@@ -52,8 +52,32 @@
 #define LIS3DH_ODR_SHIFT		4
 #define LIS3DH_ODR_BITS			(LIS3DH_ODR_IDX << LIS3DH_ODR_SHIFT)
 
+/* sampling frequency, in Hz, of each data rate */
+#if LIS3DH_ODR_IDX == 1
+	#define LIS3DH_ODR_HZ		1
+#elif LIS3DH_ODR_IDX == 2
+	#define LIS3DH_ODR_HZ		10
+#elif LIS3DH_ODR_IDX == 3
+	#define LIS3DH_ODR_HZ		25
+#elif LIS3DH_ODR_IDX == 4
+	#define LIS3DH_ODR_HZ		50
+#elif LIS3DH_ODR_IDX == 5
+	#define LIS3DH_ODR_HZ		100
+#elif LIS3DH_ODR_IDX == 6
+	#define LIS3DH_ODR_HZ		200
+#elif LIS3DH_ODR_IDX == 7
+	#define LIS3DH_ODR_HZ		400
+#elif LIS3DH_ODR_IDX == 8
+	#define LIS3DH_ODR_HZ		1600
+#elif defined(CONFIG_LIS3DH_ODR_9_NORMAL)
+	#define LIS3DH_ODR_HZ		1250
+#else
+	#define LIS3DH_ODR_HZ		5000
+#endif
+
 #define LIS3DH_REG_CTRL3		0x22
 #define LIS3DH_EN_DRDY1_INT1		BIT(4)
+#define LIS3DH_EN_WTM_INT1		BIT(2)
 
 #define LIS3DH_REG_CTRL4		0x23
 #define LIS3DH_FS_SHIFT			4
@@ -79,12 +103,31 @@
 #define LIS3DH_REG_ACCEL_Y_MSB		0x2B
 #define LIS3DH_REG_ACCEL_Z_MSB		0x2D
 
+#define LIS3DH_REG_CTRL5		0x24
+#define LIS3DH_FIFO_EN_BIT		BIT(6)
+
+#define LIS3DH_REG_FIFO_CTRL		0x2E
+#define LIS3DH_FIFO_MODE_STREAM		(2 << 6)
+#define LIS3DH_FIFO_FTH_MASK		BIT_MASK(5)
+
+#define LIS3DH_REG_FIFO_SRC		0x2F
+#define LIS3DH_FIFO_WTM_BIT		BIT(7)
+#define LIS3DH_FIFO_OVRN_BIT		BIT(6)
+#define LIS3DH_FIFO_FSS_MASK		BIT_MASK(5)
+
+#define LIS3DH_FIFO_SIZE		32
+#define LIS3DH_FRAME_SIZE		6
+
 struct lis3dh_data {
 	struct device *i2c;
 	int16_t x_sample;
 	int16_t y_sample;
 	int16_t z_sample;
 
+#ifdef CONFIG_LIS3DH_FIFO
+	uint8_t fifo_buf[LIS3DH_FIFO_SIZE * LIS3DH_FRAME_SIZE];
+#endif
+
 #ifdef CONFIG_LIS3DH_TRIGGER
 	struct device *gpio;
 	struct gpio_callback gpio_cb;
@@ -92,6 +135,11 @@ struct lis3dh_data {
 	struct sensor_trigger data_ready_trigger;
 	sensor_trigger_handler_t data_ready_handler;
 
+#ifdef CONFIG_LIS3DH_FIFO
+	struct sensor_trigger fifo_wtm_trigger;
+	sensor_trigger_handler_t fifo_wtm_handler;
+#endif
+
 #if defined(CONFIG_LIS3DH_TRIGGER_OWN_THREAD)
 	char __stack thread_stack[CONFIG_LIS3DH_THREAD_STACK_SIZE];
 	struct k_sem gpio_sem;
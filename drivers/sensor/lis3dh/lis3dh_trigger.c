@@ -18,17 +18,45 @@ int lis3dh_trigger_set(struct device *dev,
 {
 	struct lis3dh_data *drv_data = dev->driver_data;
 
-	if (trig->type != SENSOR_TRIG_DATA_READY) {
+	if (trig->type == SENSOR_TRIG_DATA_READY) {
+		gpio_pin_disable_callback(drv_data->gpio,
+					  CONFIG_LIS3DH_GPIO_PIN_NUM);
+
+		drv_data->data_ready_handler = handler;
+		drv_data->data_ready_trigger = *trig;
+#ifdef CONFIG_LIS3DH_FIFO
+	} else if (trig->type == SENSOR_TRIG_FIFO_WATERMARK) {
+		gpio_pin_disable_callback(drv_data->gpio,
+					  CONFIG_LIS3DH_GPIO_PIN_NUM);
+
+		drv_data->fifo_wtm_handler = handler;
+		drv_data->fifo_wtm_trigger = *trig;
+#endif
+	} else {
 		return -ENOTSUP;
 	}
 
-	gpio_pin_disable_callback(drv_data->gpio, CONFIG_LIS3DH_GPIO_PIN_NUM);
+#ifdef CONFIG_LIS3DH_FIFO
+	/* only route to INT1 the events someone waits for */
+	if (i2c_reg_write_byte(drv_data->i2c, LIS3DH_I2C_ADDRESS,
+			       LIS3DH_REG_CTRL3,
+			       (drv_data->data_ready_handler ?
+				LIS3DH_EN_DRDY1_INT1 : 0) |
+			       (drv_data->fifo_wtm_handler ?
+				LIS3DH_EN_WTM_INT1 : 0)) < 0) {
+		SYS_LOG_DBG("Failed to set interrupt sources.");
+		return -EIO;
+	}
 
-	drv_data->data_ready_handler = handler;
+	if (drv_data->data_ready_handler == NULL &&
+	    drv_data->fifo_wtm_handler == NULL) {
+		return 0;
+	}
+#else
 	if (handler == NULL) {
 		return 0;
 	}
-	drv_data->data_ready_trigger = *trig;
+#endif
 
 	gpio_pin_enable_callback(drv_data->gpio, CONFIG_LIS3DH_GPIO_PIN_NUM);
 
@@ -56,6 +84,16 @@ static void lis3dh_thread_cb(void *arg)
 {
 	struct device *dev = arg;
 	struct lis3dh_data *drv_data = dev->driver_data;
+#ifdef CONFIG_LIS3DH_FIFO
+	uint8_t src;
+
+	if (drv_data->fifo_wtm_handler != NULL &&
+	    i2c_reg_read_byte(drv_data->i2c, LIS3DH_I2C_ADDRESS,
+			      LIS3DH_REG_FIFO_SRC, &src) == 0 &&
+	    (src & LIS3DH_FIFO_WTM_BIT)) {
+		drv_data->fifo_wtm_handler(dev, &drv_data->fifo_wtm_trigger);
+	}
+#endif
 
 	if (drv_data->data_ready_handler != NULL) {
 		drv_data->data_ready_handler(dev,
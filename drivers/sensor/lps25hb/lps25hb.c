@@ -43,17 +43,15 @@ static int lps25hb_sample_fetch(struct device *dev,
 	struct lps25hb_data *data = dev->driver_data;
 	const struct lps25hb_config *config = dev->config->config_info;
 	uint8_t out[5];
-	int offset;
 
 	__ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL);
 
-	for (offset = 0; offset < sizeof(out); ++offset) {
-		if (i2c_reg_read_byte(data->i2c_master, config->i2c_slave_addr,
-				      LPS25HB_REG_PRESS_OUT_XL + offset,
-				      out + offset) < 0) {
-			SYS_LOG_DBG("failed to read sample");
-			return -EIO;
-		}
+	/* pressure and temperature in one transfer */
+	if (i2c_burst_read(data->i2c_master, config->i2c_slave_addr,
+			   LPS25HB_REG_PRESS_OUT_XL | LPS25HB_AUTOINCREMENT_ADDR,
+			   out, sizeof(out)) < 0) {
+		SYS_LOG_DBG("failed to read sample");
+		return -EIO;
 	}
 
 	data->sample_press = (int32_t)((uint32_t)(out[0]) |
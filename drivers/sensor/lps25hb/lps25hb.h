@@ -15,6 +15,8 @@
 #include <i2c.h>
 #include <misc/util.h>
 
+#define LPS25HB_AUTOINCREMENT_ADDR              BIT(7)
+
 #define LPS25HB_REG_WHO_AM_I                    0x0F
 #define LPS25HB_VAL_WHO_AM_I                    0xBD
 
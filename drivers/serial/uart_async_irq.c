@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <kernel.h>
+#include <misc/util.h>
+#include <uart.h>
+
+#include "uart_async_irq.h"
+
+static void async_evt(struct uart_async_irq *async, struct uart_event *evt)
+{
+	if (async->cb) {
+		async->cb(evt, async->user_data);
+	}
+}
+
+static void tx_done(struct uart_async_irq *async, enum uart_event_type type)
+{
+	struct uart_event evt = {
+		.type = type,
+		.data.tx.buf = async->tx_buf,
+		.data.tx.len = async->tx_pos,
+	};
+
+	uart_irq_tx_disable(async->dev);
+	async->tx_buf = NULL;
+
+	async_evt(async, &evt);
+}
+
+static void tx_fill(struct uart_async_irq *async)
+{
+	if (!async->tx_buf) {
+		uart_irq_tx_disable(async->dev);
+		return;
+	}
+
+	async->tx_pos += uart_fifo_fill(async->dev,
+					async->tx_buf + async->tx_pos,
+					async->tx_len - async->tx_pos);
+
+	if (async->tx_pos == async->tx_len) {
+		tx_done(async, UART_TX_DONE);
+	}
+}
+
+/* report the data received since the last report */
+static void rx_flush(struct uart_async_irq *async)
+{
+	struct uart_event evt = {
+		.type = UART_RX_RDY,
+		.data.rx.buf = async->rx_buf,
+		.data.rx.offset = async->rx_offset,
+		.data.rx.len = async->rx_pos - async->rx_offset,
+	};
+
+	if (!evt.data.rx.len) {
+		return;
+	}
+
+	async->rx_offset = async->rx_pos;
+
+	async_evt(async, &evt);
+}
+
+static void rx_buf_release(struct uart_async_irq *async, uint8_t *buf)
+{
+	struct uart_event evt = {
+		.type = UART_RX_BUF_RELEASED,
+		.data.rx_buf.buf = buf,
+	};
+
+	async_evt(async, &evt);
+}
+
+static void rx_buf_request(struct uart_async_irq *async)
+{
+	struct uart_event evt = {
+		.type = UART_RX_BUF_REQUEST,
+	};
+
+	async_evt(async, &evt);
+}
+
+static void rx_stop(struct uart_async_irq *async)
+{
+	struct uart_event evt = {
+		.type = UART_RX_DISABLED,
+	};
+
+	uart_irq_rx_disable(async->dev);
+	k_timer_stop(&async->rx_timer);
+	async->rx_enabled = false;
+
+	rx_flush(async);
+	rx_buf_release(async, async->rx_buf);
+	async->rx_buf = NULL;
+
+	if (async->rx_next_buf) {
+		rx_buf_release(async, async->rx_next_buf);
+		async->rx_next_buf = NULL;
+	}
+
+	async_evt(async, &evt);
+}
+
+/* the current buffer is full, move on to the next one if there is one */
+static void rx_buf_switch(struct uart_async_irq *async)
+{
+	if (!async->rx_next_buf) {
+		rx_stop(async);
+		return;
+	}
+
+	rx_flush(async);
+	rx_buf_release(async, async->rx_buf);
+
+	async->rx_buf = async->rx_next_buf;
+	async->rx_len = async->rx_next_len;
+	async->rx_pos = 0;
+	async->rx_offset = 0;
+	async->rx_next_buf = NULL;
+
+	rx_buf_request(async);
+}
+
+static void rx_drain(struct uart_async_irq *async)
+{
+	uint8_t discard;
+	int len;
+
+	if (!async->rx_enabled) {
+		while (uart_fifo_read(async->dev, &discard, 1)) {
+		}
+		uart_irq_rx_disable(async->dev);
+		return;
+	}
+
+	do {
+		len = uart_fifo_read(async->dev, async->rx_buf + async->rx_pos,
+				     async->rx_len - async->rx_pos);
+		async->rx_pos += len;
+
+		if (async->rx_pos == async->rx_len) {
+			rx_buf_switch(async);
+		}
+	} while (len && async->rx_enabled);
+
+	if (!async->rx_enabled || async->rx_pos == async->rx_offset) {
+		return;
+	}
+
+	if (async->rx_timeout == 0) {
+		rx_flush(async);
+	} else if (async->rx_timeout != K_FOREVER) {
+		/* restarted on every burst, so it fires once the line is idle */
+		k_timer_start(&async->rx_timer, async->rx_timeout, 0);
+	}
+}
+
+static void rx_timeout(struct k_timer *timer)
+{
+	struct uart_async_irq *async =
+		CONTAINER_OF(timer, struct uart_async_irq, rx_timer);
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (async->rx_enabled) {
+		rx_flush(async);
+	}
+
+	irq_unlock(key);
+}
+
+void uart_async_irq_init(struct uart_async_irq *async, struct device *dev)
+{
+	async->dev = dev;
+	k_timer_init(&async->rx_timer, rx_timeout, NULL);
+}
+
+int uart_async_irq_callback_set(struct uart_async_irq *async,
+				uart_callback_t cb, void *user_data)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	async->cb = cb;
+	async->user_data = user_data;
+	irq_unlock(key);
+
+	return 0;
+}
+
+int uart_async_irq_tx(struct uart_async_irq *async, const uint8_t *buf,
+		      size_t len)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (async->tx_buf) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	async->tx_buf = buf;
+	async->tx_len = len;
+	async->tx_pos = 0;
+
+	/* prime the FIFO, the interrupt refills it */
+	tx_fill(async);
+	if (async->tx_buf) {
+		uart_irq_tx_enable(async->dev);
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+int uart_async_irq_tx_abort(struct uart_async_irq *async)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (!async->tx_buf) {
+		irq_unlock(key);
+		return -EFAULT;
+	}
+
+	tx_done(async, UART_TX_ABORTED);
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+int uart_async_irq_rx_enable(struct uart_async_irq *async, uint8_t *buf,
+			     size_t len, int32_t timeout)
+{
+	unsigned int key;
+
+	if (!len) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (async->rx_enabled) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	async->rx_buf = buf;
+	async->rx_len = len;
+	async->rx_pos = 0;
+	async->rx_offset = 0;
+	async->rx_next_buf = NULL;
+	async->rx_timeout = timeout;
+	async->rx_enabled = true;
+
+	rx_buf_request(async);
+
+	uart_irq_rx_enable(async->dev);
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+int uart_async_irq_rx_buf_rsp(struct uart_async_irq *async, uint8_t *buf,
+			      size_t len)
+{
+	unsigned int key;
+	int rc = 0;
+
+	if (!len) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (!async->rx_enabled) {
+		rc = -EACCES;
+	} else if (async->rx_next_buf) {
+		rc = -EBUSY;
+	} else {
+		async->rx_next_buf = buf;
+		async->rx_next_len = len;
+	}
+
+	irq_unlock(key);
+
+	return rc;
+}
+
+int uart_async_irq_rx_disable(struct uart_async_irq *async)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (!async->rx_enabled) {
+		irq_unlock(key);
+		return -EFAULT;
+	}
+
+	rx_stop(async);
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+bool uart_async_irq_isr(struct uart_async_irq *async)
+{
+	struct device *dev = async->dev;
+
+	if (!async->cb) {
+		return false;
+	}
+
+	while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+		if (uart_irq_rx_ready(dev)) {
+			rx_drain(async);
+		} else if (uart_irq_tx_ready(dev)) {
+			tx_fill(async);
+		} else {
+			/* nothing the asynchronous API waits for */
+			break;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Asynchronous UART API on top of the interrupt driven API
+ *
+ * Drivers without DMA implement the asynchronous API with these helpers:
+ * they embed a struct uart_async_irq in their data, forward the
+ * asynchronous API calls to the matching helpers, and call
+ * uart_async_irq_isr() from their interrupt handler while a callback is
+ * set. The helpers move data with the driver's own FIFO and interrupt
+ * functions, a whole FIFO at a time.
+ */
+
+#ifndef _UART_ASYNC_IRQ_H_
+#define _UART_ASYNC_IRQ_H_
+
+#include <kernel.h>
+#include <uart.h>
+
+struct uart_async_irq {
+	struct device *dev;
+	uart_callback_t cb;
+	void *user_data;
+
+	const uint8_t *tx_buf;
+	size_t tx_len;
+	size_t tx_pos;
+
+	uint8_t *rx_buf;
+	size_t rx_len;
+	size_t rx_pos;
+	/* start of the data not reported yet */
+	size_t rx_offset;
+	uint8_t *rx_next_buf;
+	size_t rx_next_len;
+	int32_t rx_timeout;
+	struct k_timer rx_timer;
+	bool rx_enabled;
+};
+
+void uart_async_irq_init(struct uart_async_irq *async, struct device *dev);
+
+int uart_async_irq_callback_set(struct uart_async_irq *async,
+				uart_callback_t cb, void *user_data);
+
+int uart_async_irq_tx(struct uart_async_irq *async, const uint8_t *buf,
+		      size_t len);
+
+int uart_async_irq_tx_abort(struct uart_async_irq *async);
+
+int uart_async_irq_rx_enable(struct uart_async_irq *async, uint8_t *buf,
+			     size_t len, int32_t timeout);
+
+int uart_async_irq_rx_buf_rsp(struct uart_async_irq *async, uint8_t *buf,
+			      size_t len);
+
+int uart_async_irq_rx_disable(struct uart_async_irq *async);
+
+/**
+ * @brief Serve the UART interrupt in asynchronous mode
+ *
+ * @return true if the asynchronous API is in use and the interrupt was
+ * served, false if the driver should call its interrupt driven callback.
+ */
+bool uart_async_irq_isr(struct uart_async_irq *async);
+
+#endif /* _UART_ASYNC_IRQ_H_ */
@@ -40,6 +40,10 @@
 
 #include "uart_ns16550.h"
 
+#ifdef CONFIG_UART_ASYNC_API
+#include "uart_async_irq.h"
+#endif
+
 /* register definitions */
 
 #define REG_THR 0x00  /* Transmitter holding reg. */
@@ -121,6 +125,12 @@
  */
 #define FCR_FIFO_64 0x20 /* Enable 64 bytes FIFO */
 
+#ifdef CONFIG_UART_NS16750
+#define FCR_FIFO_CFG (FCR_FIFO | FCR_MODE0 | FCR_FIFO_64)
+#else
+#define FCR_FIFO_CFG (FCR_FIFO | FCR_MODE0)
+#endif
+
 /* constants for line control register */
 
 #define LCR_CS5 0x00   /* 5 bits data size */
@@ -224,6 +234,10 @@ struct uart_ns16550_dev_data_t {
 	uart_irq_callback_t	cb;	/**< Callback function pointer */
 #endif
 
+#ifdef CONFIG_UART_ASYNC_API
+	struct uart_async_irq async;	/**< Asynchronous API state */
+#endif
+
 #ifdef CONFIG_UART_NS16550_DLF
 	uint8_t dlf;		/**< DLF value */
 #endif
@@ -342,12 +356,7 @@ static int uart_ns16550_init(struct device *dev)
 	 * generate the interrupt at 8th byte
 	 * Clear TX and RX FIFO
 	 */
-	OUTBYTE(FCR(dev),
-		FCR_FIFO | FCR_MODE0 | FCR_FIFO_8 | FCR_RCVRCLR | FCR_XMITCLR
-#ifdef CONFIG_UART_NS16750
-		| FCR_FIFO_64
-#endif
-		);
+	OUTBYTE(FCR(dev), FCR_FIFO_CFG | FCR_FIFO_8 | FCR_RCVRCLR | FCR_XMITCLR);
 
 	/* clear the port */
 	INBYTE(RDR(dev));
@@ -357,6 +366,10 @@ static int uart_ns16550_init(struct device *dev)
 
 	irq_unlock(old_level);
 
+#ifdef CONFIG_UART_ASYNC_API
+	uart_async_irq_init(&dev_data->async, dev);
+#endif
+
 #ifdef CONFIG_UART_INTERRUPT_DRIVEN
 	DEV_CFG(dev)->irq_config_func(dev);
 #endif
@@ -629,6 +642,12 @@ static void uart_ns16550_isr(void *arg)
 	struct device *dev = arg;
 	struct uart_ns16550_dev_data_t * const dev_data = DEV_DATA(dev);
 
+#ifdef CONFIG_UART_ASYNC_API
+	if (uart_async_irq_isr(&dev_data->async)) {
+		return;
+	}
+#endif
+
 	if (dev_data->cb) {
 		dev_data->cb(dev);
 	}
@@ -636,6 +655,109 @@ static void uart_ns16550_isr(void *arg)
 
 #endif /* CONFIG_UART_INTERRUPT_DRIVEN */
 
+#ifdef CONFIG_UART_ASYNC_API
+
+/**
+ * @brief Set the asynchronous API callback
+ *
+ * @param dev UART device struct
+ * @param cb Callback function pointer, NULL to go back to the interrupt
+ * driven API
+ * @param user_data Pointer passed to the callback
+ *
+ * @return 0
+ */
+static int uart_ns16550_callback_set(struct device *dev, uart_callback_t cb,
+				     void *user_data)
+{
+	return uart_async_irq_callback_set(&DEV_DATA(dev)->async, cb,
+					   user_data);
+}
+
+/**
+ * @brief Start an asynchronous transmission
+ *
+ * @param dev UART device struct
+ * @param buf Data to send
+ * @param len Number of bytes to send
+ *
+ * @return 0 if successful, failed otherwise
+ */
+static int uart_ns16550_tx(struct device *dev, const uint8_t *buf, size_t len)
+{
+	return uart_async_irq_tx(&DEV_DATA(dev)->async, buf, len);
+}
+
+/**
+ * @brief Abort the asynchronous transmission
+ *
+ * @param dev UART device struct
+ *
+ * @return 0 if successful, failed otherwise
+ */
+static int uart_ns16550_tx_abort(struct device *dev)
+{
+	return uart_async_irq_tx_abort(&DEV_DATA(dev)->async);
+}
+
+/**
+ * @brief Start asynchronous reception
+ *
+ * The receive FIFO trigger is raised to 14 bytes to take fewer
+ * interrupts; the character timeout interrupt flushes shorter bursts.
+ *
+ * @param dev UART device struct
+ * @param buf Receive buffer
+ * @param len Size of the buffer
+ * @param timeout Idle line timeout in milliseconds
+ *
+ * @return 0 if successful, failed otherwise
+ */
+static int uart_ns16550_rx_enable(struct device *dev, uint8_t *buf,
+				  size_t len, int32_t timeout)
+{
+	int ret;
+
+	ret = uart_async_irq_rx_enable(&DEV_DATA(dev)->async, buf, len,
+				       timeout);
+	if (!ret) {
+		OUTBYTE(FCR(dev), FCR_FIFO_CFG | FCR_FIFO_14);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Provide the next asynchronous receive buffer
+ *
+ * @param dev UART device struct
+ * @param buf Receive buffer
+ * @param len Size of the buffer
+ *
+ * @return 0 if successful, failed otherwise
+ */
+static int uart_ns16550_rx_buf_rsp(struct device *dev, uint8_t *buf,
+				   size_t len)
+{
+	return uart_async_irq_rx_buf_rsp(&DEV_DATA(dev)->async, buf, len);
+}
+
+/**
+ * @brief Stop asynchronous reception
+ *
+ * @param dev UART device struct
+ *
+ * @return 0 if successful, failed otherwise
+ */
+static int uart_ns16550_rx_disable(struct device *dev)
+{
+	OUTBYTE(FCR(dev), FCR_FIFO_CFG | FCR_FIFO_8);
+
+	return uart_async_irq_rx_disable(&DEV_DATA(dev)->async);
+}
+
+#endif /* CONFIG_UART_ASYNC_API */
+
 #ifdef CONFIG_UART_NS16550_LINE_CTRL
 
 /**
@@ -702,6 +824,14 @@ static int uart_ns16550_drv_cmd(struct device *dev, uint32_t cmd, uint32_t p)
 		return 0;
 #endif
 
+	case CMD_SET_LOOPBACK:
+		if (p) {
+			OUTBYTE(MDC(dev), INBYTE(MDC(dev)) | MCR_LOOP);
+		} else {
+			OUTBYTE(MDC(dev), INBYTE(MDC(dev)) & ~MCR_LOOP);
+		}
+		return 0;
+
 	}
 
 	return -ENOTSUP;
@@ -733,6 +863,15 @@ static const struct uart_driver_api uart_ns16550_driver_api = {
 
 #endif
 
+#ifdef CONFIG_UART_ASYNC_API
+	.callback_set = uart_ns16550_callback_set,
+	.tx = uart_ns16550_tx,
+	.tx_abort = uart_ns16550_tx_abort,
+	.rx_enable = uart_ns16550_rx_enable,
+	.rx_buf_rsp = uart_ns16550_rx_buf_rsp,
+	.rx_disable = uart_ns16550_rx_disable,
+#endif
+
 #ifdef CONFIG_UART_NS16550_LINE_CTRL
 	.line_ctrl_set = uart_ns16550_line_ctrl_set,
 #endif
@@ -12,5 +12,6 @@
 #define _UART_NS16550_H_
 
 #define CMD_SET_DLF	0x01
+#define CMD_SET_LOOPBACK	0x02
 
 #endif /* _UART_NS16550_H_ */
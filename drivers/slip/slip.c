@@ -28,36 +28,48 @@
 #include <net/net_core.h>
 #include <console/uart_pipe.h>
 
-#define SLIP_END     0300
-#define SLIP_ESC     0333
-#define SLIP_ESC_END 0334
-#define SLIP_ESC_ESC 0335
-
-enum slip_state {
-	STATE_GARBAGE,
-	STATE_OK,
-	STATE_ESC,
+#include "slip_codec.h"
+
+#if defined(CONFIG_SLIP_STATISTICS)
+struct slip_stats {
+	uint32_t rx_frames;
+	uint32_t rx_bytes;
+	/* frames with an invalid escape sequence */
+	uint32_t rx_errors;
+	/* frames dropped for lack of buffers */
+	uint32_t rx_dropped;
+	uint32_t tx_frames;
+	uint32_t tx_bytes;
+	/* bytes on the line, escapes and END bytes included */
+	uint32_t tx_line_bytes;
 };
 
+#define SLIP_STATS(statement) statement
+#else
+#define SLIP_STATS(statement)
+#endif
+
 struct slip_context {
 	bool init_done;
 	bool first;		/* SLIP received it's byte or not after
 				 * driver initialization or SLIP_END byte.
 				 */
-	uint8_t buf[1];		/* SLIP data is read into this buf */
+	uint8_t buf[CONFIG_SLIP_RX_BUF_SIZE];	/* SLIP data is read into
+						 * this buf
+						 */
 	struct net_buf *rx;	/* and then placed into this net_buf */
 	struct net_buf *last;	/* Pointer to last fragment in the list */
-	uint8_t *ptr;		/* Where in net_buf to add data */
 	uint8_t state;
 
+	/* escaped data waiting to be written to the UART */
+	uint8_t tx_buf[CONFIG_SLIP_TX_BUF_SIZE];
+	size_t tx_len;
+
 	uint8_t mac_addr[6];
 	struct net_linkaddr ll_addr;
 
 #if defined(CONFIG_SLIP_STATISTICS)
-#define SLIP_STATS(statement)
-#else
-	uint16_t garbage;
-#define SLIP_STATS(statement) statement
+	struct slip_stats stats;
 #endif
 };
 
@@ -117,30 +129,56 @@ static void hexdump(const char *str, const uint8_t *packet,
 #define hexdump(slip, str, packet, length, ll_reserve)
 #endif
 
-static inline void slip_writeb(unsigned char c)
+static void slip_flush(struct slip_context *slip)
+{
+	if (!slip->tx_len) {
+		return;
+	}
+
+	uart_pipe_send(slip->tx_buf, slip->tx_len);
+
+	SLIP_STATS(slip->stats.tx_line_bytes += slip->tx_len);
+	slip->tx_len = 0;
+}
+
+static inline void slip_writeb(struct slip_context *slip, uint8_t c)
 {
-	uint8_t buf[1] = { c };
+	if (slip->tx_len == sizeof(slip->tx_buf)) {
+		slip_flush(slip);
+	}
+
+	slip->tx_buf[slip->tx_len++] = c;
+}
 
-	uart_pipe_send(&buf[0], 1);
+/* Escape data into the TX buffer, writing it out each time it is full. */
+static void slip_write(struct slip_context *slip, const uint8_t *data,
+		       size_t len)
+{
+	while (len) {
+		slip->tx_len += slip_encode(slip->tx_buf + slip->tx_len,
+					    sizeof(slip->tx_buf) - slip->tx_len,
+					    &data, &len);
+		if (len) {
+			slip_flush(slip);
+		}
+	}
 }
 
 static int slip_send(struct net_if *iface, struct net_buf *buf)
 {
+	struct slip_context *slip = net_if_get_device(iface)->driver_data;
 	struct net_buf *frag;
 #if defined(CONFIG_SLIP_TAP)
 	uint16_t ll_reserve = net_nbuf_ll_reserve(buf);
 	bool send_header_once = false;
 #endif
-	uint8_t *ptr;
-	uint16_t i;
-	uint8_t c;
 
 	if (!buf->frags) {
 		/* No data? */
 		return -ENODATA;
 	}
 
-	slip_writeb(SLIP_END);
+	slip_writeb(slip, SLIP_END);
 
 	for (frag = buf->frags; frag; frag = frag->frags) {
 #if defined(CONFIG_SLIP_DEBUG)
@@ -148,13 +186,9 @@ static int slip_send(struct net_if *iface, struct net_buf *buf)
 #endif
 
 #if defined(CONFIG_SLIP_TAP)
-		ptr = frag->data - ll_reserve;
-
 		/* This writes ethernet header */
 		if (!send_header_once && ll_reserve) {
-			for (i = 0; i < ll_reserve; i++) {
-				slip_writeb(*ptr++);
-			}
+			slip_write(slip, frag->data - ll_reserve, ll_reserve);
 		}
 
 		if (net_if_get_mtu(iface) > net_buf_headroom(frag)) {
@@ -164,44 +198,17 @@ static int slip_send(struct net_if *iface, struct net_buf *buf)
 			 */
 			send_header_once = true;
 			ll_reserve = 0;
-			ptr = frag->data;
 		}
-#else
-		/* There is no ll header in tun device */
-		ptr = frag->data;
 #endif
+		/* There is no ll header in tun device */
+		slip_write(slip, frag->data, frag->len);
 
-		for (i = 0; i < frag->len; ++i) {
-			c = *ptr++;
-
-			switch (c) {
-			case SLIP_END:
-				/* If it's the same code as an END character,
-				 * we send a special two character code so as
-				 * not to make the receiver think we sent
-				 * an END.
-				 */
-				slip_writeb(SLIP_ESC);
-				slip_writeb(SLIP_ESC_END);
-				break;
-			case SLIP_ESC:
-				/* If it's the same code as an ESC character,
-				 * we send a special two character code so as
-				 * not to make the receiver think we sent
-				 * an ESC.
-				 */
-				slip_writeb(SLIP_ESC);
-				slip_writeb(SLIP_ESC_ESC);
-				break;
-			default:
-				slip_writeb(c);
-			}
-		}
+		SLIP_STATS(slip->stats.tx_bytes += frag->len);
 
 #if defined(CONFIG_SLIP_DEBUG)
 		SYS_LOG_DBG("sent data %d bytes",
 			    frag->len + net_nbuf_ll_reserve(buf));
-		if (frag->len + ll_reserve) {
+		if (frag->len + net_nbuf_ll_reserve(buf)) {
 			char msg[8 + 1];
 
 			snprintf(msg, sizeof(msg), "<slip %2d", frag_count++);
@@ -214,7 +221,10 @@ static int slip_send(struct net_if *iface, struct net_buf *buf)
 	}
 
 	net_nbuf_unref(buf);
-	slip_writeb(SLIP_END);
+	slip_writeb(slip, SLIP_END);
+	slip_flush(slip);
+
+	SLIP_STATS(slip->stats.tx_frames++);
 
 	return 0;
 }
@@ -237,6 +247,9 @@ static void process_msg(struct slip_context *slip)
 		return;
 	}
 
+	SLIP_STATS(slip->stats.rx_frames++);
+	SLIP_STATS(slip->stats.rx_bytes += net_buf_frags_len(buf->frags));
+
 	if (net_recv_data(net_if_get_by_link_addr(&slip->ll_addr), buf) < 0) {
 		net_nbuf_unref(buf);
 	}
@@ -244,122 +257,115 @@ static void process_msg(struct slip_context *slip)
 	slip->rx = slip->last = NULL;
 }
 
-static inline int slip_input_byte(struct slip_context *slip,
-				  unsigned char c)
+static void slip_drop(struct slip_context *slip)
 {
-	switch (slip->state) {
-	case STATE_GARBAGE:
-		if (c == SLIP_END) {
-			slip->state = STATE_OK;
-		}
-
-		return 0;
-	case STATE_ESC:
-		if (c == SLIP_ESC_END) {
-			c = SLIP_END;
-		} else if (c == SLIP_ESC_ESC) {
-			c = SLIP_ESC;
-		} else {
-			slip->state = STATE_GARBAGE;
-			SLIP_STATS(slip->garbage++);
-			return 0;
-		}
-
-		slip->state = STATE_OK;
+	if (slip->rx) {
+		net_nbuf_unref(slip->rx);
+	}
 
-		break;
-	case STATE_OK:
-		if (c == SLIP_ESC) {
-			slip->state = STATE_ESC;
-			return 0;
-		}
+	slip->rx = NULL;
+	slip->last = NULL;
+}
 
-		if (c == SLIP_END) {
-			slip->state = STATE_OK;
-			slip->first = false;
+/* Add decoded data to the frame being received. */
+static void slip_input(struct slip_context *slip, const uint8_t *data,
+		       size_t len)
+{
+	size_t n;
 
-			if (slip->rx) {
-				return 1;
-			}
+	if (!len) {
+		return;
+	}
 
-			return 0;
-		}
+	if (!slip->first) {
+		slip->first = true;
 
-		if (slip->first && !slip->rx) {
-			/* Must have missed buffer allocation on first byte. */
-			return 0;
+		slip->rx = net_nbuf_get_reserve_rx(0, K_NO_WAIT);
+		if (!slip->rx) {
+			SLIP_STATS(slip->stats.rx_dropped++);
+			return;
 		}
 
-		if (!slip->first) {
-			slip->first = true;
-
-			slip->rx = net_nbuf_get_reserve_rx(0, K_NO_WAIT);
-			if (!slip->rx) {
-				return 0;
-			}
-
-			slip->last = net_nbuf_get_frag(slip->rx, K_NO_WAIT);
-			if (!slip->last) {
-				net_nbuf_unref(slip->rx);
-				slip->rx = NULL;
-				return 0;
-			}
-
-			net_buf_frag_add(slip->rx, slip->last);
-			slip->ptr = net_nbuf_ip_data(slip->rx);
+		slip->last = net_nbuf_get_frag(slip->rx, K_NO_WAIT);
+		if (!slip->last) {
+			slip_drop(slip);
+			SLIP_STATS(slip->stats.rx_dropped++);
+			return;
 		}
 
-		break;
+		net_buf_frag_add(slip->rx, slip->last);
 	}
 
-	if (!net_buf_tailroom(slip->last)) {
-		/* We need to allocate a new fragment */
-		struct net_buf *frag;
+	if (!slip->rx) {
+		/* Must have missed buffer allocation on first byte. */
+		return;
+	}
 
-		frag = net_nbuf_get_reserve_rx_data(0, K_NO_WAIT);
-		if (!frag) {
-			SYS_LOG_ERR("[%p] cannot allocate data fragment",
-				    slip);
-			net_nbuf_unref(slip->rx);
-			slip->rx = NULL;
-			slip->last = NULL;
+	while (len) {
+		if (!net_buf_tailroom(slip->last)) {
+			/* We need to allocate a new fragment */
+			struct net_buf *frag;
+
+			frag = net_nbuf_get_reserve_rx_data(0, K_NO_WAIT);
+			if (!frag) {
+				SYS_LOG_ERR("[%p] cannot allocate data fragment",
+					    slip);
+				slip_drop(slip);
+				SLIP_STATS(slip->stats.rx_dropped++);
+				return;
+			}
 
-			return 0;
+			net_buf_frag_insert(slip->last, frag);
+			slip->last = frag;
 		}
 
-		net_buf_frag_insert(slip->last, frag);
-		slip->last = frag;
-		slip->ptr = slip->last->data;
+		n = min(len, net_buf_tailroom(slip->last));
+		net_buf_add_mem(slip->last, data, n);
+		data += n;
+		len -= n;
 	}
-
-	/* The net_buf_add_u8() cannot add data to ll header so we need
-	 * a way to do it.
-	 */
-	if (slip->ptr < slip->last->data) {
-		*slip->ptr = c;
-	} else {
-		slip->ptr = net_buf_add_u8(slip->last, c);
-	}
-
-	slip->ptr++;
-
-	return 0;
 }
 
 static uint8_t *recv_cb(uint8_t *buf, size_t *off)
 {
 	struct slip_context *slip =
 		CONTAINER_OF(buf, struct slip_context, buf);
-	size_t i;
+	uint8_t *data = buf;
+	size_t len = *off;
+	size_t used, decoded;
+	int flags;
+
+	*off = 0;
 
 	if (!slip->init_done) {
-		*off = 0;
 		return buf;
 	}
 
-	for (i = 0; i < *off; i++) {
-		if (slip_input_byte(slip, buf[i])) {
+	while (len) {
+		used = slip_decode(&slip->state, data, len, &decoded, &flags);
+		slip_input(slip, data, decoded);
+		data += used;
+		len -= used;
+
+		if (flags & SLIP_FRAME_ERROR) {
+			/* The rest of the frame is skipped up to SLIP_END */
+			SLIP_STATS(slip->stats.rx_errors++);
+			slip_drop(slip);
+			slip->first = false;
+		}
+
+		if (!(flags & SLIP_FRAME_END)) {
+			continue;
+		}
+
+		slip->first = false;
+
+		if (!slip->rx) {
+			continue;
+		}
+
 #if defined(CONFIG_SLIP_DEBUG)
+		{
 			struct net_buf *frag = slip->rx->frags;
 			int bytes = net_buf_frags_len(frag);
 			int count = 0;
@@ -376,14 +382,11 @@ static uint8_t *recv_cb(uint8_t *buf, size_t *off)
 			}
 
 			SYS_LOG_DBG("[%p] received data %d bytes", slip, bytes);
-#endif
-			process_msg(slip);
-			break;
 		}
+#endif
+		process_msg(slip);
 	}
 
-	*off = 0;
-
 	return buf;
 }
 
@@ -396,6 +399,7 @@ static int slip_init(struct device *dev)
 	slip->state = STATE_OK;
 	slip->rx = NULL;
 	slip->first = false;
+	slip->tx_len = 0;
 
 #if defined(CONFIG_SLIP_TAP) && defined(CONFIG_NET_IPV4)
 	SYS_LOG_DBG("ARP enabled");
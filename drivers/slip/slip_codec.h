@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Private API for the SLIP driver: buffer encoder and decoder
+ *
+ * Data is escaped and unescaped a run at a time: the bytes between two
+ * END or ESC bytes are found by scanning a word at a time and copied as a
+ * block, so that the per-byte work is one comparison for data that needs
+ * no escaping, which is nearly all of it.
+ */
+
+#ifndef __SLIP_CODEC_H__
+#define __SLIP_CODEC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <toolchain.h>
+#include <misc/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+
+/* set by slip_decode() */
+#define SLIP_FRAME_END		BIT(0)
+#define SLIP_FRAME_ERROR	BIT(1)
+
+enum slip_state {
+	STATE_GARBAGE,
+	STATE_OK,
+	STATE_ESC,
+};
+
+#define _SLIP_ONES	0x01010101UL
+#define _SLIP_HIGHS	0x80808080UL
+
+/* word read over the bytes of a buffer */
+typedef uint32_t __attribute__((__may_alias__)) _slip_word_t;
+
+/* non zero if one of the bytes of @a w is END or ESC */
+static inline uint32_t _slip_word_special(uint32_t w)
+{
+	uint32_t end = w ^ (_SLIP_ONES * SLIP_END);
+	uint32_t esc = w ^ (_SLIP_ONES * SLIP_ESC);
+
+	return ((end - _SLIP_ONES) & ~end & _SLIP_HIGHS) |
+	       ((esc - _SLIP_ONES) & ~esc & _SLIP_HIGHS);
+}
+
+/* Number of bytes at the start of @a data that are neither END nor ESC. */
+static inline size_t slip_plain_len(const uint8_t *data, size_t len)
+{
+	const uint8_t *ptr = data;
+	const uint8_t *end = data + len;
+
+	while (ptr < end && ((uintptr_t)ptr & (sizeof(_slip_word_t) - 1))) {
+		if (*ptr == SLIP_END || *ptr == SLIP_ESC) {
+			return ptr - data;
+		}
+		ptr++;
+	}
+
+	while (end - ptr >= sizeof(_slip_word_t) &&
+	       !_slip_word_special(*(const _slip_word_t *)ptr)) {
+		ptr += sizeof(_slip_word_t);
+	}
+
+	while (ptr < end && *ptr != SLIP_END && *ptr != SLIP_ESC) {
+		ptr++;
+	}
+
+	return ptr - data;
+}
+
+/*
+ * Escape the bytes of @a *data into @a out, as many as fit in @a size
+ * bytes; an escape sequence is never split. Advances @a *data and
+ * @a *len past the bytes consumed and returns the number of bytes
+ * written.
+ */
+static inline size_t slip_encode(uint8_t *out, size_t size,
+				 const uint8_t **data, size_t *len)
+{
+	const uint8_t *in = *data;
+	size_t left = *len;
+	size_t used = 0;
+	size_t run;
+
+	while (left && used < size) {
+		run = slip_plain_len(in, min(left, size - used));
+		memcpy(out + used, in, run);
+		used += run;
+		in += run;
+		left -= run;
+
+		if (!left || (*in != SLIP_END && *in != SLIP_ESC)) {
+			/* all consumed, or the output is full */
+			continue;
+		}
+
+		if (size - used < 2) {
+			break;
+		}
+
+		out[used++] = SLIP_ESC;
+		out[used++] = *in++ == SLIP_END ? SLIP_ESC_END : SLIP_ESC_ESC;
+		left--;
+	}
+
+	*data = in;
+	*len = left;
+
+	return used;
+}
+
+/*
+ * Unescape the bytes of @a data in place, up to the end of the buffer, of
+ * a frame or of an invalid escape sequence, which also sets @a *state to
+ * STATE_GARBAGE so that the rest of the frame is dropped. Returns the
+ * number of bytes consumed; the first @a *out_len bytes of @a data then
+ * hold the decoded ones, and @a *flags tells why decoding stopped.
+ */
+static inline size_t slip_decode(uint8_t *state, uint8_t *data, size_t len,
+				 size_t *out_len, int *flags)
+{
+	size_t in = 0;
+	size_t out = 0;
+	size_t run;
+
+	*flags = 0;
+
+	while (in < len) {
+		switch (*state) {
+		case STATE_GARBAGE:
+			if (data[in++] == SLIP_END) {
+				*state = STATE_OK;
+			}
+
+			continue;
+		case STATE_ESC:
+			if (data[in] == SLIP_ESC_END) {
+				data[out++] = SLIP_END;
+			} else if (data[in] == SLIP_ESC_ESC) {
+				data[out++] = SLIP_ESC;
+			} else {
+				*state = STATE_GARBAGE;
+				*flags = SLIP_FRAME_ERROR;
+				*out_len = out;
+				return in + 1;
+			}
+
+			*state = STATE_OK;
+			in++;
+			continue;
+		}
+
+		run = slip_plain_len(data + in, len - in);
+		if (out != in) {
+			memmove(data + out, data + in, run);
+		}
+		out += run;
+		in += run;
+
+		if (in == len) {
+			break;
+		}
+
+		if (data[in++] == SLIP_END) {
+			*flags = SLIP_FRAME_END;
+			break;
+		}
+
+		*state = STATE_ESC;
+	}
+
+	*out_len = out;
+
+	return in;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SLIP_CODEC_H__ */
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Private API for SPI drivers: buffer sets and transaction state
+ *
+ * Drivers walk the buffer sets of a transaction one frame at a time with
+ * these helpers, which also serialize the transactions and report their
+ * end, either to the waiting caller or through the caller's poll signal.
+ */
+
+#ifndef __SPI_CONTEXT_H__
+#define __SPI_CONTEXT_H__
+
+#include <kernel.h>
+#include <spi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct spi_context {
+	struct k_sem lock;
+	struct k_sem sync;
+	int status;
+#ifdef CONFIG_SPI_ASYNC
+	struct k_poll_signal *signal;
+#endif
+
+	const struct spi_buf *current_tx;
+	size_t tx_count;
+	const struct spi_buf *current_rx;
+	size_t rx_count;
+
+	/* position in the current buffers, lengths are in frames */
+	const uint8_t *tx_buf;
+	size_t tx_len;
+	uint8_t *rx_buf;
+	size_t rx_len;
+};
+
+static inline void spi_context_init(struct spi_context *ctx)
+{
+	k_sem_init(&ctx->lock, 1, 1);
+	k_sem_init(&ctx->sync, 0, UINT_MAX);
+}
+
+static inline void spi_context_lock(struct spi_context *ctx)
+{
+	k_sem_take(&ctx->lock, K_FOREVER);
+}
+
+static inline void spi_context_release(struct spi_context *ctx)
+{
+	k_sem_give(&ctx->lock);
+}
+
+/* total length of a buffer set, in bytes */
+static inline size_t spi_context_bufs_len(const struct spi_buf *bufs,
+					  size_t count)
+{
+	size_t len = 0;
+
+	while (count--) {
+		len += bufs[count].len;
+	}
+
+	return len;
+}
+
+/* whether all the buffers of a set hold whole frames */
+static inline bool spi_context_bufs_aligned(const struct spi_buf *bufs,
+					    size_t count, uint8_t dfs)
+{
+	while (count--) {
+		if (bufs[count].len % dfs) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Skip to the first buffer of the set holding at least one frame and
+ * return its length in frames, 0 once the set is exhausted.
+ */
+static inline size_t _spi_context_buf_load(const struct spi_buf **current,
+					   size_t *count, uint8_t dfs)
+{
+	while (*count) {
+		if ((*current)->len >= dfs) {
+			return (*current)->len / dfs;
+		}
+
+		(*current)++;
+		(*count)--;
+	}
+
+	return 0;
+}
+
+static inline void _spi_context_load_tx(struct spi_context *ctx, uint8_t dfs)
+{
+	ctx->tx_len = _spi_context_buf_load(&ctx->current_tx, &ctx->tx_count,
+					    dfs);
+	ctx->tx_buf = ctx->tx_len ? ctx->current_tx->buf : NULL;
+}
+
+static inline void _spi_context_load_rx(struct spi_context *ctx, uint8_t dfs)
+{
+	ctx->rx_len = _spi_context_buf_load(&ctx->current_rx, &ctx->rx_count,
+					    dfs);
+	ctx->rx_buf = ctx->rx_len ? ctx->current_rx->buf : NULL;
+}
+
+static inline void spi_context_buffers_setup(struct spi_context *ctx,
+					     const struct spi_buf *tx_bufs,
+					     size_t tx_count,
+					     const struct spi_buf *rx_bufs,
+					     size_t rx_count,
+					     uint8_t dfs,
+					     struct k_poll_signal *signal)
+{
+	ctx->current_tx = tx_bufs;
+	ctx->tx_count = tx_count;
+	_spi_context_load_tx(ctx, dfs);
+
+	ctx->current_rx = rx_bufs;
+	ctx->rx_count = rx_count;
+	_spi_context_load_rx(ctx, dfs);
+
+#ifdef CONFIG_SPI_ASYNC
+	ctx->signal = signal;
+#else
+	ARG_UNUSED(signal);
+#endif
+}
+
+/* there are frames left to send, possibly dummy ones */
+static inline bool spi_context_tx_on(struct spi_context *ctx)
+{
+	return !!ctx->tx_len;
+}
+
+/* the next frame to send comes from a buffer */
+static inline bool spi_context_tx_buf_on(struct spi_context *ctx)
+{
+	return ctx->tx_buf && ctx->tx_len;
+}
+
+/* there are frames left to receive, possibly dropped ones */
+static inline bool spi_context_rx_on(struct spi_context *ctx)
+{
+	return !!ctx->rx_len;
+}
+
+/* the next received frame goes to a buffer */
+static inline bool spi_context_rx_buf_on(struct spi_context *ctx)
+{
+	return ctx->rx_buf && ctx->rx_len;
+}
+
+static inline void spi_context_update_tx(struct spi_context *ctx,
+					 uint8_t dfs, size_t frames)
+{
+	if (!ctx->tx_len) {
+		return;
+	}
+
+	ctx->tx_len -= frames;
+	if (ctx->tx_buf) {
+		ctx->tx_buf += frames * dfs;
+	}
+
+	if (!ctx->tx_len) {
+		ctx->current_tx++;
+		ctx->tx_count--;
+		_spi_context_load_tx(ctx, dfs);
+	}
+}
+
+static inline void spi_context_update_rx(struct spi_context *ctx,
+					 uint8_t dfs, size_t frames)
+{
+	if (!ctx->rx_len) {
+		return;
+	}
+
+	ctx->rx_len -= frames;
+	if (ctx->rx_buf) {
+		ctx->rx_buf += frames * dfs;
+	}
+
+	if (!ctx->rx_len) {
+		ctx->current_rx++;
+		ctx->rx_count--;
+		_spi_context_load_rx(ctx, dfs);
+	}
+}
+
+/* called by the driver, usually from its ISR, once the transaction is over */
+static inline void spi_context_complete(struct spi_context *ctx, int status)
+{
+#ifdef CONFIG_SPI_ASYNC
+	if (ctx->signal) {
+		k_poll_signal(ctx->signal, status);
+		spi_context_release(ctx);
+		return;
+	}
+#endif
+
+	ctx->status = status;
+	k_sem_give(&ctx->sync);
+}
+
+/*
+ * Wait for the end of a blocking transaction and release the context.
+ * Asynchronous transactions, which have a signal, do not wait: they are
+ * released by spi_context_complete().
+ */
+static inline int spi_context_wait_for_completion(struct spi_context *ctx,
+						  struct k_poll_signal *signal)
+{
+	int status;
+
+	if (signal) {
+		return 0;
+	}
+
+	k_sem_take(&ctx->sync, K_FOREVER);
+	status = ctx->status;
+	spi_context_release(ctx);
+
+	return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPI_CONTEXT_H__ */
@@ -58,34 +58,18 @@ static void completed(struct device *dev, int error)
 	const struct spi_dw_config *info = dev->config->config_info;
 	struct spi_dw_data *spi = dev->driver_data;
 
-	if (error) {
-		goto out;
-	}
-
 	/*
-	* There are several situations here.
-	* 1. spi_write w rx_buf - need last_tx && rx_buf_len zero to be done.
-	* 2. spi_write w/o rx_buf - only need to determine when write is done.
-	* 3. spi_read - need rx_buf_len zero.
-	*/
-	if (spi->tx_buf && spi->rx_buf) {
-		if (!spi->last_tx || spi->rx_buf_len)
-			return;
-	} else if (spi->tx_buf) {
-		if (!spi->last_tx)
-			return;
-	} else { /* or, spi->rx_buf!=0 */
-		if (spi->rx_buf_len)
-			return;
+	 * Every pushed frame, dummy or not, brings a frame back, so the
+	 * transaction is over once the last one is pulled.
+	 */
+	if (!error && spi->received < spi->trans_len) {
+		return;
 	}
 
-out:
 	/* need to give time for FIFOs to drain before issuing more commands */
 	while (test_bit_sr_busy(info->regs)) {
 	}
 
-	spi->error = error;
-
 	/* Disabling interrupts */
 	write_imr(DW_SPI_IMR_MASK, info->regs);
 	/* Disabling the controller */
@@ -96,7 +80,7 @@ out:
 	SYS_LOG_DBG("SPI transaction completed %s error",
 	    error ? "with" : "without");
 
-	k_sem_give(&spi->device_sync_sem);
+	spi_context_complete(&spi->ctx, error ? -EIO : 0);
 }
 
 static void push_data(struct device *dev)
@@ -107,58 +91,43 @@ static void push_data(struct device *dev)
 	uint32_t f_tx;
 	DBG_COUNTER_INIT();
 
-	if (spi->rx_buf) {
-		f_tx = DW_SPI_FIFO_DEPTH - read_txflr(info->regs) -
-					read_rxflr(info->regs);
-		if ((int)f_tx < 0) {
-			f_tx = 0; /* if rx-fifo is full, hold off tx */
-		}
-	} else {
-		f_tx = DW_SPI_FIFO_DEPTH - read_txflr(info->regs);
-	}
-	if (f_tx && (spi->tx_buf_len == 0)) {
-		/* room in fifo, yet nothing to send */
-		spi->last_tx = 1; /* setting last_tx indicates TX is done */
-	}
-	while (f_tx) {
-		if (spi->tx_buf && spi->tx_buf_len > 0) {
+	/* frames in flight must fit in the rx fifo, or it would overflow */
+	f_tx = DW_SPI_FIFO_DEPTH - (spi->transmitted - spi->received);
+
+	while (f_tx && spi->transmitted < spi->trans_len) {
+		if (spi_context_tx_buf_on(&spi->ctx)) {
 			switch (spi->dfs) {
 			case 1:
-				data = UNALIGNED_GET((uint8_t *)(spi->tx_buf));
+				data = UNALIGNED_GET((uint8_t *)
+						     (spi->ctx.tx_buf));
 				break;
 			case 2:
-				data = UNALIGNED_GET((uint16_t *)(spi->tx_buf));
+				data = UNALIGNED_GET((uint16_t *)
+						     (spi->ctx.tx_buf));
 				break;
 #ifndef CONFIG_ARC
 			case 4:
-				data = UNALIGNED_GET((uint32_t *)(spi->tx_buf));
+				data = UNALIGNED_GET((uint32_t *)
+						     (spi->ctx.tx_buf));
 				break;
 #endif
 			}
-
-			spi->tx_buf += spi->dfs;
-			spi->tx_buf_len--;
-		} else if (spi->rx_buf && spi->rx_buf_len > 0) {
-			/* No need to push more than necessary */
-			if (spi->rx_buf_len - spi->fifo_diff <= 0) {
-				break;
-			}
-
-			data = 0;
 		} else {
-			/* Nothing to push anymore */
-			break;
+			/* dummy frame, to clock in what is left to receive */
+			data = 0;
 		}
 
+		spi_context_update_tx(&spi->ctx, spi->dfs, 1);
+
 		write_dr(data, info->regs);
 		f_tx--;
-		spi->fifo_diff++;
+		spi->transmitted++;
 		DBG_COUNTER_INC();
 	}
 
-	if (spi->last_tx) {
-		write_txftlr(0, info->regs);
+	if (spi->transmitted == spi->trans_len) {
 		/* prevents any further interrupts demanding TX fifo fill */
+		write_imr(DW_SPI_IMR_UNMASK & ~DW_SPI_IMR_TXEIM, info->regs);
 	}
 
 	SYS_LOG_DBG("Pushed: %d", DBG_COUNTER_RESULT());
@@ -168,6 +137,7 @@ static void pull_data(struct device *dev)
 {
 	const struct spi_dw_config *info = dev->config->config_info;
 	struct spi_dw_data *spi = dev->driver_data;
+	uint32_t remaining;
 	uint32_t data = 0;
 	DBG_COUNTER_INIT();
 
@@ -175,32 +145,32 @@ static void pull_data(struct device *dev)
 		data = read_dr(info->regs);
 		DBG_COUNTER_INC();
 
-		if (spi->rx_buf && spi->rx_buf_len > 0) {
+		if (spi_context_rx_buf_on(&spi->ctx)) {
 			switch (spi->dfs) {
 			case 1:
-				UNALIGNED_PUT(data, (uint8_t *)spi->rx_buf);
+				UNALIGNED_PUT(data, (uint8_t *)spi->ctx.rx_buf);
 				break;
 			case 2:
-				UNALIGNED_PUT(data, (uint16_t *)spi->rx_buf);
+				UNALIGNED_PUT(data,
+					      (uint16_t *)spi->ctx.rx_buf);
 				break;
 #ifndef CONFIG_ARC
 			case 4:
-				UNALIGNED_PUT(data, (uint32_t *)spi->rx_buf);
+				UNALIGNED_PUT(data,
+					      (uint32_t *)spi->ctx.rx_buf);
 				break;
 #endif
 			}
-
-			spi->rx_buf += spi->dfs;
-			spi->rx_buf_len--;
 		}
 
-		spi->fifo_diff--;
+		spi_context_update_rx(&spi->ctx, spi->dfs, 1);
+		spi->received++;
 	}
 
-	if (!spi->rx_buf_len && spi->tx_buf_len < DW_SPI_FIFO_DEPTH) {
-		write_rxftlr(spi->tx_buf_len - 1, info->regs);
-	} else if (read_rxftlr(info->regs) >= spi->rx_buf_len) {
-		write_rxftlr(spi->rx_buf_len - 1, info->regs);
+	/* lower the threshold so that the tail of the transfer is noticed */
+	remaining = spi->trans_len - spi->received;
+	if (remaining && remaining <= read_rxftlr(info->regs)) {
+		write_rxftlr(remaining - 1, info->regs);
 	}
 
 	SYS_LOG_DBG("Pulled: %d", DBG_COUNTER_RESULT());
@@ -291,48 +261,63 @@ static int spi_dw_slave_select(struct device *dev, uint32_t slave)
 	return 0;
 }
 
-static int spi_dw_transceive(struct device *dev,
-			     const void *tx_buf, uint32_t tx_buf_len,
-			     void *rx_buf, uint32_t rx_buf_len)
+static int spi_dw_transceive_bufs(struct device *dev,
+				  struct spi_config *config,
+				  const struct spi_buf *tx_bufs, size_t tx_count,
+				  const struct spi_buf *rx_bufs, size_t rx_count,
+				  struct k_poll_signal *async)
 {
 	const struct spi_dw_config *info = dev->config->config_info;
 	struct spi_dw_data *spi = dev->driver_data;
-	uint32_t rx_thsld = DW_SPI_RXFTLR_DFLT;
-	uint32_t imask;
+	int ret;
 
 	SYS_LOG_DBG("%s: %p, %p, %u, %p, %u",
-	    __func__, dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
+	    __func__, dev, tx_bufs, tx_count, rx_bufs, rx_count);
+
+	spi_context_lock(&spi->ctx);
 
 	/* Check status */
 	if (!_spi_dw_is_controller_ready(dev)) {
 		SYS_LOG_DBG("%s: Controller is busy", __func__);
+		spi_context_release(&spi->ctx);
 		return -EBUSY;
 	}
 
+	if (config) {
+		ret = spi_dw_configure(dev, config);
+		if (ret) {
+			spi_context_release(&spi->ctx);
+			return ret;
+		}
+	}
+
+	/* A partial frame would be silently dropped */
+	if (!spi_context_bufs_aligned(tx_bufs, tx_count, spi->dfs) ||
+	    !spi_context_bufs_aligned(rx_bufs, rx_count, spi->dfs)) {
+		spi_context_release(&spi->ctx);
+		return -EINVAL;
+	}
+
 	/* Set buffers info */
-	spi->tx_buf = tx_buf;
-	spi->tx_buf_len = tx_buf_len/spi->dfs;
-	spi->rx_buf = rx_buf;
-	if (rx_buf) {
-		spi->rx_buf_len = rx_buf_len/spi->dfs;
-	} else {
-		spi->rx_buf_len = 0; /* must be zero if no buffer */
+	spi_context_buffers_setup(&spi->ctx, tx_bufs, tx_count,
+				  rx_bufs, rx_count, spi->dfs, async);
+	spi->trans_len = max(spi_context_bufs_len(tx_bufs, tx_count),
+			     spi_context_bufs_len(rx_bufs, rx_count)) /
+			 spi->dfs;
+	spi->transmitted = 0;
+	spi->received = 0;
+
+	if (!spi->trans_len) {
+		spi_context_complete(&spi->ctx, 0);
+		return spi_context_wait_for_completion(&spi->ctx, async);
 	}
-	spi->fifo_diff = 0;
-	spi->last_tx = 0;
 
 	/* Tx Threshold */
 	write_txftlr(DW_SPI_TXFTLR_DFLT, info->regs);
 
 	/* Does Rx thresholds needs to be lower? */
-	if (spi->rx_buf_len && spi->rx_buf_len < DW_SPI_FIFO_DEPTH) {
-		rx_thsld = spi->rx_buf_len - 1;
-	} else if (!spi->rx_buf_len && spi->tx_buf_len < DW_SPI_FIFO_DEPTH) {
-		rx_thsld = spi->tx_buf_len - 1;
-		/* TODO: why? */
-	}
-
-	write_rxftlr(rx_thsld, info->regs);
+	write_rxftlr(min(spi->trans_len - 1, DW_SPI_RXFTLR_DFLT),
+		     info->regs);
 
 	/* Slave select */
 	write_ser(spi->slave, info->regs);
@@ -340,25 +325,28 @@ static int spi_dw_transceive(struct device *dev,
 	_spi_control_cs(dev, 1);
 
 	/* Enable interrupts */
-	imask = DW_SPI_IMR_UNMASK;
-	if (!rx_buf) {
-		/* if there is no rx buffer, keep all rx interrupts masked */
-		imask &= DW_SPI_IMR_MASK_RX;
-	}
-
-	write_imr(imask, info->regs);
+	write_imr(DW_SPI_IMR_UNMASK, info->regs);
 
 	/* Enable the controller */
 	set_bit_ssienr(info->regs);
 
-	k_sem_take(&spi->device_sync_sem, K_FOREVER);
-
-	if (spi->error) {
-		spi->error = 0;
-		return -EIO;
-	}
+	return spi_context_wait_for_completion(&spi->ctx, async);
+}
 
-	return 0;
+static int spi_dw_transceive(struct device *dev,
+			     const void *tx_buf, uint32_t tx_buf_len,
+			     void *rx_buf, uint32_t rx_buf_len)
+{
+	const struct spi_buf tx = {
+		.buf = (void *)tx_buf,
+		.len = tx_buf_len,
+	};
+	const struct spi_buf rx = {
+		.buf = rx_buf,
+		.len = rx_buf_len,
+	};
+
+	return spi_dw_transceive_bufs(dev, NULL, &tx, 1, &rx, 1, NULL);
 }
 
 void spi_dw_isr(void *arg)
@@ -395,6 +383,7 @@ static const struct spi_driver_api dw_spi_api = {
 	.configure = spi_dw_configure,
 	.slave_select = spi_dw_slave_select,
 	.transceive = spi_dw_transceive,
+	.transceive_bufs = spi_dw_transceive_bufs,
 };
 
 int spi_dw_init(struct device *dev)
@@ -417,7 +406,7 @@ int spi_dw_init(struct device *dev)
 
 	info->config_func();
 
-	k_sem_init(&spi->device_sync_sem, 0, UINT_MAX);
+	spi_context_init(&spi->ctx);
 
 	_spi_config_cs(dev);
 
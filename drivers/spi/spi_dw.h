@@ -11,6 +11,8 @@
 
 #include <spi.h>
 
+#include "spi_context.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,23 +33,20 @@ struct spi_dw_config {
 };
 
 struct spi_dw_data {
-	struct k_sem device_sync_sem;
-	uint32_t error:1;
+	struct spi_context ctx;
 	uint32_t dfs:3; /* dfs in bytes: 1,2 or 4 */
 	uint32_t slave:17; /* up 16 slaves */
-	uint32_t fifo_diff:9; /* cannot be bigger than FIFO depth */
-	uint32_t last_tx:1;
-	uint32_t _unused:1;
+	uint32_t _unused:12;
 #ifdef CONFIG_SPI_DW_CLOCK_GATE
 	struct device *clock;
 #endif /* CONFIG_SPI_DW_CLOCK_GATE */
 #ifdef CONFIG_SPI_DW_CS_GPIO
 	struct device *cs_gpio_port;
 #endif /* CONFIG_SPI_DW_CS_GPIO */
-	const uint8_t *tx_buf;
-	uint32_t tx_buf_len;
-	uint8_t *rx_buf;
-	uint32_t rx_buf_len;
+	/* frames of the transaction, pushed ones and pulled ones */
+	uint32_t trans_len;
+	uint32_t transmitted;
+	uint32_t received;
 };
 
 /* Helper macros */
@@ -123,14 +123,12 @@ static void completed(struct device *dev, uint32_t error)
 		return;
 	}
 
-	spi->error = error;
-
 	_spi_control_cs(dev, 0);
 
 	write_sscr1(spi->sscr1, spi->regs);
 	clear_bit_sscr0_sse(spi->regs);
 
-	k_sem_give(&spi->device_sync_sem);
+	spi_context_complete(&spi->ctx, error ? -EIO : 0);
 }
 
 static void pull_data(struct device *dev)
@@ -144,10 +142,10 @@ static void pull_data(struct device *dev)
 		cnt++;
 		spi->received++;
 
-		if ((spi->received - 1) < spi->r_buf_len) {
-			*(uint8_t *)(spi->rx_buf) = data;
-			spi->rx_buf++;
+		if (spi_context_rx_buf_on(&spi->ctx)) {
+			*spi->ctx.rx_buf = data;
 		}
+		spi_context_update_rx(&spi->ctx, 1, 1);
 	}
 
 	SYS_LOG_DBG("Pulled: %d (total: %d)",	cnt, spi->received);
@@ -164,9 +162,10 @@ static void push_data(struct device *dev)
 		if (status & INTEL_SPI_SSSR_RFS) {
 			break;
 		}
-		if (spi->tx_buf && (spi->transmitted < spi->t_buf_len)) {
-			data = *(uint8_t *)(spi->tx_buf);
-			spi->tx_buf++;
+		if (spi_context_tx_on(&spi->ctx)) {
+			data = spi_context_tx_buf_on(&spi->ctx) ?
+			       *spi->ctx.tx_buf : 0;
+			spi_context_update_tx(&spi->ctx, 1, 1);
 		} else if (spi->transmitted < spi->trans_len) {
 			data = 0;
 		} else {
@@ -245,29 +244,49 @@ static int spi_intel_configure(struct device *dev,
 	return 0;
 }
 
-static int spi_intel_transceive(struct device *dev,
-				const void *tx_buf, uint32_t tx_buf_len,
-				void *rx_buf, uint32_t rx_buf_len)
+static int spi_intel_transceive_bufs(struct device *dev,
+				     struct spi_config *config,
+				     const struct spi_buf *tx_bufs,
+				     size_t tx_count,
+				     const struct spi_buf *rx_bufs,
+				     size_t rx_count,
+				     struct k_poll_signal *async)
 {
 	struct spi_intel_data *spi = dev->driver_data;
+	int ret;
 
-	SYS_LOG_DBG("spi_dw_transceive: %p, %p, %u, %p, %u",
-			dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
+	SYS_LOG_DBG("spi_intel_transceive_bufs: %p, %p, %u, %p, %u",
+			dev, tx_bufs, tx_count, rx_bufs, rx_count);
+
+	spi_context_lock(&spi->ctx);
 
 	/* Check status */
 	if (test_bit_sscr0_sse(spi->regs) && test_bit_sssr_bsy(spi->regs)) {
 		SYS_LOG_DBG("spi_intel_transceive: Controller is busy");
+		spi_context_release(&spi->ctx);
 		return -EBUSY;
 	}
 
+	if (config) {
+		ret = spi_intel_configure(dev, config);
+		if (ret) {
+			spi_context_release(&spi->ctx);
+			return ret;
+		}
+	}
+
 	/* Set buffers info */
-	spi->tx_buf = tx_buf;
-	spi->rx_buf = rx_buf;
-	spi->t_buf_len = tx_buf_len;
-	spi->r_buf_len = rx_buf_len;
+	spi_context_buffers_setup(&spi->ctx, tx_bufs, tx_count,
+				  rx_bufs, rx_count, 1, async);
 	spi->transmitted = 0;
 	spi->received = 0;
-	spi->trans_len = max(tx_buf_len, rx_buf_len);
+	spi->trans_len = max(spi_context_bufs_len(tx_bufs, tx_count),
+			     spi_context_bufs_len(rx_bufs, rx_count));
+
+	if (!spi->trans_len) {
+		spi_context_complete(&spi->ctx, 0);
+		return spi_context_wait_for_completion(&spi->ctx, async);
+	}
 
 	_spi_control_cs(dev, 1);
 
@@ -278,14 +297,26 @@ static int spi_intel_transceive(struct device *dev,
 	write_sscr1(spi->sscr1 | INTEL_SPI_SSCR1_RIE |
 				INTEL_SPI_SSCR1_TIE, spi->regs);
 
-	k_sem_take(&spi->device_sync_sem, K_FOREVER);
+	return spi_context_wait_for_completion(&spi->ctx, async);
+}
 
-	if (spi->error) {
-		spi->error = 0;
-		return -EIO;
-	}
+static int spi_intel_transceive(struct device *dev,
+				const void *tx_buf, uint32_t tx_buf_len,
+				void *rx_buf, uint32_t rx_buf_len)
+{
+	const struct spi_buf tx = {
+		.buf = (void *)tx_buf,
+		.len = tx_buf_len,
+	};
+	const struct spi_buf rx = {
+		.buf = rx_buf,
+		.len = rx_buf_len,
+	};
+
+	SYS_LOG_DBG("spi_intel_transceive: %p, %p, %u, %p, %u",
+			dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
 
-	return 0;
+	return spi_intel_transceive_bufs(dev, NULL, &tx, 1, &rx, 1, NULL);
 }
 
 void spi_intel_isr(void *arg)
@@ -323,6 +354,7 @@ static const struct spi_driver_api intel_spi_api = {
 	.configure = spi_intel_configure,
 	.slave_select = NULL,
 	.transceive = spi_intel_transceive,
+	.transceive_bufs = spi_intel_transceive_bufs,
 };
 
 #ifdef CONFIG_PCI
@@ -375,7 +407,7 @@ int spi_intel_init(struct device *dev)
 
 	_spi_config_cs(dev);
 
-	k_sem_init(&spi->device_sync_sem, 0, UINT_MAX);
+	spi_context_init(&spi->ctx);
 
 	spi_intel_set_power_state(dev, DEVICE_PM_ACTIVE_STATE);
 
@@ -13,6 +13,8 @@
 #include <pci/pci.h>
 #include <pci/pci_mgr.h>
 #endif /* CONFIG_PCI */
+#include "spi_context.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -33,18 +35,12 @@ struct spi_intel_data {
 #ifdef CONFIG_PCI
 	struct pci_dev_info pci_dev;
 #endif /* CONFIG_PCI */
-	struct k_sem device_sync_sem;
-	uint8_t error;
-	uint8_t padding[3];
+	struct spi_context ctx;
 #ifdef CONFIG_SPI_CS_GPIO
 	struct device *cs_gpio_port;
 #endif /* CONFIG_SPI_CS_GPIO */
 	uint32_t sscr0;
 	uint32_t sscr1;
-	const uint8_t *tx_buf;
-	uint8_t *rx_buf;
-	uint32_t t_buf_len;
-	uint32_t r_buf_len;
 	uint32_t transmitted;
 	uint32_t received;
 	uint32_t trans_len;
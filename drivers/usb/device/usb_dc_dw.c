@@ -330,8 +330,15 @@ static int usb_dw_tx(uint8_t ep, const uint8_t *const data,
 		return -EAGAIN;
 	}
 
+	/*
+	 * Only send what fits in whole packets, a short packet would end
+	 * the transfer on the host side while more data is to come.
+	 */
 	if (data_len > avail_space) {
-		data_len = avail_space;
+		data_len = avail_space - avail_space % ep_mps;
+		if (!data_len) {
+			return -EAGAIN;
+		}
 	}
 
 	if (data_len != 0) {
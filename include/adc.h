@@ -13,6 +13,7 @@
 #define __INCLUDE_ADC_H__
 
 #include <stdint.h>
+#include <errno.h>
 #include <device.h>
 
 #ifdef __cplusplus
@@ -63,6 +64,65 @@ struct adc_seq_table {
 	uint8_t stride[3];
 };
 
+/**
+ * @brief Callback for a full buffer of continuous sampling
+ *
+ * Called from the ISR. The buffer belongs to the application until given
+ * back with adc_buffer_release().
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param buffer The full buffer.
+ * @param length Length of the buffer, in bytes.
+ * @param user_data User data from the sampling configuration.
+ */
+typedef void (*adc_buffer_callback_t)(struct device *dev, uint8_t *buffer,
+				      uint32_t length, void *user_data);
+
+/**
+ * @brief ADC continuous sampling configuration
+ *
+ * The samples are stored in the buffers of a ring, in turn, in the format
+ * adc_read() uses.
+ */
+struct adc_continuous_cfg {
+	/** Buffers of the ring, filled in this order. */
+	uint8_t **buffers;
+
+	/** Number of buffers in the ring, from 2 to 32. */
+	uint8_t buffer_count;
+
+	/** Channel ID that should be sampled from the ADC */
+	uint8_t channel_id;
+
+	uint8_t stride[2];
+
+	/** Length of each buffer, in bytes. */
+	uint32_t buffer_length;
+
+	/** Interval between two samples, in microseconds. */
+	uint32_t interval_us;
+
+	/** Called each time a buffer is full. */
+	adc_buffer_callback_t callback;
+
+	/** Passed to the callback. */
+	void *user_data;
+};
+
+/**
+ * @brief ADC continuous sampling statistics
+ */
+struct adc_continuous_stats {
+	/** Buffers handed to the application. */
+	uint32_t buffers;
+
+	/** Times sampling found the next buffer still held. */
+	uint32_t overruns;
+
+	/** Samples dropped during the overruns. */
+	uint32_t samples_lost;
+};
+
 /**
  * @brief ADC driver API
  *
@@ -77,6 +137,20 @@ struct adc_driver_api {
 
 	/** Pointer to the read routine. */
 	int (*read)(struct device *dev, struct adc_seq_table *seq_table);
+
+	/** Pointer to the continuous sampling start routine. */
+	int (*continuous_start)(struct device *dev,
+				const struct adc_continuous_cfg *cfg);
+
+	/** Pointer to the continuous sampling stop routine. */
+	int (*continuous_stop)(struct device *dev);
+
+	/** Pointer to the buffer release routine. */
+	int (*buffer_release)(struct device *dev, uint8_t *buffer);
+
+	/** Pointer to the continuous sampling statistics routine. */
+	int (*continuous_stats)(struct device *dev,
+				struct adc_continuous_stats *stats);
 };
 
 /**
@@ -135,6 +209,95 @@ static inline int adc_read(struct device *dev, struct adc_seq_table *seq_table)
 	return api->read(dev, seq_table);
 }
 
+/**
+ * @brief Start continuous sampling
+ * This routine starts sampling a channel at a fixed interval, without gaps
+ * between the buffers of the ring as long as the application releases them
+ * in time. All the buffers of the ring belong to the driver at start.
+ * When the next buffer of the ring is still held by the application,
+ * the samples taken until it is released are dropped and counted in the
+ * statistics. adc_read() is not available while sampling.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param cfg Pointer to the sampling configuration.
+ * @retval 0 On success
+ * @retval -EINVAL If the configuration is not supported.
+ * @retval -EBUSY If the ADC is already sampling.
+ * @retval -ENOTSUP If the driver does not support continuous sampling.
+ */
+static inline int adc_continuous_start(struct device *dev,
+				       const struct adc_continuous_cfg *cfg)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (!api->continuous_start) {
+		return -ENOTSUP;
+	}
+
+	return api->continuous_start(dev, cfg);
+}
+
+/**
+ * @brief Stop continuous sampling
+ * The samples of the buffer being filled are dropped, the buffers held by
+ * the application stay valid.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @retval 0 On success
+ * @retval -EALREADY If the ADC is not sampling.
+ * @retval -ENOTSUP If the driver does not support continuous sampling.
+ */
+static inline int adc_continuous_stop(struct device *dev)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (!api->continuous_stop) {
+		return -ENOTSUP;
+	}
+
+	return api->continuous_stop(dev);
+}
+
+/**
+ * @brief Give a full buffer back to the driver
+ * This routine can be called from the buffer callback, or later from a
+ * thread once the samples are processed.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param buffer The buffer, as given to the callback.
+ * @retval 0 On success
+ * @retval -EINVAL If the buffer is not one of the ring held by the
+ *		   application.
+ * @retval -ENOTSUP If the driver does not support continuous sampling.
+ */
+static inline int adc_buffer_release(struct device *dev, uint8_t *buffer)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (!api->buffer_release) {
+		return -ENOTSUP;
+	}
+
+	return api->buffer_release(dev, buffer);
+}
+
+/**
+ * @brief Get the statistics of continuous sampling
+ * The statistics are reset by adc_continuous_start().
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param stats Where to store the statistics.
+ * @retval 0 On success
+ * @retval -ENOTSUP If the driver does not support continuous sampling.
+ */
+static inline int adc_continuous_stats_get(struct device *dev,
+					   struct adc_continuous_stats *stats)
+{
+	const struct adc_driver_api *api = dev->driver_api;
+
+	if (!api->continuous_stats) {
+		return -ENOTSUP;
+	}
+
+	return api->continuous_stats(dev, stats);
+}
+
 /**
  * @}
  */
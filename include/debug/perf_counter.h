@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Performance counters
+ *
+ * Counters and cycle histograms defined by the subsystems in their hot
+ * paths, gathered in dedicated sections so that they can all be listed
+ * at runtime, from the "perf" shell module in particular, without a
+ * registration call.
+ */
+
+#ifndef __PERF_COUNTER_H
+#define __PERF_COUNTER_H
+
+#include <kernel.h>
+#include <atomic.h>
+#include <misc/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Performance counters
+ * @defgroup perf_counter Performance counters
+ * @{
+ */
+
+/*
+ * The definitions force the alignment of the type, for the compiler not to
+ * align a larger structure more and leave holes in the sections.
+ */
+
+#if defined(CONFIG_PERF_COUNTERS)
+
+/**
+ * @brief Performance counter.
+ *
+ * @details Defined with PERF_COUNTER_DEFINE(), incremented atomically, or
+ * defined with PERF_COUNTER_EXPORT() to read a count a subsystem keeps.
+ */
+struct perf_counter {
+	/** Name of the counter */
+	const char *name;
+	/** Current value, unless read */
+	atomic_t value;
+	/** Function returning the current value, or NULL */
+	uint32_t (*read)(void);
+	/** Value at the last perf_snapshot() */
+	uint32_t snapshot;
+};
+
+/**
+ * @brief Define a performance counter.
+ *
+ * @param name_ Name of the counter, a C identifier.
+ */
+#define PERF_COUNTER_DEFINE(name_)					\
+	static struct perf_counter _perf_counter_##name_ __used		\
+	__aligned(__alignof__(struct perf_counter))			\
+	__attribute__((__section__(".perf_counter." #name_))) = {	\
+		.name = #name_,						\
+	}
+
+/**
+ * @brief List a count a subsystem keeps with the performance counters.
+ *
+ * @param name_ Name of the counter, a C identifier.
+ * @param read_ Function returning the count, as a uint32_t.
+ */
+#define PERF_COUNTER_EXPORT(name_, read_)				\
+	static struct perf_counter _perf_counter_##name_ __used		\
+	__aligned(__alignof__(struct perf_counter))			\
+	__attribute__((__section__(".perf_counter." #name_))) = {	\
+		.name = #name_,						\
+		.read = read_,						\
+	}
+
+/**
+ * @brief Increment a performance counter.
+ *
+ * @param name_ Name of the counter.
+ */
+#define PERF_COUNTER_INC(name_) atomic_inc(&_perf_counter_##name_.value)
+
+/**
+ * @brief Add to a performance counter.
+ *
+ * @param name_ Name of the counter.
+ * @param n_ Value to add, not evaluated without CONFIG_PERF_COUNTERS.
+ */
+#define PERF_COUNTER_ADD(name_, n_)					\
+	atomic_add(&_perf_counter_##name_.value, (n_))
+
+/**
+ * @brief Get the current value of a performance counter.
+ *
+ * @param counter Performance counter.
+ *
+ * @return Value of the counter.
+ */
+static inline uint32_t perf_counter_get(struct perf_counter *counter)
+{
+	return counter->read ? counter->read() : atomic_get(&counter->value);
+}
+
+/**
+ * @typedef perf_counter_cb_t
+ * @brief Callback used while iterating over the performance counters.
+ *
+ * @param counter Performance counter.
+ * @param user_data User data given to perf_counter_foreach().
+ */
+typedef void (*perf_counter_cb_t)(struct perf_counter *counter,
+				  void *user_data);
+
+/**
+ * @brief Go through the performance counters, in name order.
+ *
+ * @param cb Function called for each counter.
+ * @param user_data User data passed to @a cb.
+ */
+void perf_counter_foreach(perf_counter_cb_t cb, void *user_data);
+
+/**
+ * @brief Save the current value of the counters and histograms.
+ *
+ * @details The difference with the saved values is what the "perf diff"
+ * shell command prints.
+ */
+void perf_snapshot(void);
+
+#else
+
+#define PERF_COUNTER_DEFINE(name_)
+#define PERF_COUNTER_EXPORT(name_, read_)
+#define PERF_COUNTER_INC(name_) do { } while (0)
+#define PERF_COUNTER_ADD(name_, n_) do { } while (0)
+
+#endif /* CONFIG_PERF_COUNTERS */
+
+#if defined(CONFIG_PERF_HISTOGRAMS)
+
+/**
+ * Number of buckets of a histogram. Bucket 0 counts the samples of 0
+ * cycles, and bucket n the samples of 2^(n-1) to 2^n - 1 cycles, but for
+ * the last one, which counts all the longer samples too.
+ */
+#define PERF_HISTOGRAM_BUCKETS 24
+
+/**
+ * @brief Histogram of the cycles a code section takes.
+ */
+struct perf_histogram {
+	/** Name of the histogram */
+	const char *name;
+	/** Number of samples in each bucket */
+	atomic_t buckets[PERF_HISTOGRAM_BUCKETS];
+	/** Buckets at the last perf_snapshot() */
+	uint32_t snapshot[PERF_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * @brief Define a cycle histogram.
+ *
+ * @param name_ Name of the histogram, a C identifier.
+ */
+#define PERF_HISTOGRAM_DEFINE(name_)					\
+	static struct perf_histogram _perf_histogram_##name_ __used	\
+	__aligned(__alignof__(struct perf_histogram))			\
+	__attribute__((__section__(".perf_histogram." #name_))) = {	\
+		.name = #name_,						\
+	}
+
+/**
+ * @brief Start timing a code section.
+ *
+ * @details Declares a variable, in the scope PERF_HISTOGRAM_STOP() must
+ * be used in.
+ *
+ * @param name_ Name of the histogram.
+ */
+#define PERF_HISTOGRAM_START(name_)					\
+	uint32_t _perf_start_##name_ = k_cycle_get_32()
+
+/**
+ * @brief Add the cycles since PERF_HISTOGRAM_START() to a histogram.
+ *
+ * @param name_ Name of the histogram.
+ */
+#define PERF_HISTOGRAM_STOP(name_)					\
+	_perf_histogram_add(&_perf_histogram_##name_,			\
+			    k_cycle_get_32() - _perf_start_##name_)
+
+static inline void _perf_histogram_add(struct perf_histogram *histogram,
+				       uint32_t cycles)
+{
+	int bucket = cycles ? 32 - __builtin_clz(cycles) : 0;
+
+	atomic_inc(&histogram->buckets[min(bucket,
+					   PERF_HISTOGRAM_BUCKETS - 1)]);
+}
+
+/**
+ * @typedef perf_histogram_cb_t
+ * @brief Callback used while iterating over the histograms.
+ *
+ * @param histogram Histogram.
+ * @param user_data User data given to perf_histogram_foreach().
+ */
+typedef void (*perf_histogram_cb_t)(struct perf_histogram *histogram,
+				    void *user_data);
+
+/**
+ * @brief Go through the cycle histograms, in name order.
+ *
+ * @param cb Function called for each histogram.
+ * @param user_data User data passed to @a cb.
+ */
+void perf_histogram_foreach(perf_histogram_cb_t cb, void *user_data);
+
+#else
+
+#define PERF_HISTOGRAM_DEFINE(name_)
+#define PERF_HISTOGRAM_START(name_) do { } while (0)
+#define PERF_HISTOGRAM_STOP(name_) do { } while (0)
+
+#endif /* CONFIG_PERF_HISTOGRAMS */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERF_COUNTER_H */
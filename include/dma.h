@@ -13,6 +13,7 @@
 #ifndef _DMA_H_
 #define _DMA_H_
 
+#include <errno.h>
 #include <kernel.h>
 #include <device.h>
 
@@ -53,6 +54,13 @@ enum dma_transfer_width {
 	TRANS_WIDTH_256
 };
 
+/**
+ * @brief Status codes passed to dma_callback, errors are negative.
+ */
+#define DMA_STATUS_COMPLETE		0 /* transfer done, or one cycle */
+#define DMA_STATUS_BLOCK		1 /* one block of a chain done */
+#define DMA_STATUS_HALF_COMPLETE	2 /* first half of the block done */
+
 enum dma_channel_direction {
 	MEMORY_TO_MEMORY = 0x0,
 	MEMORY_TO_PERIPHERAL,
@@ -178,7 +186,12 @@ struct dma_block_config {
  *     dest_chaining_en     [ 18 ]      - enable/disable destination block
  *                                        chaining.
  *                                        0-disable, 1-enable
- *     reserved             [ 19 : 31 ]
+ *     cyclic               [ 19 ]      - 0-stop after the last block
+ *                                        1-restart from head_block after the
+ *                                          last block until dma_stop()
+ *     half_complete_callback_en [ 20 ] - 0-disable, 1-callback invoked when
+ *                                        half of a single block is done
+ *     reserved             [ 21 : 31 ]
  *
  * config_size is a bit field with the following parts:
  *     source_data_size    [ 0 : 15 ]    - number of bytes
@@ -191,7 +204,14 @@ struct dma_block_config {
  *
  * dma_callback is the callback function pointer. If enabled, callback function
  *              will be invoked at transfer completion or when error happens
- *              (error_code: zero-transfer success, non zero-error happens).
+ *              (error_code: DMA_STATUS_COMPLETE-transfer success,
+ *              DMA_STATUS_BLOCK-a block of the chain is done,
+ *              DMA_STATUS_HALF_COMPLETE-half of the block is done,
+ *              negative-error happens). A cyclic transfer reports
+ *              DMA_STATUS_COMPLETE at the end of every cycle, so with two
+ *              blocks and complete_callback_en set the callback alternates
+ *              between DMA_STATUS_BLOCK and DMA_STATUS_COMPLETE, one per
+ *              ping-pong buffer.
  */
 struct dma_config {
 	uint32_t  dma_slot :             6;
@@ -203,7 +223,9 @@ struct dma_config {
 	uint32_t  channel_priority :     4;
 	uint32_t  source_chaining_en :   1;
 	uint32_t  dest_chaining_en :     1;
-	uint32_t  reserved :            13;
+	uint32_t  cyclic :               1;
+	uint32_t  half_complete_callback_en : 1;
+	uint32_t  reserved :            11;
 	uint32_t  source_data_size :    16;
 	uint32_t  dest_data_size :      16;
 	uint32_t  source_burst_length : 16;
@@ -214,6 +236,18 @@ struct dma_config {
 			     int error_code);
 };
 
+/**
+ * @brief DMA channel status.
+ *
+ * busy is true while the channel is transferring.
+ * pending_length is the number of bytes left before the end of the transfer,
+ *                or of the current cycle for a cyclic transfer.
+ */
+struct dma_status {
+	bool busy;
+	uint32_t pending_length;
+};
+
 /**
  * @cond INTERNAL_HIDDEN
  *
@@ -238,6 +272,9 @@ typedef int (*dma_api_start)(struct device *dev, uint32_t channel);
 
 typedef int (*dma_api_stop)(struct device *dev, uint32_t channel);
 
+typedef int (*dma_api_get_status)(struct device *dev, uint32_t channel,
+				  struct dma_status *status);
+
 struct dma_driver_api {
 	dma_api_channel_config channel_config;
 	dma_api_transfer_config transfer_config;
@@ -246,6 +283,7 @@ struct dma_driver_api {
 	dma_api_config config;
 	dma_api_start start;
 	dma_api_stop stop;
+	dma_api_get_status get_status;
 };
 /**
  * @endcond
@@ -305,6 +343,32 @@ static inline int dma_stop(struct device *dev, uint32_t channel)
 	return api->stop(dev, channel);
 }
 
+/**
+ * @brief Get the current status of a DMA channel.
+ *
+ * Can be called from the DMA callback, for instance to know how far a
+ * cyclic transfer went when processing a ping-pong buffer.
+ *
+ * @param dev     Pointer to the device structure for the driver instance.
+ * @param channel Numeric identification of the channel to query
+ * @param status  Filled with the status of the channel
+ *
+ * @retval 0 if successful.
+ * @retval -ENOTSUP if the driver cannot report the status.
+ * @retval Negative errno code if failure.
+ */
+static inline int dma_get_status(struct device *dev, uint32_t channel,
+				 struct dma_status *status)
+{
+	const struct dma_driver_api *api = dev->driver_api;
+
+	if (!api->get_status) {
+		return -ENOTSUP;
+	}
+
+	return api->get_status(dev, channel, status);
+}
+
 /**
  * @brief Configure individual channel for DMA transfer.
  *
@@ -50,6 +50,51 @@ void uart_console_in_debug_hook_install(uart_console_in_debug_hook_t hook);
 
 #endif
 
+#ifdef CONFIG_UART_CONSOLE_BUFFERED
+/** @brief Output the characters buffered by the console
+ *
+ *  Writes the content of the transmit buffer with the UART busy waiting,
+ *  and returns once it is all written.
+ *
+ *  @return N/A
+ */
+void uart_console_flush(void);
+
+/** @brief Switch the console to unbuffered output for good
+ *
+ *  Flushes the transmit buffer, and has the console output every
+ *  following character with the UART busy waiting, for the fatal error
+ *  handlers to report a crash when interrupts are not serviced anymore.
+ *
+ *  @return N/A
+ */
+void uart_console_panic(void);
+
+/** @brief Get the number of characters dropped by the console
+ *
+ *  @return The number of characters dropped for lack of space in the
+ *  transmit buffer since boot.
+ */
+uint32_t uart_console_dropped(void);
+
+/** @brief Output characters, waiting for room in the transmit buffer
+ *
+ *  Unlike printk, which drops what does not fit in the transmit buffer,
+ *  waits for the UART to make room, letting other threads run meanwhile.
+ *  Line feeds are output with a carriage return. Called from an interrupt,
+ *  the characters that do not fit are dropped.
+ *
+ *  @param data Characters to output, not NUL terminated
+ *  @param len Number of characters
+ *
+ *  @return N/A
+ */
+void uart_console_write(const char *data, size_t len);
+#else
+static inline void uart_console_flush(void) { }
+static inline void uart_console_panic(void) { }
+#endif
+
 #ifdef __cplusplus
 }
 #endif
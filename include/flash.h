@@ -34,12 +34,53 @@ typedef int (*flash_api_write)(struct device *dev, off_t offset,
 			       const void *data, size_t len);
 typedef int (*flash_api_erase)(struct device *dev, off_t offset, size_t size);
 typedef int (*flash_api_write_protection)(struct device *dev, bool enable);
+typedef int (*flash_api_write_pages)(struct device *dev, off_t offset,
+				     const void *data, size_t len);
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+/**
+ * @brief A run of consecutive flash pages of the same size
+ *
+ * The layout of a flash device is described by an array of these, in
+ * address order. A device with uniform pages is described by a single
+ * entry.
+ */
+struct flash_pages_layout {
+	size_t pages_count; /* count of pages sequence of the same size */
+	size_t pages_size;
+};
+
+/**
+ * @brief Information about a single flash page
+ */
+struct flash_pages_info {
+	off_t start_offset; /* offset from the base of flash address */
+	size_t size;
+	uint32_t index;
+};
+
+/**
+ * @brief Retrieve the page layout of a flash device
+ *
+ * The layout is a constant array owned by the driver; it stays valid for
+ * the lifetime of the device.
+ */
+typedef void (*flash_api_pages_layout)(struct device *dev,
+				       const struct flash_pages_layout **layout,
+				       size_t *layout_size);
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
 
 struct flash_driver_api {
 	flash_api_read read;
 	flash_api_write write;
 	flash_api_erase erase;
 	flash_api_write_protection write_protection;
+	flash_api_write_pages write_pages;
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	flash_api_pages_layout page_layout;
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+	const size_t write_block_size;
+	const uint8_t erase_value;
 };
 
 /**
@@ -127,6 +168,132 @@ static inline int flash_write_protection_set(struct device *dev, bool enable)
 	return api->write_protection(dev, enable);
 }
 
+/**
+ *  @brief  Program a buffer spanning any number of flash pages
+ *
+ *  Unlike flash_write(), the caller does not need to disable write
+ *  protection beforehand nor split the buffer at program page boundaries:
+ *  the driver disables write protection for the duration of the call,
+ *  programs the data page by page and re-enables write protection once
+ *  done. The target area must have been erased.
+ *
+ *  Drivers without a dedicated implementation fall back to a single
+ *  flash_write() bracketed by write protection changes.
+ *
+ *  @param  dev             : flash device
+ *  @param  offset          : starting offset for the write
+ *  @param  data            : data to write
+ *  @param  len             : Number of bytes to write
+ *
+ *  @return  0 on success, negative errno code on fail.
+ */
+static inline int flash_write_pages(struct device *dev, off_t offset,
+				    const void *data, size_t len)
+{
+	const struct flash_driver_api *api = dev->driver_api;
+	int rc;
+
+	if (api->write_pages) {
+		return api->write_pages(dev, offset, data, len);
+	}
+
+	rc = api->write_protection(dev, false);
+	if (rc) {
+		return rc;
+	}
+
+	rc = api->write(dev, offset, data, len);
+
+	api->write_protection(dev, true);
+
+	return rc;
+}
+
+/**
+ *  @brief  Get the minimum write block size of a flash device
+ *
+ *  Offsets and lengths passed to the write APIs should be multiples of
+ *  this value.
+ *
+ *  @param  dev             : flash device
+ *
+ *  @return  write block size in bytes.
+ */
+static inline size_t flash_get_write_block_size(struct device *dev)
+{
+	const struct flash_driver_api *api = dev->driver_api;
+
+	return api->write_block_size;
+}
+
+/**
+ *  @brief  Get the value of a byte of erased flash
+ *
+ *  @param  dev             : flash device
+ *
+ *  @return  the value every byte reads back as after an erase.
+ */
+static inline uint8_t flash_get_erase_value(struct device *dev)
+{
+	const struct flash_driver_api *api = dev->driver_api;
+
+	return api->erase_value;
+}
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+/**
+ *  @brief  Get the size and start offset of the page containing an offset
+ *
+ *  @param  dev             : flash device
+ *  @param  offset          : offset within the page
+ *  @param  info            : page information, filled in on success
+ *
+ *  @return  0 on success, -EINVAL if offset is out of the device range.
+ */
+int flash_get_page_info_by_offs(struct device *dev, off_t offset,
+				struct flash_pages_info *info);
+
+/**
+ *  @brief  Get the size and start offset of a page by its index
+ *
+ *  @param  dev             : flash device
+ *  @param  page_index      : index of the page, counted from 0
+ *  @param  info            : page information, filled in on success
+ *
+ *  @return  0 on success, -EINVAL if page_index is out of range.
+ */
+int flash_get_page_info_by_idx(struct device *dev, uint32_t page_index,
+			       struct flash_pages_info *info);
+
+/**
+ *  @brief  Get the total number of pages of a flash device
+ *
+ *  @param  dev             : flash device
+ *
+ *  @return  number of pages.
+ */
+size_t flash_get_page_count(struct device *dev);
+
+/**
+ * @brief Callback invoked by flash_page_foreach() for each page
+ *
+ * @param info Page information
+ * @param data Private data passed to flash_page_foreach()
+ *
+ * @return true to continue the iteration, false to stop it.
+ */
+typedef bool (*flash_page_cb)(const struct flash_pages_info *info, void *data);
+
+/**
+ *  @brief  Iterate over all pages of a flash device, in address order
+ *
+ *  @param  dev             : flash device
+ *  @param  cb              : callback invoked for each page
+ *  @param  data            : private data passed to the callback
+ */
+void flash_page_foreach(struct device *dev, flash_page_cb cb, void *data);
+#endif /* CONFIG_FLASH_PAGE_LAYOUT */
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <kernel.h>
 #include <device.h>
 
 /*
@@ -95,6 +96,31 @@ struct i2c_msg {
 	uint8_t		flags;
 };
 
+/**
+ * @brief One I2C transfer, as queued by i2c_transfer_async().
+ *
+ * The messages are sent to one device like with i2c_transfer(). The
+ * structure and the messages belong to the driver until the transfer is
+ * over.
+ */
+struct i2c_transaction {
+	/** @cond INTERNAL_HIDDEN */
+	sys_snode_t	node;
+	/** @endcond */
+
+	/** Array of messages to transfer */
+	struct i2c_msg	*msgs;
+
+	/** Number of messages to transfer */
+	uint8_t		num_msgs;
+
+	/** Address of the I2C target device */
+	uint16_t	addr;
+
+	/** Raised with the result of the transfer when it is over */
+	struct k_poll_signal *signal;
+};
+
 union dev_config {
 	uint32_t raw;
 	struct __bits {
@@ -118,10 +144,13 @@ typedef int (*i2c_api_full_io_t)(struct device *dev,
 				 struct i2c_msg *msgs,
 				 uint8_t num_msgs,
 				 uint16_t addr);
+typedef int (*i2c_api_async_io_t)(struct device *dev,
+				  struct i2c_transaction *txn);
 
 struct i2c_driver_api {
 	i2c_api_configure_t configure;
 	i2c_api_full_io_t transfer;
+	i2c_api_async_io_t transfer_async;
 };
 /**
  * @endcond
@@ -223,6 +252,44 @@ static inline int i2c_transfer(struct device *dev,
 	return api->transfer(dev, msgs, num_msgs, addr);
 }
 
+#ifdef CONFIG_I2C_ASYNC
+/**
+ * @brief Queue a data transfer to another I2C device.
+ *
+ * This routine queues the transfer on the bus and returns without waiting
+ * for it. Transfers queued on a bus, by any thread, are performed in order,
+ * and drivers supporting the queue natively start each one from the
+ * interrupt handler as soon as the previous one is over. Once the transfer
+ * is over, its signal is raised with the result i2c_transfer() would have
+ * returned.
+ *
+ * On drivers without a transfer queue, the transfer is performed before
+ * returning and the signal is raised right away.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param txn The transfer, which must stay valid until its signal is
+ * raised.
+ *
+ * @retval 0 If the transfer is queued.
+ * @retval -EBUSY If the transfer is already queued.
+ */
+static inline int i2c_transfer_async(struct device *dev,
+				     struct i2c_transaction *txn)
+{
+	const struct i2c_driver_api *api = dev->driver_api;
+	int ret;
+
+	if (api->transfer_async) {
+		return api->transfer_async(dev, txn);
+	}
+
+	ret = api->transfer(dev, txn->msgs, txn->num_msgs, txn->addr);
+	k_poll_signal(txn->signal, ret);
+
+	return 0;
+}
+#endif /* CONFIG_I2C_ASYNC */
+
 /**
  * @brief Read multiple bytes from an internal address of an I2C device.
  *
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Public API for the flash key-value store
+ *
+ * The key-value store keeps small records, identified by a 16 bit id, in a
+ * range of flash made of at least two erase sectors. Records are appended
+ * to the active sector together with a CRC; when it is full the next sector
+ * becomes active and the live records of the oldest sector are copied into
+ * it before that sector is erased. One sector is always kept erased, so a
+ * write costs one sector copy and one erase when the oldest sector leaves
+ * room for it. Otherwise the following sectors are reclaimed too, oldest
+ * first, and when reclaiming them all would not make room the write fails
+ * before any flash is erased.
+ *
+ * A RAM hash index maps each id to the location of its latest record, so
+ * reads need a single flash access and no scan.
+ */
+
+#ifndef _KVS_H_
+#define _KVS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <kernel.h>
+#include <device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Key-value store
+ * @defgroup kvs Key-value store
+ * @{
+ */
+
+/** Id value reserved by the store, it can not be used for a record. */
+#define KVS_ID_INVALID		0xffff
+
+/**
+ * @brief Usage statistics of a key-value store
+ */
+struct kvs_stats {
+	uint32_t writes;	/* records appended, including copies */
+	uint32_t skipped_writes; /* writes of unchanged data skipped */
+	uint32_t gc_copies;	/* live records copied by garbage collection */
+	uint32_t erases;	/* sectors erased */
+};
+
+/**
+ * @brief RAM index entry, private to the store
+ */
+struct _kvs_index_entry {
+	uint16_t id;
+	uint16_t len;
+	uint32_t addr;
+};
+
+/**
+ * @brief Key-value store instance
+ *
+ * @a offset, @a sector_size and @a sector_count must be set before calling
+ * kvs_init(), the other fields are private.
+ */
+struct kvs_fs {
+	/** Offset of the store in the flash device */
+	off_t offset;
+	/** Size of a sector, a multiple of the flash erase unit */
+	uint32_t sector_size;
+	/** Number of sectors, at least 2 */
+	uint16_t sector_count;
+
+	struct device *flash_dev;
+	struct k_mutex lock;
+	uint32_t seq;
+	uint32_t write_addr;
+	uint16_t active;
+	uint16_t write_block_size;
+	uint16_t entries;
+	uint8_t erase_value;
+	struct _kvs_index_entry index[CONFIG_KVS_INDEX_SIZE];
+	struct kvs_stats stats;
+};
+
+/**
+ * @brief Mount a key-value store
+ *
+ * Scans the flash range described by @a fs and rebuilds the RAM index.
+ * An unformatted range is erased and formatted, and an interrupted
+ * garbage collection is completed.
+ *
+ * @param fs Key-value store, with its geometry set
+ * @param dev_name Name of the flash device
+ *
+ * @return 0 on success, negative errno code on fail.
+ */
+int kvs_init(struct kvs_fs *fs, const char *dev_name);
+
+/**
+ * @brief Write a record
+ *
+ * Writing data identical to the stored record does not touch flash.
+ *
+ * @param fs Key-value store
+ * @param id Record id, any value but KVS_ID_INVALID
+ * @param data Record data
+ * @param len Record length, not zero
+ *
+ * @return 0 on success, -ENOMEM if the RAM index is full, -ENOSPC if the
+ * live records do not leave room for it, the flash being left untouched,
+ * other negative errno code on fail.
+ */
+int kvs_write(struct kvs_fs *fs, uint16_t id, const void *data, size_t len);
+
+/**
+ * @brief Read a record
+ *
+ * @param fs Key-value store
+ * @param id Record id
+ * @param data Buffer receiving the record data
+ * @param len Size of the buffer, at most that many bytes are read
+ *
+ * @return the length of the stored record, which may be larger than
+ * @a len, -ENOENT if there is no such record, other negative errno code on
+ * fail.
+ */
+ssize_t kvs_read(struct kvs_fs *fs, uint16_t id, void *data, size_t len);
+
+/**
+ * @brief Delete a record
+ *
+ * @param fs Key-value store
+ * @param id Record id
+ *
+ * @return 0 on success, -ENOENT if there is no such record, other negative
+ * errno code on fail.
+ */
+int kvs_delete(struct kvs_fs *fs, uint16_t id);
+
+/**
+ * @brief Erase all records
+ *
+ * @param fs Key-value store
+ *
+ * @return 0 on success, negative errno code on fail.
+ */
+int kvs_clear(struct kvs_fs *fs);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _KVS_H_ */
@@ -23,6 +23,19 @@ extern "C" {
 #define KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID             0x0001
 #define KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID                  0x0002
 #define KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID                      0x0003
+#define KERNEL_EVENT_LOGGER_SEMAPHORE_EVENT_ID                  0x0004
+#define KERNEL_EVENT_LOGGER_MUTEX_EVENT_ID                      0x0005
+#define KERNEL_EVENT_LOGGER_QUEUE_EVENT_ID                      0x0006
+#define KERNEL_EVENT_LOGGER_ISR_EXIT_EVENT_ID                   0x0007
+
+/* operations of the semaphore, mutex and queue events */
+
+/* semaphore given, mutex unlocked, data put in a queue */
+#define KERNEL_EVENT_LOGGER_OP_GIVE                             0
+/* semaphore taken, mutex locked, data taken from a queue */
+#define KERNEL_EVENT_LOGGER_OP_TAKE                             1
+/* the thread pends on the object */
+#define KERNEL_EVENT_LOGGER_OP_PEND                             2
 
 #ifndef _ASMLANGUAGE
 
@@ -43,6 +56,32 @@ extern void _sys_k_event_logger_interrupt(void);
 static inline void _sys_k_event_logger_interrupt(void) {};
 #endif
 
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_ISR_EXIT
+extern void _sys_k_event_logger_isr_exit(void);
+#else
+static inline void _sys_k_event_logger_isr_exit(void) {};
+#endif
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SEMAPHORE
+extern void _sys_k_event_logger_sem(struct k_sem *sem, int op);
+#else
+static inline void _sys_k_event_logger_sem(struct k_sem *sem, int op) {};
+#endif
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_MUTEX
+extern void _sys_k_event_logger_mutex(struct k_mutex *mutex, int op);
+#else
+static inline void _sys_k_event_logger_mutex(struct k_mutex *mutex,
+					     int op) {};
+#endif
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_QUEUE
+extern void _sys_k_event_logger_queue(struct k_queue *queue, int op);
+#else
+static inline void _sys_k_event_logger_queue(struct k_queue *queue,
+					     int op) {};
+#endif
+
 /**
  * @brief Kernel Event Logger
  * @defgroup kernel_event_logger Kernel Event Logger
@@ -212,9 +251,14 @@ static inline void sys_k_event_logger_put_timed(uint16_t event_id)
  * This routine retrieves the next recorded event from the kernel event logger,
  * or returns immediately if no such event exists.
  *
+ * Kernel events are retrieved oldest first, whatever their type, and
+ * before the events written with sys_k_event_logger_put(), which are
+ * retrieved in the order they were written.
+ *
  * @param event_id     Area to store event type ID.
  * @param dropped      Area to store number of events that were dropped between
- *                     the previous event and the retrieved event.
+ *                     the previous event and the retrieved event. For kernel
+ *                     events, this counts the events of the same type.
  * @param event_data   Buffer to store event data.
  * @param data_size    Size of event data buffer (number of 32-bit words).
  *
@@ -225,12 +269,8 @@ static inline void sys_k_event_logger_put_timed(uint16_t event_id)
  *         the size of the event to be retrieved.
  */
 #ifdef CONFIG_KERNEL_EVENT_LOGGER
-static inline int sys_k_event_logger_get(uint16_t *event_id, uint8_t *dropped,
-				     uint32_t *event_data, uint8_t *data_size)
-{
-	return sys_event_logger_get(&sys_k_event_logger, event_id, dropped,
-				    event_data, data_size);
-}
+int sys_k_event_logger_get(uint16_t *event_id, uint8_t *dropped,
+			   uint32_t *event_data, uint8_t *data_size);
 #endif /* CONFIG_KERNEL_EVENT_LOGGER */
 
 /**
@@ -239,6 +279,9 @@ static inline int sys_k_event_logger_get(uint16_t *event_id, uint8_t *dropped,
  * This routine retrieves the next recorded event from the kernel event logger.
  * If there is no such event the caller pends until it is available.
  *
+ * Kernel events do not wake the caller up, it checks for them every
+ * CONFIG_KERNEL_EVENT_LOGGER_POLL_INTERVAL milliseconds.
+ *
  * @param event_id     Area to store event type ID.
  * @param dropped      Area to store number of events that were dropped between
  *                     the previous event and the retrieved event.
@@ -251,12 +294,8 @@ static inline int sys_k_event_logger_get(uint16_t *event_id, uint8_t *dropped,
  *         the size of the event to be retrieved.
  */
 #ifdef CONFIG_KERNEL_EVENT_LOGGER
-static inline int sys_k_event_logger_get_wait(uint16_t *event_id,
-		uint8_t *dropped, uint32_t *event_data, uint8_t *data_size)
-{
-	return sys_event_logger_get_wait(&sys_k_event_logger, event_id, dropped,
-					 event_data, data_size);
-}
+int sys_k_event_logger_get_wait(uint16_t *event_id, uint8_t *dropped,
+				uint32_t *event_data, uint8_t *data_size);
 #endif /* CONFIG_KERNEL_EVENT_LOGGER */
 
 
@@ -280,16 +319,28 @@ static inline int sys_k_event_logger_get_wait(uint16_t *event_id,
  * @retval -EMSGSIZE Buffer too small; @a data_size now indicates
  *         the size of the event to be retrieved.
  */
-#if defined(CONFIG_KERNEL_EVENT_LOGGER) && defined(CONFIG_NANO_TIMEOUTS)
-static inline int sys_k_event_logger_get_wait_timeout(uint16_t *event_id,
-			uint8_t *dropped, uint32_t *event_data,
-			uint8_t *data_size, uint32_t timeout)
-{
-	return sys_event_logger_get_wait_timeout(&sys_k_event_logger, event_id,
-						 dropped, event_data,
-						 data_size, timeout);
-}
-#endif /* CONFIG_KERNEL_EVENT_LOGGER && CONFIG_NANO_TIMEOUTS */
+#if defined(CONFIG_KERNEL_EVENT_LOGGER) && defined(CONFIG_SYS_CLOCK_EXISTS)
+int sys_k_event_logger_get_wait_timeout(uint16_t *event_id, uint8_t *dropped,
+					uint32_t *event_data,
+					uint8_t *data_size, uint32_t timeout);
+#endif /* CONFIG_KERNEL_EVENT_LOGGER && CONFIG_SYS_CLOCK_EXISTS */
+
+/**
+ * @brief Get the 64-bit timestamp of the last event retrieved.
+ *
+ * This routine returns the hardware clock cycle count at which the kernel
+ * event retrieved last was logged, extended to 64 bits, so that long
+ * traces have monotonic timestamps. For the events written with
+ * sys_k_event_logger_put(), it is the time they were retrieved.
+ *
+ * The extension relies on events being retrieved at least once per
+ * half period of the 32-bit cycle counter.
+ *
+ * @return Cycle count, extended to 64 bits.
+ */
+#ifdef CONFIG_KERNEL_EVENT_LOGGER
+uint64_t sys_k_event_logger_get_timestamp(void);
+#endif /* CONFIG_KERNEL_EVENT_LOGGER */
 
 /**
  * @brief Register thread that retrieves kernel events.
@@ -10,6 +10,9 @@
 #ifndef __SYS_LOG_H
 #define __SYS_LOG_H
 
+#include <stdint.h>
+#include <toolchain.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,12 +33,85 @@ extern "C" {
 #define SYS_LOG_LEVEL CONFIG_SYS_LOG_OVERRIDE_LEVEL
 #endif
 
+/* Levels above the ceiling are never compiled in */
+#if defined(CONFIG_SYS_LOG_MAX_LEVEL) && \
+	(SYS_LOG_LEVEL > CONFIG_SYS_LOG_MAX_LEVEL)
+#undef SYS_LOG_LEVEL
+#define SYS_LOG_LEVEL CONFIG_SYS_LOG_MAX_LEVEL
+#endif
+
+/*
+ * Levels this compile unit has code for. With runtime levels, these are
+ * all the levels up to the ceiling, and SYS_LOG_LEVEL is only the level
+ * the compile unit starts with.
+ */
+#if defined(CONFIG_SYS_LOG_RUNTIME_LEVEL)
+#define _SYS_LOG_BUILD_LEVEL CONFIG_SYS_LOG_MAX_LEVEL
+#else
+#define _SYS_LOG_BUILD_LEVEL SYS_LOG_LEVEL
+#endif
+
 /**
  * @brief System Log
  * @defgroup system_log System Log
  * @{
  */
-#if defined(CONFIG_SYS_LOG) && (SYS_LOG_LEVEL > SYS_LOG_LEVEL_OFF)
+
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+/* Most arguments of a message, the ones of LOG_LAYOUT included */
+#define SYS_LOG_DEFERRED_MAX_ARGS 16
+
+void _sys_log_deferred(const char *fmt, int nargs, ...);
+
+/**
+ * @brief Number of messages dropped by the deferred logging backend.
+ *
+ * @details Messages are dropped when they are logged faster than the
+ * logging thread outputs them, and the buffer is full.
+ *
+ * @return Number of messages dropped since boot.
+ */
+uint32_t sys_log_deferred_dropped(void);
+#endif /* CONFIG_SYS_LOG_DEFERRED */
+
+#if defined(CONFIG_SYS_LOG_RUNTIME_LEVEL)
+/**
+ * @brief Log source, the level of the messages of a compile unit.
+ *
+ * @details Each compile unit that logs has one, in a dedicated section, so
+ * that its level can be changed at runtime.
+ */
+struct sys_log_source {
+	/** Log domain of the compile unit */
+	const char *domain;
+	/** Highest level of the messages written */
+	uint8_t level;
+};
+
+/**
+ * @brief Set the log level of a domain at runtime.
+ *
+ * @param domain Log domain, as in SYS_LOG_DOMAIN, of the compile units.
+ * @param level Highest level of the messages to write, up to
+ * CONFIG_SYS_LOG_MAX_LEVEL.
+ *
+ * @return Number of compile units logging in @a domain, -ENOENT if there
+ * are none, -EINVAL if @a level is above CONFIG_SYS_LOG_MAX_LEVEL.
+ */
+int sys_log_level_set(const char *domain, int level);
+
+/**
+ * @brief Get the log level of a domain.
+ *
+ * @param domain Log domain, as in SYS_LOG_DOMAIN, of the compile units.
+ *
+ * @return Level of the first compile unit logging in @a domain, -ENOENT
+ * if there are none.
+ */
+int sys_log_level_get(const char *domain);
+#endif /* CONFIG_SYS_LOG_RUNTIME_LEVEL */
+
+#if defined(CONFIG_SYS_LOG) && (_SYS_LOG_BUILD_LEVEL > SYS_LOG_LEVEL_OFF)
 
 #define IS_SYS_LOG_ACTIVE 1
 
@@ -94,32 +170,72 @@ void syslog_hook_install(void (*hook)(const char *, ...));
 #define SYS_LOG_NL ""
 #endif
 
+#if defined(CONFIG_SYS_LOG_RUNTIME_LEVEL)
+/* Only kept by the compiler in compile units that log */
+static struct sys_log_source _sys_log_source
+	__attribute__((__section__(".sys_log_source"), __unused__)) = {
+	SYS_LOG_DOMAIN, SYS_LOG_LEVEL
+};
+
+/* A load and a branch, the arguments are only evaluated when writing */
+#define _SYS_LOG_IF(lv, log_call)					\
+	do {								\
+		if (unlikely((lv) <= _sys_log_source.level)) {		\
+			log_call;					\
+		}							\
+	} while (0)
+#else
+#define _SYS_LOG_IF(lv, log_call) log_call
+#endif /* CONFIG_SYS_LOG_RUNTIME_LEVEL */
+
 /* [domain] [level] function: */
 #define LOG_LAYOUT "[%s]%s %s: %s"
+
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+
+#define _SYS_LOG_NARGS(...)						\
+	_SYS_LOG_NARGS_N(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9,	\
+			 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define _SYS_LOG_NARGS_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11,	\
+			 _12, _13, _14, _15, _16, N, ...) N
+
+/* The arguments are stored, the message is formatted later */
+#define LOG_BACKEND_CALL(log_lv, log_color, log_format, color_off, ...)	\
+	_sys_log_deferred(LOG_LAYOUT log_format "%s" SYS_LOG_NL,	\
+	_SYS_LOG_NARGS(SYS_LOG_DOMAIN, log_lv, __func__, log_color,	\
+		       ##__VA_ARGS__, color_off),			\
+	SYS_LOG_DOMAIN, log_lv, __func__, log_color, ##__VA_ARGS__, color_off)
+
+#else
+
 #define LOG_BACKEND_CALL(log_lv, log_color, log_format, color_off, ...)	\
 	SYS_LOG_BACKEND_FN(LOG_LAYOUT log_format "%s" SYS_LOG_NL,	\
 	SYS_LOG_DOMAIN, log_lv, __func__, log_color, ##__VA_ARGS__, color_off)
 
+#endif /* CONFIG_SYS_LOG_DEFERRED */
+
 #define LOG_NO_COLOR(log_lv, log_format, ...)				\
 	LOG_BACKEND_CALL(log_lv, "", log_format, "", ##__VA_ARGS__)
 #define LOG_COLOR(log_lv, log_color, log_format, ...)			\
 	LOG_BACKEND_CALL(log_lv, log_color, log_format,			\
 	SYS_LOG_COLOR_OFF, ##__VA_ARGS__)
 
-#define SYS_LOG_ERR(...) LOG_COLOR(SYS_LOG_TAG_ERR, SYS_LOG_COLOR_RED,	\
-	##__VA_ARGS__)
+#define SYS_LOG_ERR(...) _SYS_LOG_IF(SYS_LOG_LEVEL_ERROR,		\
+	LOG_COLOR(SYS_LOG_TAG_ERR, SYS_LOG_COLOR_RED, ##__VA_ARGS__))
 
-#if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_WARNING)
-#define SYS_LOG_WRN(...) LOG_COLOR(SYS_LOG_TAG_WRN,			\
-	SYS_LOG_COLOR_YELLOW, ##__VA_ARGS__)
+#if (_SYS_LOG_BUILD_LEVEL >= SYS_LOG_LEVEL_WARNING)
+#define SYS_LOG_WRN(...) _SYS_LOG_IF(SYS_LOG_LEVEL_WARNING,		\
+	LOG_COLOR(SYS_LOG_TAG_WRN, SYS_LOG_COLOR_YELLOW, ##__VA_ARGS__))
 #endif
 
-#if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_INFO)
-#define SYS_LOG_INF(...) LOG_NO_COLOR(SYS_LOG_TAG_INF, ##__VA_ARGS__)
+#if (_SYS_LOG_BUILD_LEVEL >= SYS_LOG_LEVEL_INFO)
+#define SYS_LOG_INF(...) _SYS_LOG_IF(SYS_LOG_LEVEL_INFO,		\
+	LOG_NO_COLOR(SYS_LOG_TAG_INF, ##__VA_ARGS__))
 #endif
 
-#if (SYS_LOG_LEVEL == SYS_LOG_LEVEL_DEBUG)
-#define SYS_LOG_DBG(...) LOG_NO_COLOR(SYS_LOG_TAG_DBG, ##__VA_ARGS__)
+#if (_SYS_LOG_BUILD_LEVEL == SYS_LOG_LEVEL_DEBUG)
+#define SYS_LOG_DBG(...) _SYS_LOG_IF(SYS_LOG_LEVEL_DEBUG,		\
+	LOG_NO_COLOR(SYS_LOG_TAG_DBG, ##__VA_ARGS__))
 #endif
 
 #else
@@ -16,6 +16,22 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Output routine of the formatter
+ *
+ * @param buf Characters to output, not NUL terminated
+ * @param len Number of characters
+ * @param ctx Context given to _vprf()
+ *
+ * @return A negative value to stop the output, else 0
+ */
+typedef int (*_prf_out_t)(const char *buf, size_t len, void *ctx);
+
+extern __printf_like(3, 0) int _vprf(_prf_out_t out, void *ctx,
+				     const char *fmt, va_list ap);
+extern int _prf(int (*func)(), void *dest, const char *format,
+		va_list vargs);
+
 /**
  *
  * @brief Print kernel debugging message.
@@ -23,17 +39,9 @@ extern "C" {
  * This routine prints a kernel debugging message to the system console.
  * Output is send immediately, without any mutual exclusion or buffering.
  *
- * A basic set of conversion specifier characters are supported:
- *   - signed decimal: \%d, \%i
- *   - unsigned decimal: \%u
- *   - unsigned hexadecimal: \%x (\%X is treated as \%x)
- *   - pointer: \%p
- *   - string: \%s
- *   - character: \%c
- *   - percent: \%\%
- *
- * No other conversion specification capabilities are supported, such as flags,
- * field width, precision, or length attributes.
+ * The conversions of the C library printf() are supported, with their
+ * flags, field width, precision and length modifiers. The floating point
+ * conversions (\%e, \%f, \%g) are only supported with CONFIG_PRINTF_FLOAT.
  *
  * @param fmt Format string.
  * @param ... Optional list of format arguments.
@@ -44,7 +52,8 @@ extern "C" {
 extern __printf_like(1, 2) int printk(const char *fmt, ...);
 extern __printf_like(3, 4) int snprintk(char *str, size_t size,
 					const char *fmt, ...);
-extern int vsnprintk(char *str, size_t size, const char *fmt, va_list ap);
+extern __printf_like(3, 0) int vsnprintk(char *str, size_t size,
+					const char *fmt, va_list ap);
 
 void _vprintk(int (*out)(int, void *), void *ctx, const char *fmt, va_list ap);
 #else
@@ -63,8 +72,8 @@ static inline __printf_like(3, 4) int snprintk(char *str, size_t size,
 	return 0;
 }
 
-static inline int vsnprintk(char *str, size_t size, const char *fmt,
-			    va_list ap)
+static inline __printf_like(3, 0) int vsnprintk(char *str, size_t size,
+						const char *fmt, va_list ap)
 {
 	ARG_UNUSED(str);
 	ARG_UNUSED(size);
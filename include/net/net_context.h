@@ -715,6 +715,13 @@ typedef void (*net_context_cb_t)(struct net_context *context, void *user_data);
  * @brief Go through all the network connections and call callback
  * for each network context.
  *
+ * The contexts are not locked while the callback runs, for a callback
+ * printing a context to not hold off the network stack, but a reference
+ * is held on the context given to it: it cannot be released or
+ * reallocated before the callback returns. A context put meanwhile is
+ * released once the callback returns, and contexts allocated meanwhile
+ * may be missed.
+ *
  * @param cb User supplied callback function to call.
  * @param user_data User specified data.
  */
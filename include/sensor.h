@@ -145,6 +145,12 @@ enum sensor_trigger_type {
 
 	/** Trigger fires when a double tap is detected. */
 	SENSOR_TRIG_DOUBLE_TAP,
+
+	/**
+	 * Trigger fires when the hardware FIFO holds at least the number
+	 * of frames set with the @ref SENSOR_ATTR_FIFO_WATERMARK attribute.
+	 */
+	SENSOR_TRIG_FIFO_WATERMARK,
 };
 
 /**
@@ -191,6 +197,29 @@ enum sensor_attribute {
 	 * algorithms to calibrate itself on a certain axis, or all of them.
 	 */
 	SENSOR_ATTR_CALIB_TARGET,
+	/**
+	 * Number of frames in the hardware FIFO that fires the
+	 * @ref SENSOR_TRIG_FIFO_WATERMARK trigger.
+	 */
+	SENSOR_ATTR_FIFO_WATERMARK,
+};
+
+/**
+ * @brief Number of raw samples a sensor frame holds.
+ */
+#define SENSOR_FRAME_SAMPLES	6
+
+/**
+ * @brief Raw samples read together from a sensor FIFO.
+ *
+ * The layout of the samples is driver specific, use
+ * @ref sensor_frames_decode to convert them.
+ */
+struct sensor_frame {
+	/** When the frame was sampled, in hardware clock cycles. */
+	uint32_t timestamp;
+	/** Raw samples, in the driver's own layout. */
+	int16_t data[SENSOR_FRAME_SAMPLES];
 };
 
 /**
@@ -240,11 +269,35 @@ typedef int (*sensor_channel_get_t)(struct device *dev,
 				    enum sensor_channel chan,
 				    struct sensor_value *val);
 
+/**
+ * @typedef sensor_fifo_read_t
+ * @brief Callback API for draining the hardware FIFO
+ *
+ * See sensor_fifo_read() for argument description
+ */
+typedef int (*sensor_fifo_read_t)(struct device *dev,
+				  struct sensor_frame *frames,
+				  size_t max_frames);
+
+/**
+ * @typedef sensor_frames_decode_t
+ * @brief Callback API for converting frames
+ *
+ * See sensor_frames_decode() for argument description
+ */
+typedef int (*sensor_frames_decode_t)(struct device *dev,
+				      enum sensor_channel chan,
+				      const struct sensor_frame *frames,
+				      size_t count,
+				      struct sensor_value *val);
+
 struct sensor_driver_api {
 	sensor_attr_set_t attr_set;
 	sensor_trigger_set_t trigger_set;
 	sensor_sample_fetch_t sample_fetch;
 	sensor_channel_get_t channel_get;
+	sensor_fifo_read_t fifo_read;
+	sensor_frames_decode_t frames_decode;
 };
 
 /**
@@ -381,6 +434,67 @@ static inline int sensor_channel_get(struct device *dev,
 	return api->channel_get(dev, chan, val);
 }
 
+/**
+ * @brief Drain the hardware FIFO of a sensor
+ *
+ * Read the frames the sensor stored in its FIFO, oldest first, in as few
+ * bus transactions as possible. Each frame gets the time it was sampled,
+ * derived from the sampling frequency and the time of the read. Frames
+ * which do not fit stay in the FIFO for the next read.
+ *
+ * Since the function communicates with the sensor device, it is unsafe
+ * to call it in an ISR if the device is connected via I2C or SPI.
+ *
+ * @param dev Pointer to the sensor device
+ * @param frames Where to store the frames
+ * @param max_frames Number of frames the array can hold
+ *
+ * @return Number of frames read, negative errno code if failure.
+ */
+static inline int sensor_fifo_read(struct device *dev,
+				   struct sensor_frame *frames,
+				   size_t max_frames)
+{
+	const struct sensor_driver_api *api = dev->driver_api;
+
+	if (!api->fifo_read) {
+		return -ENOTSUP;
+	}
+
+	return api->fifo_read(dev, frames, max_frames);
+}
+
+/**
+ * @brief Convert a channel of frames read with @ref sensor_fifo_read
+ *
+ * The values of the frames are stored one after the other in @p val, one
+ * value per frame, or three for channels with the _XYZ suffix (X, Y and Z
+ * of the first frame, then of the second frame...). Frames are converted
+ * with the current configuration of the sensor, such as its range.
+ *
+ * @param dev Pointer to the sensor device
+ * @param chan The channel to convert
+ * @param frames The frames to convert
+ * @param count Number of frames
+ * @param val Where to store the values
+ *
+ * @return 0 if successful, negative errno code if failure.
+ */
+static inline int sensor_frames_decode(struct device *dev,
+				       enum sensor_channel chan,
+				       const struct sensor_frame *frames,
+				       size_t count,
+				       struct sensor_value *val)
+{
+	const struct sensor_driver_api *api = dev->driver_api;
+
+	if (!api->frames_decode) {
+		return -ENOTSUP;
+	}
+
+	return api->frames_decode(dev, chan, frames, count, val);
+}
+
 /**
  * @brief The value of gravitational constant in micro m/s^2.
  */
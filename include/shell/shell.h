@@ -6,6 +6,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdarg.h>
+#include <toolchain.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -100,6 +103,25 @@ void shell_register_prompt_handler(shell_prompt_function_t handler);
  */
 void shell_register_default_module(const char *name);
 
+/** @brief Print the output of a command.
+ *
+ *  Takes the printk format. With a buffered UART console, waits for room
+ *  in the transmit buffer instead of dropping what does not fit, so that
+ *  a command printing a long table neither loses lines nor keeps the CPU
+ *  busy waiting for the UART. Meant for the shell commands, which run in
+ *  a thread; the other threads should keep using printk.
+ *
+ *  @param fmt Format string.
+ */
+__printf_like(1, 2) void shell_printk(const char *fmt, ...);
+
+/** @brief Print the output of a command, from a va_list.
+ *
+ *  @param fmt Format string.
+ *  @param ap Arguments of the format string.
+ */
+__printf_like(1, 0) void shell_vprintk(const char *fmt, va_list ap);
+
 /**
 * @}
 */
@@ -21,6 +21,8 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <errno.h>
+#include <kernel.h>
 #include <device.h>
 
 #ifdef __cplusplus
@@ -66,6 +68,19 @@ struct spi_config {
 	uint32_t	max_sys_freq;
 };
 
+/**
+ * @brief SPI buffer structure, one element of a buffer set.
+ * buf is the memory buffer, or NULL: frames of zeros are sent in place
+ * of a NULL transmit buffer, and frames received into a NULL receive
+ * buffer are dropped.
+ * len is the length of the buffer in bytes, a whole number of frames: a
+ * frame takes 1, 2 or 4 bytes, for a word size up to 8, 16 or 32 bits.
+ */
+struct spi_buf {
+	void *buf;
+	size_t len;
+};
+
 /**
  * @typedef spi_api_configure
  * @brief Callback API upon configuring the const controller
@@ -87,11 +102,22 @@ typedef int (*spi_api_slave_select)(struct device *dev, uint32_t slave);
 typedef int (*spi_api_io)(struct device *dev,
 			  const void *tx_buf, uint32_t tx_buf_len,
 			  void *rx_buf, uint32_t rx_buf_len);
+/**
+ * @typedef spi_api_io_bufs
+ * @brief Callback API for buffer set I/O
+ * See spi_transceive_bufs() and spi_transceive_bufs_async() for argument
+ * descriptions, async is NULL for a blocking transaction.
+ */
+typedef int (*spi_api_io_bufs)(struct device *dev, struct spi_config *config,
+			       const struct spi_buf *tx_bufs, size_t tx_count,
+			       const struct spi_buf *rx_bufs, size_t rx_count,
+			       struct k_poll_signal *async);
 
 struct spi_driver_api {
 	spi_api_configure configure;
 	spi_api_slave_select slave_select;
 	spi_api_io transceive;
+	spi_api_io_bufs transceive_bufs;
 };
 
 /**
@@ -192,6 +218,99 @@ static inline int spi_transceive(struct device *dev,
 	return api->transceive(dev, tx_buf, tx_buf_len, rx_buf, rx_buf_len);
 }
 
+/**
+ * @brief Read and write data from and to buffer sets in one transaction.
+ * The frames of all the transmit buffers are sent back to back, while the
+ * received frames fill the receive buffers one after the other, so that a
+ * command and its payload do not need to be copied to a single buffer.
+ * The transaction is as long as the longer of the two sets.
+ * On drivers which do not support buffer sets natively, only sets of at
+ * most one buffer are supported.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param config Configuration to apply, as spi_configure() does: it stays
+ *		in effect for the following transactions. NULL to keep the
+ *		current one.
+ * @param tx_bufs Array of buffers to send.
+ * @param tx_count Number of buffers in tx_bufs, may be 0.
+ * @param rx_bufs Array of buffers to receive into.
+ * @param rx_count Number of buffers in rx_bufs, may be 0.
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the buffer sets are not supported by the driver.
+ * @retval -EINVAL If a buffer does not hold a whole number of frames.
+ * @retval Negative errno code if failure.
+ */
+static inline int spi_transceive_bufs(struct device *dev,
+				      struct spi_config *config,
+				      const struct spi_buf *tx_bufs,
+				      size_t tx_count,
+				      const struct spi_buf *rx_bufs,
+				      size_t rx_count)
+{
+	const struct spi_driver_api *api = dev->driver_api;
+	int ret;
+
+	if (api->transceive_bufs) {
+		return api->transceive_bufs(dev, config, tx_bufs, tx_count,
+					    rx_bufs, rx_count, NULL);
+	}
+
+	if (tx_count > 1 || rx_count > 1) {
+		return -ENOTSUP;
+	}
+
+	if (config) {
+		ret = api->configure(dev, config);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return api->transceive(dev,
+			       tx_count ? tx_bufs->buf : NULL,
+			       tx_count ? tx_bufs->len : 0,
+			       rx_count ? rx_bufs->buf : NULL,
+			       rx_count ? rx_bufs->len : 0);
+}
+
+#ifdef CONFIG_SPI_ASYNC
+/**
+ * @brief Start a buffer set transaction without waiting for its end.
+ * Same as spi_transceive_bufs(), except that the call returns as soon as
+ * the transaction is started. Its completion raises the signal, with the
+ * result of the transaction, 0 or a negative errno code, as the signal
+ * result. The buffers must stay valid until then.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param config Configuration to apply, as spi_configure() does: it stays
+ *		in effect for the following transactions. NULL to keep the
+ *		current one.
+ * @param tx_bufs Array of buffers to send.
+ * @param tx_count Number of buffers in tx_bufs, may be 0.
+ * @param rx_bufs Array of buffers to receive into.
+ * @param rx_count Number of buffers in rx_bufs, may be 0.
+ * @param async Signal raised when the transaction is over.
+ * @retval 0 If the transaction is started.
+ * @retval -ENOTSUP If the driver does not support it.
+ * @retval Negative errno code if failure.
+ */
+static inline int spi_transceive_bufs_async(struct device *dev,
+					    struct spi_config *config,
+					    const struct spi_buf *tx_bufs,
+					    size_t tx_count,
+					    const struct spi_buf *rx_bufs,
+					    size_t rx_count,
+					    struct k_poll_signal *async)
+{
+	const struct spi_driver_api *api = dev->driver_api;
+
+	if (!api->transceive_bufs) {
+		return -ENOTSUP;
+	}
+
+	return api->transceive_bufs(dev, config, tx_bufs, tx_count,
+				    rx_bufs, rx_count, async);
+}
+#endif /* CONFIG_SPI_ASYNC */
+
 #ifdef __cplusplus
 }
 #endif
@@ -80,6 +80,80 @@ typedef void (*uart_irq_callback_t)(struct device *port);
  */
 typedef void (*uart_irq_config_func_t)(struct device *port);
 
+#ifdef CONFIG_UART_ASYNC_API
+
+/**
+ * @brief Types of events passed to the asynchronous API callback.
+ */
+enum uart_event_type {
+	/** @brief Whole transmit buffer was sent. */
+	UART_TX_DONE,
+	/** @brief Transmission was aborted, part of the buffer was sent. */
+	UART_TX_ABORTED,
+	/**
+	 * @brief Data was received.
+	 *
+	 * Reported when the buffer is full, when the line stayed idle for
+	 * the receive timeout, and when reception is disabled.
+	 */
+	UART_RX_RDY,
+	/**
+	 * @brief Driver requests the next receive buffer.
+	 *
+	 * Provide it with uart_rx_buf_rsp() before the current buffer is
+	 * full, so that reception continues without gaps.
+	 */
+	UART_RX_BUF_REQUEST,
+	/** @brief Driver no longer uses a receive buffer. */
+	UART_RX_BUF_RELEASED,
+	/** @brief Reception stopped, after uart_rx_disable() or for lack
+	 * of a next buffer.
+	 */
+	UART_RX_DISABLED,
+};
+
+/**
+ * @brief Event passed to the asynchronous API callback.
+ *
+ * @param type Event type.
+ * @param data.tx Sent buffer and number of bytes sent, for TX events.
+ * @param data.rx Buffer, offset and length of the received data, for
+ * UART_RX_RDY.
+ * @param data.rx_buf Released buffer, for UART_RX_BUF_RELEASED.
+ */
+struct uart_event {
+	enum uart_event_type type;
+	union {
+		struct {
+			const uint8_t *buf;
+			size_t len;
+		} tx;
+		struct {
+			uint8_t *buf;
+			size_t offset;
+			size_t len;
+		} rx;
+		struct {
+			uint8_t *buf;
+		} rx_buf;
+	} data;
+};
+
+/**
+ * @typedef uart_callback_t
+ * @brief Define the application callback function signature for the
+ * asynchronous API.
+ *
+ * It is called from interrupt context, or from the context of the API
+ * call that triggers the event.
+ *
+ * @param evt Event, only valid during the call.
+ * @param user_data Pointer given to uart_callback_set().
+ */
+typedef void (*uart_callback_t)(struct uart_event *evt, void *user_data);
+
+#endif /* CONFIG_UART_ASYNC_API */
+
 /**
  * @brief UART device configuration.
  *
@@ -161,6 +235,30 @@ struct uart_driver_api {
 
 #endif
 
+#ifdef CONFIG_UART_ASYNC_API
+
+	/** Asynchronous API callback set function */
+	int (*callback_set)(struct device *dev, uart_callback_t cb,
+			    void *user_data);
+
+	/** Asynchronous transmit function */
+	int (*tx)(struct device *dev, const uint8_t *buf, size_t len);
+
+	/** Asynchronous transmit abort function */
+	int (*tx_abort)(struct device *dev);
+
+	/** Asynchronous receiver enabling function */
+	int (*rx_enable)(struct device *dev, uint8_t *buf, size_t len,
+			 int32_t timeout);
+
+	/** Asynchronous next receive buffer function */
+	int (*rx_buf_rsp)(struct device *dev, uint8_t *buf, size_t len);
+
+	/** Asynchronous receiver disabling function */
+	int (*rx_disable)(struct device *dev);
+
+#endif
+
 #ifdef CONFIG_UART_LINE_CTRL
 	int (*line_ctrl_set)(struct device *dev, uint32_t ctrl, uint32_t val);
 	int (*line_ctrl_get)(struct device *dev, uint32_t ctrl, uint32_t *val);
@@ -493,6 +591,162 @@ static inline void uart_irq_callback_set(struct device *dev,
 
 #endif
 
+#ifdef CONFIG_UART_ASYNC_API
+
+/**
+ * @brief Set the callback of the asynchronous API.
+ *
+ * The asynchronous API and the interrupt driven API can not be used at the
+ * same time on a device; setting a callback selects the asynchronous one.
+ *
+ * @param dev UART device structure.
+ * @param cb Callback, called for every event.
+ * @param user_data Pointer passed to the callback.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the driver does not support the asynchronous API.
+ */
+static inline int uart_callback_set(struct device *dev, uart_callback_t cb,
+				    void *user_data)
+{
+	const struct uart_driver_api *api = dev->driver_api;
+
+	if (api->callback_set) {
+		return api->callback_set(dev, cb, user_data);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Send a buffer.
+ *
+ * The call returns immediately, UART_TX_DONE is reported once the whole
+ * buffer was handed to the hardware. The buffer must stay valid until then.
+ *
+ * @param dev UART device structure.
+ * @param buf Data to send.
+ * @param len Number of bytes to send.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a transmission is already in progress.
+ * @retval -ENOTSUP If the driver does not support the asynchronous API.
+ */
+static inline int uart_tx(struct device *dev, const uint8_t *buf, size_t len)
+{
+	const struct uart_driver_api *api = dev->driver_api;
+
+	if (api->tx) {
+		return api->tx(dev, buf, len);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Abort the current transmission.
+ *
+ * UART_TX_ABORTED is reported with the number of bytes already sent.
+ *
+ * @param dev UART device structure.
+ *
+ * @retval 0 If successful.
+ * @retval -EFAULT If there is no transmission in progress.
+ * @retval -ENOTSUP If the driver does not support the asynchronous API.
+ */
+static inline int uart_tx_abort(struct device *dev)
+{
+	const struct uart_driver_api *api = dev->driver_api;
+
+	if (api->tx_abort) {
+		return api->tx_abort(dev);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Start receiving into a buffer.
+ *
+ * Received data is reported with UART_RX_RDY events. When the buffer is
+ * full the driver switches to the buffer given to uart_rx_buf_rsp() after
+ * the UART_RX_BUF_REQUEST event, so that reception never stops while two
+ * buffers are in rotation.
+ *
+ * @param dev UART device structure.
+ * @param buf Receive buffer.
+ * @param len Size of the buffer.
+ * @param timeout Time in milliseconds the line must stay idle before the
+ * data received so far is reported, K_FOREVER to only report full buffers.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If reception is already enabled.
+ * @retval -ENOTSUP If the driver does not support the asynchronous API.
+ */
+static inline int uart_rx_enable(struct device *dev, uint8_t *buf, size_t len,
+				 int32_t timeout)
+{
+	const struct uart_driver_api *api = dev->driver_api;
+
+	if (api->rx_enable) {
+		return api->rx_enable(dev, buf, len, timeout);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Provide the next receive buffer.
+ *
+ * To be called after a UART_RX_BUF_REQUEST event, typically from the
+ * callback itself.
+ *
+ * @param dev UART device structure.
+ * @param buf Receive buffer.
+ * @param len Size of the buffer.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a next buffer was already provided.
+ * @retval -EACCES If reception is disabled.
+ * @retval -ENOTSUP If the driver does not support the asynchronous API.
+ */
+static inline int uart_rx_buf_rsp(struct device *dev, uint8_t *buf,
+				  size_t len)
+{
+	const struct uart_driver_api *api = dev->driver_api;
+
+	if (api->rx_buf_rsp) {
+		return api->rx_buf_rsp(dev, buf, len);
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Stop receiving.
+ *
+ * Data still in the current buffer is reported, then all buffers are
+ * released and UART_RX_DISABLED is reported.
+ *
+ * @param dev UART device structure.
+ *
+ * @retval 0 If successful.
+ * @retval -EFAULT If reception is not enabled.
+ * @retval -ENOTSUP If the driver does not support the asynchronous API.
+ */
+static inline int uart_rx_disable(struct device *dev)
+{
+	const struct uart_driver_api *api = dev->driver_api;
+
+	if (api->rx_disable) {
+		return api->rx_disable(dev);
+	}
+
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_UART_ASYNC_API */
+
 #ifdef CONFIG_UART_LINE_CTRL
 
 /**
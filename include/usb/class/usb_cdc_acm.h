@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief USB CDC ACM device class public API
+ */
+
+#ifndef __USB_CDC_ACM_H__
+#define __USB_CDC_ACM_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief USB CDC ACM throughput statistics
+ */
+struct cdc_acm_stats {
+	/** Bytes received from the host */
+	uint32_t rx_bytes;
+	/** Bulk OUT packets received from the host */
+	uint32_t rx_packets;
+	/** Times a bulk OUT packet was NAKed, the receive ring being full */
+	uint32_t rx_naks;
+	/** Bytes sent to the host */
+	uint32_t tx_bytes;
+	/** Bulk IN transfers, of one or more packets */
+	uint32_t tx_transfers;
+	/** Zero length packets ending transfers of full packets */
+	uint32_t tx_zlps;
+	/** Times uart_fifo_fill() found the transmit ring full */
+	uint32_t tx_full;
+};
+
+/**
+ * @brief Get a snapshot of the CDC ACM statistics
+ *
+ * @param stats Filled with the current statistics.
+ */
+void cdc_acm_stats_get(struct cdc_acm_stats *stats);
+
+/**
+ * @brief Reset the CDC ACM statistics
+ */
+void cdc_acm_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USB_CDC_ACM_H__ */
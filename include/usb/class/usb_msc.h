@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief USB Mass Storage device class public API
+ */
+
+#ifndef __USB_MSC_H__
+#define __USB_MSC_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief USB Mass Storage throughput statistics
+ *
+ * Cycle counts are measured with k_cycle_get_32() around each disk
+ * access; divide the byte counts by them to get the disk side throughput.
+ */
+struct usb_msc_stats {
+	/** Bytes sent to the host */
+	uint32_t bytes_read;
+	/** Bytes received from the host */
+	uint32_t bytes_written;
+	/** Disk read requests */
+	uint32_t disk_reads;
+	/** Disk write requests */
+	uint32_t disk_writes;
+	/** Cycles spent in disk read requests */
+	uint32_t disk_read_cycles;
+	/** Cycles spent in disk write requests */
+	uint32_t disk_write_cycles;
+	/** Times the bulk IN endpoint waited for data from the disk */
+	uint32_t in_stalls;
+	/** Times the bulk OUT endpoint was NAKed waiting for the disk */
+	uint32_t out_stalls;
+};
+
+/**
+ * @brief Get a snapshot of the Mass Storage statistics
+ *
+ * @param stats Filled with the current statistics.
+ */
+void usb_msc_stats_get(struct usb_msc_stats *stats);
+
+/**
+ * @brief Reset the Mass Storage statistics
+ */
+void usb_msc_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USB_MSC_H__ */
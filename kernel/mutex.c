@@ -35,6 +35,7 @@
 #include <debug/object_tracing_common.h>
 #include <errno.h>
 #include <init.h>
+#include <logging/kernel_event_logger.h>
 
 #ifdef CONFIG_OBJECT_MONITOR
 #define RECORD_STATE_CHANGE(mutex) \
@@ -140,6 +141,8 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 
 		k_sched_unlock();
 
+		_sys_k_event_logger_mutex(mutex, KERNEL_EVENT_LOGGER_OP_TAKE);
+
 		return 0;
 	}
 
@@ -159,6 +162,8 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 	new_prio = new_prio_for_inheritance(_current->base.prio,
 					    mutex->owner->base.prio);
 
+	_sys_k_event_logger_mutex(mutex, KERNEL_EVENT_LOGGER_OP_PEND);
+
 	key = irq_lock();
 
 	K_DEBUG("adjusting prio up on mutex %p\n", mutex);
@@ -210,6 +215,8 @@ void k_mutex_unlock(struct k_mutex *mutex)
 	__ASSERT(mutex->lock_count > 0, "");
 	__ASSERT(mutex->owner == _current, "");
 
+	_sys_k_event_logger_mutex(mutex, KERNEL_EVENT_LOGGER_OP_GIVE);
+
 	_sched_lock();
 
 	RECORD_STATE_CHANGE();
@@ -20,6 +20,7 @@
 #include <ksched.h>
 #include <misc/slist.h>
 #include <init.h>
+#include <logging/kernel_event_logger.h>
 
 extern struct k_queue _k_queue_list_start[];
 extern struct k_queue _k_queue_list_end[];
@@ -82,6 +83,8 @@ void k_queue_insert(struct k_queue *queue, void *prev, void *data)
 	struct k_thread *first_pending_thread;
 	unsigned int key;
 
+	_sys_k_event_logger_queue(queue, KERNEL_EVENT_LOGGER_OP_GIVE);
+
 	key = irq_lock();
 
 	first_pending_thread = _unpend_first_thread(&queue->wait_q);
@@ -120,6 +123,8 @@ void k_queue_append_list(struct k_queue *queue, void *head, void *tail)
 	struct k_thread *first_thread, *thread;
 	unsigned int key;
 
+	_sys_k_event_logger_queue(queue, KERNEL_EVENT_LOGGER_OP_GIVE);
+
 	key = irq_lock();
 
 	first_thread = _peek_first_pending_thread(&queue->wait_q);
@@ -171,6 +176,7 @@ void *k_queue_get(struct k_queue *queue, int32_t timeout)
 	if (likely(!sys_slist_is_empty(&queue->data_q))) {
 		data = sys_slist_get_not_empty(&queue->data_q);
 		irq_unlock(key);
+		_sys_k_event_logger_queue(queue, KERNEL_EVENT_LOGGER_OP_TAKE);
 		return data;
 	}
 
@@ -179,6 +185,8 @@ void *k_queue_get(struct k_queue *queue, int32_t timeout)
 		return NULL;
 	}
 
+	_sys_k_event_logger_queue(queue, KERNEL_EVENT_LOGGER_OP_PEND);
+
 	_pend_current_thread(&queue->wait_q, timeout);
 
 	return _Swap(key) ? NULL : _current->base.swap_data;
@@ -25,6 +25,7 @@
 #include <misc/dlist.h>
 #include <ksched.h>
 #include <init.h>
+#include <logging/kernel_event_logger.h>
 
 #ifdef CONFIG_SEMAPHORE_GROUPS
 struct sem_desc {
@@ -384,6 +385,8 @@ void k_sem_give(struct k_sem *sem)
 {
 	unsigned int key;
 
+	_sys_k_event_logger_sem(sem, KERNEL_EVENT_LOGGER_OP_GIVE);
+
 	key = irq_lock();
 
 	if (do_sem_give(sem)) {
@@ -402,6 +405,7 @@ int k_sem_take(struct k_sem *sem, int32_t timeout)
 	if (likely(sem->count > 0)) {
 		sem->count--;
 		irq_unlock(key);
+		_sys_k_event_logger_sem(sem, KERNEL_EVENT_LOGGER_OP_TAKE);
 		return 0;
 	}
 
@@ -410,6 +414,8 @@ int k_sem_take(struct k_sem *sem, int32_t timeout)
 		return -EBUSY;
 	}
 
+	_sys_k_event_logger_sem(sem, KERNEL_EVENT_LOGGER_OP_PEND);
+
 	_pend_current_thread(&sem->wait_q, timeout);
 
 	return _Swap(key);
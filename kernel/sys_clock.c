@@ -12,6 +12,7 @@
 #include <sections.h>
 #include <wait_q.h>
 #include <drivers/system_timer.h>
+#include <debug/perf_counter.h>
 
 #ifdef CONFIG_SYS_CLOCK_EXISTS
 #ifdef _NON_OPTIMIZED_TICKS_PER_SEC
@@ -297,6 +298,9 @@ static void handle_time_slicing(int32_t ticks)
 #else
 #define handle_time_slicing(ticks) do { } while (0)
 #endif
+
+PERF_HISTOGRAM_DEFINE(k_tick_announce_cycles);
+
 /**
  *
  * @brief Announce a tick to the kernel
@@ -310,6 +314,7 @@ static void handle_time_slicing(int32_t ticks)
 void _nano_sys_clock_tick_announce(int32_t ticks)
 {
 	unsigned int  key;
+	PERF_HISTOGRAM_START(k_tick_announce_cycles);
 
 	K_DEBUG("ticks: %d\n", ticks);
 
@@ -322,4 +327,6 @@ void _nano_sys_clock_tick_announce(int32_t ticks)
 
 	/* time slicing is basically handled like just yet another timeout */
 	handle_time_slicing(ticks);
+
+	PERF_HISTOGRAM_STOP(k_tick_announce_cycles);
 }
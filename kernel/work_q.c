@@ -14,6 +14,10 @@
 #include <kernel_structs.h>
 #include <wait_q.h>
 #include <errno.h>
+#include <debug/perf_counter.h>
+
+PERF_COUNTER_DEFINE(k_work_items);
+PERF_HISTOGRAM_DEFINE(k_work_handler_cycles);
 
 static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 {
@@ -33,7 +37,12 @@ static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 		/* Reset pending state so it can be resubmitted by handler */
 		if (atomic_test_and_clear_bit(work->flags,
 					       K_WORK_STATE_PENDING)) {
+			PERF_HISTOGRAM_START(k_work_handler_cycles);
+
 			handler(work);
+
+			PERF_HISTOGRAM_STOP(k_work_handler_cycles);
+			PERF_COUNTER_INC(k_work_items);
 		}
 
 		/* Make sure we don't hog up the CPU if the FIFO never (or
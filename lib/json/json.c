@@ -18,491 +18,646 @@
 struct token {
 	enum json_tokens type;
 	char *start;
-	char *end;
+	size_t len;
+	int32_t num;
 };
 
-struct lexer {
-	void *(*state)(struct lexer *lexer);
-	char *start;
-	char *pos;
-	char *end;
-	struct token token;
-};
-
-struct json_obj {
-	struct lexer lexer;
+enum lex_state {
+	LEX_JSON,
+	LEX_STRING,
+	LEX_ESCAPE,
+	LEX_UNICODE,
+	LEX_NUMBER,
+	LEX_LITERAL,
 };
 
-struct json_obj_key_value {
-	const char *key;
-	size_t key_len;
-	struct token value;
+/* What the parser expects next in the innermost object or array */
+enum expect {
+	EXPECT_FIRST_KEY,	/* key or end of object */
+	EXPECT_KEY,
+	EXPECT_COLON,
+	EXPECT_VALUE,
+	EXPECT_OBJ_COMMA,	/* comma or end of object */
+	EXPECT_FIRST_ELEMENT,	/* value or end of array */
+	EXPECT_ELEMENT,
+	EXPECT_ARR_COMMA,	/* comma or end of array */
 };
 
-static bool lexer_consume(struct lexer *lexer, struct token *token,
-			  enum json_tokens empty_token)
+static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
 {
-	if (lexer->token.type == empty_token) {
-		return false;
+	if (type1 == JSON_TOK_TRUE || type1 == JSON_TOK_FALSE) {
+		return type2 == JSON_TOK_TRUE || type2 == JSON_TOK_FALSE;
 	}
 
-	*token = lexer->token;
-	lexer->token.type = empty_token;
-
-	return true;
+	return type1 == type2;
 }
 
-static bool lexer_next(struct lexer *lexer, struct token *token)
+static int push(struct json_obj_stream *stream, enum json_tokens type,
+		const struct json_obj_descr *descr, size_t descr_len,
+		void *val, size_t *count)
 {
-	while (lexer->state) {
-		if (lexer_consume(lexer, token, JSON_TOK_NONE)) {
-			return true;
-		}
+	struct json_parse_frame *frame;
 
-		lexer->state = lexer->state(lexer);
+	if (stream->depth == JSON_MAX_DEPTH) {
+		return -EINVAL;
 	}
 
-	return lexer_consume(lexer, token, JSON_TOK_EOF);
-}
+	if (type == JSON_TOK_OBJECT_START) {
+		assert(descr_len < (sizeof(frame->decoded_fields) * CHAR_BIT - 1));
+	}
 
-static void *lexer_json(struct lexer *lexer);
+	frame = &stream->frames[stream->depth++];
+	frame->descr = descr;
+	frame->descr_len = descr_len;
+	frame->val = val;
+	frame->count = count;
+	frame->decoded_fields = 0;
+	frame->type = type;
+	frame->field = -1;
+	frame->next_field = 0;
+
+	if (type == JSON_TOK_OBJECT_START) {
+		frame->expect = EXPECT_FIRST_KEY;
+	} else {
+		frame->expect = EXPECT_FIRST_ELEMENT;
+		*count = 0;
+	}
 
-static void emit(struct lexer *lexer, enum json_tokens token)
-{
-	lexer->token.type = token;
-	lexer->token.start = lexer->start;
-	lexer->token.end = lexer->pos;
-	lexer->start = lexer->pos;
+	return 0;
 }
 
-static char next(struct lexer *lexer)
+static int pop(struct json_obj_stream *stream)
 {
-	if (lexer->pos >= lexer->end) {
-		lexer->pos = lexer->end + 1;
+	struct json_parse_frame *frame = &stream->frames[--stream->depth];
+	struct json_parse_frame *parent;
 
-		return '\0';
+	/* Every field of an object must be present */
+	if (frame->type == JSON_TOK_OBJECT_START &&
+	    frame->decoded_fields != (1 << frame->descr_len) - 1) {
+		return -EINVAL;
 	}
 
-	return *lexer->pos++;
-}
+	if (!stream->depth) {
+		stream->done = true;
+		stream->result = frame->decoded_fields;
 
-static void ignore(struct lexer *lexer)
-{
-	lexer->start = lexer->pos;
-}
+		/* Stop the lexer */
+		return 1;
+	}
 
-static void backup(struct lexer *lexer)
-{
-	lexer->pos--;
+	parent = frame - 1;
+	if (parent->type == JSON_TOK_OBJECT_START) {
+		parent->decoded_fields |= 1 << parent->field;
+		parent->expect = EXPECT_OBJ_COMMA;
+	} else {
+		parent->expect = EXPECT_ARR_COMMA;
+	}
+
+	return 0;
 }
 
-static char peek(struct lexer *lexer)
+/* Release the storage of a string that is not kept */
+static void drop_string(struct json_obj_stream *stream, struct token *token)
 {
-	char chr = next(lexer);
-
-	backup(lexer);
-
-	return chr;
+	if (token->type == JSON_TOK_STRING && !stream->in_place) {
+		stream->storage_used = token->start - stream->storage;
+	}
 }
 
-static void *lexer_string(struct lexer *lexer)
+static int find_field(struct json_parse_frame *frame, const char *key,
+		      size_t len)
 {
-	ignore(lexer);
+	uint32_t hash = JSON_FIELD_HASH(key, len);
+	const struct json_obj_descr *descr;
+	size_t probe;
+	size_t i;
 
-	while (true) {
-		char chr = next(lexer);
+	/* Keys usually come in the order of the descriptors: start with
+	 * the field following the last one matched, so that in that case
+	 * the first probe matches.
+	 */
+	for (probe = 0, i = frame->next_field; probe < frame->descr_len;
+	     probe++, i = (i + 1 == frame->descr_len) ? 0 : i + 1) {
+		descr = &frame->descr[i];
 
-		if (chr == '\0') {
-			emit(lexer, JSON_TOK_ERROR);
-			return NULL;
+		/* Field has been decoded already, skip */
+		if (frame->decoded_fields & (1 << i)) {
+			continue;
 		}
 
-		if (chr == '\\') {
-			switch (next(lexer)) {
-			case '"':
-			case '\\':
-			case '/':
-			case 'b':
-			case 'f':
-			case 'n':
-			case 'r':
-			case 't':
-				continue;
-			case 'u':
-				if (!isxdigit(next(lexer))) {
-					goto error;
-				}
-
-				if (!isxdigit(next(lexer))) {
-					goto error;
-				}
-
-				if (!isxdigit(next(lexer))) {
-					goto error;
-				}
-
-				if (!isxdigit(next(lexer))) {
-					goto error;
-				}
-
-				break;
-			default:
-				goto error;
-			}
+		if (descr->field_name_hash && descr->field_name_hash != hash) {
+			continue;
 		}
 
-		if (chr == '"') {
-			backup(lexer);
-			emit(lexer, JSON_TOK_STRING);
+		if (len != descr->field_name_len ||
+		    memcmp(key, descr->field_name, len)) {
+			continue;
+		}
 
-			next(lexer);
-			ignore(lexer);
+		frame->next_field = i + 1 == frame->descr_len ? 0 : i + 1;
 
-			return lexer_json;
-		}
+		return i;
 	}
 
-error:
-	emit(lexer, JSON_TOK_ERROR);
-	return NULL;
+	return -1;
 }
 
-static void *lexer_boolean(struct lexer *lexer)
+static int parse_value(struct json_obj_stream *stream,
+		       struct json_parse_frame *frame, struct token *token)
 {
-	backup(lexer);
+	struct json_obj_descr element;
+	const struct json_obj_descr *descr;
+	char *field;
 
-	switch (next(lexer)) {
-	case 't':
-		if (next(lexer) != 'r') {
-			goto error;
-		}
+	switch (token->type) {
+	case JSON_TOK_OBJECT_START:
+	case JSON_TOK_ARRAY_START:
+	case JSON_TOK_STRING:
+	case JSON_TOK_NUMBER:
+	case JSON_TOK_TRUE:
+	case JSON_TOK_FALSE:
+	case JSON_TOK_NULL:
+		break;
+	default:
+		return -EINVAL;
+	}
 
-		if (next(lexer) != 'u') {
-			goto error;
-		}
+	if (frame->type == JSON_TOK_OBJECT_START) {
+		frame->expect = EXPECT_OBJ_COMMA;
 
-		if (next(lexer) != 'e') {
-			goto error;
-		}
+		/* Unknown key: skip its value */
+		if (frame->field < 0) {
+			if (token->type == JSON_TOK_OBJECT_START ||
+			    token->type == JSON_TOK_ARRAY_START) {
+				stream->skip_depth = 1;
+			}
 
-		emit(lexer, JSON_TOK_TRUE);
-		return lexer_json;
-	case 'f':
-		if (next(lexer) != 'a') {
-			goto error;
-		}
+			drop_string(stream, token);
 
-		if (next(lexer) != 'l') {
-			goto error;
+			return 0;
 		}
 
-		if (next(lexer) != 's') {
-			goto error;
-		}
+		descr = &frame->descr[frame->field];
+		field = frame->val + descr->offset;
+	} else {
+		frame->expect = EXPECT_ARR_COMMA;
 
-		if (next(lexer) != 'e') {
-			goto error;
+		if (*frame->count == frame->descr->array.max_elements) {
+			return -ENOSPC;
 		}
 
-		emit(lexer, JSON_TOK_FALSE);
-		return lexer_json;
-	}
-
-error:
-	emit(lexer, JSON_TOK_ERROR);
-	return NULL;
-}
-
-static void *lexer_null(struct lexer *lexer)
-{
-	if (next(lexer) != 'u') {
-		goto error;
-	}
+		element.type = frame->descr->array.element_type;
+		element.object.sub_descr = frame->descr->array.element_descr;
+		element.object.sub_descr_len =
+			frame->descr->array.element_descr_len;
 
-	if (next(lexer) != 'l') {
-		goto error;
+		descr = &element;
+		field = frame->val +
+			*frame->count * frame->descr->array.element_size;
+		(*frame->count)++;
 	}
 
-	if (next(lexer) != 'l') {
-		goto error;
+	/* Is the value of the expected type? */
+	if (!equivalent_types(token->type, descr->type)) {
+		return -EINVAL;
 	}
 
-	emit(lexer, JSON_TOK_NULL);
-	return lexer_json;
-
-error:
-	emit(lexer, JSON_TOK_ERROR);
-	return NULL;
-}
+	/* Store the decoded value */
+	switch (descr->type) {
+	case JSON_TOK_OBJECT_START:
+		return push(stream, JSON_TOK_OBJECT_START,
+			    descr->object.sub_descr,
+			    descr->object.sub_descr_len, field, NULL);
+	case JSON_TOK_ARRAY_START:
+		/* Arrays of arrays are not supported */
+		if (descr == &element) {
+			return -EINVAL;
+		}
 
+		return push(stream, JSON_TOK_ARRAY_START, descr, 1, field,
+			    (size_t *)(frame->val +
+				       descr->array.count_offset));
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE: {
+		bool *flag = (bool *)field;
 
-static void *lexer_number(struct lexer *lexer)
-{
-	while (true) {
-		char chr = next(lexer);
+		*flag = token->type == JSON_TOK_TRUE;
+		break;
+	}
+	case JSON_TOK_NUMBER: {
+		int32_t *num = (int32_t *)field;
 
-		if (isdigit(chr) || chr == '.') {
-			continue;
-		}
+		*num = token->num;
+		break;
+	}
+	case JSON_TOK_STRING: {
+		char **str = (char **)field;
 
-		backup(lexer);
-		emit(lexer, JSON_TOK_NUMBER);
+		/* Strings copied to the storage are terminated already */
+		token->start[token->len] = '\0';
+		*str = token->start;
+		break;
+	}
+	default:
+		return -EINVAL;
+	}
 
-		return lexer_json;
+	if (frame->type == JSON_TOK_OBJECT_START) {
+		frame->decoded_fields |= 1 << frame->field;
 	}
+
+	return 0;
 }
 
-static void *lexer_json(struct lexer *lexer)
+static int parse_token(struct json_obj_stream *stream, struct token *token)
 {
-	while (true) {
-		char chr = next(lexer);
-
-		switch (chr) {
-		case '\0':
-			emit(lexer, JSON_TOK_EOF);
-			return NULL;
-		case '}':
-		case '{':
-		case ',':
-		case ':':
-			emit(lexer, (enum json_tokens)chr);
-			return lexer_json;
-		case '"':
-			return lexer_string;
-		case 'n':
-			return lexer_null;
-		case 't':
-		case 'f':
-			return lexer_boolean;
-		case '-':
-			if (isdigit(peek(lexer))) {
-				return lexer_number;
+	struct json_parse_frame *frame;
+	int field;
+
+	if (stream->skip_depth) {
+		switch (token->type) {
+		case JSON_TOK_OBJECT_START:
+		case JSON_TOK_ARRAY_START:
+			if (stream->skip_depth == JSON_MAX_SKIP_DEPTH) {
+				return -EINVAL;
 			}
 
-			/* fallthrough */
+			stream->skip_depth++;
+			break;
+		case JSON_TOK_OBJECT_END:
+		case JSON_TOK_ARRAY_END:
+			stream->skip_depth--;
+			break;
 		default:
-			if (isspace(chr)) {
-				continue;
-			}
-
-			if (isdigit(chr)) {
-				return lexer_number;
-			}
-
-			emit(lexer, JSON_TOK_ERROR);
-			return NULL;
+			drop_string(stream, token);
+			break;
 		}
-	}
-}
 
-static void lexer_init(struct lexer *lexer, char *data, size_t len)
-{
-	lexer->state = lexer_json;
-	lexer->start = data;
-	lexer->pos = data;
-	lexer->end = data + len;
-	lexer->token.type = JSON_TOK_NONE;
-}
+		return 0;
+	}
 
-static int obj_init(struct json_obj *json, char *data, size_t len)
-{
-	struct token token;
+	if (!stream->depth) {
+		if (token->type != JSON_TOK_OBJECT_START) {
+			return -EINVAL;
+		}
 
-	lexer_init(&json->lexer, data, len);
+		stream->depth = 1;
+		stream->frames[0].expect = EXPECT_FIRST_KEY;
 
-	if (!lexer_next(&json->lexer, &token)) {
-		return -EINVAL;
+		return 0;
 	}
 
-	if (token.type != JSON_TOK_OBJECT_START) {
-		return -EINVAL;
-	}
+	frame = &stream->frames[stream->depth - 1];
 
-	return 0;
-}
+	switch (frame->expect) {
+	case EXPECT_FIRST_KEY:
+		if (token->type == JSON_TOK_OBJECT_END) {
+			return pop(stream);
+		}
 
-static int obj_next(struct json_obj *json, struct json_obj_key_value *kv)
-{
-	struct token token;
+		/* fallthrough */
+	case EXPECT_KEY:
+		if (token->type != JSON_TOK_STRING) {
+			return -EINVAL;
+		}
 
-	if (!lexer_next(&json->lexer, &token)) {
-		return -EINVAL;
-	}
+		field = find_field(frame, token->start, token->len);
+		frame->field = field;
+		frame->expect = EXPECT_COLON;
 
-	/* Match end of object or next key */
-	switch (token.type) {
-	case JSON_TOK_OBJECT_END:
-		kv->key = NULL;
-		kv->key_len = 0;
-		kv->value = token;
+		drop_string(stream, token);
 
 		return 0;
-	case JSON_TOK_COMMA:
-		if (!lexer_next(&json->lexer, &token)) {
+	case EXPECT_COLON:
+		if (token->type != JSON_TOK_COLON) {
 			return -EINVAL;
 		}
 
-		if (token.type != JSON_TOK_STRING) {
+		frame->expect = EXPECT_VALUE;
+
+		return 0;
+	case EXPECT_OBJ_COMMA:
+		if (token->type == JSON_TOK_OBJECT_END) {
+			return pop(stream);
+		}
+
+		if (token->type != JSON_TOK_COMMA) {
 			return -EINVAL;
 		}
 
-		/* fallthrough */
-	case JSON_TOK_STRING:
-		kv->key = token.start;
-		kv->key_len = (size_t)(token.end - token.start);
-		break;
-	default:
-		return -EINVAL;
-	}
+		frame->expect = EXPECT_KEY;
 
-	/* Match : after key */
-	if (!lexer_next(&json->lexer, &token)) {
-		return -EINVAL;
-	}
+		return 0;
+	case EXPECT_FIRST_ELEMENT:
+		if (token->type == JSON_TOK_ARRAY_END) {
+			return pop(stream);
+		}
 
-	if (token.type != JSON_TOK_COLON) {
-		return -EINVAL;
-	}
+		/* fallthrough */
+	case EXPECT_VALUE:
+	case EXPECT_ELEMENT:
+		return parse_value(stream, frame, token);
+	case EXPECT_ARR_COMMA:
+		if (token->type == JSON_TOK_ARRAY_END) {
+			return pop(stream);
+		}
 
-	/* Match value */
-	if (!lexer_next(&json->lexer, &kv->value)) {
-		return -EINVAL;
-	}
+		if (token->type != JSON_TOK_COMMA) {
+			return -EINVAL;
+		}
+
+		frame->expect = EXPECT_ELEMENT;
 
-	switch (kv->value.type) {
-	case JSON_TOK_STRING:
-	case JSON_TOK_NUMBER:
-	case JSON_TOK_TRUE:
-	case JSON_TOK_FALSE:
-	case JSON_TOK_NULL:
 		return 0;
 	default:
 		return -EINVAL;
 	}
 }
 
-static int decode_num(const struct token *token, int32_t *num)
+/* Append a part of a string to the storage, when not parsing in place */
+static int store(struct json_obj_stream *stream, const char *data,
+		 size_t len)
 {
-	/* FIXME: strtod() is not available in newlib/minimal libc,
-	 * so using strtol() here; this means no floating point
-	 * numbers.
-	 */
-	char *endptr;
-	char prev_end;
-
-	prev_end = *token->end;
-	*token->end = '\0';
-
-	errno = 0;
-	*num = strtol(token->start, &endptr, 10);
-
-	*token->end = prev_end;
-
-	if (errno != 0) {
-		return -errno;
+	if (stream->in_place) {
+		return 0;
 	}
 
-	if (*endptr) {
-		return -EINVAL;
+	/* Keep room for the NUL terminator */
+	if (len >= stream->storage_size - stream->storage_used) {
+		return -ENOMEM;
 	}
 
+	memcpy(stream->storage + stream->storage_used, data, len);
+	stream->storage_used += len;
+
 	return 0;
 }
 
-static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
+static int emit(struct json_obj_stream *stream, enum json_tokens type)
 {
-	if (type1 == JSON_TOK_TRUE || type1 == JSON_TOK_FALSE) {
-		return type2 == JSON_TOK_TRUE || type2 == JSON_TOK_FALSE;
-	}
+	struct token token = { .type = type };
 
-	return type1 == type2;
+	return parse_token(stream, &token);
 }
 
-int json_obj_parse(char *payload, size_t len,
-		   const struct json_obj_descr *descr, size_t descr_len,
-		   void *val)
+static int emit_string(struct json_obj_stream *stream, char *end)
 {
-	struct json_obj obj;
-	struct json_obj_key_value kv;
-	int32_t decoded_fields = 0;
-	size_t i;
-	int ret;
+	struct token token = { .type = JSON_TOK_STRING, .start = stream->str };
 
-	assert(descr_len < (sizeof(decoded_fields) * CHAR_BIT - 1));
+	if (stream->in_place) {
+		token.len = end - stream->str;
+	} else {
+		token.len = stream->storage + stream->storage_used - stream->str;
+		stream->storage[stream->storage_used++] = '\0';
+	}
 
-	ret = obj_init(&obj, payload, len);
-	if (ret < 0) {
-		return ret;
+	return parse_token(stream, &token);
+}
+
+static int emit_number(struct json_obj_stream *stream)
+{
+	struct token token = { .type = JSON_TOK_NUMBER };
+
+	if (!stream->digits) {
+		return -EINVAL;
 	}
 
-	while (!obj_next(&obj, &kv)) {
-		if (kv.value.type == JSON_TOK_OBJECT_END) {
-			if (decoded_fields == (1 << descr_len) - 1) {
-				return decoded_fields;
-			}
+	token.num = stream->negative ? -(int32_t)(stream->num - 1) - 1 :
+				       (int32_t)stream->num;
 
-			return -EINVAL;
-		}
+	return parse_token(stream, &token);
+}
 
-		for (i = 0; i < descr_len; i++) {
-			void *field = (char *)val + descr[i].offset;
+static const char *literal(enum json_tokens type)
+{
+	switch (type) {
+	case JSON_TOK_TRUE:
+		return "true";
+	case JSON_TOK_FALSE:
+		return "false";
+	default:
+		return "null";
+	}
+}
 
-			/* Field has been decoded already, skip */
-			if (decoded_fields & (1 << i)) {
-				continue;
+/*
+ * Tokenizes the input and passes the tokens to the parser.  All the state
+ * is kept in the stream, so that a token can be split across buffers;
+ * strings, numbers and whitespace are scanned in tight loops.
+ */
+static int lex(struct json_obj_stream *stream, char *pos, char *end)
+{
+	enum lex_state state = stream->lex_state;
+	const char *lit;
+	char *run;
+	int ret = 0;
+	char chr;
+
+	while (pos < end && !ret) {
+		switch (state) {
+		case LEX_JSON:
+			chr = *pos++;
+
+			switch (chr) {
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ',':
+			case ':':
+				ret = emit(stream, (enum json_tokens)chr);
+				break;
+			case '"':
+				stream->str = stream->in_place ? pos :
+					stream->storage + stream->storage_used;
+				state = LEX_STRING;
+				break;
+			case 't':
+			case 'f':
+			case 'n':
+				stream->num = chr;
+				stream->lit_pos = 1;
+				state = LEX_LITERAL;
+				break;
+			case '-':
+			case '0' ... '9':
+				stream->negative = chr == '-';
+				stream->digits = !stream->negative;
+				stream->num = stream->negative ? 0 : chr - '0';
+				state = LEX_NUMBER;
+				break;
+			default:
+				ret = -EINVAL;
+				break;
 			}
 
-			/* Check if it's the i-th field */
-			if (kv.key_len != descr[i].field_name_len) {
-				continue;
+			break;
+		case LEX_STRING:
+			for (run = pos; pos < end && *pos != '"' &&
+			     *pos != '\\'; pos++) {
 			}
 
-			if (memcmp(kv.key, descr[i].field_name,
-				    descr[i].field_name_len)) {
-				continue;
+			ret = store(stream, run, pos - run);
+			if (ret < 0 || pos == end) {
+				break;
 			}
 
-			/* Is the value of the expected type? */
-			if (!equivalent_types(kv.value.type, descr[i].type)) {
-				return -EINVAL;
+			if (*pos == '\\') {
+				state = LEX_ESCAPE;
+				ret = store(stream, pos++, 1);
+				break;
 			}
 
-			/* Store the decoded value */
-			switch (descr[i].type) {
-			case JSON_TOK_FALSE:
-			case JSON_TOK_TRUE: {
-				bool *value = field;
+			state = LEX_JSON;
+			ret = emit_string(stream, pos++);
+			break;
+		case LEX_ESCAPE:
+			switch (*pos) {
+			case '"':
+			case '\\':
+			case '/':
+			case 'b':
+			case 'f':
+			case 'n':
+			case 'r':
+			case 't':
+				state = LEX_STRING;
+				break;
+			case 'u':
+				stream->hex_left = 4;
+				state = LEX_UNICODE;
+				break;
+			default:
+				return -EINVAL;
+			}
 
-				*value = descr[i].type == JSON_TOK_TRUE;
+			ret = store(stream, pos++, 1);
+			break;
+		case LEX_UNICODE:
+			if (!isxdigit((unsigned char)*pos)) {
+				return -EINVAL;
+			}
 
-				break;
+			if (!--stream->hex_left) {
+				state = LEX_STRING;
 			}
-			case JSON_TOK_NUMBER: {
-				int32_t *num = field;
 
-				if (decode_num(&kv.value, num) < 0) {
+			ret = store(stream, pos++, 1);
+			break;
+		case LEX_NUMBER:
+			for (; pos < end && *pos >= '0' && *pos <= '9'; pos++) {
+				/* Up to 2^31, for INT32_MIN */
+				if (stream->num > (1U << 31) / 10 ||
+				    stream->num * 10 + (*pos - '0') >
+				    (1U << 31) - !stream->negative) {
 					return -EINVAL;
 				}
 
-				break;
+				stream->num = stream->num * 10 + (*pos - '0');
+				stream->digits = true;
 			}
-			case JSON_TOK_STRING: {
-				char **str = field;
-
-				*kv.value.end = '\0';
-				*str = kv.value.start;
 
+			if (pos == end) {
 				break;
 			}
-			default:
+
+			/* Only integers are supported */
+			if (*pos == '.' || *pos == 'e' || *pos == 'E') {
 				return -EINVAL;
 			}
 
-			decoded_fields |= 1<<i;
+			state = LEX_JSON;
+			ret = emit_number(stream);
+			break;
+		case LEX_LITERAL:
+			lit = literal((enum json_tokens)stream->num);
+
+			for (; pos < end && lit[stream->lit_pos];
+			     pos++, stream->lit_pos++) {
+				if (*pos != lit[stream->lit_pos]) {
+					return -EINVAL;
+				}
+			}
+
+			if (lit[stream->lit_pos]) {
+				break;
+			}
+
+			state = LEX_JSON;
+			ret = emit(stream, (enum json_tokens)stream->num);
+			break;
 		}
 	}
 
-	return -EINVAL;
+	stream->lex_state = state;
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	return stream->done ? stream->result : -EAGAIN;
+}
+
+static void stream_init(struct json_obj_stream *stream,
+			const struct json_obj_descr *descr, size_t descr_len,
+			void *val)
+{
+	memset(stream, 0, sizeof(*stream));
+
+	/* The top-level frame, pushed by the opening brace */
+	stream->frames[0].descr = descr;
+	stream->frames[0].descr_len = descr_len;
+	stream->frames[0].val = val;
+	stream->frames[0].type = JSON_TOK_OBJECT_START;
+	stream->frames[0].field = -1;
+
+	assert(descr_len < (sizeof(stream->frames[0].decoded_fields) *
+			    CHAR_BIT - 1));
+}
+
+void json_obj_stream_init(struct json_obj_stream *stream,
+			  const struct json_obj_descr *descr, size_t descr_len,
+			  void *val, char *storage, size_t storage_size)
+{
+	stream_init(stream, descr, descr_len, val);
+
+	stream->storage = storage;
+	stream->storage_size = storage_size;
+}
+
+int json_obj_stream_parse(struct json_obj_stream *stream, const char *data,
+			  size_t len)
+{
+	if (stream->done) {
+		return stream->result;
+	}
+
+	/* Input is only written to when parsing in place */
+	return lex(stream, (char *)data, (char *)data + len);
+}
+
+int json_obj_parse(char *payload, size_t len,
+		   const struct json_obj_descr *descr, size_t descr_len,
+		   void *val)
+{
+	struct json_obj_stream stream;
+	int ret;
+
+	/* The payload is all there: strings are terminated in place */
+	stream_init(&stream, descr, descr_len, val);
+	stream.in_place = true;
+
+	ret = lex(&stream, payload, payload + len);
+	if (ret == -EAGAIN) {
+		return -EINVAL;
+	}
+
+	return ret;
 }
 
 static const char escapable[] = "\"\\/\b\f\n\r\t";
@@ -562,3 +717,284 @@ ssize_t json_escape(char *str, size_t *len, size_t buf_size)
 
 	return json_escape_internal(str, len, escaped_len);
 }
+
+static int encode(const struct json_obj_descr *descr, const void *field,
+		  const void *val, json_append_bytes_t append_bytes,
+		  void *data);
+
+static int str_encode(const char *str, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	static const char hex[] = "0123456789abcdef";
+	const char *run;
+	char *escape;
+	char esc[6];
+	size_t esc_len;
+	int ret;
+
+	if (!str) {
+		return append_bytes("null", 4, data);
+	}
+
+	ret = append_bytes("\"", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Output the runs of characters not needing escaping at once */
+	for (run = str; *str; str++) {
+		escape = memchr(escapable, *str, sizeof(escapable) - 1);
+		if (escape) {
+			esc[0] = '\\';
+			esc[1] = "\"\\/bfnrt"[escape - escapable];
+			esc_len = 2;
+		} else if ((unsigned char)*str < 0x20) {
+			esc[0] = '\\';
+			esc[1] = 'u';
+			esc[2] = '0';
+			esc[3] = '0';
+			esc[4] = hex[*str >> 4];
+			esc[5] = hex[*str & 0xf];
+			esc_len = 6;
+		} else {
+			continue;
+		}
+
+		if (str > run) {
+			ret = append_bytes(run, str - run, data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		ret = append_bytes(esc, esc_len, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		run = str + 1;
+	}
+
+	if (str > run) {
+		ret = append_bytes(run, str - run, data);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return append_bytes("\"", 1, data);
+}
+
+static int num_encode(const int32_t *num, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	/* Sign and 10 digits */
+	char buf[11];
+	char *ptr = buf + sizeof(buf);
+	uint32_t value = *num < 0 ? -(uint32_t)*num : (uint32_t)*num;
+
+	do {
+		*--ptr = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	if (*num < 0) {
+		*--ptr = '-';
+	}
+
+	return append_bytes(ptr, buf + sizeof(buf) - ptr, data);
+}
+
+static int bool_encode(const bool *value, json_append_bytes_t append_bytes,
+		       void *data)
+{
+	if (*value) {
+		return append_bytes("true", 4, data);
+	}
+
+	return append_bytes("false", 5, data);
+}
+
+static int obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+		      const void *val, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	size_t i;
+	int ret;
+
+	ret = append_bytes("{", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < descr_len; i++) {
+		if (i > 0) {
+			ret = append_bytes(",", 1, data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		/* Field names are not escaped */
+		ret = append_bytes("\"", 1, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = append_bytes(descr[i].field_name,
+				   descr[i].field_name_len, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = append_bytes("\":", 2, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = encode(&descr[i], (const char *)val + descr[i].offset,
+			     val, append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return append_bytes("}", 1, data);
+}
+
+static int arr_encode(const struct json_obj_descr *descr, const void *field,
+		      const void *val, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	struct json_obj_descr element = {
+		.type = descr->array.element_type,
+	};
+	const char *ptr = field;
+	size_t count;
+	size_t i;
+	int ret;
+
+	element.object.sub_descr = descr->array.element_descr;
+	element.object.sub_descr_len = descr->array.element_descr_len;
+
+	count = *(const size_t *)((const char *)val +
+				  descr->array.count_offset);
+	if (count > descr->array.max_elements) {
+		return -EINVAL;
+	}
+
+	ret = append_bytes("[", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (i > 0) {
+			ret = append_bytes(",", 1, data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		ret = encode(&element, ptr, NULL, append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ptr += descr->array.element_size;
+	}
+
+	return append_bytes("]", 1, data);
+}
+
+static int encode(const struct json_obj_descr *descr, const void *field,
+		  const void *val, json_append_bytes_t append_bytes,
+		  void *data)
+{
+	switch (descr->type) {
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE:
+		return bool_encode(field, append_bytes, data);
+	case JSON_TOK_STRING:
+		return str_encode(*(char * const *)field, append_bytes, data);
+	case JSON_TOK_NUMBER:
+		return num_encode(field, append_bytes, data);
+	case JSON_TOK_OBJECT_START:
+		return obj_encode(descr->object.sub_descr,
+				  descr->object.sub_descr_len, field,
+				  append_bytes, data);
+	case JSON_TOK_ARRAY_START:
+		return arr_encode(descr, field, val, append_bytes, data);
+	default:
+		return -EINVAL;
+	}
+}
+
+int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+		    const void *val, json_append_bytes_t append_bytes,
+		    void *data)
+{
+	return obj_encode(descr, descr_len, val, append_bytes, data);
+}
+
+struct appender {
+	char *buffer;
+	size_t used;
+	size_t size;
+};
+
+static int append_bytes_to_buf(const char *bytes, size_t len, void *data)
+{
+	struct appender *appender = data;
+
+	/* Keep room for the NUL terminator */
+	if (len >= appender->size - appender->used) {
+		return -ENOMEM;
+	}
+
+	memcpy(appender->buffer + appender->used, bytes, len);
+	appender->used += len;
+
+	return 0;
+}
+
+int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
+			const void *val, char *buffer, size_t buf_size)
+{
+	struct appender appender = { .buffer = buffer, .size = buf_size };
+	int ret;
+
+	if (!buf_size) {
+		return -ENOMEM;
+	}
+
+	ret = json_obj_encode(descr, descr_len, val, append_bytes_to_buf,
+			      &appender);
+
+	buffer[appender.used] = '\0';
+
+	return ret;
+}
+
+static int measure_bytes(const char *bytes, size_t len, void *data)
+{
+	ssize_t *total = data;
+
+	*total += (ssize_t)len;
+
+	return 0;
+}
+
+ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val)
+{
+	ssize_t total = 0;
+	int ret;
+
+	ret = json_obj_encode(descr, descr_len, val, measure_bytes, &total);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return total;
+}
@@ -7,6 +7,7 @@
 #ifndef __JSON_H
 #define __JSON_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <sys/types.h>
@@ -15,6 +16,8 @@ enum json_tokens {
 	JSON_TOK_NONE = '_',
 	JSON_TOK_OBJECT_START = '{',
 	JSON_TOK_OBJECT_END = '}',
+	JSON_TOK_ARRAY_START = '[',
+	JSON_TOK_ARRAY_END = ']',
 	JSON_TOK_STRING = '"',
 	JSON_TOK_COLON = ':',
 	JSON_TOK_COMMA = ',',
@@ -29,37 +32,200 @@ enum json_tokens {
 struct json_obj_descr {
 	const char *field_name;
 	size_t field_name_len;
+
+	/* JSON_FIELD_HASH() of the field name, computed at build time by
+	 * the helper macros to match keys without comparing them; 0 if
+	 * not computed.
+	 */
+	uint32_t field_name_hash;
 	size_t offset;
 
 	/* Valid values here: JSON_TOK_STRING, JSON_TOK_NUMBER,
-	 * JSON_TOK_TRUE, JSON_TOK_FALSE. (All others ignored.)
+	 * JSON_TOK_TRUE (for booleans), JSON_TOK_OBJECT_START (for
+	 * nested objects), JSON_TOK_ARRAY_START (for arrays).
 	 */
 	enum json_tokens type;
+
+	union {
+		/* JSON_TOK_OBJECT_START: descriptor of the nested object */
+		struct {
+			const struct json_obj_descr *sub_descr;
+			size_t sub_descr_len;
+		} object;
+
+		/* JSON_TOK_ARRAY_START: the elements are stored in a C
+		 * array, and their number in a size_t field of the same
+		 * struct.  Elements are either all primitive values of
+		 * element_type, or all objects described by element_descr
+		 * if element_type is JSON_TOK_OBJECT_START.  Arrays of
+		 * arrays are not supported.
+		 */
+		struct {
+			const struct json_obj_descr *element_descr;
+			size_t element_descr_len;
+			enum json_tokens element_type;
+			size_t element_size;
+			size_t max_elements;
+			size_t count_offset;
+		} array;
+	};
 };
 
+/**
+ * @brief Hash of a key, from its length and three of its characters
+ *
+ * A constant expression when applied to a string literal, so that the
+ * descriptors carry the hash of their field name at no runtime cost.
+ * The parser computes the same from the keys it reads.
+ */
+#define JSON_FIELD_HASH(str_, len_) \
+	((len_) ? (uint32_t)(len_) ^ \
+		  ((uint32_t)(uint8_t)(str_)[0] << 8) ^ \
+		  ((uint32_t)(uint8_t)(str_)[(len_) / 2] << 16) ^ \
+		  ((uint32_t)(uint8_t)(str_)[(len_) - 1] << 24) : 0)
+
+#define __JSON_FIELD(struct_, field_name_) \
+	.field_name = (#field_name_), \
+	.field_name_len = sizeof(#field_name_) - 1, \
+	.field_name_hash = JSON_FIELD_HASH(#field_name_, \
+					   sizeof(#field_name_) - 1), \
+	.offset = offsetof(struct_, field_name_)
+
+#define __JSON_ARRAY_SIZE(array_) (sizeof(array_) / sizeof((array_)[0]))
+
+#define __JSON_MEMBER(struct_, field_name_) (((struct_ *)0)->field_name_)
+
+/**
+ * @brief Helper macro to declare a descriptor for a string, number or
+ * boolean field
+ *
+ * @param struct_ Struct holding the value
+ * @param field_name_ Field in the struct, also the name of the JSON key
+ * @param type_ JSON_TOK_STRING (char *), JSON_TOK_NUMBER (int32_t) or
+ * JSON_TOK_TRUE (bool)
+ */
+#define JSON_OBJ_DESCR_PRIM(struct_, field_name_, type_) \
+	{ \
+		__JSON_FIELD(struct_, field_name_), \
+		.type = type_, \
+	}
+
+/**
+ * @brief Helper macro to declare a descriptor for a nested object
+ *
+ * @param struct_ Struct holding the nested struct
+ * @param field_name_ Field in the struct, also the name of the JSON key
+ * @param sub_descr_ Array of descriptors of the nested struct
+ */
+#define JSON_OBJ_DESCR_OBJECT(struct_, field_name_, sub_descr_) \
+	{ \
+		__JSON_FIELD(struct_, field_name_), \
+		.type = JSON_TOK_OBJECT_START, \
+		.object = { \
+			.sub_descr = sub_descr_, \
+			.sub_descr_len = __JSON_ARRAY_SIZE(sub_descr_), \
+		}, \
+	}
+
+/**
+ * @brief Helper macro to declare a descriptor for an array of strings,
+ * numbers or booleans
+ *
+ * @param struct_ Struct holding the array
+ * @param field_name_ C array in the struct, also the name of the JSON key;
+ * its size is the maximum number of elements
+ * @param count_field_name_ size_t field of the struct holding the number of
+ * elements
+ * @param elem_type_ Type of the elements, as for JSON_OBJ_DESCR_PRIM()
+ */
+#define JSON_OBJ_DESCR_ARRAY(struct_, field_name_, count_field_name_, \
+			     elem_type_) \
+	{ \
+		__JSON_FIELD(struct_, field_name_), \
+		.type = JSON_TOK_ARRAY_START, \
+		.array = { \
+			.element_type = elem_type_, \
+			.element_size = \
+				sizeof(__JSON_MEMBER(struct_, field_name_)[0]), \
+			.max_elements = \
+				__JSON_ARRAY_SIZE(__JSON_MEMBER(struct_, \
+								field_name_)), \
+			.count_offset = offsetof(struct_, count_field_name_), \
+		}, \
+	}
+
+/**
+ * @brief Helper macro to declare a descriptor for an array of objects
+ *
+ * @param struct_ Struct holding the array
+ * @param field_name_ C array of structs in the struct, also the name of the
+ * JSON key; its size is the maximum number of elements
+ * @param count_field_name_ size_t field of the struct holding the number of
+ * elements
+ * @param elem_descr_ Array of descriptors of the element struct
+ */
+#define JSON_OBJ_DESCR_OBJ_ARRAY(struct_, field_name_, count_field_name_, \
+				 elem_descr_) \
+	{ \
+		__JSON_FIELD(struct_, field_name_), \
+		.type = JSON_TOK_ARRAY_START, \
+		.array = { \
+			.element_descr = elem_descr_, \
+			.element_descr_len = __JSON_ARRAY_SIZE(elem_descr_), \
+			.element_type = JSON_TOK_OBJECT_START, \
+			.element_size = \
+				sizeof(__JSON_MEMBER(struct_, field_name_)[0]), \
+			.max_elements = \
+				__JSON_ARRAY_SIZE(__JSON_MEMBER(struct_, \
+								field_name_)), \
+			.count_offset = offsetof(struct_, count_field_name_), \
+		}, \
+	}
+
+/**
+ * @brief Function called by the encoder to output the encoded bytes
+ *
+ * @param bytes Bytes to append, not NUL terminated
+ *
+ * @param len Number of bytes
+ *
+ * @param data Pointer given to json_obj_encode()
+ *
+ * @return 0 on success, or a negative errno code to stop the encoding
+ */
+typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
+				   void *data);
+
 /**
  * @brief Parses the JSON-encoded object pointer to by @param json, with
  * size @param len, according to the descriptor pointed to by @param descr.
  * Values are stored in a struct pointed to by @param val.  Set up the
  * descriptor like this:
  *
- *    struct s { int foo; char *bar; }
+ *    struct inner { int32_t baz; };
+ *    struct s {
+ *       int32_t foo;
+ *       char *bar;
+ *       struct inner in;
+ *       int32_t nums[4];
+ *       size_t nums_len;
+ *    };
+ *    struct json_obj_descr inner_descr[] = {
+ *       JSON_OBJ_DESCR_PRIM(struct inner, baz, JSON_TOK_NUMBER),
+ *    };
  *    struct json_obj_descr descr[] = {
- *       { .field_name = "foo",
- *         .field_name_len = 3,
- *         .offset = offsetof(struct s, foo),
- *         .type = JSON_TOK_NUMBER },
- *       { .field_name = "bar",
- *         .field_name_len = 3,
- *         .offset = offsetof(struct s, bar),
- *         .type = JSON_TOK_STRING }
+ *       JSON_OBJ_DESCR_PRIM(struct s, foo, JSON_TOK_NUMBER),
+ *       JSON_OBJ_DESCR_PRIM(struct s, bar, JSON_TOK_STRING),
+ *       JSON_OBJ_DESCR_OBJECT(struct s, in, inner_descr),
+ *       JSON_OBJ_DESCR_ARRAY(struct s, nums, nums_len, JSON_TOK_NUMBER),
  *    };
  *
  * Since this parser is designed for machine-to-machine communications,
  * some liberties were taken to simplify the design: (1) strings are not
  * unescaped; (2) no UTF-8 validation is performed; (3) only integer
- * numbers are supported; (4) nested objects are not supported, including
- * arrays and objects within objects.
+ * numbers are supported; (4) arrays of arrays are not supported.  Keys
+ * not in the descriptor are skipped, including those of nested objects
+ * and arrays.
  *
  * @param json Pointer to JSON-encoded value to be parsed
  *
@@ -75,11 +241,156 @@ struct json_obj_descr {
  *
  * @return < 0 if error, bitmap of decoded fields on success (bit 0
  * is set if first field in the descriptor has been properly decoded, etc).
+ * An array holding more elements than its C array returns -ENOSPC.
  */
 int json_obj_parse(char *json, size_t len,
 	const struct json_obj_descr *descr, size_t descr_len,
 	void *val);
 
+/* Maximum nesting of objects and arrays handled by the parser */
+#define JSON_MAX_DEPTH 8
+
+/* Maximum nesting of the skipped values of unknown keys */
+#define JSON_MAX_SKIP_DEPTH UINT8_MAX
+
+struct json_parse_frame {
+	/* Object: its descriptors; array: the descriptor of the array */
+	const struct json_obj_descr *descr;
+	size_t descr_len;
+	char *val;
+	size_t *count;
+	int32_t decoded_fields;
+	uint8_t type;
+	uint8_t expect;
+	int8_t field;
+	uint8_t next_field;
+};
+
+/**
+ * @brief State of a parse, possibly spanning several input buffers
+ *
+ * Opaque to the users of the library, who only allocate it.
+ */
+struct json_obj_stream {
+	struct json_parse_frame frames[JSON_MAX_DEPTH];
+	uint8_t depth;
+	uint8_t skip_depth;
+	bool done;
+	int32_t result;
+
+	/* Lexer */
+	uint8_t lex_state;
+	uint8_t lit_pos;
+	uint8_t hex_left;
+	bool negative;
+	bool digits;
+	uint32_t num;
+
+	/* Strings: in the input, or copied to the caller's storage */
+	char *str;
+	char *storage;
+	size_t storage_size;
+	size_t storage_used;
+	bool in_place;
+};
+
+/**
+ * @brief Starts parsing an object that arrives in several buffers
+ *
+ * Keys and strings are copied to @param storage as they are read, so that
+ * each input buffer can be reused once passed to json_obj_stream_parse();
+ * the strings stored in the struct pointed to by @param val point there.
+ * Keys are only stored until matched.
+ *
+ * @param stream Parse state to initialize
+ *
+ * @param descr Pointer to the descriptor array, as for json_obj_parse()
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @param storage Buffer holding the decoded strings, NUL terminated
+ *
+ * @param storage_size Size of the buffer
+ */
+void json_obj_stream_init(struct json_obj_stream *stream,
+			  const struct json_obj_descr *descr, size_t descr_len,
+			  void *val, char *storage, size_t storage_size);
+
+/**
+ * @brief Parses the next buffer of an object
+ *
+ * Tokens may be split across buffers.  Data following the end of the
+ * object is ignored.
+ *
+ * @param stream Parse state initialized by json_obj_stream_init()
+ *
+ * @param data Next bytes of the JSON-encoded object
+ *
+ * @param len Number of bytes
+ *
+ * @return -EAGAIN if the object is not complete yet, -ENOMEM if the
+ * strings do not fit in the storage, other errors as json_obj_parse(), or
+ * the bitmap of decoded fields once the object is complete
+ */
+int json_obj_stream_parse(struct json_obj_stream *stream, const char *data,
+			  size_t len);
+
+/**
+ * @brief Encodes the struct pointed to by @param val as a JSON object,
+ * according to the descriptor pointed to by @param descr
+ *
+ * The output is passed to @param append_bytes as it is produced, without
+ * an intermediate buffer, so that it can be written to a network buffer or
+ * a fixed buffer directly.  Strings are escaped, and NULL strings are
+ * encoded as null.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Pointer to the struct holding the values
+ *
+ * @param append_bytes Function called with the encoded bytes
+ *
+ * @param data Pointer passed to @param append_bytes
+ *
+ * @return 0 if the object has been encoded, or the negative errno code
+ * returned by @param append_bytes
+ */
+int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+		    const void *val, json_append_bytes_t append_bytes,
+		    void *data);
+
+/**
+ * @brief Encodes an object in a fixed buffer
+ *
+ * Same as json_obj_encode(), the output being stored in @param buffer and
+ * NUL terminated.
+ *
+ * @param buffer Buffer to store the encoded object
+ *
+ * @param buf_size Size of the buffer
+ *
+ * @return 0 if the object has been encoded, or -ENOMEM if the buffer is
+ * too small
+ */
+int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
+			const void *val, char *buffer, size_t buf_size);
+
+/**
+ * @brief Calculates the length of an encoded object
+ *
+ * Runs the encoder without storing its output, to size the buffer
+ * needed by json_obj_encode_buf() (which also needs room for the NUL
+ * terminator) or a payload length to send ahead of the object.
+ *
+ * @return The length of the encoded object, without NUL terminator
+ */
+ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val);
+
 /**
  * @brief Escapes the string so it can be used to encode JSON objects
  *
@@ -9,10 +9,19 @@
 #include <stdarg.h>
 #include <stdio.h>
 
-#define DESC(d) ((void *)d)
+#include <misc/printk.h>
 
-extern int _prf(int (*func)(), void *dest,
-				const char *format, va_list vargs);
+static int fprintf_out(const char *buf, size_t len, void *ctx)
+{
+	FILE *F = ctx;
+
+	while (len--) {
+		if (fputc(*buf++, F) == EOF) {
+			return EOF;
+		}
+	}
+	return 0;
+}
 
 int fprintf(FILE *_MLIBC_RESTRICT F, const char *_MLIBC_RESTRICT format, ...)
 {
@@ -20,7 +29,7 @@ int fprintf(FILE *_MLIBC_RESTRICT F, const char *_MLIBC_RESTRICT format, ...)
 	int     r;
 
 	va_start(vargs, format);
-	r = _prf(fputc, DESC(F), format, vargs);
+	r = _vprf(fprintf_out, F, format, vargs);
 	va_end(vargs);
 
 	return r;
@@ -31,7 +40,7 @@ int vfprintf(FILE *_MLIBC_RESTRICT F, const char *_MLIBC_RESTRICT format,
 {
 	int r;
 
-	r = _prf(fputc, DESC(F), format, vargs);
+	r = _vprf(fprintf_out, F, format, vargs);
 
 	return r;
 }
@@ -42,7 +51,7 @@ int printf(const char *_MLIBC_RESTRICT format, ...)
 	int     r;
 
 	va_start(vargs, format);
-	r = _prf(fputc, DESC(stdout), format, vargs);
+	r = _vprf(fprintf_out, stdout, format, vargs);
 	va_end(vargs);
 
 	return r;
@@ -52,7 +61,7 @@ int vprintf(const char *_MLIBC_RESTRICT format, va_list vargs)
 {
 	int r;
 
-	r = _prf(fputc, DESC(stdout), format, vargs);
+	r = _vprf(fprintf_out, stdout, format, vargs);
 
 	return r;
 }
@@ -8,21 +8,25 @@
 
 #include <stdarg.h>
 #include <stdio.h>
-
-extern int _prf(int (*func)(), void *dest,
-				const char *format, va_list vargs);
+#include <string.h>
+#include <misc/printk.h>
 
 struct emitter {
 	char *ptr;
 	int len;
 };
 
-static int sprintf_out(int c, struct emitter *p)
+static int sprintf_out(const char *buf, size_t len, void *ctx)
 {
+	struct emitter *p = ctx;
+
 	if (p->len > 1) { /* need to reserve a byte for EOS */
-		*(p->ptr) = c;
-		p->ptr += 1;
-		p->len -= 1;
+		if (len > (size_t)(p->len - 1)) {
+			len = p->len - 1;
+		}
+		memcpy(p->ptr, buf, len);
+		p->ptr += len;
+		p->len -= len;
 	}
 	return 0; /* indicate keep going so we get the total count */
 }
@@ -44,7 +48,7 @@ int snprintf(char *_MLIBC_RESTRICT s, size_t len,
 	p.len = (int) len;
 
 	va_start(vargs, format);
-	r = _prf(sprintf_out, (void *) (&p), format, vargs);
+	r = _vprf(sprintf_out, &p, format, vargs);
 	va_end(vargs);
 
 	*(p.ptr) = 0;
@@ -62,7 +66,7 @@ int sprintf(char *_MLIBC_RESTRICT s, const char *_MLIBC_RESTRICT format, ...)
 	p.len = (int) 0x7fffffff; /* allow up to "maxint" characters */
 
 	va_start(vargs, format);
-	r = _prf(sprintf_out, (void *) (&p), format, vargs);
+	r = _vprf(sprintf_out, &p, format, vargs);
 	va_end(vargs);
 
 	*(p.ptr) = 0;
@@ -83,7 +87,7 @@ int vsnprintf(char *_MLIBC_RESTRICT s, size_t len,
 	p.ptr = s;
 	p.len = (int) len;
 
-	r = _prf(sprintf_out, (void *) (&p), format, vargs);
+	r = _vprf(sprintf_out, &p, format, vargs);
 
 	*(p.ptr) = 0;
 	return r;
@@ -98,7 +102,7 @@ int vsprintf(char *_MLIBC_RESTRICT s, const char *_MLIBC_RESTRICT format,
 	p.ptr = s;
 	p.len = (int) 0x7fffffff; /* allow up to "maxint" characters */
 
-	r = _prf(sprintf_out, (void *) (&p), format, vargs);
+	r = _vprf(sprintf_out, &p, format, vargs);
 
 	*(p.ptr) = 0;
 	return r;
@@ -8,6 +8,23 @@
 
 #include <string.h>
 
+/*
+ * Word at a time helpers. Words may alias the bytes of any buffer. A word
+ * has a zero byte if subtracting one from every byte borrows into the top
+ * bit of a byte that had it clear.
+ */
+typedef unsigned int __attribute__((__may_alias__)) word_t;
+
+#define WORD_SIZE	sizeof(word_t)
+#define WORD_MASK	(WORD_SIZE - 1)
+#define ONES		0x01010101U
+#define HIGHS		0x80808080U
+
+#define ALIGNED(p)	((((unsigned int)(p)) & WORD_MASK) == 0)
+#define SAME_ALIGN(p, q) \
+	(((((unsigned int)(p)) ^ ((unsigned int)(q))) & WORD_MASK) == 0)
+#define HAS_ZERO(w)	(((w) - ONES) & ~(w) & HIGHS)
+
 /**
  *
  * @brief Copy a string
@@ -67,6 +84,19 @@ char *strncpy(char *_MLIBC_RESTRICT d, const char *_MLIBC_RESTRICT s, size_t n)
 char *strchr(const char *s, int c)
 {
 	char tmp = (char) c;
+	word_t mask = ONES * (unsigned char)tmp;
+	const word_t *w;
+
+	while (!ALIGNED(s) && (*s != tmp) && (*s != '\0'))
+		s++;
+
+	/* skip the words holding neither the byte nor the terminator */
+	if (ALIGNED(s)) {
+		for (w = (const word_t *)s; !HAS_ZERO(*w) && !HAS_ZERO(*w ^ mask);
+		     w++) {
+		}
+		s = (const char *)w;
+	}
 
 	while ((*s != tmp) && (*s != '\0'))
 		s++;
@@ -103,14 +133,24 @@ char *strrchr(const char *s, int c)
 
 size_t strlen(const char *s)
 {
-	size_t n = 0;
+	const char *end = s;
+	const word_t *w;
 
-	while (*s != '\0') {
-		s++;
-		n++;
+	while (!ALIGNED(end)) {
+		if (*end == '\0') {
+			return end - s;
+		}
+		end++;
+	}
+
+	/* skip the words without a terminator */
+	for (w = (const word_t *)end; !HAS_ZERO(*w); w++) {
 	}
 
-	return n;
+	for (end = (const char *)w; *end != '\0'; end++) {
+	}
+
+	return end - s;
 }
 
 /**
@@ -122,6 +162,29 @@ size_t strlen(const char *s)
 
 int strcmp(const char *s1, const char *s2)
 {
+	const word_t *w1, *w2;
+
+	if (SAME_ALIGN(s1, s2)) {
+		while (!ALIGNED(s1) && (*s1 == *s2) && (*s1 != '\0')) {
+			s1++;
+			s2++;
+		}
+
+		/* skip the equal words without a terminator */
+		if (ALIGNED(s1)) {
+			w1 = (const word_t *)s1;
+			w2 = (const word_t *)s2;
+
+			while ((*w1 == *w2) && !HAS_ZERO(*w1)) {
+				w1++;
+				w2++;
+			}
+
+			s1 = (const char *)w1;
+			s2 = (const char *)w2;
+		}
+	}
+
 	while ((*s1 == *s2) && (*s1 != '\0')) {
 		s1++;
 		s2++;
@@ -179,10 +242,34 @@ int memcmp(const void *m1, const void *m2, size_t n)
 {
 	const char *c1 = m1;
 	const char *c2 = m2;
+	const word_t *w1, *w2;
 
 	if (!n)
 		return 0;
 
+	/* skip the equal words, keeping at least one byte to compare */
+	if (SAME_ALIGN(c1, c2)) {
+		while (!ALIGNED(c1) && (n > 1) && (*c1 == *c2)) {
+			c1++;
+			c2++;
+			n--;
+		}
+
+		if (ALIGNED(c1)) {
+			w1 = (const word_t *)c1;
+			w2 = (const word_t *)c2;
+
+			while ((n > WORD_SIZE) && (*w1 == *w2)) {
+				w1++;
+				w2++;
+				n -= WORD_SIZE;
+			}
+
+			c1 = (const char *)w1;
+			c2 = (const char *)w2;
+		}
+	}
+
 	while ((--n > 0) && (*c1 == *c2)) {
 		c1++;
 		c2++;
@@ -203,18 +290,50 @@ void *memmove(void *d, const void *s, size_t n)
 	char *dest = d;
 	const char *src  = s;
 
-	if ((size_t) (d - s) < n) {
+	if ((size_t) (dest - src) < n) {
 		/*
 		 * The <src> buffer overlaps with the start of the <dest> buffer.
 		 * Copy backwards to prevent the premature corruption of <src>.
 		 */
 
+		if (SAME_ALIGN(dest, src)) {
+			while ((n > 0) && !ALIGNED(dest + n)) {
+				n--;
+				dest[n] = src[n];
+			}
+
+			while (n >= WORD_SIZE) {
+				n -= WORD_SIZE;
+				*(word_t *)(dest + n) = *(const word_t *)(src + n);
+			}
+		}
+
 		while (n > 0) {
 			n--;
 			dest[n] = src[n];
 		}
 	} else {
-		/* It is safe to perform a forward-copy */
+		/*
+		 * It is safe to perform a forward-copy, a word at a time too:
+		 * a word is read before the <dest> word overlapping it is
+		 * written.
+		 */
+		if (SAME_ALIGN(dest, src)) {
+			while ((n > 0) && !ALIGNED(dest)) {
+				*dest = *src;
+				dest++;
+				src++;
+				n--;
+			}
+
+			while (n >= WORD_SIZE) {
+				*(word_t *)dest = *(const word_t *)src;
+				dest += WORD_SIZE;
+				src += WORD_SIZE;
+				n -= WORD_SIZE;
+			}
+		}
+
 		while (n > 0) {
 			*dest = *src;
 			dest++;
@@ -226,6 +345,84 @@ void *memmove(void *d, const void *s, size_t n)
 	return d;
 }
 
+#if !defined(CONFIG_ARCH_HAS_MEMCPY)
+
+/* combine the end of a word and the start of the next, <shift> bits in */
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define MERGE(w, next, shift) \
+	(((w) << (shift)) | ((next) >> (WORD_SIZE * 8 - (shift))))
+#else
+#define MERGE(w, next, shift) \
+	(((w) >> (shift)) | ((next) << (WORD_SIZE * 8 - (shift))))
+#endif
+
+/**
+ *
+ * @brief Copy words from a word-aligned source
+ *
+ * @return number of bytes copied, a multiple of the word size
+ */
+
+static inline size_t copy_words(word_t *_MLIBC_RESTRICT d,
+				const word_t *_MLIBC_RESTRICT s, size_t n)
+{
+	word_t *start = d;
+
+	for (; n >= 4 * WORD_SIZE; n -= 4 * WORD_SIZE) {
+		d[0] = s[0];
+		d[1] = s[1];
+		d[2] = s[2];
+		d[3] = s[3];
+		d += 4;
+		s += 4;
+	}
+
+	for (; n >= WORD_SIZE; n -= WORD_SIZE) {
+		*(d++) = *(s++);
+	}
+
+	return (d - start) * WORD_SIZE;
+}
+
+/**
+ *
+ * @brief Copy words from a misaligned source
+ *
+ * Reads the aligned words holding the source bytes, and shifts them
+ * together into destination words. The aligned words read never extend
+ * past the ones holding the first and last source bytes.
+ *
+ * @return number of bytes copied, a multiple of the word size
+ */
+
+static inline size_t copy_shifted(word_t *_MLIBC_RESTRICT d,
+				  const unsigned char *_MLIBC_RESTRICT s,
+				  size_t n)
+{
+	unsigned int offset = (unsigned int)s & WORD_MASK;
+	unsigned int shift = offset * 8;
+	const word_t *s_word = (const word_t *)(s - offset);
+	word_t *start = d;
+	word_t w, next;
+
+	w = *(s_word++);
+
+	for (; n >= 2 * WORD_SIZE; n -= 2 * WORD_SIZE) {
+		next = *(s_word++);
+		d[0] = MERGE(w, next, shift);
+		w = *(s_word++);
+		d[1] = MERGE(next, w, shift);
+		d += 2;
+	}
+
+	if (n >= WORD_SIZE) {
+		next = *s_word;
+		*(d++) = MERGE(w, next, shift);
+	}
+
+	return (d - start) * WORD_SIZE;
+}
+
 /**
  *
  * @brief Copy bytes in memory
@@ -235,35 +432,31 @@ void *memmove(void *d, const void *s, size_t n)
 
 void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
 {
-	/* attempt word-sized copying only if buffers have identical alignment */
-
 	unsigned char *d_byte = (unsigned char *)d;
 	const unsigned char *s_byte = (const unsigned char *)s;
+	size_t copied;
 
-	if ((((unsigned int)d ^ (unsigned int)s_byte) & 0x3) == 0) {
+	if (n >= 2 * WORD_SIZE) {
 
-		/* do byte-sized copying until word-aligned or finished */
+		/* do byte-sized copying until the destination is word-aligned */
 
-		while (((unsigned int)d_byte) & 0x3) {
-			if (n == 0) {
-				return d;
-			}
+		while (!ALIGNED(d_byte)) {
 			*(d_byte++) = *(s_byte++);
 			n--;
-		};
+		}
 
 		/* do word-sized copying as long as possible */
 
-		unsigned int *d_word = (unsigned int *)d_byte;
-		const unsigned int *s_word = (const unsigned int *)s_byte;
-
-		while (n >= sizeof(unsigned int)) {
-			*(d_word++) = *(s_word++);
-			n -= sizeof(unsigned int);
+		if (ALIGNED(s_byte)) {
+			copied = copy_words((word_t *)d_byte,
+					    (const word_t *)s_byte, n);
+		} else {
+			copied = copy_shifted((word_t *)d_byte, s_byte, n);
 		}
 
-		d_byte = (unsigned char *)d_word;
-		s_byte = (unsigned char *)s_word;
+		d_byte += copied;
+		s_byte += copied;
+		n -= copied;
 	}
 
 	/* do byte-sized copying until finished */
@@ -276,6 +469,10 @@ void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
 	return d;
 }
 
+#endif /* !CONFIG_ARCH_HAS_MEMCPY */
+
+#if !defined(CONFIG_ARCH_HAS_MEMSET)
+
 /**
  *
  * @brief Set bytes in memory
@@ -300,15 +497,21 @@ void *memset(void *buf, int c, size_t n)
 
 	/* do word-sized initialization as long as possible */
 
-	unsigned int *d_word = (unsigned int *)d_byte;
-	unsigned int c_word = (unsigned int)(unsigned char)c;
+	word_t *d_word = (word_t *)d_byte;
+	word_t c_word = ONES * c_byte;
 
-	c_word |= c_word << 8;
-	c_word |= c_word << 16;
+	while (n >= 4 * WORD_SIZE) {
+		d_word[0] = c_word;
+		d_word[1] = c_word;
+		d_word[2] = c_word;
+		d_word[3] = c_word;
+		d_word += 4;
+		n -= 4 * WORD_SIZE;
+	}
 
-	while (n >= sizeof(unsigned int)) {
+	while (n >= WORD_SIZE) {
 		*(d_word++) = c_word;
-		n -= sizeof(unsigned int);
+		n -= WORD_SIZE;
 	}
 
 	/* do byte-sized initialization until finished */
@@ -323,6 +526,8 @@ void *memset(void *buf, int c, size_t n)
 	return buf;
 }
 
+#endif /* !CONFIG_ARCH_HAS_MEMSET */
+
 /**
  *
  * @brief Scan byte in memory
@@ -332,15 +537,28 @@ void *memset(void *buf, int c, size_t n)
 
 void *memchr(const void *s, unsigned char c, size_t n)
 {
-	if (n != 0) {
-		const unsigned char *p = s;
+	const unsigned char *p = s;
+	word_t mask = ONES * c;
+	const word_t *w;
 
-		do {
-			if (*p++ == c) {
-				return ((void *)(p - 1));
-			}
+	while ((n > 0) && !ALIGNED(p)) {
+		if (*p == c) {
+			return (void *)p;
+		}
+		p++;
+		n--;
+	}
 
-		} while (--n != 0);
+	/* skip the words without the byte */
+	for (w = (const word_t *)p; (n >= WORD_SIZE) && !HAS_ZERO(*w ^ mask);
+	     w++) {
+		n -= WORD_SIZE;
+	}
+
+	for (p = (const unsigned char *)w; n > 0; p++, n--) {
+		if (*p == c) {
+			return (void *)p;
+		}
 	}
 
 	return NULL;
@@ -0,0 +1,829 @@
+/*
+ * Copyright (c) 1997-2010, 2012-2015 Wind River Systems, Inc.
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Formatted output engine
+ *
+ * printk() and the printf() family of the minimal C library all format with
+ * _vprf(). Literal text, padding and converted fields are collected in a
+ * small buffer on the stack, and passed to the output function a chunk at a
+ * time rather than a character at a time.
+ *
+ * Decimal digits are extracted by multiplying by the reciprocal of ten with
+ * shifts and adds, which needs neither a hardware divider nor the division
+ * routines of libgcc, and is exact once the remainder is corrected.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <misc/printk.h>
+#include <misc/util.h>
+
+#ifndef EOF
+#define EOF  -1
+#endif
+
+/* characters passed to the output function at once, at most */
+#define CHUNK_SIZE	32
+
+/* length modifiers */
+enum {
+	LEN_NONE,
+	LEN_HH,
+	LEN_H,
+	LEN_L,
+	LEN_LL,
+};
+
+struct prf_state {
+	_prf_out_t out;
+	void *ctx;
+	int count;
+	int len;
+	bool error;
+	char buf[CHUNK_SIZE];
+};
+
+struct prf_spec {
+	bool minus;
+	bool plus;
+	bool space;
+	bool alt;
+	bool zero;
+	int width;
+	int precision;	/* negative if not specified */
+};
+
+static void flush(struct prf_state *st)
+{
+	if (st->len && !st->error && st->out(st->buf, st->len, st->ctx) < 0) {
+		st->error = true;
+	}
+
+	st->len = 0;
+}
+
+static void emit(struct prf_state *st, const char *s, int n)
+{
+	int chunk;
+
+	st->count += n;
+
+	while (n > 0) {
+		chunk = min(n, CHUNK_SIZE - st->len);
+		memcpy(&st->buf[st->len], s, chunk);
+		st->len += chunk;
+		s += chunk;
+		n -= chunk;
+
+		if (st->len == CHUNK_SIZE) {
+			flush(st);
+		}
+	}
+}
+
+static void emit_pad(struct prf_state *st, char c, int n)
+{
+	int chunk;
+
+	if (n <= 0) {
+		return;
+	}
+
+	st->count += n;
+
+	while (n > 0) {
+		chunk = min(n, CHUNK_SIZE - st->len);
+		memset(&st->buf[st->len], c, chunk);
+		st->len += chunk;
+		n -= chunk;
+
+		if (st->len == CHUNK_SIZE) {
+			flush(st);
+		}
+	}
+}
+
+/**
+ * @brief Output a field, justified in its width
+ *
+ * @param prefix Sign or radix prefix, before any zero padding
+ * @param zeros Number of zeros between the prefix and the body
+ */
+static void emit_field(struct prf_state *st, const struct prf_spec *spec,
+		       const char *prefix, int prefix_len, int zeros,
+		       const char *body, int body_len)
+{
+	int pad = spec->width - (prefix_len + zeros + body_len);
+
+	if (!spec->minus) {
+		emit_pad(st, ' ', pad);
+	}
+
+	emit(st, prefix, prefix_len);
+	emit_pad(st, '0', zeros);
+	emit(st, body, body_len);
+
+	if (spec->minus) {
+		emit_pad(st, ' ', pad);
+	}
+}
+
+/* n / 10, as n * 0.8 / 8 with the error corrected by the remainder */
+static inline uint32_t divu10(uint32_t n)
+{
+	uint32_t q, r;
+
+	q = (n >> 1) + (n >> 2);
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	q >>= 3;
+	r = n - ((q << 3) + (q << 1));
+
+	return q + (r > 9);
+}
+
+static inline uint64_t divu10_64(uint64_t n)
+{
+	uint64_t q, r;
+
+	q = (n >> 1) + (n >> 2);
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	q += q >> 32;
+	q >>= 3;
+	r = n - ((q << 3) + (q << 1));
+
+	return q + (r > 9);
+}
+
+/**
+ * @brief Convert a number to digits
+ *
+ * The digits are written backwards, ending at <end>.
+ *
+ * @return pointer to the first digit
+ */
+static char *to_digits(char *end, uint64_t value, int base, bool upper)
+{
+	const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	uint32_t v32, q32;
+	uint64_t q;
+
+	switch (base) {
+	case 10:
+		while (value > UINT32_MAX) {
+			q = divu10_64(value);
+			*--end = '0' + (value - ((q << 3) + (q << 1)));
+			value = q;
+		}
+
+		for (v32 = value; v32; v32 = q32) {
+			q32 = divu10(v32);
+			*--end = '0' + (v32 - ((q32 << 3) + (q32 << 1)));
+		}
+		break;
+	case 16:
+		for (; value; value >>= 4) {
+			*--end = digits[value & 0xf];
+		}
+		break;
+	default:
+		for (; value; value >>= 3) {
+			*--end = '0' + (value & 0x7);
+		}
+		break;
+	}
+
+	return end;
+}
+
+static void print_int(struct prf_state *st, const struct prf_spec *spec,
+		      uint64_t value, bool negative, int conv)
+{
+	/* 22 octal digits for 64 bits */
+	char digits[22];
+	char *end = digits + sizeof(digits);
+	char *start;
+	char prefix[2];
+	int prefix_len = 0;
+	int len, zeros;
+
+	if (negative) {
+		prefix[prefix_len++] = '-';
+	} else if (spec->plus && (conv == 'd' || conv == 'i')) {
+		prefix[prefix_len++] = '+';
+	} else if (spec->space && (conv == 'd' || conv == 'i')) {
+		prefix[prefix_len++] = ' ';
+	}
+
+	switch (conv) {
+	case 'o':
+		start = to_digits(end, value, 8, false);
+		break;
+	case 'x':
+	case 'X':
+	case 'p':
+		start = to_digits(end, value, 16, conv == 'X');
+		if ((spec->alt && value) || conv == 'p') {
+			prefix[prefix_len++] = '0';
+			prefix[prefix_len++] = conv == 'X' ? 'X' : 'x';
+		}
+		break;
+	default:
+		start = to_digits(end, value, 10, false);
+		break;
+	}
+
+	len = end - start;
+
+	/* a zero value converts to "0" unless the precision is zero */
+	zeros = (spec->precision < 0 ? 1 : spec->precision) - len;
+
+	/* the alternate octal form starts with a zero */
+	if (conv == 'o' && spec->alt && zeros <= 0 &&
+	    (len == 0 || *start != '0')) {
+		zeros = 1;
+	}
+
+	zeros = max(zeros, 0);
+
+	if (spec->zero && spec->precision < 0 && !spec->minus) {
+		zeros = max(zeros, spec->width - prefix_len - len);
+	}
+
+	emit_field(st, spec, prefix, prefix_len, zeros, start, len);
+}
+
+static void print_str(struct prf_state *st, const struct prf_spec *spec,
+		      const char *s)
+{
+	int len;
+
+	if (!s) {
+		s = "(null)";
+	}
+
+	if (spec->precision < 0) {
+		len = strlen(s);
+	} else {
+		for (len = 0; len < spec->precision && s[len]; len++) {
+		}
+	}
+
+	emit_field(st, spec, NULL, 0, 0, s, len);
+}
+
+#if defined(CONFIG_PRINTF_FLOAT)
+
+static	void _rlrshift(uint64_t *v)
+{
+	*v = (*v & 1) + (*v >> 1);
+}
+
+/* Tiny integer divide-by-five routine.  The full 64 bit division
+ * implementations in libgcc are very large on some architectures, and
+ * currently nothing in Zephyr pulls it into the link.  So it makes
+ * sense to define this much smaller special case here to avoid
+ * including it just for printf.
+ *
+ * It works by iteratively dividing the most significant 32 bits of
+ * the 64 bit value by 5.  This will leave a remainder of 0-4
+ * (i.e. three significant bits), ensuring that the top 29 bits of the
+ * remainder are zero for the next iteration.  Thus in the second
+ * iteration only 35 significant bits remain, and in the third only
+ * six.  This was tested exhaustively through the first ~10B values in
+ * the input space, and for ~2e12 (4 hours runtime) random inputs
+ * taken from the full 64 bit space.
+ */
+static void _ldiv5(uint64_t *v)
+{
+	uint32_t i, hi;
+	uint64_t rem = *v, quot = 0, q;
+	static const char shifts[] = { 32, 3, 0 };
+
+	/* Usage in this file wants rounded behavior, not truncation.  So add
+	 * two to get the threshold right.
+	 */
+	rem += 2;
+
+	for (i = 0; i < 3; i++) {
+		hi = rem >> shifts[i];
+		q = (uint64_t)(hi / 5) << shifts[i];
+		rem -= q * 5;
+		quot += q;
+	}
+
+	*v = quot;
+}
+
+static	char _get_digit(uint64_t *fr, int *digit_count)
+{
+	int		rval;
+
+	if (*digit_count > 0) {
+		*digit_count -= 1;
+		*fr = *fr * 10;
+		rval = ((*fr >> 60) & 0xF) + '0';
+		*fr &= 0x0FFFFFFFFFFFFFFFull;
+	} else
+		rval = '0';
+	return (char) (rval);
+}
+
+/*
+ *	_to_float
+ *
+ *	Convert a floating point # to ASCII.
+ *
+ *	Parameters:
+ *		"buf"		Buffer to write result into.
+ *		"double_temp"	# to convert (either IEEE single or double).
+ *		"c"		The conversion type (one of e,E,f,g,G).
+ *		"falt"		TRUE if "#" conversion flag in effect.
+ *		"fplus"		TRUE if "+" conversion flag in effect.
+ *		"fspace"	TRUE if " " conversion flag in effect.
+ *		"precision"	Desired precision (negative if undefined).
+ */
+
+/*
+ *	The following two constants define the simulated binary floating
+ *	point limit for the first stage of the conversion (fraction times
+ *	power of two becomes fraction times power of 10), and the second
+ *	stage (pulling the resulting decimal digits outs).
+ */
+
+#define	MAXFP1	0xFFFFFFFF	/* Largest # if first fp format */
+#define HIGHBIT64 (1ull<<63)
+
+static int _to_float(char *buf, uint64_t double_temp, int c,
+					 int falt, int fplus, int fspace, int precision)
+{
+	register int    decexp;
+	register int    exp;
+	int             sign;
+	int             digit_count;
+	uint64_t        fract;
+	uint64_t        ltemp;
+	int             prune_zero;
+	char           *start = buf;
+
+	exp = double_temp >> 52 & 0x7ff;
+	fract = (double_temp << 11) & ~HIGHBIT64;
+	sign = !!(double_temp & HIGHBIT64);
+
+
+	if (exp == 0x7ff) {
+		if (!fract) {
+			*buf++ = sign ? '-' : '+';
+			*buf++ = 'I';
+			*buf++ = 'N';
+			*buf++ = 'F';
+		} else {
+			*buf++ = 'N';
+			*buf++ = 'a';
+			*buf++ = 'N';
+		}
+		*buf = 0;
+		return buf - start;
+	}
+
+	if ((exp | fract) != 0) {
+		exp -= (1023 - 1);	/* +1 since .1 vs 1. */
+		fract |= HIGHBIT64;
+		decexp = true;		/* Wasn't zero */
+	} else
+		decexp = false;		/* It was zero */
+
+	if (decexp && sign) {
+		*buf++ = '-';
+	} else if (fplus) {
+		*buf++ = '+';
+	} else if (fspace) {
+		*buf++ = ' ';
+	}
+
+	decexp = 0;
+	while (exp <= -3) {
+		while ((fract >> 32) >= (MAXFP1 / 5)) {
+			_rlrshift(&fract);
+			exp++;
+		}
+		fract *= 5;
+		exp++;
+		decexp--;
+
+		while ((fract >> 32) <= (MAXFP1 / 2)) {
+			fract <<= 1;
+			exp--;
+		}
+	}
+
+	while (exp > 0) {
+		_ldiv5(&fract);
+		exp--;
+		decexp++;
+		while ((fract >> 32) <= (MAXFP1 / 2)) {
+			fract <<= 1;
+			exp--;
+		}
+	}
+
+	while (exp < (0 + 4)) {
+		_rlrshift(&fract);
+		exp++;
+	}
+
+	if (precision < 0)
+		precision = 6;		/* Default precision if none given */
+	prune_zero = false;		/* Assume trailing 0's allowed     */
+	if ((c == 'g') || (c == 'G')) {
+		if (!falt && (precision > 0))
+			prune_zero = true;
+		if ((decexp < (-4 + 1)) || (decexp > (precision + 1))) {
+			if (c == 'g')
+				c = 'e';
+			else
+				c = 'E';
+		} else
+			c = 'f';
+	}
+
+	if (c == 'f') {
+		exp = precision + decexp;
+		if (exp < 0)
+			exp = 0;
+	} else
+		exp = precision + 1;
+	digit_count = 16;
+	if (exp > 16)
+		exp = 16;
+
+	ltemp = 0x0800000000000000;
+	while (exp--) {
+		_ldiv5(&ltemp);
+		_rlrshift(&ltemp);
+	}
+
+	fract += ltemp;
+	if ((fract >> 32) & 0xF0000000) {
+		_ldiv5(&fract);
+		_rlrshift(&fract);
+		decexp++;
+	}
+
+	if (c == 'f') {
+		if (decexp > 0) {
+			while (decexp > 0) {
+				*buf++ = _get_digit(&fract, &digit_count);
+				decexp--;
+			}
+		} else
+			*buf++ = '0';
+		if (falt || (precision > 0))
+			*buf++ = '.';
+		while (precision-- > 0) {
+			if (decexp < 0) {
+				*buf++ = '0';
+				decexp++;
+			} else
+				*buf++ = _get_digit(&fract, &digit_count);
+		}
+	} else {
+		*buf = _get_digit(&fract, &digit_count);
+		if (*buf++ != '0')
+			decexp--;
+		if (falt || (precision > 0))
+			*buf++ = '.';
+		while (precision-- > 0)
+			*buf++ = _get_digit(&fract, &digit_count);
+	}
+
+	if (prune_zero) {
+		while (*--buf == '0')
+			;
+		if (*buf != '.')
+			buf++;
+	}
+
+	if ((c == 'e') || (c == 'E')) {
+		*buf++ = (char) c;
+		if (decexp < 0) {
+			decexp = -decexp;
+			*buf++ = '-';
+		} else
+			*buf++ = '+';
+		*buf++ = (char) ((decexp / 100) + '0');
+		decexp %= 100;
+		*buf++ = (char) ((decexp / 10) + '0');
+		decexp %= 10;
+		*buf++ = (char) (decexp + '0');
+	}
+	*buf = 0;
+
+	return buf - start;
+}
+
+/*
+ * Digits of the largest double, a point, the largest precision handled, a
+ * sign and an exponent.
+ */
+#define FLOAT_PRECISION_MAX	64
+#define FLOAT_BUF_SIZE		(309 + 1 + FLOAT_PRECISION_MAX + 8)
+
+/* in its own stack frame, only taken by floating point conversions */
+static void __attribute__((noinline)) print_float(struct prf_state *st,
+				   const struct prf_spec *spec,
+				   double value, int conv)
+{
+	char buf[FLOAT_BUF_SIZE];
+	union {
+		double d;
+		uint64_t i;
+	} u;
+	int len, prefix_len, zeros;
+
+	u.d = value;
+	len = _to_float(buf, u.i, conv, spec->alt, spec->plus, spec->space,
+			min(spec->precision, FLOAT_PRECISION_MAX));
+
+	prefix_len = (buf[0] == '-' || buf[0] == '+' || buf[0] == ' ');
+	zeros = 0;
+
+	/* infinities and NaNs are only padded with spaces */
+	if (spec->zero && !spec->minus && buf[prefix_len] >= '0' &&
+	    buf[prefix_len] <= '9') {
+		zeros = max(spec->width - len, 0);
+	}
+
+	emit_field(st, spec, buf, prefix_len, zeros, buf + prefix_len,
+		   len - prefix_len);
+}
+
+#endif /* CONFIG_PRINTF_FLOAT */
+
+static int atoi_adv(const char **fmt)
+{
+	int i = 0;
+
+	while (**fmt >= '0' && **fmt <= '9') {
+		i = 10 * i + *(*fmt)++ - '0';
+	}
+
+	return i;
+}
+
+/**
+ * @brief Format a string
+ *
+ * The C99 conversions are supported but %a, and the floating point ones
+ * only with CONFIG_PRINTF_FLOAT, else their argument is skipped and the
+ * conversion output as is. %p outputs the address in hex, with a 0x
+ * prefix, zero-padded to the size of a pointer.
+ *
+ * @param out Function passed the output a chunk at a time; returning a
+ *            negative value stops the output
+ * @param ctx Context passed to <out>
+ * @param fmt Format string
+ * @param ap Arguments
+ *
+ * @return Number of characters output, or EOF if <out> failed
+ */
+int _vprf(_prf_out_t out, void *ctx, const char *fmt, va_list ap)
+{
+	struct prf_state st;
+	struct prf_spec spec;
+	const char *lit;
+	uint64_t value;
+	int64_t svalue;
+	int length;
+	int c;
+
+	st.out = out;
+	st.ctx = ctx;
+	st.count = 0;
+	st.len = 0;
+	st.error = false;
+
+	while (*fmt) {
+		/* literal text up to the next conversion */
+		for (lit = fmt; *fmt && *fmt != '%'; fmt++) {
+		}
+		emit(&st, lit, fmt - lit);
+
+		if (!*fmt) {
+			break;
+		}
+
+		lit = fmt++;
+
+		memset(&spec, 0, sizeof(spec));
+		spec.precision = -1;
+
+		for (;; fmt++) {
+			if (*fmt == '-') {
+				spec.minus = true;
+			} else if (*fmt == '+') {
+				spec.plus = true;
+			} else if (*fmt == ' ') {
+				spec.space = true;
+			} else if (*fmt == '#') {
+				spec.alt = true;
+			} else if (*fmt == '0') {
+				spec.zero = true;
+			} else {
+				break;
+			}
+		}
+
+		if (*fmt == '*') {
+			spec.width = va_arg(ap, int);
+			if (spec.width < 0) {
+				spec.minus = true;
+				spec.width = -spec.width;
+			}
+			fmt++;
+		} else {
+			spec.width = atoi_adv(&fmt);
+		}
+
+		if (*fmt == '.') {
+			fmt++;
+			if (*fmt == '*') {
+				/* a negative precision is taken as omitted */
+				spec.precision = va_arg(ap, int);
+				spec.precision = max(spec.precision, -1);
+				fmt++;
+			} else {
+				spec.precision = atoi_adv(&fmt);
+			}
+		}
+
+		length = LEN_NONE;
+		switch (*fmt) {
+		case 'h':
+			length = (*++fmt == 'h') ? (fmt++, LEN_HH) : LEN_H;
+			break;
+		case 'l':
+			length = (*++fmt == 'l') ? (fmt++, LEN_LL) : LEN_L;
+			break;
+		case 'j':
+			length = LEN_LL;
+			fmt++;
+			break;
+		case 'z':
+		case 't':
+			length = sizeof(size_t) == sizeof(long long) ?
+				 LEN_LL : LEN_L;
+			fmt++;
+			break;
+		case 'L':
+			/* long double is passed as a double */
+			fmt++;
+			break;
+		}
+
+		c = *fmt++;
+
+		switch (c) {
+		case 'd':
+		case 'i':
+			if (length == LEN_LL) {
+				svalue = va_arg(ap, long long);
+			} else if (length == LEN_L) {
+				svalue = va_arg(ap, long);
+			} else {
+				svalue = va_arg(ap, int);
+				if (length == LEN_H) {
+					svalue = (short)svalue;
+				} else if (length == LEN_HH) {
+					svalue = (signed char)svalue;
+				}
+			}
+
+			value = svalue < 0 ? -(uint64_t)svalue : svalue;
+			print_int(&st, &spec, value, svalue < 0, c);
+			break;
+
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			if (length == LEN_LL) {
+				value = va_arg(ap, unsigned long long);
+			} else if (length == LEN_L) {
+				value = va_arg(ap, unsigned long);
+			} else {
+				value = va_arg(ap, unsigned int);
+				if (length == LEN_H) {
+					value = (unsigned short)value;
+				} else if (length == LEN_HH) {
+					value = (unsigned char)value;
+				}
+			}
+
+			print_int(&st, &spec, value, false, c);
+			break;
+
+		case 'p':
+			value = (uintptr_t)va_arg(ap, void *);
+			if (spec.precision < 0) {
+				spec.precision = 2 * sizeof(void *);
+			}
+
+			print_int(&st, &spec, value, false, c);
+			break;
+
+		case 'c': {
+			char ch = va_arg(ap, int);
+
+			emit_field(&st, &spec, NULL, 0, 0, &ch, 1);
+			break;
+		}
+
+		case 's':
+			print_str(&st, &spec, va_arg(ap, char *));
+			break;
+
+		case 'n':
+			*va_arg(ap, int *) = st.count;
+			break;
+
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+#if defined(CONFIG_PRINTF_FLOAT)
+			print_float(&st, &spec, va_arg(ap, double),
+				    c == 'F' ? 'f' : c);
+#else
+			(void)va_arg(ap, double);
+			emit(&st, lit, fmt - lit);
+#endif
+			break;
+
+		case '%':
+			emit(&st, "%", 1);
+			break;
+
+		case '\0':
+			/* a lone % ending the format */
+			fmt--;
+			emit(&st, lit, fmt - lit);
+			break;
+
+		default:
+			/* not a conversion, output as is */
+			emit(&st, lit, fmt - lit);
+			break;
+		}
+	}
+
+	flush(&st);
+
+	return st.error ? EOF : st.count;
+}
+
+struct char_out_ctx {
+	int (*func)(int c, void *ctx);
+	void *ctx;
+};
+
+static int char_out(const char *buf, size_t len, void *ctx)
+{
+	struct char_out_ctx *out = ctx;
+
+	while (len--) {
+		if (out->func(*buf++, out->ctx) == EOF) {
+			return EOF;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Format a string to a character output function
+ *
+ * Same as _vprf(), for output functions taking a character at a time.
+ *
+ * @return Number of characters output, or EOF if <func> returned EOF
+ */
+int _prf(int (*func)(), void *dest, const char *format, va_list vargs)
+{
+	struct char_out_ctx out = { func, dest };
+
+	return _vprf(char_out, &out, format, vargs);
+}
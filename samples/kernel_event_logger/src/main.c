@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * A producer thread passes items to a consumer thread through a FIFO,
+ * under a mutex, and signals them with a semaphore, while a collector
+ * thread dumps the kernel events this generates to the console. The dump
+ * is converted to a trace viewer timeline by
+ * scripts/kernel_event_trace.py.
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <logging/kernel_event_logger.h>
+
+/* size of stack area used by each thread */
+#define STACKSIZE 1024
+
+/* scheduling priority of the producer and consumer */
+#define PRIORITY 7
+
+/* delay between items (in ms) */
+#define SLEEPTIME 100
+
+struct item {
+	void *fifo_reserved;
+	uint32_t value;
+};
+
+static struct item items[4];
+
+K_FIFO_DEFINE(item_fifo);
+K_MUTEX_DEFINE(item_mutex);
+K_SEM_DEFINE(item_sem, 0, ARRAY_SIZE(items));
+
+static uint32_t total;
+
+void producer(void *dummy1, void *dummy2, void *dummy3)
+{
+	uint32_t value = 0;
+
+	ARG_UNUSED(dummy1);
+	ARG_UNUSED(dummy2);
+	ARG_UNUSED(dummy3);
+
+	while (1) {
+		struct item *item = &items[value % ARRAY_SIZE(items)];
+
+		item->value = value++;
+
+		k_mutex_lock(&item_mutex, K_FOREVER);
+		k_fifo_put(&item_fifo, item);
+		k_mutex_unlock(&item_mutex);
+
+		k_sem_give(&item_sem);
+		k_sleep(SLEEPTIME);
+	}
+}
+
+void consumer(void *dummy1, void *dummy2, void *dummy3)
+{
+	struct item *item;
+
+	ARG_UNUSED(dummy1);
+	ARG_UNUSED(dummy2);
+	ARG_UNUSED(dummy3);
+
+	while (1) {
+		k_sem_take(&item_sem, K_FOREVER);
+
+		k_mutex_lock(&item_mutex, K_FOREVER);
+		item = k_fifo_get(&item_fifo, K_NO_WAIT);
+		k_mutex_unlock(&item_mutex);
+
+		total += item->value;
+	}
+}
+
+K_THREAD_DEFINE(producer_id, STACKSIZE, producer, NULL, NULL, NULL,
+		PRIORITY, 0, K_NO_WAIT);
+K_THREAD_DEFINE(consumer_id, STACKSIZE, consumer, NULL, NULL, NULL,
+		PRIORITY - 1, 0, K_NO_WAIT);
+
+static void dump_thread(k_tid_t thread, const char *name)
+{
+	printk("KEL thread %08x %s\n", (uint32_t)thread, name);
+}
+
+/*
+ * Dump format, one line per record:
+ *   KEL clock <hardware cycles per second>
+ *   KEL thread <address> <name>
+ *   KEL event <id> <64-bit cycles> <dropped> <data words>...
+ */
+void collector(void *dummy1, void *dummy2, void *dummy3)
+{
+	extern k_tid_t const _main_thread;
+	extern k_tid_t const _idle_thread;
+	uint32_t data[4];
+	uint64_t cycles;
+	uint16_t event_id;
+	uint8_t dropped;
+	uint8_t size;
+	int i;
+
+	ARG_UNUSED(dummy1);
+	ARG_UNUSED(dummy2);
+	ARG_UNUSED(dummy3);
+
+	sys_k_event_logger_register_as_collector();
+
+	printk("KEL clock %u\n", sys_clock_hw_cycles_per_sec);
+	dump_thread(_main_thread, "main");
+	dump_thread(_idle_thread, "idle");
+	dump_thread(producer_id, "producer");
+	dump_thread(consumer_id, "consumer");
+
+	while (1) {
+		size = ARRAY_SIZE(data);
+		if (sys_k_event_logger_get_wait(&event_id, &dropped, data,
+						&size) < 0) {
+			continue;
+		}
+
+		cycles = sys_k_event_logger_get_timestamp();
+
+		printk("KEL event %u %08x%08x %u", event_id,
+		       (uint32_t)(cycles >> 32), (uint32_t)cycles, dropped);
+		for (i = 0; i < size; i++) {
+			printk(" %08x", data[i]);
+		}
+		printk("\n");
+	}
+}
+
+K_THREAD_DEFINE(collector_id, STACKSIZE, collector, NULL, NULL, NULL,
+		K_PRIO_COOP(PRIORITY), 0, K_NO_WAIT);
@@ -26,12 +26,17 @@ struct nats_info {
 	const char *version;
 	const char *go;
 	const char *host;
-	size_t max_payload;
-	uint16_t port;
+	int32_t max_payload;
+	int32_t port;
 	bool ssl_required;
 	bool auth_required;
 };
 
+struct nats_connect {
+	const char *user;
+	const char *pass;
+};
+
 struct io_vec {
 	const void *base;
 	size_t len;
@@ -122,30 +127,44 @@ static inline int transmit(struct net_context *conn, const char buffer[],
 	});
 }
 
-#define FIELD(struct_, member_, type_) { \
-	.field_name = #member_, \
-	.field_name_len = sizeof(#member_) - 1, \
-	.offset = offsetof(struct_, member_), \
-	.type = type_ \
+static const struct json_obj_descr nats_info_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct nats_info, server_id, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, version, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, go, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, host, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, port, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, auth_required, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, ssl_required, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, max_payload, JSON_TOK_NUMBER),
+};
+
+static const struct json_obj_descr nats_connect_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct nats_connect, user, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_connect, pass, JSON_TOK_STRING),
+};
+
+static int append_bytes_to_nbuf(const char *bytes, size_t len, void *data)
+{
+	struct net_buf *buf = data;
+
+	if (!net_nbuf_append(buf, len, (const uint8_t *)bytes, K_FOREVER)) {
+		return -ENOMEM;
+	}
+
+	return 0;
 }
+
 static int handle_server_info(struct nats *nats, char *payload, size_t len)
 {
-	static const struct json_obj_descr descr[] = {
-		FIELD(struct nats_info, server_id, JSON_TOK_STRING),
-		FIELD(struct nats_info, version, JSON_TOK_STRING),
-		FIELD(struct nats_info, go, JSON_TOK_STRING),
-		FIELD(struct nats_info, host, JSON_TOK_STRING),
-		FIELD(struct nats_info, port, JSON_TOK_NUMBER),
-		FIELD(struct nats_info, auth_required, JSON_TOK_TRUE),
-		FIELD(struct nats_info, ssl_required, JSON_TOK_TRUE),
-		FIELD(struct nats_info, max_payload, JSON_TOK_NUMBER),
-	};
 	struct nats_info info = {};
+	struct nats_connect connect;
+	struct net_buf *buf;
 	char user[32], pass[64];
-	size_t user_len = sizeof(user), pass_len = sizeof(pass);
+	size_t user_len = sizeof(user) - 1, pass_len = sizeof(pass) - 1;
 	int ret;
 
-	ret = json_obj_parse(payload, len, descr, ARRAY_SIZE(descr), &info);
+	ret = json_obj_parse(payload, len, nats_info_descr,
+			     ARRAY_SIZE(nats_info_descr), &info);
 	if (ret < 0) {
 		return -EINVAL;
 	}
@@ -167,25 +186,43 @@ static int handle_server_info(struct nats *nats, char *payload, size_t len)
 		return ret;
 	}
 
-	ret = json_escape(user, &user_len, sizeof(user));
-	if (ret < 0) {
-		return ret;
+	if (user_len >= sizeof(user) || pass_len >= sizeof(pass)) {
+		return -EINVAL;
+	}
+
+	user[user_len] = '\0';
+	pass[pass_len] = '\0';
+
+	connect.user = user;
+	connect.pass = pass;
+
+	buf = net_nbuf_get_tx(nats->conn, K_FOREVER);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	/* The encoder escapes the credentials, and writes the object in
+	 * the network buffer directly.
+	 */
+	ret = append_bytes_to_nbuf("CONNECT ", sizeof("CONNECT ") - 1, buf);
+	if (!ret) {
+		ret = json_obj_encode(nats_connect_descr,
+				      ARRAY_SIZE(nats_connect_descr), &connect,
+				      append_bytes_to_nbuf, buf);
+	}
+
+	if (!ret) {
+		ret = append_bytes_to_nbuf("\r\n", 2, buf);
 	}
 
-	ret = json_escape(pass, &pass_len, sizeof(pass));
 	if (ret < 0) {
+		net_nbuf_unref(buf);
+
 		return ret;
 	}
 
-	return transmitv(nats->conn, 5, (struct io_vec[]) {
-		TRANSMITV_LITERAL("CONNECT {\"user\":\""),
-		{ .base = user, .len = user_len },
-		TRANSMITV_LITERAL("\",\"pass\":\""),
-		{ .base = pass, .len = pass_len },
-		TRANSMITV_LITERAL("\"}\r\n"),
-	});
+	return net_context_send(buf, NULL, K_NO_WAIT, NULL, NULL);
 }
-#undef FIELD
 
 static bool char_in_set(char chr, const char *set)
 {
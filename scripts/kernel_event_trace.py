@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2017 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+"""Convert a kernel event logger dump to a trace viewer timeline
+
+Reads the console output of a collector dumping kernel events, like
+samples/kernel_event_logger, and writes them in the Trace Event Format,
+which chrome://tracing and other trace viewers load. Threads become
+tracks showing when they run, with their semaphore, mutex and queue
+operations, and each interrupt line a track showing its ISR runs.
+
+A context switch event records the thread switched out, so a thread is
+known to run from the previous context switch to the one switching it
+out, and the operations logged in between are shown on its track.
+
+Dump lines, anywhere in the console output:
+
+    KEL clock <hardware cycles per second>
+    KEL thread <address> <name>
+    KEL event <id> <64-bit cycles> <dropped> <data words>...
+
+all numbers but the clock rate, event ID and dropped count in hex.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+CONTEXT_SWITCH = 1
+INTERRUPT = 2
+SLEEP = 3
+SEMAPHORE = 4
+MUTEX = 5
+QUEUE = 6
+ISR_EXIT = 7
+
+EVENT_NAMES = {
+    CONTEXT_SWITCH: "context switch",
+    INTERRUPT: "interrupt",
+    SLEEP: "sleep",
+    SEMAPHORE: "semaphore",
+    MUTEX: "mutex",
+    QUEUE: "queue",
+    ISR_EXIT: "ISR exit",
+}
+
+OPS = {
+    SEMAPHORE: ("give", "take", "pend"),
+    MUTEX: ("unlock", "lock", "pend"),
+    QUEUE: ("put", "get", "pend"),
+}
+
+# process ID of the thread tracks, and of the interrupt tracks
+THREADS_PID = 1
+IRQS_PID = 2
+
+line_re = re.compile(r"KEL (clock|thread|event) (.*)$")
+
+
+class Converter:
+    def __init__(self):
+        self.hz = None
+        self.names = {}
+        self.trace = []
+        self.switched_at = None
+        self.pending = []
+        self.irqs = {}
+
+    def us(self, cycles):
+        if not self.hz:
+            sys.exit("no 'KEL clock' line before the first event")
+        return cycles * 1000000.0 / self.hz
+
+    def thread_tid(self, thread):
+        if thread not in self.names:
+            self.names[thread] = "thread %08x" % thread
+            self.metadata(THREADS_PID, thread, self.names[thread])
+        return thread
+
+    def metadata(self, pid, tid, name):
+        self.trace.append({"ph": "M", "name": "thread_name", "pid": pid,
+                           "tid": tid, "args": {"name": name}})
+
+    def instant(self, pid, tid, ts, name, args=None):
+        self.trace.append({"ph": "i", "s": "t", "name": name, "pid": pid,
+                           "tid": tid, "ts": ts, "args": args or {}})
+
+    def switched_out(self, tid, ts):
+        if self.switched_at is not None:
+            self.trace.append({"ph": "X", "name": "running",
+                               "pid": THREADS_PID, "tid": tid,
+                               "ts": self.switched_at,
+                               "dur": ts - self.switched_at})
+        for event in self.pending:
+            event["tid"] = tid
+        self.trace.extend(self.pending)
+        self.pending = []
+        self.switched_at = ts
+
+    def event(self, event_id, ts, dropped, data):
+        if dropped:
+            self.trace.append({"ph": "i", "s": "g", "ts": ts,
+                               "name": "%d %s events dropped" %
+                               (dropped, EVENT_NAMES.get(event_id, "?")),
+                               "pid": THREADS_PID, "tid": 0})
+
+        if event_id == CONTEXT_SWITCH:
+            self.switched_out(self.thread_tid(data[1]), ts)
+        elif event_id == INTERRUPT:
+            irq = data[1]
+            if irq not in self.irqs:
+                self.metadata(IRQS_PID, irq, "IRQ %d" % irq)
+            self.irqs[irq] = ts
+        elif event_id == ISR_EXIT:
+            irq = data[1]
+            start = self.irqs.pop(irq, None)
+            if start is not None:
+                self.trace.append({"ph": "X", "name": "ISR", "pid": IRQS_PID,
+                                   "tid": irq, "ts": start,
+                                   "dur": ts - start})
+        elif event_id in OPS:
+            op = OPS[event_id][data[2]] if data[2] < 3 else str(data[2])
+            # on the track of the thread running, known once switched out
+            self.pending.append({"ph": "i", "s": "t", "pid": THREADS_PID,
+                                 "name": "%s %s" % (EVENT_NAMES[event_id],
+                                                    op),
+                                 "ts": ts, "args": {"object":
+                                                    "%08x" % data[1]}})
+        elif event_id == SLEEP:
+            self.instant(THREADS_PID, 0, ts, "wake up",
+                         {"ticks slept": data[1], "IRQ": data[2]})
+        else:
+            self.instant(THREADS_PID, 0, ts, "event %d" % event_id,
+                         {"data": ["%08x" % d for d in data]})
+
+    def line(self, kind, fields):
+        if kind == "clock":
+            self.hz = int(fields[0])
+        elif kind == "thread":
+            thread = int(fields[0], 16)
+            self.names[thread] = fields[1]
+            self.metadata(THREADS_PID, thread, fields[1])
+        else:
+            data = [int(f, 16) for f in fields[3:]]
+            self.event(int(fields[0]), self.us(int(fields[1], 16)),
+                       int(fields[2]), data)
+
+    def finish(self):
+        # still running at the end of the dump
+        for event in self.pending:
+            event["tid"] = 0
+        self.trace.extend(self.pending)
+        self.metadata(THREADS_PID, 0, "kernel")
+        self.trace.append({"ph": "M", "name": "process_name",
+                           "pid": THREADS_PID, "args": {"name": "threads"}})
+        self.trace.append({"ph": "M", "name": "process_name",
+                           "pid": IRQS_PID, "args": {"name": "interrupts"}})
+        return {"traceEvents": self.trace, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", nargs="?", type=argparse.FileType("r"),
+                        default=sys.stdin,
+                        help="console output holding the dump (default: "
+                             "standard input)")
+    parser.add_argument("-o", "--output", type=argparse.FileType("w"),
+                        default=sys.stdout,
+                        help="JSON trace to write (default: standard "
+                             "output)")
+    args = parser.parse_args()
+
+    converter = Converter()
+    for text in args.dump:
+        match = line_re.search(text.strip())
+        if match:
+            converter.line(match.group(1), match.group(2).split())
+
+    json.dump(converter.finish(), args.output, indent=1)
+    args.output.write("\n")
+
+
+if __name__ == "__main__":
+    main()
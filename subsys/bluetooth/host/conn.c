@@ -15,6 +15,7 @@
 #include <misc/util.h>
 #include <misc/stack.h>
 #include <misc/__assert.h>
+#include <debug/perf_counter.h>
 
 #define BT_DBG_ENABLED IS_ENABLED(CONFIG_BLUETOOTH_DEBUG_CONN)
 #include <bluetooth/log.h>
@@ -853,6 +854,10 @@ static void bt_conn_reset_rx_state(struct bt_conn *conn)
 	conn->rx_len = 0;
 }
 
+PERF_COUNTER_DEFINE(bt_acl_rx_frags);
+PERF_COUNTER_DEFINE(bt_acl_tx_frags);
+PERF_HISTOGRAM_DEFINE(bt_acl_tx_wait_cycles);
+
 void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags)
 {
 	struct bt_l2cap_hdr *hdr;
@@ -860,6 +865,8 @@ void bt_conn_recv(struct bt_conn *conn, struct net_buf *buf, uint8_t flags)
 
 	BT_DBG("handle %u len %u flags %02x", conn->handle, buf->len, flags);
 
+	PERF_COUNTER_INC(bt_acl_rx_frags);
+
 	/* Check packet boundary flags */
 	switch (flags) {
 	case BT_ACL_START:
@@ -969,7 +976,9 @@ static bool send_frag(struct bt_conn *conn, struct net_buf *buf, uint8_t flags,
 	       flags);
 
 	/* Wait until the controller can accept ACL packets */
+	PERF_HISTOGRAM_START(bt_acl_tx_wait_cycles);
 	k_sem_take(bt_conn_get_pkts(conn), K_FOREVER);
+	PERF_HISTOGRAM_STOP(bt_acl_tx_wait_cycles);
 
 	/* Check for disconnection while waiting for pkts_sem */
 	if (conn->state != BT_CONN_CONNECTED) {
@@ -989,6 +998,7 @@ static bool send_frag(struct bt_conn *conn, struct net_buf *buf, uint8_t flags,
 	}
 
 	conn->pending_pkts++;
+	PERF_COUNTER_INC(bt_acl_tx_frags);
 	return true;
 
 fail:
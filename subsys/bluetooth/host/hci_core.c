@@ -15,6 +15,7 @@
 #include <misc/byteorder.h>
 #include <misc/stack.h>
 #include <misc/__assert.h>
+#include <debug/perf_counter.h>
 #include <soc.h>
 
 #define BT_DBG_ENABLED IS_ENABLED(CONFIG_BLUETOOTH_DEBUG_HCI_CORE)
@@ -3577,6 +3578,8 @@ int bt_send(struct net_buf *buf)
 	return bt_dev.drv->send(buf);
 }
 
+PERF_COUNTER_DEFINE(bt_hci_rx_events);
+
 int bt_recv(struct net_buf *buf)
 {
 	bt_monitor_send(bt_monitor_opcode(buf), buf->data, buf->len);
@@ -3600,6 +3603,7 @@ int bt_recv(struct net_buf *buf)
 		return 0;
 #endif /* BLUETOOTH_CONN */
 	case BT_BUF_EVT:
+		PERF_COUNTER_INC(bt_hci_rx_events);
 #if defined(CONFIG_BLUETOOTH_RECV_IS_RX_THREAD)
 		hci_event(buf);
 #else
@@ -31,9 +31,6 @@
 
 static struct device *monitor_dev;
 
-extern int _prf(int (*func)(), void *dest,
-		const char *format, va_list vargs);
-
 static void monitor_send(const void *data, size_t len)
 {
 	const uint8_t *buf = data;
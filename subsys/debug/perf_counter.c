@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Performance counters registry
+ *
+ * The counters and histograms are found between the start and end symbols
+ * of their sections, sorted by name by the linker.
+ */
+
+#include <string.h>
+#include <misc/printk.h>
+#include <shell/shell.h>
+#include <debug/perf_counter.h>
+
+extern struct perf_counter __perf_counter_start[];
+extern struct perf_counter __perf_counter_end[];
+
+#if defined(CONFIG_PERF_HISTOGRAMS)
+extern struct perf_histogram __perf_histogram_start[];
+extern struct perf_histogram __perf_histogram_end[];
+#endif
+
+void perf_counter_foreach(perf_counter_cb_t cb, void *user_data)
+{
+	struct perf_counter *counter;
+
+	for (counter = __perf_counter_start; counter < __perf_counter_end;
+	     counter++) {
+		cb(counter, user_data);
+	}
+}
+
+#if defined(CONFIG_PERF_HISTOGRAMS)
+void perf_histogram_foreach(perf_histogram_cb_t cb, void *user_data)
+{
+	struct perf_histogram *histogram;
+
+	for (histogram = __perf_histogram_start;
+	     histogram < __perf_histogram_end; histogram++) {
+		cb(histogram, user_data);
+	}
+}
+#endif
+
+void perf_snapshot(void)
+{
+	struct perf_counter *counter;
+
+	for (counter = __perf_counter_start; counter < __perf_counter_end;
+	     counter++) {
+		counter->snapshot = perf_counter_get(counter);
+	}
+
+#if defined(CONFIG_PERF_HISTOGRAMS)
+	{
+		struct perf_histogram *histogram;
+		int i;
+
+		for (histogram = __perf_histogram_start;
+		     histogram < __perf_histogram_end; histogram++) {
+			for (i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+				histogram->snapshot[i] =
+					atomic_get(&histogram->buckets[i]);
+			}
+		}
+	}
+#endif
+}
+
+#if defined(CONFIG_CONSOLE_SHELL)
+
+struct print_info {
+	/* only print the names starting with it, if not NULL */
+	const char *prefix;
+	/* print the difference with the snapshot */
+	bool diff;
+};
+
+static bool print_name(const char *name, struct print_info *info)
+{
+	return !info->prefix ||
+	       !strncmp(name, info->prefix, strlen(info->prefix));
+}
+
+static void print_counter(struct perf_counter *counter, void *user_data)
+{
+	struct print_info *info = user_data;
+	uint32_t value;
+
+	if (!print_name(counter->name, info)) {
+		return;
+	}
+
+	value = perf_counter_get(counter);
+	if (info->diff) {
+		value -= counter->snapshot;
+	}
+
+	shell_printk("%-32s %10u\n", counter->name, value);
+}
+
+#if defined(CONFIG_PERF_HISTOGRAMS)
+static void print_histogram(struct perf_histogram *histogram,
+			    void *user_data)
+{
+	struct print_info *info = user_data;
+	uint32_t samples[PERF_HISTOGRAM_BUCKETS];
+	uint32_t total = 0;
+	int i;
+
+	if (!print_name(histogram->name, info)) {
+		return;
+	}
+
+	for (i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+		samples[i] = atomic_get(&histogram->buckets[i]);
+		if (info->diff) {
+			samples[i] -= histogram->snapshot[i];
+		}
+
+		total += samples[i];
+	}
+
+	shell_printk("%s, %u samples, cycles:\n", histogram->name, total);
+
+	for (i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+		if (!samples[i]) {
+			continue;
+		}
+
+		if (!i) {
+			shell_printk("%22u %10u\n", 0, samples[i]);
+		} else if (i < PERF_HISTOGRAM_BUCKETS - 1) {
+			shell_printk("%10u - %9u %10u\n", 1 << (i - 1),
+				     (1 << i) - 1, samples[i]);
+		} else {
+			shell_printk("%10u - %9s %10u\n", 1 << (i - 1), "max",
+				     samples[i]);
+		}
+	}
+}
+#endif
+
+static void print(int argc, char *argv[], bool diff)
+{
+	struct print_info info = {
+		.prefix = argc > 1 ? argv[1] : NULL,
+		.diff = diff,
+	};
+
+	perf_counter_foreach(print_counter, &info);
+
+#if defined(CONFIG_PERF_HISTOGRAMS)
+	perf_histogram_foreach(print_histogram, &info);
+#endif
+}
+
+static int shell_cmd_list(int argc, char *argv[])
+{
+	print(argc, argv, false);
+
+	return 0;
+}
+
+static int shell_cmd_snapshot(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	perf_snapshot();
+
+	return 0;
+}
+
+static int shell_cmd_diff(int argc, char *argv[])
+{
+	print(argc, argv, true);
+
+	return 0;
+}
+
+static struct shell_cmd perf_commands[] = {
+	{ "list", shell_cmd_list,
+	  "[prefix], show the counters and histograms" },
+	{ "snapshot", shell_cmd_snapshot, "save the counters and histograms" },
+	{ "diff", shell_cmd_diff,
+	  "[prefix], show the changes since the snapshot" },
+	{ NULL, NULL, NULL }
+};
+
+SHELL_REGISTER("perf", perf_commands);
+
+#endif /* CONFIG_CONSOLE_SHELL */
@@ -12,11 +12,18 @@
 #include <errno.h>
 #include <device.h>
 #include <flash.h>
+#include <debug/perf_counter.h>
 
 #define SECTOR_SIZE 512
 
 static struct device *flash_dev;
 
+PERF_COUNTER_DEFINE(disk_sectors_read);
+PERF_COUNTER_DEFINE(disk_sectors_written);
+PERF_COUNTER_DEFINE(disk_block_updates);
+PERF_COUNTER_DEFINE(disk_block_partial_updates);
+PERF_HISTOGRAM_DEFINE(disk_block_update_cycles);
+
 /* flash read-copy-erase-write operation */
 static uint8_t read_copy_buf[CONFIG_DISK_ERASE_BLOCK_SIZE];
 static uint8_t *fs_buff = read_copy_buf;
@@ -77,6 +84,8 @@ int disk_access_read(uint8_t *buff, uint32_t start_sector,
 
 	num_read = GET_NUM_BLOCK(remaining, CONFIG_DISK_FLASH_MAX_RW_SIZE);
 
+	PERF_COUNTER_ADD(disk_sectors_read, sector_count);
+
 	for (uint32_t i = 0; i < num_read; i++) {
 		if (remaining < CONFIG_DISK_FLASH_MAX_RW_SIZE) {
 			len = remaining;
@@ -140,12 +149,16 @@ static int update_flash_block(off_t start_addr, uint32_t size, const void *buff)
 {
 	off_t fl_addr;
 	uint8_t *src = (uint8_t *)buff;
-	uint32_t num_write;
+	PERF_HISTOGRAM_START(disk_block_update_cycles);
+
+	PERF_COUNTER_INC(disk_block_updates);
 
 	/* if size is a partial block, perform read-copy with user data */
 	if (size < CONFIG_DISK_ERASE_BLOCK_SIZE) {
 		int rc;
 
+		PERF_COUNTER_INC(disk_block_partial_updates);
+
 		rc = read_copy_flash_block(start_addr, size, buff, fs_buff);
 		if (rc != 0) {
 			return -EIO;
@@ -165,23 +178,16 @@ static int update_flash_block(off_t start_addr, uint32_t size, const void *buff)
 		return -EIO;
 	}
 
-	/* write data to flash */
-	num_write = GET_NUM_BLOCK(CONFIG_DISK_ERASE_BLOCK_SIZE,
-				  CONFIG_DISK_FLASH_MAX_RW_SIZE);
-
-	for (uint32_t i = 0; i < num_write; i++) {
-		/* flash_write reenabled write-protection so disable it again */
-		flash_write_protection_set(flash_dev, false);
-
-		if (flash_write(flash_dev, fl_addr, src,
-				CONFIG_DISK_FLASH_MAX_RW_SIZE) != 0) {
-			return -EIO;
-		}
-
-		fl_addr += CONFIG_DISK_FLASH_MAX_RW_SIZE;
-		src += CONFIG_DISK_FLASH_MAX_RW_SIZE;
+	/* write data to flash, the driver splits it into program pages and
+	 * handles write-protection for the whole block
+	 */
+	if (flash_write_pages(flash_dev, fl_addr, src,
+			      CONFIG_DISK_ERASE_BLOCK_SIZE) != 0) {
+		return -EIO;
 	}
 
+	PERF_HISTOGRAM_STOP(disk_block_update_cycles);
+
 	return 0;
 }
 
@@ -195,6 +201,8 @@ int disk_access_write(const uint8_t *buff, uint32_t start_sector,
 	fl_addr = lba_to_address(start_sector);
 	remaining = (sector_count * SECTOR_SIZE);
 
+	PERF_COUNTER_ADD(disk_sectors_written, sector_count);
+
 	/* check if start address is erased-aligned address  */
 	if (fl_addr & (CONFIG_DISK_FLASH_ERASE_ALIGNMENT - 1)) {
 		off_t block_bnd;
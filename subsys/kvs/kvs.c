@@ -0,0 +1,901 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <misc/util.h>
+#include <device.h>
+#include <flash.h>
+#include <kvs.h>
+
+/*
+ * Flash layout
+ *
+ * Each sector starts with a sector header, followed by records appended
+ * back to back. A record is a record header followed by its data, padded
+ * to the flash write block size. A record of length 0 deletes its id.
+ * The first record header reading as erased flash marks the end of the
+ * sector.
+ *
+ * The sector with the highest sequence number is the active one, the
+ * sector following it is always erased, and the one after that is the
+ * oldest one, next to be garbage collected.
+ */
+
+#define KVS_MAGIC		0x4b565331 /* "KVS1" */
+#define KVS_SEQ_INVALID		0xffffffff
+#define KVS_MAX_WRITE_BLOCK	8
+
+#define KVS_INDEX_MASK		(CONFIG_KVS_INDEX_SIZE - 1)
+
+BUILD_ASSERT((CONFIG_KVS_INDEX_SIZE & KVS_INDEX_MASK) == 0);
+
+/* scratch buffer size used to compare and copy flash contents */
+#define KVS_CHUNK_SIZE		32
+
+struct kvs_sector_hdr {
+	uint32_t magic;
+	uint32_t seq;
+};
+
+struct kvs_rec_hdr {
+	uint16_t id;
+	uint16_t len;
+	uint16_t crc;
+	uint16_t reserved;
+};
+
+/* CRC-16/CCITT, polynomial 0x1021, one nibble at a time */
+static const uint16_t crc16_tab[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+	0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+static uint16_t kvs_crc16(uint16_t crc, const uint8_t *data, size_t len)
+{
+	while (len--) {
+		crc = (crc << 4) ^ crc16_tab[(crc >> 12) ^ (*data >> 4)];
+		crc = (crc << 4) ^ crc16_tab[(crc >> 12) ^ (*data & 0x0f)];
+		data++;
+	}
+
+	return crc;
+}
+
+/* CRC covering the id and length of the header, seeded for its data */
+static uint16_t kvs_rec_hdr_crc(const struct kvs_rec_hdr *hdr)
+{
+	return kvs_crc16(0xffff, (const uint8_t *)hdr,
+			 offsetof(struct kvs_rec_hdr, crc));
+}
+
+static inline uint32_t kvs_rec_size(struct kvs_fs *fs, size_t len)
+{
+	return sizeof(struct kvs_rec_hdr) + ROUND_UP(len, fs->write_block_size);
+}
+
+static inline uint32_t kvs_sector_addr(struct kvs_fs *fs, uint16_t sector)
+{
+	return (uint32_t)sector * fs->sector_size;
+}
+
+static inline uint16_t kvs_sector_next(struct kvs_fs *fs, uint16_t sector)
+{
+	return (sector + 1 == fs->sector_count) ? 0 : sector + 1;
+}
+
+static int kvs_flash_read(struct kvs_fs *fs, uint32_t addr, void *data,
+			  size_t len)
+{
+	return flash_read(fs->flash_dev, fs->offset + addr, data, len);
+}
+
+static int kvs_flash_write(struct kvs_fs *fs, uint32_t addr,
+			   const void *data, size_t len)
+{
+	return flash_write_pages(fs->flash_dev, fs->offset + addr, data, len);
+}
+
+static int kvs_flash_erase(struct kvs_fs *fs, uint16_t sector)
+{
+	int rc;
+
+	rc = flash_write_protection_set(fs->flash_dev, false);
+	if (rc) {
+		return rc;
+	}
+
+	rc = flash_erase(fs->flash_dev,
+			 fs->offset + kvs_sector_addr(fs, sector),
+			 fs->sector_size);
+
+	flash_write_protection_set(fs->flash_dev, true);
+
+	fs->stats.erases++;
+
+	return rc;
+}
+
+/* returns 0 if the flash contents match data, 1 if not */
+static int kvs_flash_cmp(struct kvs_fs *fs, uint32_t addr, const void *data,
+			 size_t len)
+{
+	const uint8_t *src = data;
+	uint8_t buf[KVS_CHUNK_SIZE];
+	size_t chunk;
+	int rc;
+
+	while (len) {
+		chunk = min(len, sizeof(buf));
+
+		rc = kvs_flash_read(fs, addr, buf, chunk);
+		if (rc) {
+			return rc;
+		}
+
+		if (memcmp(buf, src, chunk)) {
+			return 1;
+		}
+
+		addr += chunk;
+		src += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+static int kvs_flash_is_erased(struct kvs_fs *fs, uint32_t addr, size_t len)
+{
+	uint8_t buf[KVS_CHUNK_SIZE];
+	size_t chunk;
+	size_t i;
+	int rc;
+
+	while (len) {
+		chunk = min(len, sizeof(buf));
+
+		rc = kvs_flash_read(fs, addr, buf, chunk);
+		if (rc) {
+			return rc;
+		}
+
+		for (i = 0; i < chunk; i++) {
+			if (buf[i] != fs->erase_value) {
+				return 0;
+			}
+		}
+
+		addr += chunk;
+		len -= chunk;
+	}
+
+	return 1;
+}
+
+/* copy len bytes of flash, len being a multiple of the write block size */
+static int kvs_flash_copy(struct kvs_fs *fs, uint32_t dst, uint32_t src,
+			  size_t len)
+{
+	uint8_t buf[KVS_CHUNK_SIZE];
+	size_t chunk;
+	int rc;
+
+	while (len) {
+		chunk = min(len, sizeof(buf));
+
+		rc = kvs_flash_read(fs, src, buf, chunk);
+		if (rc) {
+			return rc;
+		}
+
+		rc = kvs_flash_write(fs, dst, buf, chunk);
+		if (rc) {
+			return rc;
+		}
+
+		dst += chunk;
+		src += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+static int kvs_rec_crc_check(struct kvs_fs *fs, const struct kvs_rec_hdr *hdr,
+			     uint32_t addr)
+{
+	uint8_t buf[KVS_CHUNK_SIZE];
+	uint16_t crc = kvs_rec_hdr_crc(hdr);
+	size_t len = hdr->len;
+	size_t chunk;
+	int rc;
+
+	addr += sizeof(*hdr);
+
+	while (len) {
+		chunk = min(len, sizeof(buf));
+
+		rc = kvs_flash_read(fs, addr, buf, chunk);
+		if (rc) {
+			return rc;
+		}
+
+		crc = kvs_crc16(crc, buf, chunk);
+
+		addr += chunk;
+		len -= chunk;
+	}
+
+	return (crc == hdr->crc) ? 0 : -EIO;
+}
+
+/*
+ * RAM index: open addressing with linear probing, empty slots have the
+ * KVS_ID_INVALID id.
+ */
+
+static inline uint32_t kvs_hash(uint16_t id)
+{
+	return ((id * 0x9e3779b1) >> 16) & KVS_INDEX_MASK;
+}
+
+static struct _kvs_index_entry *kvs_index_find(struct kvs_fs *fs, uint16_t id)
+{
+	uint32_t slot = kvs_hash(id);
+	int i;
+
+	for (i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		if (fs->index[slot].id == id) {
+			return &fs->index[slot];
+		}
+
+		if (fs->index[slot].id == KVS_ID_INVALID) {
+			return NULL;
+		}
+
+		slot = (slot + 1) & KVS_INDEX_MASK;
+	}
+
+	return NULL;
+}
+
+static int kvs_index_set(struct kvs_fs *fs, uint16_t id, uint16_t len,
+			 uint32_t addr)
+{
+	uint32_t slot = kvs_hash(id);
+	int i;
+
+	for (i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		if (fs->index[slot].id == KVS_ID_INVALID) {
+			fs->entries++;
+			break;
+		}
+
+		if (fs->index[slot].id == id) {
+			break;
+		}
+
+		slot = (slot + 1) & KVS_INDEX_MASK;
+	}
+
+	if (i == CONFIG_KVS_INDEX_SIZE) {
+		return -ENOMEM;
+	}
+
+	fs->index[slot].id = id;
+	fs->index[slot].len = len;
+	fs->index[slot].addr = addr;
+
+	return 0;
+}
+
+/* backward shift deletion, keeps probe sequences free of holes */
+static void kvs_index_remove(struct kvs_fs *fs, struct _kvs_index_entry *entry)
+{
+	uint32_t hole = entry - fs->index;
+	uint32_t slot = hole;
+	uint32_t home;
+	int i;
+
+	for (i = 1; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		slot = (slot + 1) & KVS_INDEX_MASK;
+
+		if (fs->index[slot].id == KVS_ID_INVALID) {
+			break;
+		}
+
+		home = kvs_hash(fs->index[slot].id);
+
+		/* move the entry unless its home lies in (hole, slot] */
+		if (((slot - home) & KVS_INDEX_MASK) >=
+		    ((slot - hole) & KVS_INDEX_MASK)) {
+			fs->index[hole] = fs->index[slot];
+			hole = slot;
+		}
+	}
+
+	fs->index[hole].id = KVS_ID_INVALID;
+	fs->entries--;
+}
+
+static void kvs_index_clear(struct kvs_fs *fs)
+{
+	memset(fs->index, 0xff, sizeof(fs->index));
+	fs->entries = 0;
+}
+
+/* append a record, data being in RAM */
+static int kvs_rec_append(struct kvs_fs *fs, const struct kvs_rec_hdr *hdr,
+			  const void *data, uint32_t *addr)
+{
+	uint8_t tail[KVS_MAX_WRITE_BLOCK];
+	size_t aligned = ROUND_DOWN(hdr->len, fs->write_block_size);
+	uint32_t rec = fs->write_addr;
+	int rc;
+
+	/* the space is consumed even if a write fails halfway */
+	fs->write_addr += kvs_rec_size(fs, hdr->len);
+	fs->stats.writes++;
+
+	rc = kvs_flash_write(fs, rec, hdr, sizeof(*hdr));
+	if (rc) {
+		return rc;
+	}
+
+	if (aligned) {
+		rc = kvs_flash_write(fs, rec + sizeof(*hdr), data, aligned);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	if (aligned != hdr->len) {
+		memset(tail, fs->erase_value, sizeof(tail));
+		memcpy(tail, (const uint8_t *)data + aligned,
+		       hdr->len - aligned);
+
+		rc = kvs_flash_write(fs, rec + sizeof(*hdr) + aligned, tail,
+				     fs->write_block_size);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	*addr = rec;
+
+	return 0;
+}
+
+static inline bool kvs_entry_in_sector(struct kvs_fs *fs,
+				       struct _kvs_index_entry *entry,
+				       uint16_t sector)
+{
+	uint32_t start = kvs_sector_addr(fs, sector);
+
+	return entry->id != KVS_ID_INVALID &&
+	       entry->addr >= start && entry->addr < start + fs->sector_size;
+}
+
+/* size taken by the live records of a sector */
+static uint32_t kvs_sector_live(struct kvs_fs *fs, uint16_t sector)
+{
+	uint32_t live = 0;
+	int i;
+
+	for (i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		if (kvs_entry_in_sector(fs, &fs->index[i], sector)) {
+			live += kvs_rec_size(fs, fs->index[i].len);
+		}
+	}
+
+	return live;
+}
+
+/*
+ * Copy the live records of a sector from addr on, end being the end of the
+ * destination sector. The index only points to the copies once they are
+ * all written, a failed copy leaves it untouched.
+ */
+static int kvs_gc(struct kvs_fs *fs, uint16_t sector, uint32_t *addr,
+		  uint32_t end)
+{
+	struct _kvs_index_entry *entry;
+	uint32_t dst = *addr;
+	uint32_t size;
+	int rc;
+	int i;
+
+	if (dst + kvs_sector_live(fs, sector) > end) {
+		return -ENOSPC;
+	}
+
+	for (i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		entry = &fs->index[i];
+
+		if (!kvs_entry_in_sector(fs, entry, sector)) {
+			continue;
+		}
+
+		/* header and CRC are unchanged, copy the record as is */
+		size = kvs_rec_size(fs, entry->len);
+		rc = kvs_flash_copy(fs, dst, entry->addr, size);
+		if (rc) {
+			return rc;
+		}
+
+		dst += size;
+	}
+
+	/* same walk, the index has not changed */
+	for (i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		entry = &fs->index[i];
+
+		if (!kvs_entry_in_sector(fs, entry, sector)) {
+			continue;
+		}
+
+		entry->addr = *addr;
+		*addr += kvs_rec_size(fs, entry->len);
+		fs->stats.writes++;
+		fs->stats.gc_copies++;
+	}
+
+	return 0;
+}
+
+static int kvs_sector_open(struct kvs_fs *fs, uint16_t sector, uint32_t seq)
+{
+	struct kvs_sector_hdr hdr = {
+		.magic = KVS_MAGIC,
+		.seq = seq,
+	};
+
+	return kvs_flash_write(fs, kvs_sector_addr(fs, sector), &hdr,
+			       sizeof(hdr));
+}
+
+/*
+ * Reclaim the oldest sector: its live records are copied to the spare
+ * sector, which then becomes the active one, and it is erased to become
+ * the next spare. A failed copy erases the spare again and leaves the
+ * active sector as it was.
+ */
+static int kvs_rotate(struct kvs_fs *fs)
+{
+	uint16_t sector = kvs_sector_next(fs, fs->active);
+	uint16_t gc_sector = kvs_sector_next(fs, sector);
+	uint32_t addr = kvs_sector_addr(fs, sector);
+	int rc;
+
+	rc = kvs_sector_open(fs, sector, fs->seq + 1);
+	if (!rc) {
+		addr += sizeof(struct kvs_sector_hdr);
+		rc = kvs_gc(fs, gc_sector, &addr,
+			    kvs_sector_addr(fs, sector) + fs->sector_size);
+	}
+
+	if (rc) {
+		kvs_flash_erase(fs, sector);
+		return rc;
+	}
+
+	fs->active = sector;
+	fs->seq++;
+	fs->write_addr = addr;
+
+	return kvs_flash_erase(fs, gc_sector);
+}
+
+/*
+ * Make room for size bytes in the active sector. A reclaimed sector leaves
+ * its live records at the start of the new active one, so the sectors to
+ * reclaim, oldest first, are known before touching the flash.
+ */
+static int kvs_reserve(struct kvs_fs *fs, uint32_t size)
+{
+	uint32_t room = fs->sector_size - sizeof(struct kvs_sector_hdr);
+	uint32_t end = kvs_sector_addr(fs, fs->active) + fs->sector_size;
+	uint16_t sector;
+	int rotations;
+	int rc;
+
+	if (fs->write_addr + size <= end) {
+		return 0;
+	}
+
+	/* the oldest sector follows the spare one, the active one is last */
+	sector = kvs_sector_next(fs, kvs_sector_next(fs, fs->active));
+
+	for (rotations = 1; rotations < fs->sector_count; rotations++) {
+		if (kvs_sector_live(fs, sector) + size <= room) {
+			break;
+		}
+
+		sector = kvs_sector_next(fs, sector);
+	}
+
+	if (rotations == fs->sector_count) {
+		return -ENOSPC;
+	}
+
+	while (rotations--) {
+		rc = kvs_rotate(fs);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+static bool kvs_rec_hdr_is_erased(struct kvs_fs *fs,
+				  const struct kvs_rec_hdr *hdr)
+{
+	const uint8_t *p = (const uint8_t *)hdr;
+	size_t i;
+
+	for (i = 0; i < sizeof(*hdr); i++) {
+		if (p[i] != fs->erase_value) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* add the records of a sector to the index, returns the end of its data */
+static int kvs_sector_scan(struct kvs_fs *fs, uint16_t sector, uint32_t *end)
+{
+	uint32_t addr = kvs_sector_addr(fs, sector);
+	uint32_t sector_end = addr + fs->sector_size;
+	struct _kvs_index_entry *entry;
+	struct kvs_rec_hdr hdr;
+	uint32_t size;
+	int rc;
+
+	addr += sizeof(struct kvs_sector_hdr);
+
+	while (addr + sizeof(hdr) <= sector_end) {
+		rc = kvs_flash_read(fs, addr, &hdr, sizeof(hdr));
+		if (rc) {
+			return rc;
+		}
+
+		if (kvs_rec_hdr_is_erased(fs, &hdr)) {
+			break;
+		}
+
+		size = kvs_rec_size(fs, hdr.len);
+		if (hdr.id == KVS_ID_INVALID || size > sector_end - addr) {
+			/* garbage, nothing can be trusted past this point */
+			addr = sector_end;
+			break;
+		}
+
+		rc = kvs_rec_crc_check(fs, &hdr, addr);
+		if (rc == -EIO) {
+			/* interrupted write, skip it */
+			addr += size;
+			continue;
+		} else if (rc) {
+			return rc;
+		}
+
+		if (hdr.len) {
+			rc = kvs_index_set(fs, hdr.id, hdr.len, addr);
+			if (rc) {
+				return rc;
+			}
+		} else {
+			entry = kvs_index_find(fs, hdr.id);
+			if (entry) {
+				kvs_index_remove(fs, entry);
+			}
+		}
+
+		addr += size;
+	}
+
+	*end = addr;
+
+	return 0;
+}
+
+static int kvs_format(struct kvs_fs *fs)
+{
+	uint16_t sector;
+	int rc;
+
+	kvs_index_clear(fs);
+
+	for (sector = 0; sector < fs->sector_count; sector++) {
+		rc = kvs_flash_is_erased(fs, kvs_sector_addr(fs, sector),
+					 fs->sector_size);
+		if (rc < 0) {
+			return rc;
+		}
+
+		if (!rc) {
+			rc = kvs_flash_erase(fs, sector);
+			if (rc) {
+				return rc;
+			}
+		}
+	}
+
+	rc = kvs_sector_open(fs, 0, 0);
+	if (rc) {
+		return rc;
+	}
+
+	fs->active = 0;
+	fs->seq = 0;
+	fs->write_addr = sizeof(struct kvs_sector_hdr);
+
+	return 0;
+}
+
+static int kvs_mount(struct kvs_fs *fs)
+{
+	struct kvs_sector_hdr hdr;
+	bool found = false;
+	uint16_t sector;
+	uint16_t spare;
+	int i;
+	int rc;
+
+	for (sector = 0; sector < fs->sector_count; sector++) {
+		rc = kvs_flash_read(fs, kvs_sector_addr(fs, sector), &hdr,
+				    sizeof(hdr));
+		if (rc) {
+			return rc;
+		}
+
+		if (hdr.magic != KVS_MAGIC || hdr.seq == KVS_SEQ_INVALID) {
+			continue;
+		}
+
+		if (!found || hdr.seq > fs->seq) {
+			fs->active = sector;
+			fs->seq = hdr.seq;
+			found = true;
+		}
+	}
+
+	if (!found) {
+		return kvs_format(fs);
+	}
+
+	/* scan from the oldest sector to the active one */
+	sector = fs->active;
+	for (i = 0; i < fs->sector_count; i++) {
+		sector = kvs_sector_next(fs, sector);
+
+		rc = kvs_flash_read(fs, kvs_sector_addr(fs, sector), &hdr,
+				    sizeof(hdr));
+		if (rc) {
+			return rc;
+		}
+
+		if (hdr.magic != KVS_MAGIC || hdr.seq == KVS_SEQ_INVALID) {
+			continue;
+		}
+
+		rc = kvs_sector_scan(fs, sector, &fs->write_addr);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	/* complete a garbage collection interrupted by a reset */
+	spare = kvs_sector_next(fs, fs->active);
+
+	rc = kvs_flash_is_erased(fs, kvs_sector_addr(fs, spare),
+				 fs->sector_size);
+	if (rc < 0) {
+		return rc;
+	}
+
+	if (rc) {
+		return 0;
+	}
+
+	rc = kvs_flash_read(fs, kvs_sector_addr(fs, spare), &hdr, sizeof(hdr));
+	if (rc) {
+		return rc;
+	}
+
+	if (hdr.magic == KVS_MAGIC && hdr.seq != KVS_SEQ_INVALID) {
+		rc = kvs_gc(fs, spare, &fs->write_addr,
+			    kvs_sector_addr(fs, fs->active) + fs->sector_size);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return kvs_flash_erase(fs, spare);
+}
+
+int kvs_init(struct kvs_fs *fs, const char *dev_name)
+{
+	size_t write_block_size;
+
+	fs->flash_dev = device_get_binding(dev_name);
+	if (!fs->flash_dev) {
+		return -ENODEV;
+	}
+
+	write_block_size = flash_get_write_block_size(fs->flash_dev);
+	if (!write_block_size) {
+		write_block_size = 1;
+	}
+
+	if (write_block_size > KVS_MAX_WRITE_BLOCK ||
+	    (write_block_size & (write_block_size - 1))) {
+		return -EINVAL;
+	}
+
+	fs->write_block_size = write_block_size;
+
+	if (fs->sector_count < 2 ||
+	    (fs->sector_size % write_block_size) ||
+	    fs->sector_size < sizeof(struct kvs_sector_hdr) +
+			      kvs_rec_size(fs, KVS_MAX_WRITE_BLOCK)) {
+		return -EINVAL;
+	}
+
+	fs->erase_value = flash_get_erase_value(fs->flash_dev);
+	memset(&fs->stats, 0, sizeof(fs->stats));
+
+	k_mutex_init(&fs->lock);
+	kvs_index_clear(fs);
+
+	return kvs_mount(fs);
+}
+
+int kvs_write(struct kvs_fs *fs, uint16_t id, const void *data, size_t len)
+{
+	struct _kvs_index_entry *entry;
+	struct kvs_rec_hdr hdr;
+	uint32_t size;
+	uint32_t addr;
+	int rc;
+
+	if (id == KVS_ID_INVALID || !data || !len) {
+		return -EINVAL;
+	}
+
+	size = kvs_rec_size(fs, len);
+	if (len > UINT16_MAX ||
+	    size > fs->sector_size - sizeof(struct kvs_sector_hdr)) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&fs->lock, K_FOREVER);
+
+	entry = kvs_index_find(fs, id);
+	if (entry) {
+		if (entry->len == len &&
+		    !kvs_flash_cmp(fs, entry->addr + sizeof(hdr), data, len)) {
+			fs->stats.skipped_writes++;
+			rc = 0;
+			goto out;
+		}
+	} else if (fs->entries == CONFIG_KVS_INDEX_SIZE) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	rc = kvs_reserve(fs, size);
+	if (rc) {
+		goto out;
+	}
+
+	hdr.id = id;
+	hdr.len = len;
+	hdr.crc = kvs_crc16(kvs_rec_hdr_crc(&hdr), data, len);
+	hdr.reserved = 0xffff;
+
+	rc = kvs_rec_append(fs, &hdr, data, &addr);
+	if (rc) {
+		goto out;
+	}
+
+	rc = kvs_index_set(fs, id, len, addr);
+
+out:
+	k_mutex_unlock(&fs->lock);
+
+	return rc;
+}
+
+ssize_t kvs_read(struct kvs_fs *fs, uint16_t id, void *data, size_t len)
+{
+	struct _kvs_index_entry *entry;
+	ssize_t rc;
+
+	k_mutex_lock(&fs->lock, K_FOREVER);
+
+	entry = kvs_index_find(fs, id);
+	if (!entry) {
+		rc = -ENOENT;
+		goto out;
+	}
+
+	rc = kvs_flash_read(fs, entry->addr + sizeof(struct kvs_rec_hdr),
+			    data, min(len, entry->len));
+	if (!rc) {
+		rc = entry->len;
+	}
+
+out:
+	k_mutex_unlock(&fs->lock);
+
+	return rc;
+}
+
+int kvs_delete(struct kvs_fs *fs, uint16_t id)
+{
+	struct _kvs_index_entry *entry;
+	struct kvs_rec_hdr hdr;
+	uint32_t addr;
+	int rc;
+
+	k_mutex_lock(&fs->lock, K_FOREVER);
+
+	if (!kvs_index_find(fs, id)) {
+		rc = -ENOENT;
+		goto out;
+	}
+
+	rc = kvs_reserve(fs, sizeof(hdr));
+	if (rc) {
+		goto out;
+	}
+
+	hdr.id = id;
+	hdr.len = 0;
+	hdr.crc = kvs_rec_hdr_crc(&hdr);
+	hdr.reserved = 0xffff;
+
+	rc = kvs_rec_append(fs, &hdr, NULL, &addr);
+	if (rc) {
+		goto out;
+	}
+
+	/* garbage collection may have moved the entry */
+	entry = kvs_index_find(fs, id);
+	kvs_index_remove(fs, entry);
+
+out:
+	k_mutex_unlock(&fs->lock);
+
+	return rc;
+}
+
+int kvs_clear(struct kvs_fs *fs)
+{
+	uint16_t sector;
+	int rc;
+
+	k_mutex_lock(&fs->lock, K_FOREVER);
+
+	for (sector = 0; sector < fs->sector_count; sector++) {
+		rc = kvs_flash_erase(fs, sector);
+		if (rc) {
+			goto out;
+		}
+	}
+
+	rc = kvs_format(fs);
+
+out:
+	k_mutex_unlock(&fs->lock);
+
+	return rc;
+}
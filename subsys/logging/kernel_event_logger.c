@@ -7,16 +7,112 @@
 /**
  * @file
  * @brief Kernel event logger support.
+ *
+ * Kernel events are logged in a ring per event type, without locking
+ * interrupts: a slot is reserved with a compare and swap on the ring head,
+ * filled, and marked written by storing its sequence number. The collector
+ * retrieves the oldest written event of all rings, and extends its cycle
+ * timestamp to 64 bits.
+ *
+ * Events written with sys_k_event_logger_put() go to the ring buffer of
+ * sys_k_event_logger instead, as they have sizes of their own.
  */
 
 
 #include <logging/kernel_event_logger.h>
 #include <misc/util.h>
 #include <init.h>
+#include <atomic.h>
+#include <string.h>
 #include <kernel_structs.h>
 #include <kernel_event_logger_arch.h>
 #include <misc/__assert.h>
 
+#define RING_EVENTS CONFIG_KERNEL_EVENT_LOGGER_RING_EVENTS
+
+BUILD_ASSERT((RING_EVENTS & (RING_EVENTS - 1)) == 0);
+
+/* Most data words of a kernel event */
+#define EVENT_MAX_SIZE 3
+
+struct event_slot {
+	/* index of the event plus one once it is written */
+	atomic_t seq;
+	/* hardware cycles, to order the events of all rings */
+	uint32_t cycles;
+	uint32_t data[EVENT_MAX_SIZE];
+};
+
+struct event_ring {
+	/* next event to reserve, and to retrieve */
+	atomic_t head;
+	atomic_t tail;
+	/* events dropped since the last one retrieved */
+	atomic_t dropped;
+	uint16_t event_id;
+	uint8_t data_size;
+	struct event_slot slots[RING_EVENTS];
+};
+
+#define EVENT_RING_DEFINE(name, id, size)				\
+	static struct event_ring name = {				\
+		.event_id = id,						\
+		.data_size = size,					\
+	}
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
+EVENT_RING_DEFINE(context_switch_ring,
+		  KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, 2);
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT
+EVENT_RING_DEFINE(interrupt_ring, KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID, 2);
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SLEEP
+EVENT_RING_DEFINE(sleep_ring, KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID, 3);
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SEMAPHORE
+EVENT_RING_DEFINE(sem_ring, KERNEL_EVENT_LOGGER_SEMAPHORE_EVENT_ID, 3);
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_MUTEX
+EVENT_RING_DEFINE(mutex_ring, KERNEL_EVENT_LOGGER_MUTEX_EVENT_ID, 3);
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_QUEUE
+EVENT_RING_DEFINE(queue_ring, KERNEL_EVENT_LOGGER_QUEUE_EVENT_ID, 3);
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_ISR_EXIT
+EVENT_RING_DEFINE(isr_exit_ring, KERNEL_EVENT_LOGGER_ISR_EXIT_EVENT_ID, 2);
+#endif
+
+static struct event_ring * const rings[] = {
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
+	&context_switch_ring,
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT
+	&interrupt_ring,
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SLEEP
+	&sleep_ring,
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SEMAPHORE
+	&sem_ring,
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_MUTEX
+	&mutex_ring,
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_QUEUE
+	&queue_ring,
+#endif
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_ISR_EXIT
+	&isr_exit_ring,
+#endif
+	NULL
+};
+
+/* 64-bit timestamp of the event retrieved last, and the latest one */
+static uint64_t timestamp;
+static uint64_t last_timestamp;
+static uint32_t last_cycles;
+
 struct event_logger sys_k_event_logger;
 
 uint32_t _sys_k_event_logger_buffer[CONFIG_KERNEL_EVENT_LOGGER_BUFFER_SIZE];
@@ -47,6 +143,9 @@ static int _sys_k_event_logger_init(struct device *arg)
 	sys_event_logger_init(&sys_k_event_logger, _sys_k_event_logger_buffer,
 		CONFIG_KERNEL_EVENT_LOGGER_BUFFER_SIZE);
 
+	last_cycles = k_cycle_get_32();
+	last_timestamp = last_cycles;
+
 	return 0;
 }
 SYS_INIT(_sys_k_event_logger_init,
@@ -61,9 +160,177 @@ SYS_INIT(_sys_k_event_logger_init,
  * to point to an application-defined routine.
  *
  */
-sys_k_timer_func_t _sys_k_get_time = k_cycle_get_32;
+static uint32_t cycle_get_32(void)
+{
+	/* k_cycle_get_32() may be a macro */
+	return k_cycle_get_32();
+}
+
+sys_k_timer_func_t _sys_k_get_time = cycle_get_32;
 #endif /* CONFIG_KERNEL_EVENT_LOGGER_CUSTOM_TIMESTAMP */
 
+static inline int logged_by_collector(void)
+{
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
+	return !_is_in_isr() && _collector_coop_thread == _kernel.current;
+#else
+	return 0;
+#endif
+}
+
+static inline void event_put(struct event_ring *ring, uint32_t *data)
+{
+	struct event_slot *slot;
+	uint32_t idx;
+	int i;
+
+	do {
+		idx = atomic_get(&ring->head);
+		if (idx - (uint32_t)atomic_get(&ring->tail) >= RING_EVENTS) {
+			atomic_inc(&ring->dropped);
+			return;
+		}
+	} while (!atomic_cas(&ring->head, idx, idx + 1));
+
+	slot = &ring->slots[idx & (RING_EVENTS - 1)];
+	slot->cycles = k_cycle_get_32();
+	for (i = 0; i < ring->data_size; i++) {
+		slot->data[i] = data[i];
+	}
+
+	atomic_set(&slot->seq, idx + 1);
+}
+
+/* Extend the cycles of an event retrieved to 64 bits */
+static void timestamp_update(uint32_t cycles)
+{
+	int32_t delta = cycles - last_cycles;
+
+	/* events of different types are not always retrieved in order */
+	timestamp = last_timestamp + delta;
+	if (delta > 0) {
+		last_timestamp = timestamp;
+		last_cycles = cycles;
+	}
+}
+
+static int kernel_event_get(uint16_t *event_id, uint8_t *dropped,
+			    uint32_t *event_data, uint8_t *data_size)
+{
+	struct event_ring *ring = NULL;
+	struct event_slot *slot = NULL;
+	struct event_slot *oldest;
+	uint32_t idx;
+	int i;
+
+	for (i = 0; rings[i]; i++) {
+		idx = atomic_get(&rings[i]->tail);
+		oldest = &rings[i]->slots[idx & (RING_EVENTS - 1)];
+
+		/* empty, or its oldest event is still being written */
+		if ((uint32_t)atomic_get(&oldest->seq) != idx + 1) {
+			continue;
+		}
+
+		if (!slot || (int32_t)(oldest->cycles - slot->cycles) < 0) {
+			ring = rings[i];
+			slot = oldest;
+		}
+	}
+
+	if (!ring) {
+		return 0;
+	}
+
+	if (*data_size < ring->data_size) {
+		*data_size = ring->data_size;
+		return -EMSGSIZE;
+	}
+
+	*event_id = ring->event_id;
+	*dropped = min(atomic_clear(&ring->dropped), UINT8_MAX);
+	*data_size = ring->data_size;
+	memcpy(event_data, slot->data, ring->data_size * sizeof(uint32_t));
+	timestamp_update(slot->cycles);
+
+	/* the slot can be reused from now on */
+	atomic_inc(&ring->tail);
+
+	return ring->data_size;
+}
+
+int sys_k_event_logger_get(uint16_t *event_id, uint8_t *dropped,
+			   uint32_t *event_data, uint8_t *data_size)
+{
+	int ret;
+
+	ret = kernel_event_get(event_id, dropped, event_data, data_size);
+	if (ret) {
+		return ret;
+	}
+
+	ret = sys_event_logger_get(&sys_k_event_logger, event_id, dropped,
+				   event_data, data_size);
+	if (ret > 0) {
+		timestamp_update(k_cycle_get_32());
+	}
+
+	return ret;
+}
+
+/*
+ * Only the events written with sys_k_event_logger_put() give the
+ * semaphore, it is left for sys_event_logger_get() to take.
+ */
+static void wait_for_events(int32_t ms)
+{
+	if (!k_sem_take(&sys_k_event_logger.sync_sema, ms)) {
+		k_sem_give(&sys_k_event_logger.sync_sema);
+	}
+}
+
+int sys_k_event_logger_get_wait(uint16_t *event_id, uint8_t *dropped,
+				uint32_t *event_data, uint8_t *data_size)
+{
+	int ret;
+
+	while (!(ret = sys_k_event_logger_get(event_id, dropped, event_data,
+					      data_size))) {
+		wait_for_events(CONFIG_KERNEL_EVENT_LOGGER_POLL_INTERVAL);
+	}
+
+	return ret;
+}
+
+#ifdef CONFIG_SYS_CLOCK_EXISTS
+int sys_k_event_logger_get_wait_timeout(uint16_t *event_id, uint8_t *dropped,
+					uint32_t *event_data,
+					uint8_t *data_size, uint32_t timeout)
+{
+	int64_t end = k_uptime_get() + __ticks_to_ms(timeout);
+	int64_t left;
+	int ret;
+
+	while (!(ret = sys_k_event_logger_get(event_id, dropped, event_data,
+					      data_size))) {
+		left = end - k_uptime_get();
+		if (left <= 0) {
+			return 0;
+		}
+
+		wait_for_events(min(left,
+				    CONFIG_KERNEL_EVENT_LOGGER_POLL_INTERVAL));
+	}
+
+	return ret;
+}
+#endif /* CONFIG_SYS_CLOCK_EXISTS */
+
+uint64_t sys_k_event_logger_get_timestamp(void)
+{
+	return timestamp;
+}
+
 void sys_k_event_logger_put_timed(uint16_t event_id)
 {
 	uint32_t data[1];
@@ -80,23 +347,12 @@ void _sys_k_event_logger_context_switch(void)
 	extern struct _kernel _kernel;
 	uint32_t data[2];
 
-	extern void _sys_event_logger_put_non_preemptible(
-		struct event_logger *logger,
-		uint16_t event_id,
-		uint32_t *event_data,
-		uint8_t data_size);
-
 	const int event_id = KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID;
 
 	if (!sys_k_must_log_event(event_id)) {
 		return;
 	}
 
-	/* if the kernel event logger has not been initialized, do nothing */
-	if (sys_k_event_logger.ring_buf.buf == NULL) {
-		return;
-	}
-
 	if (_collector_coop_thread == _kernel.current) {
 		return;
 	}
@@ -105,25 +361,10 @@ void _sys_k_event_logger_context_switch(void)
 	data[1] = (uint32_t)_kernel.current;
 
 	/*
-	 * The mechanism we use to log the kernel events uses a sync semaphore
-	 * to inform that there are available events to be collected. The
-	 * context switch event can be triggered from a task. When we signal a
-	 * semaphore from a task and a fiber is waiting for that semaphore, a
-	 * context switch is generated immediately. Due to the fact that we
-	 * register the context switch event while the context switch is being
-	 * processed, a new context switch can be generated before the kernel
-	 * finishes processing the current context switch. We need to prevent
-	 * this because the kernel is not able to handle it.  The
-	 * _sem_give_non_preemptible function does not trigger a context
-	 * switch when we signal the semaphore from any type of thread. Using
-	 * _sys_event_logger_put_non_preemptible function, that internally
-	 * uses _sem_give_non_preemptible function for signaling the sync
-	 * semaphore, allow us registering the context switch event without
-	 * triggering any new context switch during the process.
+	 * Logging the event gives no semaphore, so it cannot trigger a new
+	 * context switch while this one is being processed.
 	 */
-	_sys_event_logger_put_non_preemptible(&sys_k_event_logger,
-		KERNEL_EVENT_LOGGER_CONTEXT_SWITCH_EVENT_ID, data,
-		ARRAY_SIZE(data));
+	event_put(&context_switch_ring, data);
 }
 
 #define ASSERT_CURRENT_IS_COOP_THREAD() \
@@ -147,19 +388,67 @@ void _sys_k_event_logger_interrupt(void)
 		return;
 	}
 
-	/* if the kernel event logger has not been initialized, we do nothing */
-	if (sys_k_event_logger.ring_buf.buf == NULL) {
+	data[0] = _sys_k_get_time();
+	data[1] = _sys_current_irq_key_get();
+
+	event_put(&interrupt_ring, data);
+}
+#endif /* CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT */
+
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_ISR_EXIT
+void _sys_k_event_logger_isr_exit(void)
+{
+	uint32_t data[2];
+
+	if (!sys_k_must_log_event(KERNEL_EVENT_LOGGER_ISR_EXIT_EVENT_ID)) {
 		return;
 	}
 
 	data[0] = _sys_k_get_time();
 	data[1] = _sys_current_irq_key_get();
 
-	sys_k_event_logger_put(KERNEL_EVENT_LOGGER_INTERRUPT_EVENT_ID, data,
-		ARRAY_SIZE(data));
+	event_put(&isr_exit_ring, data);
 }
-#endif /* CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT */
+#endif /* CONFIG_KERNEL_EVENT_LOGGER_ISR_EXIT */
+
+
+static inline void object_event_put(struct event_ring *ring, void *object,
+				    int op)
+{
+	uint32_t data[3];
 
+	if (!sys_k_must_log_event(ring->event_id) || logged_by_collector()) {
+		return;
+	}
+
+	data[0] = _sys_k_get_time();
+	data[1] = (uint32_t)object;
+	data[2] = op;
+
+	event_put(ring, data);
+}
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_SEMAPHORE
+void _sys_k_event_logger_sem(struct k_sem *sem, int op)
+{
+	object_event_put(&sem_ring, sem, op);
+}
+#endif /* CONFIG_KERNEL_EVENT_LOGGER_SEMAPHORE */
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_MUTEX
+void _sys_k_event_logger_mutex(struct k_mutex *mutex, int op)
+{
+	object_event_put(&mutex_ring, mutex, op);
+}
+#endif /* CONFIG_KERNEL_EVENT_LOGGER_MUTEX */
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_QUEUE
+void _sys_k_event_logger_queue(struct k_queue *queue, int op)
+{
+	object_event_put(&queue_ring, queue, op);
+}
+#endif /* CONFIG_KERNEL_EVENT_LOGGER_QUEUE */
 
 #ifdef CONFIG_KERNEL_EVENT_LOGGER_SLEEP
 void _sys_k_event_logger_enter_sleep(void)
@@ -193,8 +482,7 @@ void _sys_k_event_logger_exit_sleep(void)
 		 */
 		_sys_k_event_logger_sleep_start_time = 0;
 
-		sys_k_event_logger_put(KERNEL_EVENT_LOGGER_SLEEP_EVENT_ID, data,
-			ARRAY_SIZE(data));
+		event_put(&sleep_ring, data);
 	}
 }
 #endif /* CONFIG_KERNEL_EVENT_LOGGER_SLEEP */
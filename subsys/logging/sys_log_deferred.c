@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Deferred logging backend
+ *
+ * Log calls reserve a message slot with a compare and swap on the write
+ * index, fill it and mark it complete by storing its sequence number, so
+ * that threads and ISRs log concurrently without locking. The logging
+ * thread outputs complete messages in order, and stops at a slot still
+ * being filled until its writer is done.
+ */
+
+#include <kernel.h>
+#include <init.h>
+#include <atomic.h>
+#include <stdarg.h>
+#include <misc/printk.h>
+#include <logging/sys_log.h>
+#include <debug/perf_counter.h>
+
+#define ENTRIES CONFIG_SYS_LOG_DEFERRED_ENTRIES
+
+BUILD_ASSERT((ENTRIES & (ENTRIES - 1)) == 0);
+
+struct log_msg {
+	/* sequence number of the message plus one once it is complete */
+	atomic_t seq;
+	const char *fmt;
+	uint32_t timestamp;
+	uint32_t args[SYS_LOG_DEFERRED_MAX_ARGS];
+};
+
+static struct log_msg msgs[ENTRIES];
+
+/* next message to reserve, and to output */
+static atomic_t write_idx;
+static atomic_t read_idx;
+
+static atomic_t dropped;
+static uint32_t dropped_reported;
+
+static K_SEM_DEFINE(log_sem, 0, 1);
+
+void _sys_log_deferred(const char *fmt, int nargs, ...)
+{
+	struct log_msg *msg;
+	uint32_t idx;
+	va_list ap;
+	int i;
+
+	do {
+		idx = atomic_get(&write_idx);
+		if (idx - (uint32_t)atomic_get(&read_idx) >= ENTRIES) {
+			atomic_inc(&dropped);
+			return;
+		}
+	} while (!atomic_cas(&write_idx, idx, idx + 1));
+
+	msg = &msgs[idx & (ENTRIES - 1)];
+	msg->fmt = fmt;
+	msg->timestamp = k_cycle_get_32();
+
+	va_start(ap, nargs);
+	for (i = 0; i < nargs; i++) {
+		msg->args[i] = va_arg(ap, uint32_t);
+	}
+	va_end(ap);
+
+	atomic_set(&msg->seq, idx + 1);
+
+	/* the thread sleeps only once it output everything */
+	if (idx == (uint32_t)atomic_get(&read_idx)) {
+		k_sem_give(&log_sem);
+	}
+}
+
+uint32_t sys_log_deferred_dropped(void)
+{
+	return atomic_get(&dropped);
+}
+
+PERF_COUNTER_EXPORT(sys_log_deferred_dropped, sys_log_deferred_dropped);
+
+static void log_output(struct log_msg *msg)
+{
+	uint32_t *a = msg->args;
+	uint32_t us;
+
+	us = SYS_CLOCK_HW_CYCLES_TO_NS64(msg->timestamp) / NSEC_PER_USEC;
+
+	/* unused arguments are ignored */
+#if defined(CONFIG_SYS_LOG_EXT_HOOK)
+	syslog_hook("[%010u] ", us);
+	syslog_hook(msg->fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7],
+		    a[8], a[9], a[10], a[11], a[12], a[13], a[14], a[15]);
+#else
+	printk("[%010u] ", us);
+	printk(msg->fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7],
+	       a[8], a[9], a[10], a[11], a[12], a[13], a[14], a[15]);
+#endif
+}
+
+static void log_thread(void *p1, void *p2, void *p3)
+{
+	struct log_msg *msg;
+	uint32_t idx;
+	uint32_t count;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		idx = atomic_get(&read_idx);
+
+		if (idx == (uint32_t)atomic_get(&write_idx)) {
+			k_sem_take(&log_sem, K_FOREVER);
+			continue;
+		}
+
+		msg = &msgs[idx & (ENTRIES - 1)];
+		if ((uint32_t)atomic_get(&msg->seq) != idx + 1) {
+			/* let the writer, maybe preempted, complete it */
+			k_sleep(1);
+			continue;
+		}
+
+		log_output(msg);
+		atomic_set(&read_idx, idx + 1);
+
+		count = atomic_get(&dropped);
+		if (count != dropped_reported) {
+			printk("--- %u log messages dropped ---\n",
+			       count - dropped_reported);
+			dropped_reported = count;
+		}
+	}
+}
+
+K_THREAD_DEFINE(sys_log_deferred_thread, CONFIG_SYS_LOG_DEFERRED_STACK_SIZE,
+		log_thread, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0, K_NO_WAIT);
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Runtime log levels
+ *
+ * The log sources of the compile units are found between the section
+ * start and end symbols. A domain usually spans several compile units,
+ * which all have their own source, so a domain is set as a whole.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <misc/printk.h>
+#include <logging/sys_log.h>
+#include <shell/shell.h>
+
+extern struct sys_log_source __sys_log_source_start[];
+extern struct sys_log_source __sys_log_source_end[];
+
+int sys_log_level_set(const char *domain, int level)
+{
+	struct sys_log_source *src;
+	int count = 0;
+
+	if (level < SYS_LOG_LEVEL_OFF || level > CONFIG_SYS_LOG_MAX_LEVEL) {
+		return -EINVAL;
+	}
+
+	for (src = __sys_log_source_start; src < __sys_log_source_end; src++) {
+		if (!domain || !strcmp(src->domain, domain)) {
+			src->level = level;
+			count++;
+		}
+	}
+
+	return count ? count : -ENOENT;
+}
+
+int sys_log_level_get(const char *domain)
+{
+	struct sys_log_source *src;
+
+	for (src = __sys_log_source_start; src < __sys_log_source_end; src++) {
+		if (!strcmp(src->domain, domain)) {
+			return src->level;
+		}
+	}
+
+	return -ENOENT;
+}
+
+#if defined(CONFIG_CONSOLE_SHELL)
+
+static int shell_cmd_list(int argc, char *argv[])
+{
+	struct sys_log_source *src, *prev;
+
+	for (src = __sys_log_source_start; src < __sys_log_source_end; src++) {
+		/* list a domain once */
+		for (prev = __sys_log_source_start; prev < src; prev++) {
+			if (!strcmp(prev->domain, src->domain)) {
+				break;
+			}
+		}
+
+		if (prev == src) {
+			printk("%-24s %u\n", src->domain, src->level);
+		}
+	}
+
+	printk("levels up to %u are built in\n", CONFIG_SYS_LOG_MAX_LEVEL);
+
+	return 0;
+}
+
+static int shell_cmd_level(int argc, char *argv[])
+{
+	int ret;
+
+	if (argc != 3) {
+		printk("usage: level <domain|all> <level>\n");
+		return -EINVAL;
+	}
+
+	ret = sys_log_level_set(strcmp(argv[1], "all") ? argv[1] : NULL,
+				atoi(argv[2]));
+	if (ret == -EINVAL) {
+		printk("level must be 0 to %u\n", CONFIG_SYS_LOG_MAX_LEVEL);
+	} else if (ret == -ENOENT) {
+		printk("no log domain %s\n", argv[1]);
+	}
+
+	return ret < 0 ? ret : 0;
+}
+
+static struct shell_cmd log_commands[] = {
+	{ "list", shell_cmd_list, "show the log domains and their levels" },
+	{ "level", shell_cmd_level,
+	  "<domain|all> <level>, set the log level, 0 OFF to 4 DEBUG" },
+	{ NULL, NULL, NULL }
+};
+
+SHELL_REGISTER("log", log_commands);
+
+#endif /* CONFIG_CONSOLE_SHELL */
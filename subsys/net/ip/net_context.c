@@ -2007,6 +2007,21 @@ int net_context_recv(struct net_context *context,
 	return 0;
 }
 
+/* take a reference, unless the last one is being dropped */
+static bool context_ref_used(struct net_context *context)
+{
+	atomic_val_t rc;
+
+	do {
+		rc = atomic_get(&context->refcount);
+		if (!rc) {
+			return false;
+		}
+	} while (!atomic_cas(&context->refcount, rc, rc + 1));
+
+	return true;
+}
+
 void net_context_foreach(net_context_cb_t cb, void *user_data)
 {
 	int i;
@@ -2014,11 +2029,22 @@ void net_context_foreach(net_context_cb_t cb, void *user_data)
 	k_sem_take(&contexts_lock, K_FOREVER);
 
 	for (i = 0; i < NET_MAX_CONTEXT; i++) {
-		if (!net_context_is_used(&contexts[i])) {
+		if (!net_context_is_used(&contexts[i]) ||
+		    !context_ref_used(&contexts[i])) {
 			continue;
 		}
 
+		/* a slow callback must not hold off the allocations, the
+		 * reference keeps the context from being released meanwhile
+		 */
+		k_sem_give(&contexts_lock);
+
 		cb(&contexts[i], user_data);
+
+		/* releases the context if it was put during the callback */
+		net_context_unref(&contexts[i]);
+
+		k_sem_take(&contexts_lock, K_FOREVER);
 	}
 
 	k_sem_give(&contexts_lock);
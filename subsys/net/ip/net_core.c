@@ -28,6 +28,7 @@
 #include <net/arp.h>
 #include <net/nbuf.h>
 #include <net/net_core.h>
+#include <debug/perf_counter.h>
 
 #include "net_private.h"
 #include "net_shell.h"
@@ -61,6 +62,12 @@
 NET_STACK_DEFINE(RX, rx_stack, CONFIG_NET_RX_STACK_SIZE,
 		 CONFIG_NET_RX_STACK_SIZE + CONFIG_NET_RX_STACK_RPL);
 
+PERF_COUNTER_DEFINE(net_rx_packets);
+PERF_COUNTER_DEFINE(net_rx_queued);
+PERF_COUNTER_DEFINE(net_tx_packets);
+PERF_COUNTER_DEFINE(net_tx_loopback);
+PERF_HISTOGRAM_DEFINE(net_rx_cycles);
+
 static struct k_fifo rx_queue;
 static k_tid_t rx_tid;
 
@@ -549,8 +556,13 @@ static void net_rx_thread(void)
 
 		net_stats_update_bytes_recv(pkt_len);
 
+		PERF_HISTOGRAM_START(net_rx_cycles);
+
 		processing_data(buf, false);
 
+		PERF_HISTOGRAM_STOP(net_rx_cycles);
+		PERF_COUNTER_INC(net_rx_packets);
+
 		net_print_statistics();
 		net_nbuf_print();
 
@@ -672,6 +684,8 @@ int net_send_data(struct net_buf *buf)
 	}
 #endif
 
+	PERF_COUNTER_INC(net_tx_packets);
+
 	status = check_ip_addr(buf);
 	if (status < 0) {
 		return status;
@@ -679,6 +693,7 @@ int net_send_data(struct net_buf *buf)
 		/* Packet is destined back to us so send it directly
 		 * to RX processing.
 		 */
+		PERF_COUNTER_INC(net_tx_loopback);
 		processing_data(buf, true);
 		return 0;
 	}
@@ -704,6 +719,8 @@ int net_recv_data(struct net_if *iface, struct net_buf *buf)
 
 	net_buf_put(&rx_queue, buf);
 
+	PERF_COUNTER_INC(net_rx_queued);
+
 	return 0;
 }
 
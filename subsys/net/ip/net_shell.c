@@ -40,6 +40,12 @@
 
 #define NET_SHELL_MODULE "net"
 
+/*
+ * The tables can be long: wait for room in the console buffer instead of
+ * dropping lines, see shell_printk().
+ */
+#define printk shell_printk
+
 /* net_stack dedicated section limiters */
 extern struct net_stack_info __net_stack_start[];
 extern struct net_stack_info __net_stack_end[];
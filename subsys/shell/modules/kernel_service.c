@@ -11,6 +11,9 @@
 
 #define SHELL_KERNEL "kernel"
 
+/* wait for room in the console buffer instead of dropping lines */
+#define printk shell_printk
+
 static int shell_cmd_version(int argc, char *argv[])
 {
 	uint32_t version = sys_kernel_version_get();
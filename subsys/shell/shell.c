@@ -55,6 +55,98 @@ static struct k_fifo cmds_queue;
 static shell_cmd_function_t app_cmd_handler;
 static shell_prompt_function_t app_prompt_handler;
 
+#if defined(CONFIG_UART_CONSOLE_BUFFERED) && !defined(CONFIG_TELNET_CONSOLE)
+static int shell_out(const char *buf, size_t len, void *ctx)
+{
+	ARG_UNUSED(ctx);
+
+	uart_console_write(buf, len);
+
+	return 0;
+}
+#else
+static int shell_out(const char *buf, size_t len, void *ctx)
+{
+	ARG_UNUSED(ctx);
+
+	printk("%.*s", (int)len, buf);
+
+	return 0;
+}
+#endif
+
+void shell_vprintk(const char *fmt, va_list ap)
+{
+	_vprf(shell_out, NULL, fmt, ap);
+}
+
+void shell_printk(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	shell_vprintk(fmt, ap);
+	va_end(ap);
+}
+
+#ifdef CONFIG_CONSOLE_SHELL_WORK_Q
+/*
+ * Commands run on a work queue of their own, at a low preemptible priority,
+ * for a long command to never hold off the threads of the system. The
+ * shell thread waits for a command to complete before reading the next.
+ */
+static char __stack work_q_stack[CONFIG_CONSOLE_SHELL_WORK_Q_STACKSIZE];
+static struct k_work_q work_q;
+
+static struct {
+	struct k_work work;
+	struct k_sem done;
+	shell_cmd_function_t cb;
+	int argc;
+	char **argv;
+	int ret;
+} cmd_work;
+
+static void cmd_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	cmd_work.ret = cmd_work.cb(cmd_work.argc, cmd_work.argv);
+
+	k_sem_give(&cmd_work.done);
+}
+
+static void cmd_work_init(void)
+{
+	k_work_init(&cmd_work.work, cmd_work_handler);
+	k_sem_init(&cmd_work.done, 0, 1);
+
+	k_work_q_start(&work_q, work_q_stack, sizeof(work_q_stack),
+		       CONFIG_CONSOLE_SHELL_WORK_Q_PRIORITY);
+}
+
+static int cmd_run(shell_cmd_function_t cb, int argc, char *argv[])
+{
+	cmd_work.cb = cb;
+	cmd_work.argc = argc;
+	cmd_work.argv = argv;
+
+	k_work_submit_to_queue(&work_q, &cmd_work.work);
+	k_sem_take(&cmd_work.done, K_FOREVER);
+
+	return cmd_work.ret;
+}
+#else
+static inline void cmd_work_init(void)
+{
+}
+
+static inline int cmd_run(shell_cmd_function_t cb, int argc, char *argv[])
+{
+	return cb(argc, argv);
+}
+#endif
+
 static const char *get_prompt(void)
 {
 	if (app_prompt_handler) {
@@ -361,7 +453,7 @@ static void shell(void *p1, void *p2, void *p3)
 		}
 
 		/* Execute callback with arguments */
-		if (cb(argc, argv) < 0) {
+		if (cmd_run(cb, argc, argv) < 0) {
 			show_cmd_help(argv);
 		}
 
@@ -519,6 +611,7 @@ void shell_init(const char *str)
 	k_fifo_init(&avail_queue);
 
 	line_queue_init();
+	cmd_work_init();
 
 	prompt = str ? str : "";
 
@@ -42,6 +42,9 @@
 #include <uart.h>
 #include <string.h>
 #include <misc/byteorder.h>
+#include <misc/printk.h>
+#include <shell/shell.h>
+#include <usb/class/usb_cdc_acm.h>
 #include "cdc_acm.h"
 #include "usb_device.h"
 #include "usb_common.h"
@@ -63,8 +66,12 @@ static struct uart_driver_api cdc_acm_driver_api;
 /* 115200bps, no parity, 1 stop bit, 8bit char */
 #define CDC_ACM_DEFAUL_BAUDRATE {sys_cpu_to_le32(115200), 0, 0, 8}
 
-/* Size of the internal buffer used for storing received data */
-#define CDC_ACM_BUFFER_SIZE (2 * CDC_BULK_EP_MPS)
+/* Size of the internal buffers used for storing received and sent data */
+#define CDC_ACM_RX_BUF_SIZE CONFIG_CDC_ACM_RX_BUF_SIZE
+#define CDC_ACM_TX_BUF_SIZE CONFIG_CDC_ACM_TX_BUF_SIZE
+
+/* Largest bulk IN transfer, in full packets */
+#define CDC_ACM_TX_XFER_SIZE (4 * CDC_BULK_EP_MPS)
 
 /* Misc. macros */
 #define LOW_BYTE(x)  ((x) & 0xFF)
@@ -85,9 +92,20 @@ struct cdc_acm_dev_data_t {
 	uint8_t rx_ready;                 /* Rx ready status */
 	uint8_t tx_irq_ena;               /* Tx interrupt enable status */
 	uint8_t rx_irq_ena;               /* Rx interrupt enable status */
-	uint8_t rx_buf[CDC_ACM_BUFFER_SIZE];/* Internal Rx buffer */
+	uint8_t rx_buf[CDC_ACM_RX_BUF_SIZE];/* Internal Rx buffer */
 	uint32_t rx_buf_head;             /* Head of the internal Rx buffer */
 	uint32_t rx_buf_tail;             /* Tail of the internal Rx buffer */
+	/* A received packet waits for room in rx_buf, the endpoint NAKs */
+	uint8_t rx_paused;
+	uint8_t tx_buf[CDC_ACM_TX_BUF_SIZE];/* Internal Tx buffer */
+	uint32_t tx_buf_head;             /* Head of the internal Tx buffer */
+	uint32_t tx_buf_tail;             /* Tail of the internal Tx buffer */
+	/* Bulk IN transfer in progress, and its length */
+	uint8_t tx_busy;
+	uint32_t tx_len;
+	/* The USB controller accesses its FIFOs per 32-bit words */
+	uint32_t rx_packet[CDC_BULK_EP_MPS / 4];
+	uint32_t tx_xfer[CDC_ACM_TX_XFER_SIZE / 4];
 	/* Interface data buffer */
 	uint8_t interface_data[CDC_CLASS_REQ_MAX_DATA_SIZE];
 	/* CDC ACM line coding properties. LE order */
@@ -100,6 +118,65 @@ struct cdc_acm_dev_data_t {
 	uint8_t notification_sent;
 };
 
+#if defined(CONFIG_CDC_ACM_STATS)
+static struct cdc_acm_stats cdc_acm_stats;
+
+#define CDC_ACM_STATS_ADD(_field, _val) (cdc_acm_stats._field += (_val))
+
+void cdc_acm_stats_get(struct cdc_acm_stats *stats)
+{
+	int key = irq_lock();
+
+	memcpy(stats, &cdc_acm_stats, sizeof(*stats));
+	irq_unlock(key);
+}
+
+void cdc_acm_stats_reset(void)
+{
+	int key = irq_lock();
+
+	memset(&cdc_acm_stats, 0, sizeof(cdc_acm_stats));
+	irq_unlock(key);
+}
+#else
+#define CDC_ACM_STATS_ADD(_field, _val)
+#endif
+
+/* Bytes stored in a ring buffer, which keeps one byte free */
+static inline uint32_t cdc_acm_ring_used(uint32_t head, uint32_t tail,
+					 uint32_t size)
+{
+	return (size + head - tail) % size;
+}
+
+static inline uint32_t cdc_acm_ring_free(uint32_t head, uint32_t tail,
+					 uint32_t size)
+{
+	return size - 1 - cdc_acm_ring_used(head, tail, size);
+}
+
+/* Copy data at the head of a ring buffer, the caller checked for room */
+static uint32_t cdc_acm_ring_put(uint8_t *ring, uint32_t size, uint32_t head,
+				 const uint8_t *data, uint32_t len)
+{
+	uint32_t part = min(len, size - head);
+
+	memcpy(ring + head, data, part);
+	memcpy(ring, data + part, len - part);
+
+	return (head + len) % size;
+}
+
+/* Copy data from the tail of a ring buffer, without consuming it */
+static void cdc_acm_ring_peek(const uint8_t *ring, uint32_t size,
+			      uint32_t tail, uint8_t *data, uint32_t len)
+{
+	uint32_t part = min(len, size - tail);
+
+	memcpy(data, ring + tail, part);
+	memcpy(data + part, ring, len - part);
+}
+
 /* Structure representing the global USB description */
 static const uint8_t cdc_acm_usb_description[] = {
 	/* Device descriptor */
@@ -295,6 +372,137 @@ int cdc_acm_class_handle_req(struct usb_setup_packet *pSetup,
 	return 0;
 }
 
+static void cdc_acm_tx_retry(struct k_timer *timer);
+
+/* Retries a transfer the controller had no room for, a frame later */
+static K_TIMER_DEFINE(tx_retry_timer, cdc_acm_tx_retry, NULL);
+
+/**
+ * @brief Start a bulk IN transfer of the data in the Tx buffer
+ *
+ * Up to CDC_ACM_TX_XFER_SIZE bytes are sent at once, as full packets
+ * but for the last one. When a transfer of full packets emptied the
+ * buffer, it is followed by a zero length packet so that the host does
+ * not wait for more data to end its read. When the controller takes
+ * nothing, no bulk IN event follows, so the transfer is retried from a
+ * timer. Called with interrupts locked.
+ *
+ * @param dev_data CDC ACM device data.
+ *
+ * @return  N/A.
+ */
+static void cdc_acm_tx_start(struct cdc_acm_dev_data_t * const dev_data)
+{
+	uint32_t len, written = 0;
+
+	if (dev_data->tx_busy || dev_data->usb_status != USB_DC_CONFIGURED) {
+		return;
+	}
+
+	len = min(cdc_acm_ring_used(dev_data->tx_buf_head,
+				    dev_data->tx_buf_tail,
+				    CDC_ACM_TX_BUF_SIZE),
+		  CDC_ACM_TX_XFER_SIZE);
+
+	if (!len) {
+		if (!dev_data->tx_len || dev_data->tx_len % CDC_BULK_EP_MPS) {
+			return;
+		}
+
+		if (usb_write(CDC_ENDP_IN, NULL, 0, NULL) < 0) {
+			k_timer_start(&tx_retry_timer, K_MSEC(1), 0);
+			return;
+		}
+
+		dev_data->tx_len = 0;
+		dev_data->tx_busy = 1;
+		CDC_ACM_STATS_ADD(tx_zlps, 1);
+
+		return;
+	}
+
+	cdc_acm_ring_peek(dev_data->tx_buf, CDC_ACM_TX_BUF_SIZE,
+			  dev_data->tx_buf_tail, (uint8_t *)dev_data->tx_xfer,
+			  len);
+
+	/*
+	 * The controller may take less than asked, in whole packets, the
+	 * rest stays queued
+	 */
+	if (usb_write(CDC_ENDP_IN, (uint8_t *)dev_data->tx_xfer, len,
+		      &written) < 0 || !written) {
+		k_timer_start(&tx_retry_timer, K_MSEC(1), 0);
+		return;
+	}
+
+	dev_data->tx_buf_tail = (dev_data->tx_buf_tail + written) %
+		CDC_ACM_TX_BUF_SIZE;
+	dev_data->tx_len = written;
+	dev_data->tx_busy = 1;
+
+	CDC_ACM_STATS_ADD(tx_bytes, written);
+	CDC_ACM_STATS_ADD(tx_transfers, 1);
+}
+
+static void cdc_acm_tx_retry(struct k_timer *timer)
+{
+	int key;
+
+	ARG_UNUSED(timer);
+
+	key = irq_lock();
+	cdc_acm_tx_start(DEV_DATA(cdc_acm_dev));
+	irq_unlock(key);
+}
+
+/**
+ * @brief Store a received packet in the Rx buffer
+ *
+ * When the Rx buffer cannot take the whole packet, it is left in the
+ * controller, which NAKs the host until the packet is read. Called with
+ * interrupts locked.
+ *
+ * @param dev_data CDC ACM device data.
+ *
+ * @return  N/A.
+ */
+static void cdc_acm_rx_packet(struct cdc_acm_dev_data_t * const dev_data)
+{
+	uint32_t len = 0;
+
+	usb_ep_read_wait(CDC_ENDP_OUT, NULL, 0, &len);
+
+	if (len > cdc_acm_ring_free(dev_data->rx_buf_head,
+				    dev_data->rx_buf_tail,
+				    CDC_ACM_RX_BUF_SIZE)) {
+		if (!dev_data->rx_paused) {
+			dev_data->rx_paused = 1;
+			CDC_ACM_STATS_ADD(rx_naks, 1);
+		}
+
+		return;
+	}
+
+	usb_ep_read_wait(CDC_ENDP_OUT, (uint8_t *)dev_data->rx_packet,
+			 sizeof(dev_data->rx_packet), &len);
+	dev_data->rx_buf_head = cdc_acm_ring_put(dev_data->rx_buf,
+						 CDC_ACM_RX_BUF_SIZE,
+						 dev_data->rx_buf_head,
+						 (uint8_t *)dev_data->rx_packet,
+						 len);
+	dev_data->rx_paused = 0;
+
+	/* Let the host send the next packet */
+	usb_ep_read_continue(CDC_ENDP_OUT);
+
+	CDC_ACM_STATS_ADD(rx_bytes, len);
+	CDC_ACM_STATS_ADD(rx_packets, 1);
+
+	if (len) {
+		dev_data->rx_ready = 1;
+	}
+}
+
 /**
  * @brief EP Bulk IN handler, used to send data to the Host
  *
@@ -306,10 +514,17 @@ int cdc_acm_class_handle_req(struct usb_setup_packet *pSetup,
 static void cdc_acm_bulk_in(uint8_t ep, enum usb_dc_ep_cb_status_code ep_status)
 {
 	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(cdc_acm_dev);
+	int key;
 
 	ARG_UNUSED(ep_status);
 	ARG_UNUSED(ep);
 
+	/* Send the next data right away, packets go back to back */
+	key = irq_lock();
+	dev_data->tx_busy = 0;
+	cdc_acm_tx_start(dev_data);
+	irq_unlock(key);
+
 	dev_data->tx_ready = 1;
 	k_sem_give(&poll_wait_sem);
 	/* Call callback only if tx irq ena */
@@ -330,44 +545,20 @@ static void cdc_acm_bulk_out(uint8_t ep,
 			     enum usb_dc_ep_cb_status_code ep_status)
 {
 	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(cdc_acm_dev);
-	uint32_t bytes_to_read, i, j, buf_head;
-	uint8_t tmp_buf[4];
+	int key;
 
 	ARG_UNUSED(ep_status);
+	ARG_UNUSED(ep);
 
-	/* Check how many bytes were received */
-	usb_read(ep, NULL, 0, &bytes_to_read);
-
-	buf_head = dev_data->rx_buf_head;
+	key = irq_lock();
+	cdc_acm_rx_packet(dev_data);
+	irq_unlock(key);
 
-	/*
-	 * Quark SE USB controller is always storing data
-	 * in the FIFOs per 32-bit words.
+	/* Call callback only if rx irq ena and there is data to read, which
+	 * also makes room for a packet the host is kept waiting with
 	 */
-	for (i = 0; i < bytes_to_read; i += 4) {
-		usb_read(ep, tmp_buf, 4, NULL);
-
-		for (j = 0; j < 4; j++) {
-			if (i + j == bytes_to_read) {
-				/* We read all the data */
-				break;
-			}
-
-			if (((buf_head + 1) % CDC_ACM_BUFFER_SIZE) ==
-			    dev_data->rx_buf_tail) {
-				/* FIFO full, discard data */
-				SYS_LOG_ERR("CDC buffer full!");
-			} else {
-				dev_data->rx_buf[buf_head] = tmp_buf[j];
-				buf_head = (buf_head + 1) % CDC_ACM_BUFFER_SIZE;
-			}
-		}
-	}
-
-	dev_data->rx_buf_head = buf_head;
-	dev_data->rx_ready = 1;
-	/* Call callback only if rx irq ena */
-	if (dev_data->cb && dev_data->rx_irq_ena) {
+	if (dev_data->cb && dev_data->rx_irq_ena &&
+	    dev_data->rx_buf_head != dev_data->rx_buf_tail) {
 		dev_data->cb(cdc_acm_dev);
 	}
 }
@@ -401,9 +592,21 @@ static void cdc_acm_dev_status_cb(enum usb_dc_status_code status)
 {
 	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(cdc_acm_dev);
 
+	int key;
+
 	/* Store the new status */
 	dev_data->usb_status = status;
 
+	if (status == USB_DC_RESET || status == USB_DC_DISCONNECTED) {
+		/* The endpoints are reset, pending data is meaningless */
+		key = irq_lock();
+		dev_data->tx_buf_tail = dev_data->tx_buf_head;
+		dev_data->tx_busy = 0;
+		dev_data->tx_len = 0;
+		dev_data->rx_paused = 0;
+		irq_unlock(key);
+	}
+
 	/* Check the USB status and do needed action if required */
 	switch (status) {
 	case USB_DC_ERROR:
@@ -521,6 +724,8 @@ static int cdc_acm_init(struct device *dev)
 /**
  * @brief Fill FIFO with data
  *
+ * The data is queued in the Tx buffer and sent in the background.
+ *
  * @param dev     CDC ACM device struct.
  * @param tx_data Data to transmit.
  * @param len     Number of bytes to send.
@@ -531,16 +736,32 @@ static int cdc_acm_fifo_fill(struct device *dev,
 			     const uint8_t *tx_data, int len)
 {
 	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(dev);
-	uint32_t bytes_written = 0;
+	uint32_t room;
+	int key;
 
-	if (dev_data->usb_status != USB_DC_CONFIGURED) {
+	if (dev_data->usb_status != USB_DC_CONFIGURED || len <= 0) {
 		return 0;
 	}
 
+	key = irq_lock();
+
+	room = cdc_acm_ring_free(dev_data->tx_buf_head, dev_data->tx_buf_tail,
+				 CDC_ACM_TX_BUF_SIZE);
+	if (len > room) {
+		CDC_ACM_STATS_ADD(tx_full, 1);
+		len = room;
+	}
+
+	dev_data->tx_buf_head = cdc_acm_ring_put(dev_data->tx_buf,
+						 CDC_ACM_TX_BUF_SIZE,
+						 dev_data->tx_buf_head,
+						 tx_data, len);
 	dev_data->tx_ready = 0;
-	usb_write(CDC_ENDP_IN, tx_data, len, &bytes_written);
+	cdc_acm_tx_start(dev_data);
+
+	irq_unlock(key);
 
-	return bytes_written;
+	return len;
 }
 
 /**
@@ -555,30 +776,38 @@ static int cdc_acm_fifo_fill(struct device *dev,
 static int cdc_acm_fifo_read(struct device *dev, uint8_t *rx_data,
 			     const int size)
 {
-	uint32_t avail_data, bytes_read, i;
+	uint32_t avail_data, bytes_read;
 	struct cdc_acm_dev_data_t * const dev_data = DEV_DATA(dev);
+	int key;
 
-	avail_data = (CDC_ACM_BUFFER_SIZE + dev_data->rx_buf_head -
-		      dev_data->rx_buf_tail) % CDC_ACM_BUFFER_SIZE;
-	if (avail_data > size) {
-		bytes_read = size;
-	} else {
-		bytes_read = avail_data;
+	if (size <= 0) {
+		return 0;
 	}
 
-	for (i = 0; i < bytes_read; i++) {
-		rx_data[i] = dev_data->rx_buf[(dev_data->rx_buf_tail + i) %
-					      CDC_ACM_BUFFER_SIZE];
-	}
+	key = irq_lock();
 
+	avail_data = cdc_acm_ring_used(dev_data->rx_buf_head,
+				       dev_data->rx_buf_tail,
+				       CDC_ACM_RX_BUF_SIZE);
+	bytes_read = min(avail_data, size);
+
+	cdc_acm_ring_peek(dev_data->rx_buf, CDC_ACM_RX_BUF_SIZE,
+			  dev_data->rx_buf_tail, rx_data, bytes_read);
 	dev_data->rx_buf_tail = (dev_data->rx_buf_tail + bytes_read) %
-		CDC_ACM_BUFFER_SIZE;
+		CDC_ACM_RX_BUF_SIZE;
+
+	if (dev_data->rx_paused) {
+		/* Take the packet the host is waiting with */
+		cdc_acm_rx_packet(dev_data);
+	}
 
 	if (dev_data->rx_buf_tail == dev_data->rx_buf_head) {
 		/* Buffer empty */
 		dev_data->rx_ready = 0;
 	}
 
+	irq_unlock(key);
+
 	return bytes_read;
 }
 
@@ -862,16 +1091,21 @@ static int cdc_acm_poll_in(struct device *dev, unsigned char *c)
 /*
  * @brief Output a character in polled mode.
  *
- * The UART poll method for USB UART is simulated by waiting till
- * we get the next BULK In upcall from the USB device controller or 100 ms.
+ * The UART poll method for USB UART is simulated by queuing the character
+ * in the Tx buffer. When it is full, we wait for the next BULK In upcall
+ * from the USB device controller or 100 ms.
  *
  * @return the same character which is sent
  */
 static unsigned char cdc_acm_poll_out(struct device *dev,
 				      unsigned char c)
 {
-	cdc_acm_fifo_fill(dev, &c, 1);
-	k_sem_take(&poll_wait_sem, K_MSEC(100));
+	while (!cdc_acm_fifo_fill(dev, &c, 1)) {
+		if (DEV_DATA(dev)->usb_status != USB_DC_CONFIGURED ||
+		    k_sem_take(&poll_wait_sem, K_MSEC(100))) {
+			break;
+		}
+	}
 
 	return c;
 }
@@ -904,3 +1138,47 @@ static struct cdc_acm_dev_data_t cdc_acm_dev_data = {
 DEVICE_INIT(cdc_acm, CONFIG_CDC_ACM_PORT_NAME, &cdc_acm_init,
 	    &cdc_acm_dev_data, NULL,
 	    APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEVICE);
+
+#if defined(CONFIG_CDC_ACM_STATS) && defined(CONFIG_CONSOLE_SHELL)
+
+static uint32_t stats_since;
+
+static int shell_cmd_stats(int argc, char *argv[])
+{
+	struct cdc_acm_stats stats;
+	uint32_t ms = k_uptime_get_32() - stats_since;
+
+	cdc_acm_stats_get(&stats);
+
+	printk("RX: %u bytes in %u packets, %u NAKs\n", stats.rx_bytes,
+	       stats.rx_packets, stats.rx_naks);
+	printk("TX: %u bytes in %u transfers, %u ZLPs, ring full %u times\n",
+	       stats.tx_bytes, stats.tx_transfers, stats.tx_zlps,
+	       stats.tx_full);
+
+	if (ms) {
+		printk("%u ms: RX %u bytes/s, TX %u bytes/s\n", ms,
+		       (uint32_t)((uint64_t)stats.rx_bytes * MSEC_PER_SEC / ms),
+		       (uint32_t)((uint64_t)stats.tx_bytes * MSEC_PER_SEC / ms));
+	}
+
+	return 0;
+}
+
+static int shell_cmd_reset(int argc, char *argv[])
+{
+	cdc_acm_stats_reset();
+	stats_since = k_uptime_get_32();
+
+	return 0;
+}
+
+static struct shell_cmd cdc_acm_commands[] = {
+	{ "stats", shell_cmd_stats, "show throughput statistics" },
+	{ "reset", shell_cmd_reset, "reset throughput statistics" },
+	{ NULL, NULL, NULL }
+};
+
+SHELL_REGISTER("cdc_acm", cdc_acm_commands);
+
+#endif /* CONFIG_CDC_ACM_STATS && CONFIG_CONSOLE_SHELL */
@@ -38,6 +38,7 @@
 #include <string.h>
 #include <misc/__assert.h>
 #include <disk_access.h>
+#include <usb/class/usb_msc.h>
 #include "mass_storage.h"
 #include "usb_device.h"
 #include "usb_common.h"
@@ -56,12 +57,86 @@
 #define DISK_THREAD_STACK_SZ	512
 #define DISK_THREAD_PRIO	-5
 
+/* Size of one transfer buffer, disk accesses are done buffer by buffer */
+#define MSD_BUF_SIZE	(CONFIG_USB_MASS_STORAGE_BUF_BLOCKS * BLOCK_SIZE)
+#define MSD_BUF_COUNT	CONFIG_USB_MASS_STORAGE_BUF_COUNT
+#define MSD_BUF_NEXT(idx)	(((idx) + 1) % MSD_BUF_COUNT)
+
 static volatile int thread_op;
 static char __stack mass_thread_stack[DISK_THREAD_STACK_SZ];
 static struct k_sem disk_wait_sem;
-static volatile uint32_t defered_wr_sz;
 
-static uint8_t page[BLOCK_SIZE];
+/*
+ * Data is staged in a ring of buffers shared between the USB endpoint
+ * callbacks and the disk thread, so that the disk is accessed for the
+ * next buffer while the current one goes over the bulk endpoint.
+ *
+ * For reads the disk thread fills FREE buffers and marks them READY, the
+ * bulk IN handler sends READY buffers and frees them. For writes the bulk
+ * OUT handler fills FREE buffers and marks them READY, the disk thread
+ * writes READY buffers to disk and frees them.
+ */
+enum msd_buf_state {
+	MSD_BUF_FREE,
+	MSD_BUF_READY,
+};
+
+struct msd_buf {
+	uint8_t data[MSD_BUF_SIZE];
+	/* first block of the buffer on the disk */
+	uint32_t lba;
+	/* bytes of valid data */
+	uint32_t len;
+	/* bytes already sent to or received from the host */
+	uint32_t pos;
+	volatile enum msd_buf_state state;
+};
+
+static struct msd_buf msd_bufs[MSD_BUF_COUNT];
+
+/* buffer used by the endpoint handlers */
+static uint8_t usb_idx;
+/* buffer used by the disk thread */
+static uint8_t disk_idx;
+
+/* next block to read from or write to the disk, and bytes left */
+static uint32_t disk_lba;
+static volatile uint32_t disk_left;
+static bool disk_error;
+
+/* an endpoint waits for the disk thread to free or fill a buffer */
+static volatile bool in_stalled;
+static volatile bool out_stalled;
+
+#if defined(CONFIG_USB_MASS_STORAGE_STATS)
+static struct usb_msc_stats msd_stats;
+
+#define MSD_STATS_ADD(_field, _val) (msd_stats._field += (_val))
+#define MSD_STATS_DECLARE_START() uint32_t start_cycles
+#define MSD_STATS_START() (start_cycles = k_cycle_get_32())
+#define MSD_STATS_ELAPSED() (k_cycle_get_32() - start_cycles)
+
+void usb_msc_stats_get(struct usb_msc_stats *stats)
+{
+	int key = irq_lock();
+
+	memcpy(stats, &msd_stats, sizeof(*stats));
+	irq_unlock(key);
+}
+
+void usb_msc_stats_reset(void)
+{
+	int key = irq_lock();
+
+	memset(&msd_stats, 0, sizeof(msd_stats));
+	irq_unlock(key);
+}
+#else
+#define MSD_STATS_ADD(_field, _val)
+#define MSD_STATS_DECLARE_START()
+#define MSD_STATS_START()
+#define MSD_STATS_ELAPSED() 0
+#endif
 
 /* Initialized during mass_storage_init() */
 static uint32_t memory_size;
@@ -203,11 +278,33 @@ static void msd_init(void)
 {
 	memset((void *)&cbw, 0, sizeof(struct CBW));
 	memset((void *)&csw, 0, sizeof(struct CSW));
-	memset(page, 0, sizeof(page));
+	memset(msd_bufs, 0, sizeof(msd_bufs));
+	usb_idx = 0;
+	disk_idx = 0;
+	disk_left = 0;
+	in_stalled = false;
+	out_stalled = false;
 	addr = 0;
 	length = 0;
 }
 
+static void msd_bufs_reset(uint32_t size)
+{
+	int i;
+
+	for (i = 0; i < MSD_BUF_COUNT; i++) {
+		msd_bufs[i].state = MSD_BUF_FREE;
+		msd_bufs[i].pos = 0;
+		msd_bufs[i].len = 0;
+	}
+
+	usb_idx = 0;
+	disk_idx = 0;
+	disk_lba = addr / BLOCK_SIZE;
+	disk_left = size;
+	disk_error = false;
+}
+
 static void sendCSW(void)
 {
 	csw.Signature = CSW_Signature;
@@ -382,58 +479,79 @@ static bool readCapacity(void)
 	return true;
 }
 
-static void thread_memory_read_done(void)
+/* Called from the bulk IN handler, or from the disk thread with the
+ * interrupts locked when the IN endpoint was waiting for data.
+ */
+static void memoryRead(void)
 {
+	struct msd_buf *buf = &msd_bufs[usb_idx];
 	uint32_t n;
 
+	if (buf->state != MSD_BUF_READY) {
+		/* resumed by the disk thread once the buffer is filled */
+		in_stalled = true;
+		MSD_STATS_ADD(in_stalls, 1);
+		return;
+	}
+
 	n = (length > MAX_PACKET) ? MAX_PACKET : length;
 	if ((addr + n) > memory_size) {
 		n = memory_size - addr;
 		stage = ERROR;
 	}
 
-	if (usb_write(EPBULK_IN, &page[addr % BLOCK_SIZE], n, NULL) != 0) {
+	/* the data is copied into the endpoint FIFO before returning */
+	if (usb_write(EPBULK_IN, &buf->data[buf->pos], n, NULL) != 0) {
 		SYS_LOG_ERR("usb write failure");
 	}
+
+	buf->pos += n;
 	addr += n;
 	length -= n;
 
 	csw.DataResidue -= n;
+	MSD_STATS_ADD(bytes_read, n);
+
+	if (buf->pos == buf->len) {
+		buf->state = MSD_BUF_FREE;
+		usb_idx = MSD_BUF_NEXT(usb_idx);
+		if (disk_left) {
+			k_sem_give(&disk_wait_sem);
+		}
+	}
 
 	if (!length || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == PROCESS_CBW) ? CSW_PASSED : CSW_FAILED;
+		csw.Status = (stage == PROCESS_CBW && !disk_error) ?
+			     CSW_PASSED : CSW_FAILED;
 		stage = (stage == PROCESS_CBW) ? SEND_CSW : stage;
 	}
 }
 
-
-static void memoryRead(void)
+static void msd_start_read(void)
 {
-	uint32_t n;
-
-	n = (length > MAX_PACKET) ? MAX_PACKET : length;
-	if ((addr + n) > memory_size) {
-		n = memory_size - addr;
-		stage = ERROR;
-	}
-
-	/* we read an entire block */
-	if (!(addr % BLOCK_SIZE)) {
-		thread_op = THREAD_OP_READ_QUEUED;
-		SYS_LOG_DBG("Signal thread for %d", (addr/BLOCK_SIZE));
-		k_sem_give(&disk_wait_sem);
+	if (addr >= memory_size) {
+		SYS_LOG_WRN("BI - STall > MemSz");
+		usb_ep_set_stall(EPBULK_IN);
+		csw.Status = CSW_FAILED;
+		sendCSW();
 		return;
 	}
-	usb_write(EPBULK_IN, &page[addr % BLOCK_SIZE], n, NULL);
-	addr += n;
-	length -= n;
 
-	csw.DataResidue -= n;
+	stage = PROCESS_CBW;
+	msd_bufs_reset(min(length, memory_size - addr));
 
-	if (!length || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == PROCESS_CBW) ? CSW_PASSED : CSW_FAILED;
-		stage = (stage == PROCESS_CBW) ? SEND_CSW : stage;
-	}
+	/* the first packet is sent by the disk thread */
+	in_stalled = true;
+	thread_op = THREAD_OP_READ_QUEUED;
+	k_sem_give(&disk_wait_sem);
+}
+
+static void msd_start_write(void)
+{
+	stage = PROCESS_CBW;
+	msd_bufs_reset(min(length, memory_size - addr));
+	msd_bufs[usb_idx].lba = disk_lba;
+	thread_op = THREAD_OP_WRITE_QUEUED;
 }
 
 static bool infoTransfer(void)
@@ -546,8 +664,7 @@ static void CBWDecode(uint8_t *buf, uint16_t size)
 			SYS_LOG_DBG(">> READ");
 			if (infoTransfer()) {
 				if ((cbw.Flags & 0x80)) {
-					stage = PROCESS_CBW;
-					memoryRead();
+					msd_start_read();
 				} else {
 					usb_ep_set_stall(EPBULK_OUT);
 					SYS_LOG_DBG("BO-STALL");
@@ -561,7 +678,7 @@ static void CBWDecode(uint8_t *buf, uint16_t size)
 			SYS_LOG_DBG(">> WRITE");
 			if (infoTransfer()) {
 				if (!(cbw.Flags & 0x80)) {
-					stage = PROCESS_CBW;
+					msd_start_write();
 				} else {
 					usb_ep_set_stall(EPBULK_IN);
 					SYS_LOG_DBG("BI-STALL");
@@ -605,6 +722,7 @@ static void CBWDecode(uint8_t *buf, uint16_t size)
 
 static void memoryVerify(uint8_t *buf, uint16_t size)
 {
+	uint8_t *page = msd_bufs[0].data;
 	uint32_t n;
 
 	if ((addr + size) > memory_size) {
@@ -645,6 +763,8 @@ static void memoryVerify(uint8_t *buf, uint16_t size)
 
 static void memoryWrite(uint8_t *buf, uint16_t size)
 {
+	struct msd_buf *wbuf = &msd_bufs[usb_idx];
+
 	if ((addr + size) > memory_size) {
 		size = memory_size - addr;
 		stage = ERROR;
@@ -652,30 +772,41 @@ static void memoryWrite(uint8_t *buf, uint16_t size)
 		SYS_LOG_WRN("BO - STall > MemSz");
 	}
 
-	/* we fill an array in RAM of 1 block before writing it in memory */
-	for (int i = 0; i < size; i++) {
-		page[addr % BLOCK_SIZE + i] = buf[i];
+	if (size > MSD_BUF_SIZE - wbuf->pos) {
+		size = MSD_BUF_SIZE - wbuf->pos;
 	}
 
-	/* if the array is filled, write it in memory */
-	if (!((addr + size) % BLOCK_SIZE)) {
-		if (!(disk_access_status() & DISK_STATUS_WR_PROTECT)) {
-			SYS_LOG_DBG("Disk WRITE Qd %d", (addr/BLOCK_SIZE));
-			thread_op = THREAD_OP_WRITE_QUEUED;  /* write_queued */
-			defered_wr_sz = size;
-			k_sem_give(&disk_wait_sem);
-			return;
-		}
-	}
+	/* gather packets in RAM, the buffer is written once it is full */
+	memcpy(&wbuf->data[wbuf->pos], buf, size);
+	wbuf->pos += size;
 
 	addr += size;
 	length -= size;
 	csw.DataResidue -= size;
+	MSD_STATS_ADD(bytes_written, size);
 
-	if ((!length) || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == ERROR) ? CSW_FAILED : CSW_PASSED;
-		sendCSW();
+	if ((wbuf->pos < MSD_BUF_SIZE) && length && (stage == PROCESS_CBW)) {
+		return;
+	}
+
+	/* hand the buffer over to the disk thread; the CSW is sent by the
+	 * disk thread once the last buffer reached the disk
+	 */
+	SYS_LOG_DBG("Disk WRITE Qd %d", wbuf->lba);
+	wbuf->len = wbuf->pos;
+	wbuf->state = MSD_BUF_READY;
+
+	usb_idx = MSD_BUF_NEXT(usb_idx);
+	msd_bufs[usb_idx].lba = wbuf->lba + wbuf->len / BLOCK_SIZE;
+
+	/* keep the host waiting until a buffer is available */
+	if (!length || (stage != PROCESS_CBW) ||
+	    msd_bufs[usb_idx].state != MSD_BUF_FREE) {
+		out_stalled = true;
+		MSD_STATS_ADD(out_stalls, 1);
 	}
+
+	k_sem_give(&disk_wait_sem);
 }
 
 
@@ -724,7 +855,7 @@ static void mass_storage_bulk_out(uint8_t ep,
 		break;
 	}
 
-	if (thread_op != THREAD_OP_WRITE_QUEUED) {
+	if (!out_stalled) {
 		usb_ep_read_continue(ep);
 	} else {
 		SYS_LOG_DBG("> BO not clearing NAKs yet");
@@ -732,23 +863,112 @@ static void mass_storage_bulk_out(uint8_t ep,
 
 }
 
-static void thread_memory_write_done(void)
+/* Disk thread side of a READ: fill free buffers ahead of the endpoint */
+static void thread_memory_read(void)
 {
-	uint32_t size = defered_wr_sz;
+	struct msd_buf *buf;
+	uint32_t n;
+	int key;
+	MSD_STATS_DECLARE_START();
 
-	addr += size;
-	length -= size;
-	csw.DataResidue -= size;
+	while (disk_left) {
+		buf = &msd_bufs[disk_idx];
+		if (buf->state != MSD_BUF_FREE) {
+			/* woken up again when the endpoint frees it */
+			return;
+		}
 
+		n = min(disk_left, MSD_BUF_SIZE);
 
-	if ((!length) || (stage != PROCESS_CBW)) {
-		csw.Status = (stage == ERROR) ? CSW_FAILED : CSW_PASSED;
-		sendCSW();
+		MSD_STATS_START();
+
+		if (disk_access_read(buf->data, disk_lba, n / BLOCK_SIZE)) {
+			SYS_LOG_ERR("!! Disk Read Error %d !", disk_lba);
+			disk_error = true;
+		}
+
+		MSD_STATS_ADD(disk_reads, 1);
+		MSD_STATS_ADD(disk_read_cycles, MSD_STATS_ELAPSED());
+
+		buf->lba = disk_lba;
+		buf->len = n;
+		buf->pos = 0;
+		disk_lba += n / BLOCK_SIZE;
+		disk_left -= n;
+		disk_idx = MSD_BUF_NEXT(disk_idx);
+
+		key = irq_lock();
+		buf->state = MSD_BUF_READY;
+		if (in_stalled) {
+			/*
+			 * No IN transfer in flight, start the next one. Its
+			 * completion must not run memoryRead() before this
+			 * one has advanced the counters, keep the interrupts
+			 * locked.
+			 */
+			in_stalled = false;
+			memoryRead();
+		}
+		irq_unlock(key);
 	}
+}
+
+/* Disk thread side of a WRITE: flush ready buffers to the disk */
+static void thread_memory_write(void)
+{
+	struct msd_buf *buf;
+	uint32_t n;
+	int key;
+	MSD_STATS_DECLARE_START();
+
+	while (msd_bufs[disk_idx].state == MSD_BUF_READY) {
+		buf = &msd_bufs[disk_idx];
+		n = buf->len / BLOCK_SIZE;
+
+		if (!(disk_access_status() & DISK_STATUS_WR_PROTECT) && n) {
+			MSD_STATS_START();
 
-	thread_op = THREAD_OP_WRITE_DONE;
+			if (disk_access_write(buf->data, buf->lba, n)) {
+				SYS_LOG_ERR("!!!!! Disk Write Error %d !!!!!",
+					    buf->lba);
+				disk_error = true;
+			}
+
+			MSD_STATS_ADD(disk_writes, 1);
+			MSD_STATS_ADD(disk_write_cycles, MSD_STATS_ELAPSED());
+		}
 
-	usb_ep_read_continue(EPBULK_OUT);
+		disk_idx = MSD_BUF_NEXT(disk_idx);
+
+		key = irq_lock();
+		buf->pos = 0;
+		buf->state = MSD_BUF_FREE;
+
+		if (!length || (stage != PROCESS_CBW)) {
+			if (msd_bufs[disk_idx].state == MSD_BUF_READY) {
+				irq_unlock(key);
+				continue;
+			}
+
+			/* everything reached the disk, report the status */
+			out_stalled = false;
+			irq_unlock(key);
+
+			csw.Status = (stage == ERROR || disk_error) ?
+				     CSW_FAILED : CSW_PASSED;
+			sendCSW();
+			usb_ep_read_continue(EPBULK_OUT);
+			return;
+		}
+
+		if (out_stalled) {
+			out_stalled = false;
+			irq_unlock(key);
+			usb_ep_read_continue(EPBULK_OUT);
+		} else {
+			irq_unlock(key);
+		}
+	}
 }
 
 /**
@@ -881,19 +1101,10 @@ static void mass_thread_main(int arg1, int unused)
 
 		switch (thread_op) {
 		case THREAD_OP_READ_QUEUED:
-			if (disk_access_read(page, (addr/BLOCK_SIZE), 1)) {
-				SYS_LOG_ERR("!! Disk Read Error %d !",
-						addr/BLOCK_SIZE);
-			}
-
-			thread_memory_read_done();
+			thread_memory_read();
 			break;
 		case THREAD_OP_WRITE_QUEUED:
-			if (disk_access_write(page, (addr/BLOCK_SIZE), 1)) {
-				SYS_LOG_ERR("!!!!! Disk Write Error %d !!!!!",
-					    addr/BLOCK_SIZE);
-			}
-			thread_memory_write_done();
+			thread_memory_write();
 			break;
 		default:
 			SYS_LOG_ERR("XXXXXX thread_op  %d ! XXXXX", thread_op);
@@ -104,6 +104,5 @@ struct CSW {
 
 #define THREAD_OP_READ_QUEUED		1
 #define THREAD_OP_WRITE_QUEUED		3
-#define THREAD_OP_WRITE_DONE		4
 
 #endif /* __MASS_STORAGE_H__ */
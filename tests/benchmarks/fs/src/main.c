@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure file system and disk performance
+ *
+ * Run a fixed set of file system workloads on the disk backend selected
+ * by the configuration and report their throughput or latency, so that
+ * changes to the file system or disk layers can be compared run to run.
+ */
+
+#include <zephyr.h>
+#include <fs.h>
+#include <stdio.h>
+#include <string.h>
+#include <tc_util.h>
+
+#define SEQ_FILE	"seq.bin"
+#define SEQ_SIZE	KB(32)
+#define IO_SIZE		KB(1)
+#define RAND_IO_SIZE	512
+#define RAND_OPS	64
+#define SMALL_FILES	32
+#define SMALL_SIZE	64
+#define DIR_NAME	"bench"
+#define DIR_ENTRIES	64
+#define DIR_PASSES	4
+#define SYNC_FILE	"sync.bin"
+#define SYNC_OPS	32
+#define PATH_LEN	32
+
+#if defined(CONFIG_DISK_ACCESS_RAM)
+#define BACKEND		"RAM disk"
+#elif defined(CONFIG_FLASH_SIMULATOR)
+#define BACKEND		"flash simulator"
+#else
+#define BACKEND		CONFIG_DISK_FLASH_DEV_NAME
+#endif
+
+static uint8_t buf[IO_SIZE];
+static uint32_t rand_state = 1;
+
+static uint32_t rand_next(void)
+{
+	/* Numerical Recipes LCG, deterministic so runs are comparable */
+	rand_state = rand_state * 1664525 + 1013904223;
+
+	return rand_state >> 8;
+}
+
+static uint32_t elapsed_us(uint32_t start)
+{
+	return SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start) / 1000;
+}
+
+static void report_bytes(const char *what, uint32_t start, uint32_t bytes,
+			 int rc)
+{
+	uint32_t us = elapsed_us(start);
+
+	if (rc) {
+		TC_PRINT("%-18s: failed (%d)\n", what, rc);
+		return;
+	}
+
+	TC_PRINT("%-18s: %6u B in %8u us, %6u KiB/s\n", what, bytes, us,
+		 us ? (uint32_t)((uint64_t)bytes * 1000000 / 1024 / us) : 0);
+}
+
+static void report_ops(const char *what, uint32_t start, uint32_t ops,
+		       int rc)
+{
+	uint32_t us = elapsed_us(start);
+
+	if (rc) {
+		TC_PRINT("%-18s: failed (%d)\n", what, rc);
+		return;
+	}
+
+	TC_PRINT("%-18s: %6u ops in %6u us, %6u ops/s\n", what, ops, us,
+		 us ? (uint32_t)((uint64_t)ops * 1000000 / us) : 0);
+}
+
+static int write_all(fs_file_t *file, const void *data, size_t len)
+{
+	ssize_t n = fs_write(file, data, len);
+
+	if (n < 0) {
+		return n;
+	}
+
+	return (n == len) ? 0 : -ENOSPC;
+}
+
+static int read_all(fs_file_t *file, void *data, size_t len)
+{
+	ssize_t n = fs_read(file, data, len);
+
+	if (n < 0) {
+		return n;
+	}
+
+	return (n == len) ? 0 : -EIO;
+}
+
+static int seq_write(void)
+{
+	fs_file_t file;
+	uint32_t done;
+	int rc;
+
+	rc = fs_open(&file, SEQ_FILE);
+	if (rc) {
+		return rc;
+	}
+
+	for (done = 0; done < SEQ_SIZE && !rc; done += IO_SIZE) {
+		memset(buf, done / IO_SIZE, IO_SIZE);
+		rc = write_all(&file, buf, IO_SIZE);
+	}
+
+	if (!rc) {
+		rc = fs_sync(&file);
+	}
+
+	fs_close(&file);
+
+	return rc;
+}
+
+static int seq_read(void)
+{
+	fs_file_t file;
+	uint32_t done;
+	int rc;
+
+	rc = fs_open(&file, SEQ_FILE);
+	if (rc) {
+		return rc;
+	}
+
+	for (done = 0; done < SEQ_SIZE && !rc; done += IO_SIZE) {
+		rc = read_all(&file, buf, IO_SIZE);
+		if (!rc && buf[IO_SIZE - 1] != (uint8_t)(done / IO_SIZE)) {
+			rc = -EIO;
+		}
+	}
+
+	fs_close(&file);
+
+	return rc;
+}
+
+static int rand_io(bool write)
+{
+	fs_file_t file;
+	off_t offset;
+	int rc;
+	int i;
+
+	rc = fs_open(&file, SEQ_FILE);
+	if (rc) {
+		return rc;
+	}
+
+	for (i = 0; i < RAND_OPS && !rc; i++) {
+		offset = (rand_next() % (SEQ_SIZE / RAND_IO_SIZE)) *
+			 RAND_IO_SIZE;
+
+		rc = fs_seek(&file, offset, FS_SEEK_SET);
+		if (rc) {
+			break;
+		}
+
+		if (write) {
+			/* keep the pattern seq_read() expects */
+			memset(buf, offset / IO_SIZE, RAND_IO_SIZE);
+			rc = write_all(&file, buf, RAND_IO_SIZE);
+		} else {
+			rc = read_all(&file, buf, RAND_IO_SIZE);
+		}
+	}
+
+	if (!rc && write) {
+		rc = fs_sync(&file);
+	}
+
+	fs_close(&file);
+
+	return rc;
+}
+
+static int create_files(const char *dir, int count, size_t size)
+{
+	char path[PATH_LEN];
+	fs_file_t file;
+	int rc = 0;
+	int i;
+
+	memset(buf, 0x5a, size);
+
+	for (i = 0; i < count && !rc; i++) {
+		snprintf(path, sizeof(path), "%s/f%03d.bin", dir, i);
+
+		rc = fs_open(&file, path);
+		if (rc) {
+			break;
+		}
+
+		if (size) {
+			rc = write_all(&file, buf, size);
+		}
+
+		fs_close(&file);
+	}
+
+	return rc;
+}
+
+static int delete_files(const char *dir, int count)
+{
+	char path[PATH_LEN];
+	int rc = 0;
+	int i;
+
+	for (i = 0; i < count && !rc; i++) {
+		snprintf(path, sizeof(path), "%s/f%03d.bin", dir, i);
+		rc = fs_unlink(path);
+	}
+
+	return rc;
+}
+
+static int list_dir(const char *path, int *entries)
+{
+	struct fs_dirent entry;
+	fs_dir_t dir;
+	int rc;
+
+	rc = fs_opendir(&dir, path);
+	if (rc) {
+		return rc;
+	}
+
+	*entries = 0;
+
+	for (;;) {
+		rc = fs_readdir(&dir, &entry);
+
+		/* entry.name[0] == 0 means end-of-dir */
+		if (rc || entry.name[0] == 0) {
+			break;
+		}
+
+		(*entries)++;
+	}
+
+	fs_closedir(&dir);
+
+	return rc;
+}
+
+static void sync_latency(void)
+{
+	uint32_t min_us = UINT32_MAX;
+	uint32_t max_us = 0;
+	uint32_t total_us = 0;
+	fs_file_t file;
+	uint32_t start;
+	uint32_t us;
+	int rc;
+	int i;
+
+	rc = fs_open(&file, SYNC_FILE);
+	if (rc) {
+		TC_PRINT("%-18s: failed (%d)\n", "sync", rc);
+		return;
+	}
+
+	memset(buf, 0xa5, SMALL_SIZE);
+
+	for (i = 0; i < SYNC_OPS && !rc; i++) {
+		rc = write_all(&file, buf, SMALL_SIZE);
+		if (rc) {
+			break;
+		}
+
+		start = k_cycle_get_32();
+		rc = fs_sync(&file);
+		us = elapsed_us(start);
+
+		total_us += us;
+		min_us = min(min_us, us);
+		max_us = max(max_us, us);
+	}
+
+	fs_close(&file);
+	fs_unlink(SYNC_FILE);
+
+	if (rc) {
+		TC_PRINT("%-18s: failed (%d)\n", "sync", rc);
+		return;
+	}
+
+	TC_PRINT("%-18s: min %u us, avg %u us, max %u us after %u B writes\n",
+		 "sync", min_us, total_us / SYNC_OPS, max_us, SMALL_SIZE);
+}
+
+void main(void)
+{
+	struct fs_statvfs stat;
+	uint32_t start;
+	int entries = 0;
+	int rc;
+	int i;
+
+	TC_START("file system performance");
+
+	rc = fs_statvfs(&stat);
+	if (rc) {
+		TC_ERROR("Cannot get volume information (%d)\n", rc);
+		TC_END_RESULT(TC_FAIL);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	TC_PRINT("backend: %s, %lu clusters of %lu B, %lu free\n", BACKEND,
+		 stat.f_blocks, stat.f_frsize, stat.f_bfree);
+
+	/* start from a clean volume, leftovers of a previous run are fine */
+	fs_unlink(SEQ_FILE);
+	delete_files(DIR_NAME, DIR_ENTRIES);
+	fs_unlink(DIR_NAME);
+	delete_files("", SMALL_FILES);
+
+	start = k_cycle_get_32();
+	rc = seq_write();
+	report_bytes("sequential write", start, SEQ_SIZE, rc);
+
+	start = k_cycle_get_32();
+	rc = rc ? rc : seq_read();
+	report_bytes("sequential read", start, SEQ_SIZE, rc);
+
+	start = k_cycle_get_32();
+	rc = rc ? rc : rand_io(true);
+	report_bytes("random write", start, RAND_OPS * RAND_IO_SIZE, rc);
+
+	start = k_cycle_get_32();
+	rc = rc ? rc : rand_io(false);
+	report_bytes("random read", start, RAND_OPS * RAND_IO_SIZE, rc);
+
+	/* random writes must not have corrupted the file */
+	rc = rc ? rc : seq_read();
+	rc = rc ? rc : fs_unlink(SEQ_FILE);
+
+	start = k_cycle_get_32();
+	rc = rc ? rc : create_files("", SMALL_FILES, SMALL_SIZE);
+	report_ops("small file create", start, SMALL_FILES, rc);
+
+	start = k_cycle_get_32();
+	rc = rc ? rc : delete_files("", SMALL_FILES);
+	report_ops("small file delete", start, SMALL_FILES, rc);
+
+	rc = rc ? rc : fs_mkdir(DIR_NAME);
+	rc = rc ? rc : create_files(DIR_NAME, DIR_ENTRIES, 0);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < DIR_PASSES && !rc; i++) {
+		rc = list_dir(DIR_NAME, &entries);
+	}
+	if (!rc && entries != DIR_ENTRIES) {
+		rc = -EIO;
+	}
+	report_ops("directory entries", start, DIR_PASSES * DIR_ENTRIES, rc);
+
+	rc = rc ? rc : delete_files(DIR_NAME, DIR_ENTRIES);
+	rc = rc ? rc : fs_unlink(DIR_NAME);
+
+	if (!rc) {
+		sync_latency();
+	}
+
+	TC_END_RESULT(rc ? TC_FAIL : TC_PASS);
+	TC_END_REPORT(rc ? TC_FAIL : TC_PASS);
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the JSON parser and encoder on realistic payloads
+ *
+ * Parse each payload in place and streamed in chunks, and encode one, and
+ * report the cycles each takes. The decoded values are checked too.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <json.h>
+
+#define CALLS	16
+#define CHUNK	64
+
+struct nats_info {
+	const char *server_id;
+	const char *version;
+	const char *go;
+	const char *host;
+	int32_t port;
+	bool auth_required;
+	bool ssl_required;
+	int32_t max_payload;
+};
+
+static const struct json_obj_descr nats_info_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct nats_info, server_id, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, version, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, go, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, host, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, port, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, auth_required, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, ssl_required, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct nats_info, max_payload, JSON_TOK_NUMBER),
+};
+
+static const char nats_info_json[] =
+	"{\"server_id\":\"ad29ea9cbb16f2865c177bbd4db446ca\","
+	"\"version\":\"0.9.6\",\"go\":\"go1.7.4\",\"host\":\"0.0.0.0\","
+	"\"port\":4222,\"auth_required\":false,\"ssl_required\":false,"
+	"\"max_payload\":1048576}";
+
+struct reading {
+	const char *sensor;
+	int32_t value;
+	int32_t scale;
+};
+
+struct location {
+	int32_t lat;
+	int32_t lon;
+};
+
+struct report {
+	const char *device;
+	int32_t seq;
+	bool charging;
+	struct location location;
+	struct reading readings[4];
+	size_t readings_len;
+	int32_t history[16];
+	size_t history_len;
+};
+
+static const struct json_obj_descr reading_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct reading, sensor, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct reading, value, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct reading, scale, JSON_TOK_NUMBER),
+};
+
+static const struct json_obj_descr location_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct location, lat, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct location, lon, JSON_TOK_NUMBER),
+};
+
+static const struct json_obj_descr report_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct report, device, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct report, seq, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct report, charging, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_OBJECT(struct report, location, location_descr),
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct report, readings, readings_len,
+				 reading_descr),
+	JSON_OBJ_DESCR_ARRAY(struct report, history, history_len,
+			     JSON_TOK_NUMBER),
+};
+
+static const char report_json[] =
+	"{\"device\":\"quark-se-c1000-devboard\",\"seq\":1287,"
+	"\"charging\":true,\"location\":{\"lat\":45523064,"
+	"\"lon\":-122676483},\"readings\":[{\"sensor\":\"temperature\","
+	"\"value\":2315,\"scale\":-2},{\"sensor\":\"humidity\","
+	"\"value\":4710,\"scale\":-2},{\"sensor\":\"pressure\","
+	"\"value\":101325,\"scale\":0}],\"history\":[2290,2295,2301,"
+	"2304,2310,2312,2315,2315]}";
+
+struct config {
+	const char *ssid;
+	const char *broker;
+	int32_t interval;
+	int32_t retries;
+	bool tls;
+};
+
+static const struct json_obj_descr config_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct config, ssid, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct config, broker, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct config, interval, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct config, retries, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct config, tls, JSON_TOK_TRUE),
+};
+
+/* Keys in reverse order, and keys the device does not know */
+static const char config_json[] =
+	"{\"tls\":true,\"retries\":3,\"comment\":\"factory settings\","
+	"\"interval\":60,\"broker\":\"mqtt.example.com\","
+	"\"extra\":{\"owner\":\"lab\",\"tags\":[\"a\",\"b\"]},"
+	"\"ssid\":\"zephyr-lab\"}";
+
+static char payload[512];
+static char storage[256];
+static char encoded[512];
+
+static int rc = TC_PASS;
+
+static void check(int ok, const char *what)
+{
+	if (!ok) {
+		TC_ERROR("%s failed\n", what);
+		rc = TC_FAIL;
+	}
+}
+
+static void report(const char *what, size_t len, uint32_t cycles)
+{
+	cycles = max(cycles, 1);
+
+	TC_PRINT("%-24s %4u bytes: %7u cycles, %3u.%02u bytes per kcycle\n",
+		 what, len, cycles, len * 1000 / cycles,
+		 len * 100000 / cycles % 100);
+}
+
+/* Cycles of json_obj_parse(), the payload being copied out of the count */
+static uint32_t parse(const char *json, size_t len,
+		      const struct json_obj_descr *descr, size_t descr_len,
+		      void *val, int *ret)
+{
+	uint32_t cycles = 0;
+	uint32_t start;
+	int i;
+
+	for (i = 0; i < CALLS; i++) {
+		memcpy(payload, json, len);
+
+		start = k_cycle_get_32();
+		*ret = json_obj_parse(payload, len, descr, descr_len, val);
+		cycles += k_cycle_get_32() - start;
+	}
+
+	return cycles / CALLS;
+}
+
+/* Cycles of json_obj_stream_parse() on the payload split in chunks */
+static uint32_t stream(const char *json, size_t len,
+		       const struct json_obj_descr *descr, size_t descr_len,
+		       void *val, int *ret)
+{
+	struct json_obj_stream s;
+	uint32_t start;
+	size_t pos;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < CALLS; i++) {
+		json_obj_stream_init(&s, descr, descr_len, val, storage,
+				     sizeof(storage));
+
+		for (pos = 0, *ret = -EAGAIN; pos < len && *ret == -EAGAIN;
+		     pos += CHUNK) {
+			*ret = json_obj_stream_parse(&s, json + pos,
+						     min(len - pos, CHUNK));
+		}
+	}
+
+	return (k_cycle_get_32() - start) / CALLS;
+}
+
+static union {
+	struct nats_info info;
+	struct report report;
+	struct config config;
+} decoded;
+
+static void bench_nats_info(void)
+{
+	size_t len = sizeof(nats_info_json) - 1;
+	int ret;
+
+	report("nats info, in place",  len,
+	       parse(nats_info_json, len, nats_info_descr,
+		     ARRAY_SIZE(nats_info_descr), &decoded, &ret));
+	check(ret == (1 << ARRAY_SIZE(nats_info_descr)) - 1 &&
+	      decoded.info.port == 4222 &&
+	      decoded.info.max_payload == 1048576 &&
+	      !strcmp(decoded.info.version, "0.9.6"), "nats info");
+
+	report("nats info, streamed", len,
+	       stream(nats_info_json, len, nats_info_descr,
+		      ARRAY_SIZE(nats_info_descr), &decoded, &ret));
+	check(ret == (1 << ARRAY_SIZE(nats_info_descr)) - 1 &&
+	      !strcmp(decoded.info.server_id,
+		      "ad29ea9cbb16f2865c177bbd4db446ca"),
+	      "nats info streamed");
+}
+
+static void check_report(int ret, const char *what)
+{
+	struct report *r = &decoded.report;
+
+	check(ret == (1 << ARRAY_SIZE(report_descr)) - 1 &&
+	      r->seq == 1287 && r->charging &&
+	      r->location.lon == -122676483 && r->readings_len == 3 &&
+	      r->readings[2].value == 101325 &&
+	      !strcmp(r->readings[1].sensor, "humidity") &&
+	      r->history_len == 8 && r->history[7] == 2315, what);
+}
+
+static void bench_report(void)
+{
+	size_t len = sizeof(report_json) - 1;
+	struct report copy;
+	uint32_t start;
+	int ret;
+	int i;
+
+	report("sensor report, in place", len,
+	       parse(report_json, len, report_descr,
+		     ARRAY_SIZE(report_descr), &decoded, &ret));
+	check_report(ret, "sensor report");
+
+	report("sensor report, streamed", len,
+	       stream(report_json, len, report_descr,
+		      ARRAY_SIZE(report_descr), &decoded, &ret));
+	check_report(ret, "sensor report streamed");
+
+	copy = decoded.report;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < CALLS; i++) {
+		ret = json_obj_encode_buf(report_descr,
+					  ARRAY_SIZE(report_descr), &copy,
+					  encoded, sizeof(encoded));
+	}
+	report("sensor report, encoded", strlen(encoded),
+	       (k_cycle_get_32() - start) / CALLS);
+	check(!ret && !strcmp(encoded, report_json), "sensor report encoded");
+}
+
+static void bench_config(void)
+{
+	size_t len = sizeof(config_json) - 1;
+	int ret;
+
+	report("config, in place", len,
+	       parse(config_json, len, config_descr,
+		     ARRAY_SIZE(config_descr), &decoded, &ret));
+	check(ret == (1 << ARRAY_SIZE(config_descr)) - 1 &&
+	      decoded.config.interval == 60 && decoded.config.tls &&
+	      !strcmp(decoded.config.ssid, "zephyr-lab"), "config");
+
+	report("config, streamed", len,
+	       stream(config_json, len, config_descr,
+		      ARRAY_SIZE(config_descr), &decoded, &ret));
+	check(ret == (1 << ARRAY_SIZE(config_descr)) - 1 &&
+	      !strcmp(decoded.config.broker, "mqtt.example.com"),
+	      "config streamed");
+}
+
+void main(void)
+{
+	TC_START("JSON parsing and encoding");
+
+	bench_nats_info();
+	bench_report();
+	bench_config();
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the flash key-value store
+ *
+ * Update, read and rewrite a set of records on the flash simulator and
+ * report the operations per second of each phase, as well as the flash
+ * erases and garbage collection copies caused by the updates. Only a few
+ * records are updated, like settings next to counters, so that garbage
+ * collection has live records to copy.
+ */
+
+#include <zephyr.h>
+#include <kvs.h>
+#include <tc_util.h>
+
+#define SECTOR_SIZE	KB(4)
+#define SECTOR_COUNT	4
+#define RECORD_COUNT	16
+#define HOT_COUNT	4
+#define RECORD_SIZE	32
+#define OPS		1000
+
+static struct kvs_fs fs = {
+	.offset = 0,
+	.sector_size = SECTOR_SIZE,
+	.sector_count = SECTOR_COUNT,
+};
+
+static uint8_t buf[RECORD_SIZE];
+static uint32_t last_seq[RECORD_COUNT];
+
+static void report(const char *what, uint32_t start, uint32_t ops, int rc)
+{
+	uint32_t us;
+
+	us = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start) / 1000;
+
+	if (rc < 0) {
+		TC_PRINT("%-18s: failed (%d)\n", what, rc);
+		return;
+	}
+
+	TC_PRINT("%-18s: %5u ops in %7u us, %8u ops/s\n", what, ops, us,
+		 us ? (uint32_t)((uint64_t)ops * 1000000 / us) : 0);
+}
+
+static void fill(uint32_t seq)
+{
+	int i;
+
+	for (i = 0; i < RECORD_SIZE; i++) {
+		buf[i] = seq + i;
+	}
+}
+
+static int write(uint16_t id, uint32_t seq)
+{
+	fill(seq);
+	last_seq[id] = seq;
+
+	return kvs_write(&fs, id, buf, sizeof(buf));
+}
+
+static int populate(void)
+{
+	int rc = 0;
+	int i;
+
+	for (i = 0; i < RECORD_COUNT && !rc; i++) {
+		rc = write(i, i);
+	}
+
+	return rc;
+}
+
+static int update(uint32_t first)
+{
+	uint32_t i;
+	int rc = 0;
+
+	for (i = first; i < first + OPS && !rc; i++) {
+		rc = write(i % HOT_COUNT, i);
+	}
+
+	return rc;
+}
+
+/* write back the data each record already holds */
+static int rewrite(void)
+{
+	int rc = 0;
+	int i;
+
+	for (i = 0; i < OPS && !rc; i++) {
+		fill(last_seq[i % RECORD_COUNT]);
+		rc = kvs_write(&fs, i % RECORD_COUNT, buf, sizeof(buf));
+	}
+
+	return rc;
+}
+
+static int read(void)
+{
+	ssize_t rc = 0;
+	int i;
+
+	for (i = 0; i < OPS && rc >= 0; i++) {
+		rc = kvs_read(&fs, i % RECORD_COUNT, buf, sizeof(buf));
+	}
+
+	return rc < 0 ? rc : 0;
+}
+
+void main(void)
+{
+	struct kvs_stats before;
+	uint32_t start;
+	int rc;
+
+	TC_START("flash key-value store");
+
+	rc = kvs_init(&fs, CONFIG_FLASH_SIMULATOR_DEV_NAME);
+	if (!rc) {
+		rc = kvs_clear(&fs);
+	}
+
+	if (rc) {
+		TC_ERROR("Cannot mount the store (%d)\n", rc);
+		TC_END_RESULT(TC_FAIL);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	/* reach the steady state before measuring */
+	rc = populate();
+	rc = rc ? rc : update(0);
+
+	before = fs.stats;
+	start = k_cycle_get_32();
+	rc = rc ? rc : update(OPS);
+	report("update", start, OPS, rc);
+	TC_PRINT("%20u erases, %u gc copies per %u updates\n",
+		 fs.stats.erases - before.erases,
+		 fs.stats.gc_copies - before.gc_copies, OPS);
+
+	start = k_cycle_get_32();
+	rc = rc ? rc : read();
+	report("read", start, OPS, rc);
+
+	before = fs.stats;
+	start = k_cycle_get_32();
+	rc = rc ? rc : rewrite();
+	report("unchanged write", start, OPS, rc);
+	if (!rc && fs.stats.writes != before.writes) {
+		TC_ERROR("Unchanged data was written\n");
+		rc = -EIO;
+	}
+
+	start = k_cycle_get_32();
+	rc = rc ? rc : kvs_init(&fs, CONFIG_FLASH_SIMULATOR_DEV_NAME);
+	report("mount", start, 1, rc);
+
+	TC_END_RESULT(rc ? TC_FAIL : TC_PASS);
+	TC_END_REPORT(rc ? TC_FAIL : TC_PASS);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the cost of the performance counters
+ *
+ * Increment a counter and time an empty code section in a histogram, and
+ * report the cycles each takes, loop included. Then check what the
+ * registry lists.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+#include <debug/perf_counter.h>
+
+#define CALLS	1000
+
+PERF_COUNTER_DEFINE(bench_inc);
+PERF_COUNTER_DEFINE(bench_add);
+PERF_HISTOGRAM_DEFINE(bench_section_cycles);
+
+static uint32_t exported = 1234;
+
+static uint32_t exported_read(void)
+{
+	return exported;
+}
+
+PERF_COUNTER_EXPORT(bench_exported, exported_read);
+
+static int rc = TC_PASS;
+
+struct find_info {
+	const char *name;
+	struct perf_counter *counter;
+	const char *prev;
+	bool sorted;
+};
+
+static void find_counter(struct perf_counter *counter, void *user_data)
+{
+	struct find_info *info = user_data;
+
+	if (info->prev && strcmp(info->prev, counter->name) > 0) {
+		info->sorted = false;
+	}
+
+	info->prev = counter->name;
+
+	if (!strcmp(counter->name, info->name)) {
+		info->counter = counter;
+	}
+}
+
+static struct perf_counter *get_counter(const char *name)
+{
+	struct find_info info = {
+		.name = name,
+		.sorted = true,
+	};
+
+	perf_counter_foreach(find_counter, &info);
+
+	if (!info.sorted) {
+		TC_ERROR("Counters not sorted by name\n");
+		rc = TC_FAIL;
+	}
+
+	if (!info.counter) {
+		TC_ERROR("Counter %s not listed\n", name);
+		rc = TC_FAIL;
+	}
+
+	return info.counter;
+}
+
+static void check_counter(const char *name, uint32_t value)
+{
+	struct perf_counter *counter = get_counter(name);
+
+	if (counter && perf_counter_get(counter) != value) {
+		TC_ERROR("Counter %s is %u, not %u\n", name,
+			 perf_counter_get(counter), value);
+		rc = TC_FAIL;
+	}
+}
+
+static void count_samples(struct perf_histogram *histogram, void *user_data)
+{
+	uint32_t *samples = user_data;
+	int i;
+
+	if (strcmp(histogram->name, "bench_section_cycles")) {
+		return;
+	}
+
+	for (i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+		*samples += atomic_get(&histogram->buckets[i]);
+	}
+}
+
+static void report(const char *what, uint32_t cycles)
+{
+	TC_PRINT("%-24s %4u.%02u cycles\n", what, cycles / CALLS,
+		 cycles * 100 / CALLS % 100);
+}
+
+void main(void)
+{
+	struct perf_counter *counter;
+	uint32_t start, cycles;
+	uint32_t samples = 0;
+	int i;
+
+	TC_START("performance counters");
+
+	start = k_cycle_get_32();
+	for (i = 0; i < CALLS; i++) {
+		PERF_COUNTER_INC(bench_inc);
+	}
+	cycles = k_cycle_get_32() - start;
+	report("counter increment", cycles);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < CALLS; i++) {
+		PERF_HISTOGRAM_START(bench_section_cycles);
+		PERF_HISTOGRAM_STOP(bench_section_cycles);
+	}
+	cycles = k_cycle_get_32() - start;
+	report("histogram section", cycles);
+
+	for (i = 0; i < CALLS; i++) {
+		PERF_COUNTER_ADD(bench_add, 2);
+	}
+
+	check_counter("bench_inc", CALLS);
+	check_counter("bench_add", 2 * CALLS);
+	check_counter("bench_exported", 1234);
+
+	perf_histogram_foreach(count_samples, &samples);
+	if (samples != CALLS) {
+		TC_ERROR("%u histogram samples, not %u\n", samples, CALLS);
+		rc = TC_FAIL;
+	}
+
+	perf_snapshot();
+	PERF_COUNTER_INC(bench_inc);
+	exported++;
+
+	counter = get_counter("bench_inc");
+	if (counter && (counter->snapshot != CALLS ||
+			perf_counter_get(counter) - counter->snapshot != 1)) {
+		TC_ERROR("Snapshot of bench_inc is %u\n", counter->snapshot);
+		rc = TC_FAIL;
+	}
+
+	counter = get_counter("bench_exported");
+	if (counter && counter->snapshot != 1234) {
+		TC_ERROR("Snapshot of bench_exported is %u\n",
+			 counter->snapshot);
+		rc = TC_FAIL;
+	}
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the cost of formatting common conversions
+ *
+ * Format each conversion into a buffer with snprintk() and snprintf(), and
+ * report the cycles a call takes. Both format with the same engine, which
+ * converts integers without division and outputs in chunks; snprintf() only
+ * adds the truncation of the C library on top. The output of every call is
+ * checked too.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CALLS	16
+
+static char buf[128];
+
+static int rc = TC_PASS;
+
+/* cycles per call of <call> */
+#define MEASURE(call)						\
+	({							\
+		uint32_t start = k_cycle_get_32();		\
+		int i;						\
+								\
+		for (i = 0; i < CALLS; i++) {			\
+			call;					\
+		}						\
+		(k_cycle_get_32() - start) / CALLS;		\
+	})
+
+static void check(const char *what, const char *expected)
+{
+	if (strcmp(buf, expected) != 0) {
+		TC_ERROR("%s: expected \"%s\", got \"%s\"\n", what, expected,
+			 buf);
+		rc = TC_FAIL;
+	}
+}
+
+static void report(const char *what, uint32_t printk_cycles,
+		   uint32_t printf_cycles)
+{
+	TC_PRINT("%-24s snprintk %6u cycles, snprintf %6u cycles\n", what,
+		 printk_cycles, printf_cycles);
+}
+
+/* format <args> with both functions, and check the output */
+#define BENCH(what, expected, fmt, args...)				\
+	do {								\
+		uint32_t k, f;						\
+									\
+		k = MEASURE(snprintk(buf, sizeof(buf), fmt, args));	\
+		check(what, expected);					\
+		f = MEASURE(snprintf(buf, sizeof(buf), fmt, args));	\
+		check(what, expected);					\
+		report(what, k, f);					\
+	} while (0)
+
+void main(void)
+{
+	TC_START("formatted output");
+
+	BENCH("%d small", "42", "%d", 42);
+	BENCH("%d large", "-2147483647", "%d", -2147483647);
+	BENCH("%u", "4294967295", "%u", 4294967295u);
+	BENCH("%08x", "0000beef", "%08x", 0xbeef);
+	BENCH("%x", "deadbeef", "%x", 0xdeadbeef);
+	BENCH("%llu", "18446744073709551615", "%llu",
+	      18446744073709551615ull);
+	BENCH("%llx", "123456789abcdef0", "%llx", 0x123456789abcdef0ull);
+	BENCH("%-10s|", "zephyr    |", "%-10s|", "zephyr");
+	BENCH("%s long", "the quick brown fox jumps over the lazy dog",
+	      "%s", "the quick brown fox jumps over the lazy dog");
+	BENCH("%p", "0x0000dead", "%p", (void *)0xdead);
+	BENCH("log line", "[00001234] <inf> net: iface 0x00001000 up, mtu 1500",
+	      "[%08u] <%s> %s: iface %p up, mtu %d", 1234, "inf", "net",
+	      (void *)0x1000, 1500);
+#if defined(CONFIG_PRINTF_FLOAT)
+	BENCH("%f", "3.141593", "%f", 3.14159265);
+	BENCH("%.2f", "-1234.57", "%.2f", -1234.567);
+	BENCH("%e", "1.234000e+003", "%e", 1234.0);
+#endif
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the cost of a printk call
+ *
+ * Print 80 character lines and report the cycles each call takes in its
+ * caller. Built with prj.conf, the console writes the characters with the
+ * UART busy waiting; with prj_buffered.conf, they are only appended to the
+ * transmit buffer. The buffered build then prints a burst larger than its
+ * buffer with interrupts locked, and checks that the overflow is counted,
+ * and writes the same burst with uart_console_write(), which must wait for
+ * room instead of dropping characters.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <drivers/console/uart_console.h>
+
+#define CALLS	8
+
+/* 79 characters and the line feed */
+#define LINE	"%02d ------------------------------------------------------" \
+		"----------------------\n"
+
+static uint32_t measure(void)
+{
+	uint32_t start;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < CALLS; i++) {
+		printk(LINE, i);
+	}
+
+	return (k_cycle_get_32() - start) / CALLS;
+}
+
+void main(void)
+{
+	uint32_t cycles;
+	int rc = TC_PASS;
+
+	TC_START("printk call cost");
+
+	cycles = measure();
+
+	/* let the console catch up before reporting */
+	k_sleep(500);
+
+#if defined(CONFIG_UART_CONSOLE_BUFFERED)
+	TC_PRINT("buffered console, %u byte buffer\n",
+		 CONFIG_UART_CONSOLE_TX_BUF_SIZE);
+#else
+	TC_PRINT("polled console\n");
+#endif
+	TC_PRINT("80 character line: %6u cycles, %6u ns per call\n", cycles,
+		 (uint32_t)SYS_CLOCK_HW_CYCLES_TO_NS64(cycles));
+
+#if defined(CONFIG_UART_CONSOLE_BUFFERED)
+	{
+		/* lines of 80 characters plus a carriage return */
+		int lines = 2 * CONFIG_UART_CONSOLE_TX_BUF_SIZE / 81;
+		uint32_t dropped = uart_console_dropped();
+		unsigned int key;
+		int i;
+
+		key = irq_lock();
+		for (i = 0; i < lines; i++) {
+			printk(LINE, i);
+		}
+		irq_unlock(key);
+
+		uart_console_flush();
+
+		dropped = uart_console_dropped() - dropped;
+		TC_PRINT("\n%u of %u burst characters dropped\n", dropped,
+			 lines * 81);
+
+		if (dropped < lines * 81 - CONFIG_UART_CONSOLE_TX_BUF_SIZE) {
+			TC_ERROR("Overflow not counted\n");
+			rc = TC_FAIL;
+		}
+
+		/* the same burst, waiting for room in the buffer */
+		dropped = uart_console_dropped();
+
+		for (i = 0; i < lines; i++) {
+			char line[81];
+			int len = snprintk(line, sizeof(line), LINE, i);
+
+			uart_console_write(line, len);
+		}
+
+		uart_console_flush();
+
+		if (uart_console_dropped() != dropped) {
+			TC_ERROR("Characters dropped waiting for room\n");
+			rc = TC_FAIL;
+		}
+	}
+#endif
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the SLIP encoder and decoder
+ *
+ * Frames are escaped the way the SLIP driver sends them, a transmit
+ * buffer at a time, and looped back through the decoder a UART FIFO at a
+ * time, the way the driver receives them, then compared with the
+ * original. Each payload mix is also run through a byte at a time codec,
+ * like the one the driver used before, for comparison.
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <stdio.h>
+#include <tc_util.h>
+
+#include "slip_codec.h"
+
+#define FRAME_SIZE	1280
+#define FRAMES		64
+/* CONFIG_SLIP_TX_BUF_SIZE and CONFIG_SLIP_RX_BUF_SIZE defaults */
+#define TX_CHUNK	64
+#define RX_CHUNK	16
+
+static uint8_t frame[FRAME_SIZE];
+static uint8_t wire[2 * FRAME_SIZE + 2];
+static uint8_t decoded[FRAME_SIZE];
+static uint8_t fifo[RX_CHUNK];
+
+static size_t encode(void)
+{
+	const uint8_t *data = frame;
+	size_t len = sizeof(frame);
+	size_t used = 1;
+
+	wire[0] = SLIP_END;
+
+	while (len) {
+		used += slip_encode(wire + used,
+				    min(TX_CHUNK, sizeof(wire) - 1 - used),
+				    &data, &len);
+	}
+
+	wire[used++] = SLIP_END;
+
+	return used;
+}
+
+static size_t decode(size_t wire_len)
+{
+	uint8_t state = STATE_OK;
+	size_t in = 0;
+	size_t out = 0;
+	size_t chunk, pos, used, n;
+	int flags;
+
+	while (in < wire_len) {
+		/* what the UART interrupt handler reads at once */
+		chunk = min(RX_CHUNK, wire_len - in);
+		memcpy(fifo, wire + in, chunk);
+		in += chunk;
+
+		for (pos = 0; pos < chunk; pos += used) {
+			used = slip_decode(&state, fifo + pos, chunk - pos,
+					   &n, &flags);
+			if (out + n > sizeof(decoded) ||
+			    (flags & SLIP_FRAME_ERROR)) {
+				return 0;
+			}
+
+			memcpy(decoded + out, fifo + pos, n);
+			out += n;
+		}
+	}
+
+	return out;
+}
+
+static size_t encode_bytes(void)
+{
+	size_t used = 0;
+	size_t i;
+
+	wire[used++] = SLIP_END;
+
+	for (i = 0; i < sizeof(frame); i++) {
+		switch (frame[i]) {
+		case SLIP_END:
+			wire[used++] = SLIP_ESC;
+			wire[used++] = SLIP_ESC_END;
+			break;
+		case SLIP_ESC:
+			wire[used++] = SLIP_ESC;
+			wire[used++] = SLIP_ESC_ESC;
+			break;
+		default:
+			wire[used++] = frame[i];
+		}
+	}
+
+	wire[used++] = SLIP_END;
+
+	return used;
+}
+
+static size_t decode_bytes(size_t wire_len)
+{
+	uint8_t state = STATE_OK;
+	size_t out = 0;
+	size_t i;
+	uint8_t c;
+
+	for (i = 0; i < wire_len; i++) {
+		c = wire[i];
+
+		if (state == STATE_ESC) {
+			c = (c == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
+			state = STATE_OK;
+		} else if (c == SLIP_ESC) {
+			state = STATE_ESC;
+			continue;
+		} else if (c == SLIP_END) {
+			continue;
+		}
+
+		if (out == sizeof(decoded)) {
+			return 0;
+		}
+
+		decoded[out++] = c;
+	}
+
+	return out;
+}
+
+static void report(const char *what, uint32_t start, int rc)
+{
+	uint32_t us;
+
+	us = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start) / 1000;
+
+	if (rc) {
+		TC_PRINT("%-24s: data mismatch\n", what);
+		return;
+	}
+
+	TC_PRINT("%-24s: %7u us, %6u KiB/s\n", what, us,
+		 us ? (uint32_t)((uint64_t)FRAMES * FRAME_SIZE * 1000000 /
+				 1024 / us) : 0);
+}
+
+static int check(size_t len)
+{
+	if (len != sizeof(frame) || memcmp(decoded, frame, len)) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int run(const char *name)
+{
+	char what[32];
+	uint32_t start;
+	size_t wire_len = 0;
+	int rc = 0;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < FRAMES; i++) {
+		wire_len = encode();
+	}
+	snprintf(what, sizeof(what), "%s encode", name);
+	report(what, start, 0);
+
+	TC_PRINT("%24s  %u bytes on the line per %u byte frame\n", "",
+		 (unsigned int)wire_len, FRAME_SIZE);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < FRAMES && !rc; i++) {
+		rc = check(decode(wire_len));
+	}
+	snprintf(what, sizeof(what), "%s decode", name);
+	report(what, start, rc);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < FRAMES; i++) {
+		if (encode_bytes() != wire_len) {
+			rc = -EIO;
+		}
+	}
+	snprintf(what, sizeof(what), "%s bytewise encode", name);
+	report(what, start, rc);
+
+	start = k_cycle_get_32();
+	for (i = 0; i < FRAMES && !rc; i++) {
+		rc = check(decode_bytes(wire_len));
+	}
+	snprintf(what, sizeof(what), "%s bytewise decode", name);
+	report(what, start, rc);
+
+	return rc;
+}
+
+void main(void)
+{
+	uint32_t seed = 1;
+	int rc;
+	int i;
+
+	TC_START("SLIP codec loopback");
+
+	/* text, nothing to escape */
+	for (i = 0; i < FRAME_SIZE; i++) {
+		frame[i] = 'a' + i % 26;
+	}
+	rc = run("text");
+
+	/* random binary data, one byte in 128 is escaped */
+	for (i = 0; i < FRAME_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		frame[i] = seed >> 16;
+	}
+	rc = rc ? rc : run("binary");
+
+	/* worst case, every byte is escaped */
+	for (i = 0; i < FRAME_SIZE; i++) {
+		frame[i] = (i & 1) ? SLIP_END : SLIP_ESC;
+	}
+	rc = rc ? rc : run("escapes");
+
+	TC_END_RESULT(rc ? TC_FAIL : TC_PASS);
+	TC_END_REPORT(rc ? TC_FAIL : TC_PASS);
+}
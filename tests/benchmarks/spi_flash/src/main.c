@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure SPI NOR flash throughput
+ *
+ * Erase, program and read the last 64 KiB of the flash and report the
+ * time each operation takes. Data goes through a 4 KiB buffer so that the
+ * benchmark fits in the RAM of small boards.
+ */
+
+#include <zephyr.h>
+#include <flash.h>
+#include <tc_util.h>
+
+#define AREA_SIZE	KB(64)
+#define AREA_OFFSET	(CONFIG_SPI_FLASH_W25QXXDV_FLASH_SIZE - AREA_SIZE)
+#define SECTOR_SIZE	KB(4)
+#define BUF_SIZE	KB(4)
+#define SMALL_IO_SIZE	256
+
+static uint8_t buf[BUF_SIZE];
+
+static void report(const char *what, uint32_t start, int rc)
+{
+	uint32_t ms = k_uptime_get_32() - start;
+
+	if (rc) {
+		TC_PRINT("%-18s: failed (%d)\n", what, rc);
+		return;
+	}
+
+	if (ms) {
+		TC_PRINT("%-18s: %3u KiB in %u ms, %u KiB/s\n", what,
+			 AREA_SIZE / 1024, ms, (AREA_SIZE / 1024) * 1000 / ms);
+	} else {
+		TC_PRINT("%-18s: %3u KiB in < 1 ms\n", what, AREA_SIZE / 1024);
+	}
+}
+
+static int erase(struct device *dev, off_t offset, size_t len)
+{
+	int rc;
+
+	rc = flash_write_protection_set(dev, false);
+	if (rc) {
+		return rc;
+	}
+
+	return flash_erase(dev, offset, len);
+}
+
+static int erase_sectors(struct device *dev)
+{
+	off_t offset;
+	int rc = 0;
+
+	for (offset = AREA_OFFSET; offset < AREA_OFFSET + AREA_SIZE && !rc;
+	     offset += SECTOR_SIZE) {
+		rc = erase(dev, offset, SECTOR_SIZE);
+	}
+
+	return rc;
+}
+
+static int program(struct device *dev)
+{
+	off_t offset;
+	int rc = 0;
+
+	for (offset = AREA_OFFSET; offset < AREA_OFFSET + AREA_SIZE && !rc;
+	     offset += BUF_SIZE) {
+		rc = flash_write_pages(dev, offset, buf, BUF_SIZE);
+	}
+
+	return rc;
+}
+
+static int read(struct device *dev, size_t io_size)
+{
+	off_t offset;
+	int rc = 0;
+
+	for (offset = AREA_OFFSET; offset < AREA_OFFSET + AREA_SIZE && !rc;
+	     offset += io_size) {
+		rc = flash_read(dev, offset, buf + (offset % BUF_SIZE),
+				io_size);
+	}
+
+	return rc;
+}
+
+void main(void)
+{
+	struct device *dev;
+	uint32_t start;
+	int i, rc, status = TC_PASS;
+
+	TC_START("SPI flash throughput");
+
+	dev = device_get_binding(CONFIG_SPI_FLASH_W25QXXDV_DRV_NAME);
+	if (!dev) {
+		TC_ERROR("Cannot get %s device\n",
+			 CONFIG_SPI_FLASH_W25QXXDV_DRV_NAME);
+		TC_END_RESULT(TC_FAIL);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	for (i = 0; i < BUF_SIZE; i++) {
+		buf[i] = i ^ (i >> 8);
+	}
+
+	start = k_uptime_get_32();
+	rc = erase(dev, AREA_OFFSET, AREA_SIZE);
+	report("block erase", start, rc);
+
+	start = k_uptime_get_32();
+	rc = erase_sectors(dev);
+	report("sector erase", start, rc);
+
+	start = k_uptime_get_32();
+	rc = program(dev);
+	report("program", start, rc);
+
+	memset(buf, 0, sizeof(buf));
+
+	start = k_uptime_get_32();
+	rc = read(dev, BUF_SIZE);
+	report("read (4K calls)", start, rc);
+
+	for (i = 0; i < BUF_SIZE; i++) {
+		if (buf[i] != (uint8_t)(i ^ (i >> 8))) {
+			TC_ERROR("Mismatch at offset %d\n", i);
+			status = TC_FAIL;
+			break;
+		}
+	}
+
+	start = k_uptime_get_32();
+	rc = read(dev, SMALL_IO_SIZE);
+	report("read (256B calls)", start, rc);
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the string and memory functions of the C library
+ *
+ * Call each function on buffers of a few sizes, word-aligned and
+ * misaligned, and report the cycles a call takes. The result of every
+ * call is checked too.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+
+#define CALLS	16
+#define MAX_LEN	1024
+
+static const size_t lengths[] = { 16, 64, 256, MAX_LEN };
+
+static char src[MAX_LEN + 8] __aligned(4);
+static char dst[MAX_LEN + 8] __aligned(4);
+
+static int rc = TC_PASS;
+
+/* cycles per call of <call> */
+#define MEASURE(call)						\
+	({							\
+		uint32_t start = k_cycle_get_32();		\
+		int i;						\
+								\
+		for (i = 0; i < CALLS; i++) {			\
+			call;					\
+		}						\
+		(k_cycle_get_32() - start) / CALLS;		\
+	})
+
+static void check(int ok, const char *what, size_t len)
+{
+	if (!ok) {
+		TC_ERROR("%s of %u bytes failed\n", what, len);
+		rc = TC_FAIL;
+	}
+}
+
+static void report(const char *what, size_t len, uint32_t cycles)
+{
+	/* a call faster than the cycle counter resolution */
+	cycles = max(cycles, 1);
+
+	TC_PRINT("%-24s %5u bytes: %6u cycles, %3u.%02u bytes per cycle\n",
+		 what, len, cycles, len / cycles, len * 100 / cycles % 100);
+}
+
+static void bench_copy(size_t len, int s_off, int d_off, const char *what)
+{
+	uint32_t cycles;
+
+	memset(dst, 0, sizeof(dst));
+	cycles = MEASURE(memcpy(dst + d_off, src + s_off, len));
+	check(!memcmp(dst + d_off, src + s_off, len), what, len);
+	report(what, len, cycles);
+}
+
+static void bench_move(size_t len, int off, const char *what)
+{
+	uint32_t cycles;
+
+	/* an overlapping copy, backwards */
+	memcpy(dst, src, len);
+	cycles = MEASURE(memmove(dst + off, dst, len - off));
+	check(!memcmp(dst + off, src, off), what, len);
+	report(what, len, cycles);
+}
+
+static void bench_scan(size_t len)
+{
+	uint32_t cycles;
+	void *p = NULL;
+	size_t n = 0;
+	int cmp = 1;
+
+	memset(src, 'a', sizeof(src));
+	memset(dst, 'a', sizeof(dst));
+	src[len] = '\0';
+	dst[len] = '\0';
+
+	cycles = MEASURE(memset(dst, 'a', len));
+	report("memset", len, cycles);
+
+	cycles = MEASURE(cmp = memcmp(src, dst, len));
+	check(cmp == 0, "memcmp", len);
+	report("memcmp", len, cycles);
+
+	cycles = MEASURE(p = memchr(src, '\0', len + 1));
+	check(p == src + len, "memchr", len);
+	report("memchr", len, cycles);
+
+	cycles = MEASURE(n = strlen(src));
+	check(n == len, "strlen", len);
+	report("strlen", len, cycles);
+
+	cycles = MEASURE(n = strlen(src + 1));
+	check(n == len - 1, "strlen misaligned", len);
+	report("strlen misaligned", len, cycles);
+
+	cycles = MEASURE(cmp = strcmp(src, dst));
+	check(cmp == 0, "strcmp", len);
+	report("strcmp", len, cycles);
+
+	cycles = MEASURE(p = strchr(src, 'b'));
+	check(p == NULL, "strchr", len);
+	report("strchr", len, cycles);
+}
+
+void main(void)
+{
+	int i, j;
+
+	TC_START("string and memory functions");
+
+	for (i = 0; i < sizeof(src); i++) {
+		src[i] = i * 7 + 1;
+	}
+
+	for (j = 0; j < ARRAY_SIZE(lengths); j++) {
+		bench_copy(lengths[j], 0, 0, "memcpy aligned");
+		bench_copy(lengths[j], 1, 0, "memcpy misaligned src");
+		bench_copy(lengths[j], 3, 1, "memcpy misaligned both");
+		bench_move(lengths[j], 4, "memmove aligned");
+		bench_move(lengths[j], 1, "memmove misaligned");
+	}
+
+	for (j = 0; j < ARRAY_SIZE(lengths); j++) {
+		bench_scan(lengths[j]);
+	}
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
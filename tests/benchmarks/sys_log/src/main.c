@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the cost of a log call
+ *
+ * Log messages with and without arguments and report the cycles each call
+ * takes in its caller. Built with prj.conf, the message is formatted and
+ * written to the console during the call; with prj_deferred.conf, it is
+ * only stored for the logging thread. The deferred build then logs a burst
+ * larger than its buffer and checks that the overflow is counted. With
+ * prj_runtime.conf, the level of the domain is then lowered at runtime and
+ * the cost of a call that is filtered out is measured.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define SYS_LOG_DOMAIN "bench"
+#define SYS_LOG_LEVEL SYS_LOG_LEVEL_DEBUG
+#include <logging/sys_log.h>
+
+#define CALLS	16
+
+static uint32_t cycles_no_args;
+static uint32_t cycles_args;
+
+static void measure(void)
+{
+	uint32_t start;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < CALLS; i++) {
+		SYS_LOG_DBG("fixed message");
+	}
+	cycles_no_args = (k_cycle_get_32() - start) / CALLS;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < CALLS; i++) {
+		SYS_LOG_DBG("message %d of %d, value 0x%08x", i, CALLS,
+			    i * 0x01010101);
+	}
+	cycles_args = (k_cycle_get_32() - start) / CALLS;
+}
+
+static void report(const char *what, uint32_t cycles)
+{
+	TC_PRINT("%-20s: %6u cycles, %6u ns per call\n", what, cycles,
+		 (uint32_t)SYS_CLOCK_HW_CYCLES_TO_NS64(cycles));
+}
+
+void main(void)
+{
+	int rc = TC_PASS;
+
+	TC_START("log call cost");
+
+	measure();
+
+	/* let the logging thread catch up before reporting */
+	k_sleep(500);
+
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+	TC_PRINT("deferred logging, %u message buffer\n",
+		 CONFIG_SYS_LOG_DEFERRED_ENTRIES);
+#else
+	TC_PRINT("immediate logging\n");
+#endif
+	report("no arguments", cycles_no_args);
+	report("three arguments", cycles_args);
+
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+	{
+		uint32_t dropped = sys_log_deferred_dropped();
+		int i;
+
+		for (i = 0; i < 2 * CONFIG_SYS_LOG_DEFERRED_ENTRIES; i++) {
+			SYS_LOG_DBG("burst message %d", i);
+		}
+
+		k_sleep(500);
+
+		dropped = sys_log_deferred_dropped() - dropped;
+		TC_PRINT("%u of %u burst messages dropped\n", dropped,
+			 2 * CONFIG_SYS_LOG_DEFERRED_ENTRIES);
+
+		if (dropped < CONFIG_SYS_LOG_DEFERRED_ENTRIES) {
+			TC_ERROR("Overflow not counted\n");
+			rc = TC_FAIL;
+		}
+	}
+#endif
+
+#if defined(CONFIG_SYS_LOG_RUNTIME_LEVEL)
+	if (sys_log_level_set(SYS_LOG_DOMAIN, SYS_LOG_LEVEL_INFO) < 1 ||
+	    sys_log_level_get(SYS_LOG_DOMAIN) != SYS_LOG_LEVEL_INFO) {
+		TC_ERROR("Domain level not set\n");
+		rc = TC_FAIL;
+	}
+
+	measure();
+
+	TC_PRINT("debug messages filtered out at runtime\n");
+	report("no arguments", cycles_no_args);
+	report("three arguments", cycles_args);
+
+	sys_log_level_set(SYS_LOG_DOMAIN, SYS_LOG_LEVEL_DEBUG);
+#endif
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_adc_basic
+ * @{
+ * @defgroup t_adc_continuous test_adc_continuous
+ * @brief TestPurpose: verify continuous sampling into a ring of buffers
+ *                     with the simulated ADC, whose samples count the
+ *                     samples taken before them
+ * - API coverage
+ *   -# adc_continuous_start adc_continuous_stop
+ *   -# adc_buffer_release adc_continuous_stats_get
+ * @}
+ */
+
+#include <ztest.h>
+#include <adc.h>
+
+#define ADC_DEV_NAME	CONFIG_ADC_0_NAME
+#define BUF_COUNT	4
+#define BUF_SAMPLES	64
+#define INTERVAL_US	100
+#define EVT_TIMEOUT	500
+
+static struct device *adc_dev;
+
+static uint16_t samples[BUF_COUNT][BUF_SAMPLES];
+static uint8_t *buffers[BUF_COUNT] = {
+	(uint8_t *)samples[0], (uint8_t *)samples[1],
+	(uint8_t *)samples[2], (uint8_t *)samples[3],
+};
+
+/* first and last sample of each full buffer, in order */
+#define LOG_SIZE	64
+static uint16_t log_first[LOG_SIZE];
+static uint16_t log_last[LOG_SIZE];
+static volatile int log_count;
+static volatile bool release_in_callback;
+static volatile bool bad_callback;
+
+static struct k_sem buf_sem;
+K_MSGQ_DEFINE(buf_msgq, sizeof(uint8_t *), BUF_COUNT, 4);
+
+static void buffer_cb(struct device *dev, uint8_t *buffer, uint32_t length,
+		      void *user_data)
+{
+	uint16_t *data = (uint16_t *)buffer;
+
+	/* called from the ISR, checked by the tests */
+	if (length != sizeof(samples[0]) || user_data != &buf_sem) {
+		bad_callback = true;
+	}
+
+	if (log_count < LOG_SIZE) {
+		log_first[log_count] = data[0];
+		log_last[log_count] = data[BUF_SAMPLES - 1];
+	}
+	log_count++;
+
+	if (release_in_callback) {
+		adc_buffer_release(dev, buffer);
+	} else {
+		k_msgq_put(&buf_msgq, &buffer, K_NO_WAIT);
+	}
+
+	k_sem_give(&buf_sem);
+}
+
+static struct adc_continuous_cfg cont_cfg = {
+	.buffers = buffers,
+	.buffer_count = BUF_COUNT,
+	.buffer_length = sizeof(samples[0]),
+	.interval_us = INTERVAL_US,
+	.callback = buffer_cb,
+	.user_data = &buf_sem,
+};
+
+static void reset(bool in_callback)
+{
+	k_sem_reset(&buf_sem);
+	k_msgq_purge(&buf_msgq);
+	log_count = 0;
+	bad_callback = false;
+	release_in_callback = in_callback;
+}
+
+static void wait_buffers(int count)
+{
+	while (log_count < count) {
+		assert_equal(k_sem_take(&buf_sem, EVT_TIMEOUT), 0,
+			     "no buffer");
+	}
+}
+
+static void check_contiguous(int from, int to)
+{
+	int i;
+
+	for (i = from; i < to; i++) {
+		assert_equal((uint16_t)(log_last[i] - log_first[i]),
+			     BUF_SAMPLES - 1, "gap in a buffer");
+		if (i > from) {
+			assert_equal((uint16_t)(log_first[i] -
+						log_last[i - 1]), 1,
+				     "gap between buffers");
+		}
+	}
+}
+
+static void test_continuous_setup(void)
+{
+	adc_dev = device_get_binding(ADC_DEV_NAME);
+	assert_not_null(adc_dev, "no ADC device");
+
+	k_sem_init(&buf_sem, 0, UINT_MAX);
+	adc_enable(adc_dev);
+}
+
+static void test_continuous_gapless(void)
+{
+	struct adc_continuous_stats stats;
+
+	reset(true);
+
+	assert_equal(adc_continuous_start(adc_dev, &cont_cfg), 0,
+		     "start failed");
+	wait_buffers(4 * BUF_COUNT);
+	assert_equal(adc_continuous_stop(adc_dev), 0, "stop failed");
+
+	assert_false(bad_callback, "wrong callback arguments");
+	check_contiguous(0, 4 * BUF_COUNT);
+
+	assert_equal(adc_continuous_stats_get(adc_dev, &stats), 0,
+		     "no statistics");
+	assert_true(stats.buffers >= 4 * BUF_COUNT, "buffers not counted");
+	assert_equal(stats.overruns, 0, "unexpected overrun");
+	assert_equal(stats.samples_lost, 0, "unexpected loss");
+}
+
+/* buffers processed by a thread, as an application would */
+static void test_continuous_thread_release(void)
+{
+	uint8_t *buffer;
+	int i;
+
+	reset(false);
+
+	assert_equal(adc_continuous_start(adc_dev, &cont_cfg), 0,
+		     "start failed");
+
+	for (i = 0; i < 4 * BUF_COUNT; i++) {
+		assert_equal(k_msgq_get(&buf_msgq, &buffer, EVT_TIMEOUT), 0,
+			     "no buffer");
+		assert_equal(adc_buffer_release(adc_dev, buffer), 0,
+			     "release failed");
+	}
+
+	assert_equal(adc_continuous_stop(adc_dev), 0, "stop failed");
+	check_contiguous(0, 4 * BUF_COUNT);
+}
+
+static void test_continuous_overrun(void)
+{
+	struct adc_continuous_stats stats;
+	uint8_t *buffer;
+	uint16_t lost;
+
+	reset(false);
+
+	assert_equal(adc_continuous_start(adc_dev, &cont_cfg), 0,
+		     "start failed");
+
+	/* keep all the buffers, sampling has nowhere to go */
+	wait_buffers(BUF_COUNT);
+	k_sleep(20);
+
+	assert_equal(adc_continuous_stats_get(adc_dev, &stats), 0,
+		     "no statistics");
+	assert_equal(stats.buffers, BUF_COUNT, "buffer filled while held");
+	assert_equal(stats.overruns, 1, "overrun not counted");
+	assert_true(stats.samples_lost > 0, "lost samples not counted");
+
+	while (k_msgq_get(&buf_msgq, &buffer, K_NO_WAIT) == 0) {
+		assert_equal(adc_buffer_release(adc_dev, buffer), 0,
+			     "release failed");
+	}
+
+	/* sampling resumes in the released buffers, after the lost ones */
+	wait_buffers(BUF_COUNT + 1);
+	assert_equal(adc_continuous_stop(adc_dev), 0, "stop failed");
+
+	assert_equal(adc_continuous_stats_get(adc_dev, &stats), 0,
+		     "no statistics");
+	lost = log_first[BUF_COUNT] - log_last[BUF_COUNT - 1] - 1;
+	assert_equal(lost, (uint16_t)stats.samples_lost,
+		     "lost samples miscounted");
+	check_contiguous(0, BUF_COUNT);
+}
+
+static void test_continuous_interval(void)
+{
+	struct adc_continuous_stats stats;
+	uint32_t start, expected, taken;
+
+	reset(true);
+
+	start = k_cycle_get_32();
+	assert_equal(adc_continuous_start(adc_dev, &cont_cfg), 0,
+		     "start failed");
+	k_sleep(200);
+	assert_equal(adc_continuous_stop(adc_dev), 0, "stop failed");
+
+	expected = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start) /
+		   1000 / INTERVAL_US;
+
+	assert_equal(adc_continuous_stats_get(adc_dev, &stats), 0,
+		     "no statistics");
+	taken = stats.buffers * BUF_SAMPLES;
+
+	/* samples are taken on each tick, and stored a buffer at a time */
+	TC_PRINT("%u samples expected, %u in full buffers\n", expected,
+		 taken);
+	assert_true(taken <= expected, "sampling too fast");
+	assert_true(taken + BUF_SAMPLES +
+		    2 * USEC_PER_SEC / INTERVAL_US /
+		    CONFIG_SYS_CLOCK_TICKS_PER_SEC >= expected,
+		    "sampling too slow");
+}
+
+static void test_continuous_errors(void)
+{
+	struct adc_continuous_cfg bad_cfg = cont_cfg;
+	struct adc_seq_entry entry = {
+		.buffer = (uint8_t *)samples[0],
+		.buffer_length = sizeof(samples[0]),
+	};
+	struct adc_seq_table table = {
+		.entries = &entry,
+		.num_entries = 1,
+	};
+	uint16_t other[BUF_SAMPLES];
+
+	reset(false);
+
+	bad_cfg.buffer_count = 1;
+	assert_equal(adc_continuous_start(adc_dev, &bad_cfg), -EINVAL,
+		     "single buffer accepted");
+
+	bad_cfg = cont_cfg;
+	bad_cfg.interval_us = 0;
+	assert_equal(adc_continuous_start(adc_dev, &bad_cfg), -EINVAL,
+		     "no interval accepted");
+
+	assert_equal(adc_continuous_stop(adc_dev), -EALREADY,
+		     "idle ADC stopped");
+
+	assert_equal(adc_continuous_start(adc_dev, &cont_cfg), 0,
+		     "start failed");
+	assert_equal(adc_continuous_start(adc_dev, &cont_cfg), -EBUSY,
+		     "started twice");
+	assert_equal(adc_read(adc_dev, &table), -EBUSY,
+		     "read while sampling");
+
+	/* buffers the driver owns cannot be released */
+	assert_equal(adc_buffer_release(adc_dev, buffers[0]), -EINVAL,
+		     "buffer being filled released");
+	assert_equal(adc_buffer_release(adc_dev, buffers[1]), -EINVAL,
+		     "free buffer released");
+	assert_equal(adc_buffer_release(adc_dev, (uint8_t *)other), -EINVAL,
+		     "unknown buffer released");
+
+	assert_equal(adc_continuous_stop(adc_dev), 0, "stop failed");
+	assert_equal(adc_read(adc_dev, &table), 0, "read after stop failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(adc_continuous_test,
+			 ztest_unit_test(test_continuous_setup),
+			 ztest_unit_test(test_continuous_gapless),
+			 ztest_unit_test(test_continuous_thread_release),
+			 ztest_unit_test(test_continuous_overrun),
+			 ztest_unit_test(test_continuous_interval),
+			 ztest_unit_test(test_continuous_errors));
+	ztest_run_test_suite(adc_continuous_test);
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_dma_mem_to_mem
+ * @{
+ * @defgroup t_dma_chain_cyclic test_dma_chain_cyclic
+ * @brief TestPurpose: verify block chains, cyclic transfers and the
+ *                     channel status with the software DMA controller
+ * - API coverage
+ *   -# dma_config dma_start dma_stop
+ *   -# dma_get_status
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <dma.h>
+
+#define DMA_DEV_NAME	CONFIG_DMA_SW_DEV_NAME
+#define BLOCK_SIZE	64
+#define CYCLES		3
+#define EVT_TIMEOUT	500
+
+static struct device *dma_dev;
+
+static uint8_t src[3][BLOCK_SIZE];
+static uint8_t dst[3][BLOCK_SIZE];
+
+static struct dma_block_config blocks[3];
+static struct dma_config dma_cfg;
+
+static struct k_sem done_sem;
+static volatile int statuses[16];
+static volatile int status_count;
+static volatile int stop_after;
+
+static void dma_cb(struct device *dev, uint32_t channel, int status)
+{
+	if (status_count < ARRAY_SIZE(statuses)) {
+		statuses[status_count] = status;
+	}
+	status_count++;
+
+	if (status < 0 || (stop_after && status_count == stop_after)) {
+		dma_stop(dev, channel);
+		k_sem_give(&done_sem);
+	} else if (!stop_after && status == DMA_STATUS_COMPLETE) {
+		k_sem_give(&done_sem);
+	}
+}
+
+static void setup_blocks(int count)
+{
+	int i, j;
+
+	memset(blocks, 0, sizeof(blocks));
+	memset(dst, 0, sizeof(dst));
+
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < BLOCK_SIZE; j++) {
+			src[i][j] = i * BLOCK_SIZE + j;
+		}
+
+		blocks[i].source_address = (uint32_t)src[i];
+		blocks[i].dest_address = (uint32_t)dst[i];
+		blocks[i].block_size = BLOCK_SIZE;
+		if (i + 1 < count) {
+			blocks[i].next_block = &blocks[i + 1];
+		}
+	}
+
+	memset(&dma_cfg, 0, sizeof(dma_cfg));
+	dma_cfg.channel_direction = MEMORY_TO_MEMORY;
+	dma_cfg.source_data_size = 1;
+	dma_cfg.dest_data_size = 1;
+	dma_cfg.source_burst_length = 1;
+	dma_cfg.dest_burst_length = 1;
+	dma_cfg.block_count = count;
+	dma_cfg.head_block = blocks;
+	dma_cfg.dma_callback = dma_cb;
+
+	k_sem_reset(&done_sem);
+	status_count = 0;
+	stop_after = 0;
+}
+
+static void test_dma_setup(void)
+{
+	dma_dev = device_get_binding(DMA_DEV_NAME);
+	assert_not_null(dma_dev, "no DMA device");
+
+	k_sem_init(&done_sem, 0, 1);
+}
+
+static void test_dma_chain(void)
+{
+	struct dma_status status;
+
+	setup_blocks(3);
+
+	assert_equal(dma_config(dma_dev, 0, &dma_cfg), 0, "config failed");
+	assert_equal(dma_start(dma_dev, 0), 0, "start failed");
+	assert_equal(k_sem_take(&done_sem, EVT_TIMEOUT), 0, "no completion");
+
+	/* a single callback for the whole chain */
+	assert_equal(status_count, 1, "wrong number of callbacks");
+	assert_equal(statuses[0], DMA_STATUS_COMPLETE, "wrong status");
+	assert_equal(memcmp(dst, src, sizeof(dst)), 0, "wrong data");
+
+	assert_equal(dma_get_status(dma_dev, 0, &status), 0, "no status");
+	assert_false(status.busy, "channel still busy");
+	assert_equal(status.pending_length, 0, "data still pending");
+}
+
+static void test_dma_chain_block_callback(void)
+{
+	setup_blocks(3);
+	dma_cfg.complete_callback_en = 1;
+
+	assert_equal(dma_config(dma_dev, 0, &dma_cfg), 0, "config failed");
+	assert_equal(dma_start(dma_dev, 0), 0, "start failed");
+	assert_equal(k_sem_take(&done_sem, EVT_TIMEOUT), 0, "no completion");
+
+	assert_equal(status_count, 3, "wrong number of callbacks");
+	assert_equal(statuses[0], DMA_STATUS_BLOCK, "wrong status");
+	assert_equal(statuses[1], DMA_STATUS_BLOCK, "wrong status");
+	assert_equal(statuses[2], DMA_STATUS_COMPLETE, "wrong status");
+	assert_equal(memcmp(dst, src, sizeof(dst)), 0, "wrong data");
+}
+
+static void test_dma_cyclic_ping_pong(void)
+{
+	struct dma_status status;
+	int i;
+
+	setup_blocks(2);
+	dma_cfg.complete_callback_en = 1;
+	dma_cfg.cyclic = 1;
+	stop_after = 2 * CYCLES;
+
+	assert_equal(dma_config(dma_dev, 1, &dma_cfg), 0, "config failed");
+	assert_equal(dma_start(dma_dev, 1), 0, "start failed");
+	assert_equal(dma_start(dma_dev, 1), -EBUSY, "started twice");
+
+	assert_equal(k_sem_take(&done_sem, EVT_TIMEOUT), 0, "not stopped");
+
+	/* the buffers take turns until stopped */
+	for (i = 0; i < 2 * CYCLES; i++) {
+		assert_equal(statuses[i], (i & 1) ? DMA_STATUS_COMPLETE :
+			     DMA_STATUS_BLOCK, "wrong status");
+	}
+
+	assert_equal(memcmp(dst, src, 2 * BLOCK_SIZE), 0, "wrong data");
+
+	k_sleep(10);
+	assert_equal(status_count, 2 * CYCLES, "callback after stop");
+	assert_equal(dma_get_status(dma_dev, 1, &status), 0, "no status");
+	assert_false(status.busy, "channel still busy");
+}
+
+static void test_dma_cyclic_half(void)
+{
+	int i;
+
+	setup_blocks(1);
+	dma_cfg.cyclic = 1;
+	dma_cfg.half_complete_callback_en = 1;
+	stop_after = 2 * CYCLES;
+
+	assert_equal(dma_config(dma_dev, 0, &dma_cfg), 0, "config failed");
+	assert_equal(dma_start(dma_dev, 0), 0, "start failed");
+	assert_equal(k_sem_take(&done_sem, EVT_TIMEOUT), 0, "not stopped");
+
+	for (i = 0; i < 2 * CYCLES; i++) {
+		assert_equal(statuses[i], (i & 1) ? DMA_STATUS_COMPLETE :
+			     DMA_STATUS_HALF_COMPLETE, "wrong status");
+	}
+
+	assert_equal(memcmp(dst[0], src[0], BLOCK_SIZE), 0, "wrong data");
+}
+
+/* a fixed source address, as when reading a peripheral data register */
+static void test_dma_fixed_source(void)
+{
+	static uint32_t reg = 0xa5a5a5a5;
+	static uint32_t words[BLOCK_SIZE / 4];
+	int i;
+
+	setup_blocks(1);
+	blocks[0].source_address = (uint32_t)&reg;
+	blocks[0].dest_address = (uint32_t)words;
+	blocks[0].source_addr_adj = 2;
+	dma_cfg.source_data_size = 4;
+	dma_cfg.dest_data_size = 4;
+
+	assert_equal(dma_config(dma_dev, 2, &dma_cfg), 0, "config failed");
+	assert_equal(dma_start(dma_dev, 2), 0, "start failed");
+	assert_equal(k_sem_take(&done_sem, EVT_TIMEOUT), 0, "no completion");
+
+	for (i = 0; i < ARRAY_SIZE(words); i++) {
+		assert_equal(words[i], reg, "wrong data");
+	}
+}
+
+static void test_dma_bad_config(void)
+{
+	setup_blocks(1);
+	dma_cfg.channel_direction = PERIPHERAL_TO_MEMORY;
+	assert_equal(dma_config(dma_dev, 0, &dma_cfg), -ENOTSUP,
+		     "peripheral accepted");
+
+	setup_blocks(1);
+	dma_cfg.dest_data_size = 2;
+	assert_equal(dma_config(dma_dev, 0, &dma_cfg), -EINVAL,
+		     "mismatched sizes accepted");
+
+	setup_blocks(1);
+	assert_equal(dma_config(dma_dev, CONFIG_DMA_SW_CHANNELS, &dma_cfg),
+		     -EINVAL, "bad channel accepted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dma_chain_cyclic_test,
+			 ztest_unit_test(test_dma_setup),
+			 ztest_unit_test(test_dma_chain),
+			 ztest_unit_test(test_dma_chain_block_callback),
+			 ztest_unit_test(test_dma_cyclic_ping_pong),
+			 ztest_unit_test(test_dma_cyclic_half),
+			 ztest_unit_test(test_dma_fixed_source),
+			 ztest_unit_test(test_dma_bad_config));
+	ztest_run_test_suite(dma_chain_cyclic_test);
+}
@@ -18,12 +18,16 @@ extern void test_dma_m2m_chan0_burst8(void);
 extern void test_dma_m2m_chan1_burst8(void);
 extern void test_dma_m2m_chan0_burst16(void);
 extern void test_dma_m2m_chan1_burst16(void);
+extern void test_dma_m2m_chan0_width4(void);
+extern void test_dma_m2m_chan1_width4_halves(void);
 
 #ifdef CONFIG_CONSOLE_SHELL
 TC_CMD_DEFINE(test_dma_m2m_chan0_burst8)
 TC_CMD_DEFINE(test_dma_m2m_chan1_burst8)
 TC_CMD_DEFINE(test_dma_m2m_chan0_burst16)
 TC_CMD_DEFINE(test_dma_m2m_chan1_burst16)
+TC_CMD_DEFINE(test_dma_m2m_chan0_width4)
+TC_CMD_DEFINE(test_dma_m2m_chan1_width4_halves)
 #endif
 
 void test_main(void)
@@ -35,6 +39,8 @@ void test_main(void)
 		TC_CMD_ITEM(test_dma_m2m_chan1_burst8),
 		TC_CMD_ITEM(test_dma_m2m_chan0_burst16),
 		TC_CMD_ITEM(test_dma_m2m_chan1_burst16),
+		TC_CMD_ITEM(test_dma_m2m_chan0_width4),
+		TC_CMD_ITEM(test_dma_m2m_chan1_width4_halves),
 		{ NULL, NULL }
 	};
 	SHELL_REGISTER("runtest", commands);
@@ -43,7 +49,9 @@ void test_main(void)
 			 ztest_unit_test(test_dma_m2m_chan0_burst8),
 			 ztest_unit_test(test_dma_m2m_chan1_burst8),
 			 ztest_unit_test(test_dma_m2m_chan0_burst16),
-			 ztest_unit_test(test_dma_m2m_chan1_burst16));
+			 ztest_unit_test(test_dma_m2m_chan1_burst16),
+			 ztest_unit_test(test_dma_m2m_chan0_width4),
+			 ztest_unit_test(test_dma_m2m_chan1_width4_halves));
 	ztest_run_test_suite(dma_m2m_test);
 #endif
 }
@@ -12,6 +12,7 @@
  * @details
  * - Test Steps
  *   -# Set dma channel configuration including source/dest addr, burstlen
+ *      and data width, with a half complete callback or not
  *   -# Set direction memory-to-memory
  *   -# Start transter
  * - Expected Results
@@ -26,19 +27,24 @@
 #define DMA_DEVICE_NAME CONFIG_DMA_0_NAME
 #define RX_BUFF_SIZE (48)
 
-static const char tx_data[] = "It is harder to be kind than to be wise";
-static char rx_data[RX_BUFF_SIZE] = { 0 };
+/* 40 bytes with the NUL, a multiple of all the data widths */
+static const char tx_data[] __aligned(4) =
+	"It is harder to be kind than to be wise";
+static char rx_data[RX_BUFF_SIZE] __aligned(4) = { 0 };
 
 static void test_done(struct device *dev, uint32_t id, int error_code)
 {
-	if (error_code == 0) {
+	if (error_code == DMA_STATUS_HALF_COMPLETE) {
+		TC_PRINT("DMA transfer half done\n");
+	} else if (error_code == 0) {
 		TC_PRINT("DMA transfer done\n");
 	} else {
 		TC_PRINT("DMA transfer met an error\n");
 	}
 }
 
-static int test_task(uint32_t chan_id, uint32_t blen)
+static int test_task(uint32_t chan_id, uint32_t blen, uint32_t width,
+		     bool halves)
 {
 	struct dma_config dma_cfg = {0};
 	struct dma_block_config dma_block_cfg = {0};
@@ -50,19 +56,22 @@ static int test_task(uint32_t chan_id, uint32_t blen)
 	}
 
 	dma_cfg.channel_direction = MEMORY_TO_MEMORY;
-	dma_cfg.source_data_size = 1;
-	dma_cfg.dest_data_size = 1;
+	dma_cfg.source_data_size = width;
+	dma_cfg.dest_data_size = width;
 	dma_cfg.source_burst_length = blen;
 	dma_cfg.dest_burst_length = blen;
 	dma_cfg.dma_callback = test_done;
+	dma_cfg.half_complete_callback_en = halves;
 	dma_cfg.block_count = 1;
 	dma_cfg.head_block = &dma_block_cfg;
 
-	TC_PRINT("Preparing DMA Controller: Chan_ID=%u, BURST_LEN=%u\n",
-			chan_id, blen >> 3);
+	TC_PRINT("Preparing DMA Controller: Chan_ID=%u, BURST_LEN=%u, "
+		 "WIDTH=%u\n", chan_id, blen >> 3, width);
 
 	TC_PRINT("Starting the transfer\n");
-	dma_block_cfg.block_size = strlen(tx_data);
+	memset(rx_data, 0, sizeof(rx_data));
+	/* in bytes, whatever the data width */
+	dma_block_cfg.block_size = sizeof(tx_data);
 	dma_block_cfg.source_address = (uint32_t)tx_data;
 	dma_block_cfg.dest_address = (uint32_t)rx_data;
 
@@ -85,20 +94,31 @@ static int test_task(uint32_t chan_id, uint32_t blen)
 /* export test cases */
 void test_dma_m2m_chan0_burst8(void)
 {
-	assert_true((test_task(0, 8) == TC_PASS), NULL);
+	assert_true((test_task(0, 8, 1, false) == TC_PASS), NULL);
 }
 
 void test_dma_m2m_chan1_burst8(void)
 {
-	assert_true((test_task(1, 8) == TC_PASS), NULL);
+	assert_true((test_task(1, 8, 1, false) == TC_PASS), NULL);
 }
 
 void test_dma_m2m_chan0_burst16(void)
 {
-	assert_true((test_task(0, 16) == TC_PASS), NULL);
+	assert_true((test_task(0, 16, 1, false) == TC_PASS), NULL);
 }
 
 void test_dma_m2m_chan1_burst16(void)
 {
-	assert_true((test_task(1, 16) == TC_PASS), NULL);
+	assert_true((test_task(1, 16, 1, false) == TC_PASS), NULL);
+}
+
+void test_dma_m2m_chan0_width4(void)
+{
+	assert_true((test_task(0, 8, 4, false) == TC_PASS), NULL);
+}
+
+/* the second half starts half the bytes in, not half the items */
+void test_dma_m2m_chan1_width4_halves(void)
+{
+	assert_true((test_task(1, 8, 4, true) == TC_PASS), NULL);
 }
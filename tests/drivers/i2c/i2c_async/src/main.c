@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_i2c_basic
+ * @{
+ * @defgroup t_i2c_async test_i2c_async
+ * @brief TestPurpose: verify the I2C transfer queue with an emulated bus
+ *                     completing its messages from a timer, and the
+ *                     fallback on drivers without a queue
+ * - API coverage
+ *   -# i2c_transfer_async i2c_transfer
+ *   -# i2c_burst_read i2c_burst_write
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <i2c.h>
+
+#include "i2c_queue.h"
+
+#define EMUL_NAME	"I2C_EMUL"
+#define EMUL_SYNC_NAME	"I2C_EMUL_SYNC"
+#define TARGET_A	0x10
+#define TARGET_B	0x20
+#define TARGET_NONE	0x30
+#define REG_COUNT	16
+#define EVT_TIMEOUT	500
+
+/* emulated targets: register files with an auto-incremented pointer */
+static uint8_t regs[2][REG_COUNT];
+static uint8_t reg_ptr[2];
+
+static int emul_target(uint16_t addr)
+{
+	switch (addr) {
+	case TARGET_A:
+		return 0;
+	case TARGET_B:
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+/* the first byte written after a start condition selects the register */
+static int emul_msg(uint16_t addr, struct i2c_msg *msg, bool start)
+{
+	int target = emul_target(addr);
+	uint32_t i = 0;
+
+	if (target < 0) {
+		/* NACK */
+		return -EIO;
+	}
+
+	if ((msg->flags & I2C_MSG_RW_MASK) == I2C_MSG_READ) {
+		for (; i < msg->len; i++) {
+			msg->buf[i] = regs[target][reg_ptr[target]++];
+			reg_ptr[target] %= REG_COUNT;
+		}
+		return 0;
+	}
+
+	if (start && msg->len) {
+		reg_ptr[target] = msg->buf[0] % REG_COUNT;
+		i = 1;
+	}
+
+	for (; i < msg->len; i++) {
+		regs[target][reg_ptr[target]++] = msg->buf[i];
+		reg_ptr[target] %= REG_COUNT;
+	}
+
+	return 0;
+}
+
+/* bus with a transfer queue, one message per timer expiry */
+struct emul_data {
+	struct i2c_queue queue;
+	struct k_timer timer;
+	struct i2c_msg *msg;
+	struct device *dev;
+};
+
+static struct emul_data emul_data;
+
+static volatile int msgs_started;
+static volatile int msgs_started_isr;
+static uint16_t addr_log[16];
+
+static void emul_start(struct device *dev, struct i2c_msg *msg)
+{
+	struct emul_data *data = dev->driver_data;
+
+	if (msgs_started < ARRAY_SIZE(addr_log)) {
+		addr_log[msgs_started] = i2c_queue_addr(&data->queue);
+	}
+	msgs_started++;
+	if (k_is_in_isr()) {
+		msgs_started_isr++;
+	}
+
+	data->msg = msg;
+	k_timer_start(&data->timer, K_MSEC(1), 0);
+}
+
+static void emul_tick(struct k_timer *timer)
+{
+	struct emul_data *data = CONTAINER_OF(timer, struct emul_data, timer);
+	struct i2c_msg *msg;
+	int status;
+
+	status = emul_msg(i2c_queue_addr(&data->queue), data->msg,
+			  !data->queue.msg ||
+			  (data->msg->flags & I2C_MSG_RESTART));
+
+	msg = i2c_queue_next(&data->queue, status);
+	if (msg) {
+		emul_start(data->dev, msg);
+	}
+}
+
+static int emul_configure(struct device *dev, uint32_t dev_config)
+{
+	return 0;
+}
+
+static int emul_transfer(struct device *dev, struct i2c_msg *msgs,
+			 uint8_t num_msgs, uint16_t addr)
+{
+	struct emul_data *data = dev->driver_data;
+
+	return i2c_queue_transfer(&data->queue, dev, msgs, num_msgs, addr,
+				  emul_start);
+}
+
+static int emul_transfer_async(struct device *dev,
+			       struct i2c_transaction *txn)
+{
+	struct emul_data *data = dev->driver_data;
+	struct i2c_msg *msg;
+	int ret;
+
+	msg = i2c_queue_submit(&data->queue, txn, &ret);
+	if (msg) {
+		emul_start(dev, msg);
+	}
+
+	return ret;
+}
+
+static const struct i2c_driver_api emul_api = {
+	.configure = emul_configure,
+	.transfer = emul_transfer,
+	.transfer_async = emul_transfer_async,
+};
+
+static int emul_init(struct device *dev)
+{
+	struct emul_data *data = dev->driver_data;
+
+	i2c_queue_init(&data->queue);
+	k_timer_init(&data->timer, emul_tick, NULL);
+	data->dev = dev;
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(i2c_emul, EMUL_NAME, &emul_init, &emul_data, NULL,
+		    POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &emul_api);
+
+/* bus without a transfer queue */
+static int emul_sync_transfer(struct device *dev, struct i2c_msg *msgs,
+			      uint8_t num_msgs, uint16_t addr)
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < num_msgs && !ret; i++) {
+		ret = emul_msg(addr, &msgs[i],
+			       !i || (msgs[i].flags & I2C_MSG_RESTART));
+	}
+
+	return ret;
+}
+
+static const struct i2c_driver_api emul_sync_api = {
+	.configure = emul_configure,
+	.transfer = emul_sync_transfer,
+};
+
+static int emul_sync_init(struct device *dev)
+{
+	return 0;
+}
+
+DEVICE_AND_API_INIT(i2c_emul_sync, EMUL_SYNC_NAME, &emul_sync_init, NULL,
+		    NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &emul_sync_api);
+
+static struct device *i2c_dev;
+static struct device *i2c_sync_dev;
+
+/* a register read: write the register, then read from it */
+struct reg_read {
+	uint8_t reg;
+	uint8_t buf[4];
+	struct i2c_msg msgs[2];
+	struct i2c_transaction txn;
+	struct k_poll_signal signal;
+};
+
+static void reg_read_init(struct reg_read *rd, uint16_t addr, uint8_t reg)
+{
+	memset(rd, 0, sizeof(*rd));
+
+	rd->reg = reg;
+	rd->msgs[0].buf = &rd->reg;
+	rd->msgs[0].len = 1;
+	rd->msgs[0].flags = I2C_MSG_WRITE;
+	rd->msgs[1].buf = rd->buf;
+	rd->msgs[1].len = sizeof(rd->buf);
+	rd->msgs[1].flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP;
+
+	k_poll_signal_init(&rd->signal);
+	rd->txn.msgs = rd->msgs;
+	rd->txn.num_msgs = ARRAY_SIZE(rd->msgs);
+	rd->txn.addr = addr;
+	rd->txn.signal = &rd->signal;
+}
+
+static int wait_signal(struct k_poll_signal *signal)
+{
+	struct k_poll_event event = K_POLL_EVENT_INITIALIZER(
+		K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, signal);
+
+	return k_poll(&event, 1, EVT_TIMEOUT);
+}
+
+static void reset(void)
+{
+	int i;
+
+	for (i = 0; i < REG_COUNT; i++) {
+		regs[0][i] = 0xa0 + i;
+		regs[1][i] = 0xb0 + i;
+	}
+
+	msgs_started = 0;
+	msgs_started_isr = 0;
+}
+
+static void test_i2c_setup(void)
+{
+	i2c_dev = device_get_binding(EMUL_NAME);
+	assert_not_null(i2c_dev, "no I2C device");
+
+	i2c_sync_dev = device_get_binding(EMUL_SYNC_NAME);
+	assert_not_null(i2c_sync_dev, "no synchronous I2C device");
+}
+
+/* transfers of several targets queued on a bus, run back to back */
+static void test_i2c_async_queue(void)
+{
+	struct reg_read rd[3];
+	uint8_t expected[4] = { 0xb4, 0xb5, 0xb6, 0xb7 };
+	int i;
+
+	reset();
+
+	reg_read_init(&rd[0], TARGET_A, 0);
+	reg_read_init(&rd[1], TARGET_B, 4);
+	reg_read_init(&rd[2], TARGET_A, 8);
+
+	for (i = 0; i < ARRAY_SIZE(rd); i++) {
+		assert_equal(i2c_transfer_async(i2c_dev, &rd[i].txn), 0,
+			     "transfer not queued");
+	}
+
+	/* the transfers are over in the order they were queued */
+	assert_equal(wait_signal(&rd[2].signal), 0, "no completion signal");
+
+	for (i = 0; i < ARRAY_SIZE(rd); i++) {
+		assert_equal(rd[i].signal.signaled, 1, "signal not raised");
+		assert_equal(rd[i].signal.result, 0, "transfer failed");
+	}
+
+	assert_equal(memcmp(rd[1].buf, expected, sizeof(expected)), 0,
+		     "wrong data");
+	assert_equal(rd[0].buf[0], 0xa0, "wrong data");
+	assert_equal(rd[2].buf[3], 0xab, "wrong data");
+
+	/* only the first message waited for a thread */
+	assert_equal(msgs_started, 6, "wrong number of messages");
+	assert_equal(msgs_started_isr, 5, "message started from a thread");
+	assert_equal(addr_log[0], TARGET_A, "wrong order");
+	assert_equal(addr_log[2], TARGET_B, "wrong order");
+	assert_equal(addr_log[4], TARGET_A, "wrong order");
+}
+
+/* a synchronous transfer waits for the queued ones */
+static void test_i2c_sync_after_async(void)
+{
+	struct reg_read rd;
+	uint8_t data[2] = { 0x55, 0xaa };
+	uint8_t check[2];
+
+	reset();
+
+	reg_read_init(&rd, TARGET_B, 2);
+	assert_equal(i2c_transfer_async(i2c_dev, &rd.txn), 0,
+		     "transfer not queued");
+
+	assert_equal(i2c_burst_write(i2c_dev, TARGET_B, 2, data,
+				     sizeof(data)), 0, "write failed");
+	assert_equal(rd.signal.signaled, 1, "queued transfer not over");
+	assert_equal(rd.buf[0], 0xb2, "read after the write");
+
+	assert_equal(i2c_burst_read(i2c_dev, TARGET_B, 2, check,
+				    sizeof(check)), 0, "read failed");
+	assert_equal(memcmp(check, data, sizeof(data)), 0, "wrong data");
+}
+
+/* a failed transfer does not stop the queue */
+static void test_i2c_async_nack(void)
+{
+	struct reg_read rd[2];
+
+	reset();
+
+	reg_read_init(&rd[0], TARGET_NONE, 0);
+	reg_read_init(&rd[1], TARGET_A, 0);
+
+	assert_equal(i2c_transfer_async(i2c_dev, &rd[0].txn), 0,
+		     "transfer not queued");
+	assert_equal(i2c_transfer_async(i2c_dev, &rd[1].txn), 0,
+		     "transfer not queued");
+	assert_equal(i2c_transfer_async(i2c_dev, &rd[1].txn), -EBUSY,
+		     "transfer queued twice");
+
+	assert_equal(wait_signal(&rd[1].signal), 0, "no completion signal");
+	assert_equal(rd[0].signal.result, -EIO, "NACK not reported");
+	assert_equal(rd[1].signal.result, 0, "transfer failed");
+	assert_equal(rd[1].buf[0], 0xa0, "wrong data");
+
+	/* the failed transfer stopped at its first message */
+	assert_equal(msgs_started, 3, "wrong number of messages");
+}
+
+/* drivers without a queue complete the transfer before returning */
+static void test_i2c_async_fallback(void)
+{
+	struct reg_read rd;
+
+	reset();
+
+	reg_read_init(&rd, TARGET_A, 12);
+	assert_equal(i2c_transfer_async(i2c_sync_dev, &rd.txn), 0,
+		     "transfer failed");
+	assert_equal(rd.signal.signaled, 1, "signal not raised");
+	assert_equal(rd.signal.result, 0, "transfer failed");
+	assert_equal(rd.buf[0], 0xac, "wrong data");
+
+	reg_read_init(&rd, TARGET_NONE, 0);
+	assert_equal(i2c_transfer_async(i2c_sync_dev, &rd.txn), 0,
+		     "transfer failed");
+	assert_equal(rd.signal.result, -EIO, "NACK not reported");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(i2c_async_test,
+			 ztest_unit_test(test_i2c_setup),
+			 ztest_unit_test(test_i2c_async_queue),
+			 ztest_unit_test(test_i2c_sync_after_async),
+			 ztest_unit_test(test_i2c_async_nack),
+			 ztest_unit_test(test_i2c_async_fallback));
+	ztest_run_test_suite(i2c_async_test);
+}
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_sensor
+ * @{
+ * @defgroup t_sensor_fifo test_sensor_fifo_stream
+ * @brief TestPurpose: verify FIFO streaming and batched frame decoding
+ *                     with the LIS3DH driver on an emulated I2C bus
+ * - API coverage
+ *   -# sensor_fifo_read sensor_frames_decode
+ *   -# sensor_attr_set sensor_sample_fetch sensor_channel_get
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <i2c.h>
+#include <sensor.h>
+#include <misc/byteorder.h>
+
+#define EMUL_NAME		CONFIG_LIS3DH_I2C_MASTER_DEV_NAME
+#define EMUL_FIFO_SIZE		32
+#define EMUL_FRAME_SIZE		6
+
+#define REG_AUTOINCREMENT	0x80
+#define REG_CTRL5		0x24
+#define REG_OUT_X_L		0x28
+#define REG_OUT_Z_H		0x2D
+#define REG_FIFO_CTRL		0x2E
+#define REG_FIFO_SRC		0x2F
+#define REG_COUNT		0x40
+
+#define FIFO_EN			0x40
+#define FIFO_MODE_STREAM	0x80
+#define FIFO_SRC_WTM		0x80
+#define FIFO_SRC_OVRN		0x40
+#define FIFO_SRC_EMPTY		0x20
+
+/*
+ * Emulated LIS3DH: a register file and the FIFO of the chip behind an I2C
+ * master, which counts the bus transactions.
+ */
+static uint8_t emul_regs[REG_COUNT];
+static uint8_t emul_fifo[EMUL_FIFO_SIZE][EMUL_FRAME_SIZE];
+static uint8_t emul_frame[EMUL_FRAME_SIZE];
+static int emul_head;
+static int emul_count;
+static int emul_transfers;
+
+static bool emul_fifo_on(void)
+{
+	return (emul_regs[REG_CTRL5] & FIFO_EN) &&
+	       (emul_regs[REG_FIFO_CTRL] & 0xC0);
+}
+
+static void emul_push(int16_t x, int16_t y, int16_t z)
+{
+	uint8_t *frame;
+
+	/* stream mode, the oldest frame makes room for the new one */
+	if (emul_count == EMUL_FIFO_SIZE) {
+		emul_head = (emul_head + 1) % EMUL_FIFO_SIZE;
+		emul_count--;
+	}
+
+	frame = emul_fifo[(emul_head + emul_count) % EMUL_FIFO_SIZE];
+	sys_put_le16(x, &frame[0]);
+	sys_put_le16(y, &frame[2]);
+	sys_put_le16(z, &frame[4]);
+	emul_count++;
+}
+
+static uint8_t emul_read_reg(uint8_t reg)
+{
+	uint8_t src;
+
+	if (reg == REG_FIFO_SRC) {
+		src = min(emul_count, EMUL_FIFO_SIZE - 1);
+		if (emul_count == EMUL_FIFO_SIZE) {
+			src |= FIFO_SRC_OVRN;
+		}
+		if (emul_count > (emul_regs[REG_FIFO_CTRL] & 0x1F)) {
+			src |= FIFO_SRC_WTM;
+		}
+		if (emul_count == 0) {
+			src |= FIFO_SRC_EMPTY;
+		}
+		return src;
+	}
+
+	if (emul_fifo_on() && reg >= REG_OUT_X_L && reg <= REG_OUT_Z_H) {
+		/* reading the X axis LSB pops the next frame */
+		if (reg == REG_OUT_X_L && emul_count) {
+			memcpy(emul_frame, emul_fifo[emul_head],
+			       EMUL_FRAME_SIZE);
+			emul_head = (emul_head + 1) % EMUL_FIFO_SIZE;
+			emul_count--;
+		}
+		return emul_frame[reg - REG_OUT_X_L];
+	}
+
+	return emul_regs[reg];
+}
+
+static uint8_t emul_next_reg(uint8_t reg, bool autoincrement)
+{
+	if (!autoincrement) {
+		return reg;
+	}
+
+	/* in FIFO mode the output registers wrap around */
+	if (emul_fifo_on() && reg == REG_OUT_Z_H) {
+		return REG_OUT_X_L;
+	}
+
+	return (reg + 1) % REG_COUNT;
+}
+
+static int emul_configure(struct device *dev, uint32_t dev_config)
+{
+	return 0;
+}
+
+static int emul_transfer(struct device *dev, struct i2c_msg *msgs,
+			 uint8_t num_msgs, uint16_t addr)
+{
+	bool autoincrement = false;
+	uint8_t reg = 0;
+	uint32_t i;
+
+	if (addr != CONFIG_LIS3DH_I2C_ADDR) {
+		return -EIO;
+	}
+
+	emul_transfers++;
+
+	for (; num_msgs; num_msgs--, msgs++) {
+		i = 0;
+
+		if ((msgs->flags & I2C_MSG_RW_MASK) == I2C_MSG_READ) {
+			for (; i < msgs->len; i++) {
+				msgs->buf[i] = emul_read_reg(reg);
+				reg = emul_next_reg(reg, autoincrement);
+			}
+			continue;
+		}
+
+		/* the first byte written selects the register */
+		if (msgs->len) {
+			reg = msgs->buf[0] & ~REG_AUTOINCREMENT;
+			autoincrement = msgs->buf[0] & REG_AUTOINCREMENT;
+			i = 1;
+		}
+
+		for (; i < msgs->len; i++) {
+			emul_regs[reg] = msgs->buf[i];
+			reg = emul_next_reg(reg, autoincrement);
+		}
+	}
+
+	return 0;
+}
+
+static const struct i2c_driver_api emul_api = {
+	.configure = emul_configure,
+	.transfer = emul_transfer,
+};
+
+static int emul_init(struct device *dev)
+{
+	return 0;
+}
+
+DEVICE_AND_API_INIT(i2c_emul, EMUL_NAME, &emul_init, NULL, NULL,
+		    POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &emul_api);
+
+static struct device *sensor_dev;
+static struct sensor_frame frames[EMUL_FIFO_SIZE];
+
+static void emul_reset(void)
+{
+	emul_head = 0;
+	emul_count = 0;
+	emul_transfers = 0;
+}
+
+static void push_frames(int first, int count)
+{
+	int i;
+
+	for (i = first; i < first + count; i++) {
+		emul_push(16 * i, -16 * i, 1000 + i);
+	}
+}
+
+static void check_frames(int first, int count)
+{
+	uint32_t period = sys_clock_hw_cycles_per_sec / 100;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		assert_equal(frames[i].data[0], 16 * (first + i), "wrong X");
+		assert_equal(frames[i].data[1], -16 * (first + i), "wrong Y");
+		assert_equal(frames[i].data[2], 1000 + first + i, "wrong Z");
+
+		/* 100 Hz between consecutive frames */
+		if (i) {
+			assert_equal(frames[i].timestamp -
+				     frames[i - 1].timestamp, period,
+				     "wrong timestamp");
+		}
+	}
+}
+
+static void test_fifo_setup(void)
+{
+	sensor_dev = device_get_binding(CONFIG_LIS3DH_NAME);
+	assert_not_null(sensor_dev, "no sensor device");
+
+	assert_true(emul_regs[REG_CTRL5] & FIFO_EN, "FIFO not enabled");
+	assert_equal(emul_regs[REG_FIFO_CTRL],
+		     FIFO_MODE_STREAM | (CONFIG_LIS3DH_FIFO_WATERMARK - 1),
+		     "wrong FIFO mode");
+}
+
+static void test_fifo_empty(void)
+{
+	emul_reset();
+
+	assert_equal(sensor_fifo_read(sensor_dev, frames, EMUL_FIFO_SIZE), 0,
+		     "frames read from an empty FIFO");
+	assert_equal(emul_transfers, 1, "more than the status read");
+}
+
+static void test_fifo_read(void)
+{
+	emul_reset();
+	push_frames(0, 10);
+
+	assert_equal(sensor_fifo_read(sensor_dev, frames, EMUL_FIFO_SIZE), 10,
+		     "wrong frame count");
+	check_frames(0, 10);
+
+	/* the status, then all the frames in a single burst */
+	assert_equal(emul_transfers, 2, "FIFO not read in one burst");
+	assert_equal(emul_count, 0, "FIFO not drained");
+}
+
+static void test_fifo_partial(void)
+{
+	emul_reset();
+	push_frames(0, 20);
+
+	assert_equal(sensor_fifo_read(sensor_dev, frames, 8), 8,
+		     "wrong frame count");
+	check_frames(0, 8);
+	assert_equal(emul_count, 12, "frames lost");
+
+	/* the rest comes out in order on the next read */
+	assert_equal(sensor_fifo_read(sensor_dev, frames, EMUL_FIFO_SIZE), 12,
+		     "wrong frame count");
+	check_frames(8, 12);
+}
+
+static void test_fifo_overrun(void)
+{
+	emul_reset();
+	push_frames(0, 40);
+
+	/* a full FIFO holds the newest frames */
+	assert_equal(sensor_fifo_read(sensor_dev, frames, EMUL_FIFO_SIZE),
+		     EMUL_FIFO_SIZE, "wrong frame count");
+	check_frames(40 - EMUL_FIFO_SIZE, EMUL_FIFO_SIZE);
+}
+
+static void test_frames_decode(void)
+{
+	struct sensor_value xyz[3 * 2], x[2], fetched[3];
+	int i;
+
+	emul_reset();
+
+	/* 1 g on Z, twice: once read as frames, once fetched */
+	emul_push(-16384, 8192, 16384);
+	emul_push(-16384, 8192, 16384);
+
+	assert_equal(sensor_fifo_read(sensor_dev, frames, 1), 1,
+		     "wrong frame count");
+	frames[1] = frames[0];
+
+	assert_equal(sensor_frames_decode(sensor_dev, SENSOR_CHAN_ACCEL_XYZ,
+					  frames, 2, xyz), 0,
+		     "decode failed");
+	assert_equal(sensor_frames_decode(sensor_dev, SENSOR_CHAN_ACCEL_X,
+					  frames, 2, x), 0,
+		     "decode failed");
+
+	assert_equal(xyz[2].val1, 9, "wrong Z value");
+	assert_equal(xyz[0].val1, -10, "wrong X value");
+	assert_equal(xyz[1].val1, 4, "wrong Y value");
+
+	for (i = 0; i < 3; i++) {
+		assert_equal(xyz[3 + i].val1, xyz[i].val1, "wrong order");
+		assert_equal(xyz[3 + i].val2, xyz[i].val2, "wrong order");
+	}
+
+	assert_equal(x[1].val1, xyz[0].val1, "wrong X values");
+	assert_equal(x[1].val2, xyz[0].val2, "wrong X values");
+
+	/* the same raw sample gives the same value through the fetch path */
+	assert_equal(sensor_sample_fetch(sensor_dev), 0, "fetch failed");
+	assert_equal(sensor_channel_get(sensor_dev, SENSOR_CHAN_ACCEL_XYZ,
+					fetched), 0, "channel get failed");
+
+	for (i = 0; i < 3; i++) {
+		assert_equal(fetched[i].val1, xyz[i].val1, "wrong fetch");
+		assert_equal(fetched[i].val2, xyz[i].val2, "wrong fetch");
+	}
+
+	assert_equal(sensor_frames_decode(sensor_dev, SENSOR_CHAN_GYRO_XYZ,
+					  frames, 1, xyz), -ENOTSUP,
+		     "gyro channel decoded");
+}
+
+static void test_fifo_watermark(void)
+{
+	struct sensor_value val = { .val1 = 8 };
+
+	assert_equal(sensor_attr_set(sensor_dev, SENSOR_CHAN_ACCEL_XYZ,
+				     SENSOR_ATTR_FIFO_WATERMARK, &val), 0,
+		     "watermark not set");
+	assert_equal(emul_regs[REG_FIFO_CTRL], FIFO_MODE_STREAM | 7,
+		     "wrong watermark");
+
+	emul_reset();
+	push_frames(0, 8);
+	assert_true(emul_read_reg(REG_FIFO_SRC) & FIFO_SRC_WTM,
+		    "watermark not reached");
+
+	val.val1 = 0;
+	assert_equal(sensor_attr_set(sensor_dev, SENSOR_CHAN_ACCEL_XYZ,
+				     SENSOR_ATTR_FIFO_WATERMARK, &val), -EINVAL,
+		     "empty watermark accepted");
+
+	val.val1 = EMUL_FIFO_SIZE + 1;
+	assert_equal(sensor_attr_set(sensor_dev, SENSOR_CHAN_ACCEL_XYZ,
+				     SENSOR_ATTR_FIFO_WATERMARK, &val), -EINVAL,
+		     "watermark above the FIFO size accepted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(sensor_fifo_test,
+			 ztest_unit_test(test_fifo_setup),
+			 ztest_unit_test(test_fifo_empty),
+			 ztest_unit_test(test_fifo_read),
+			 ztest_unit_test(test_fifo_partial),
+			 ztest_unit_test(test_fifo_overrun),
+			 ztest_unit_test(test_frames_decode),
+			 ztest_unit_test(test_fifo_watermark));
+	ztest_run_test_suite(sensor_fifo_test);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_spi_loopback
+ * @{
+ * @defgroup t_spi_bufs test_spi_buffer_sets
+ * @brief TestPurpose: verify buffer set and asynchronous SPI transactions
+ *                     with the controller in loopback mode
+ * - API coverage
+ *   -# spi_transceive_bufs spi_transceive_bufs_async
+ *   -# spi_transceive
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <spi.h>
+
+#define SPI_DEV_NAME		CONFIG_SPI_0_NAME
+#define SPI_SLAVE		1
+#define SPI_MAX_CLK_FREQ_250KHZ	128
+
+static struct spi_config spi_conf = {
+	.config = SPI_MODE_LOOP | SPI_WORD(8),
+	.max_sys_freq = SPI_MAX_CLK_FREQ_250KHZ,
+};
+
+static struct device *spi_dev;
+
+/* a flash style command, address and payload, sent without copies */
+static uint8_t cmd[1] = { 0x02 };
+static uint8_t addr[3] = { 0x01, 0x02, 0x03 };
+static uint8_t payload[12] = "loopback ok";
+static uint8_t rx_payload[sizeof(payload)];
+static uint8_t rx_all[32];
+
+static const struct spi_buf tx_bufs[] = {
+	{ .buf = cmd, .len = sizeof(cmd) },
+	{ .buf = addr, .len = sizeof(addr) },
+	{ .buf = payload, .len = sizeof(payload) },
+};
+
+static void test_spi_setup(void)
+{
+	spi_dev = device_get_binding(SPI_DEV_NAME);
+	assert_not_null(spi_dev, "no SPI device");
+
+	assert_equal(spi_slave_select(spi_dev, SPI_SLAVE), 0,
+		     "slave select failed");
+}
+
+static void test_spi_bufs(void)
+{
+	const struct spi_buf rx_bufs[] = {
+		/* command and address frames are dropped */
+		{ .buf = NULL, .len = sizeof(cmd) + sizeof(addr) },
+		{ .buf = rx_payload, .len = sizeof(rx_payload) },
+	};
+
+	memset(rx_payload, 0, sizeof(rx_payload));
+
+	assert_equal(spi_transceive_bufs(spi_dev, &spi_conf,
+					 tx_bufs, ARRAY_SIZE(tx_bufs),
+					 rx_bufs, ARRAY_SIZE(rx_bufs)), 0,
+		     "transceive failed");
+	assert_equal(memcmp(rx_payload, payload, sizeof(payload)), 0,
+		     "wrong payload received");
+}
+
+static void test_spi_bufs_rx_longer(void)
+{
+	const struct spi_buf rx_bufs[] = {
+		{ .buf = rx_all, .len = sizeof(rx_all) },
+	};
+
+	memset(rx_all, 0xff, sizeof(rx_all));
+
+	/* the receive set is longer, dummy frames of zeros fill the gap */
+	assert_equal(spi_transceive_bufs(spi_dev, NULL, tx_bufs, 2,
+					 rx_bufs, ARRAY_SIZE(rx_bufs)), 0,
+		     "transceive failed");
+	assert_equal(rx_all[0], cmd[0], "wrong command received");
+	assert_equal(memcmp(rx_all + 1, addr, sizeof(addr)), 0,
+		     "wrong address received");
+	assert_equal(rx_all[sizeof(rx_all) - 1], 0, "wrong dummy frame");
+}
+
+static void test_spi_bufs_tx_only(void)
+{
+	/* nothing to receive into, the set length comes from tx only */
+	assert_equal(spi_transceive_bufs(spi_dev, NULL,
+					 tx_bufs, ARRAY_SIZE(tx_bufs),
+					 NULL, 0), 0, "write failed");
+}
+
+static void test_spi_async(void)
+{
+	struct k_poll_signal signal = K_POLL_SIGNAL_INITIALIZER();
+	struct k_poll_event event = K_POLL_EVENT_INITIALIZER(
+		K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &signal);
+	const struct spi_buf rx_bufs[] = {
+		{ .buf = NULL, .len = sizeof(cmd) + sizeof(addr) },
+		{ .buf = rx_payload, .len = sizeof(rx_payload) },
+	};
+
+	memset(rx_payload, 0, sizeof(rx_payload));
+
+	assert_equal(spi_transceive_bufs_async(spi_dev, &spi_conf,
+					       tx_bufs, ARRAY_SIZE(tx_bufs),
+					       rx_bufs, ARRAY_SIZE(rx_bufs),
+					       &signal), 0,
+		     "async transceive failed");
+
+	assert_equal(k_poll(&event, 1, 1000), 0, "no completion signal");
+	assert_equal(signal.signaled, 1, "signal not raised");
+	assert_equal(signal.result, 0, "transaction failed");
+	assert_equal(memcmp(rx_payload, payload, sizeof(payload)), 0,
+		     "wrong payload received");
+
+	/* a blocking transaction right after waits for the bus to be free */
+	signal.signaled = 0;
+	event.state = K_POLL_STATE_NOT_READY;
+	assert_equal(spi_transceive_bufs_async(spi_dev, NULL,
+					       tx_bufs, ARRAY_SIZE(tx_bufs),
+					       NULL, 0, &signal), 0,
+		     "async write failed");
+	assert_equal(spi_transceive_bufs(spi_dev, NULL,
+					 tx_bufs, ARRAY_SIZE(tx_bufs),
+					 rx_bufs, ARRAY_SIZE(rx_bufs)), 0,
+		     "transceive failed");
+	assert_equal(signal.signaled, 1, "first transaction not over");
+}
+
+static void test_spi_legacy(void)
+{
+	memset(rx_payload, 0, sizeof(rx_payload));
+
+	assert_equal(spi_configure(spi_dev, &spi_conf), 0, "config failed");
+	assert_equal(spi_transceive(spi_dev, payload, sizeof(payload),
+				    rx_payload, sizeof(rx_payload)), 0,
+		     "transceive failed");
+	assert_equal(memcmp(rx_payload, payload, sizeof(payload)), 0,
+		     "wrong data received");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(spi_loopback_test,
+			 ztest_unit_test(test_spi_setup),
+			 ztest_unit_test(test_spi_bufs),
+			 ztest_unit_test(test_spi_bufs_rx_longer),
+			 ztest_unit_test(test_spi_bufs_tx_only),
+			 ztest_unit_test(test_spi_async),
+			 ztest_unit_test(test_spi_legacy));
+	ztest_run_test_suite(spi_loopback_test);
+}
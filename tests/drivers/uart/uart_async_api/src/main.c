@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_uart_async
+ * @{
+ * @defgroup t_uart_async_api test_uart_async_api
+ * @brief TestPurpose: verify the asynchronous UART API on a port put in
+ *                     internal loopback
+ * - API coverage
+ *   -# uart_callback_set
+ *   -# uart_tx uart_tx_abort
+ *   -# uart_rx_enable uart_rx_buf_rsp uart_rx_disable
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <uart.h>
+
+#include "uart_ns16550.h"
+
+#define UART_NAME	CONFIG_UART_NS16550_PORT_1_NAME
+#define RX_TIMEOUT	10
+#define EVT_TIMEOUT	500
+#define BULK_SIZE	4096
+#define BULK_BUF_SIZE	256
+
+static struct device *uart_dev;
+
+static uint8_t tx_buf[BULK_BUF_SIZE];
+static uint8_t rx_bufs[2][BULK_BUF_SIZE];
+static uint8_t rx_data[BULK_BUF_SIZE];
+
+static struct k_sem tx_sem;
+static struct k_sem rx_sem;
+static struct k_sem rx_disabled_sem;
+
+static volatile enum uart_event_type tx_type;
+static volatile size_t tx_len;
+static volatile size_t rx_total;
+static volatile size_t rx_events;
+static volatile int rx_released;
+static volatile bool rx_provide;
+static volatile int rx_next;
+static volatile size_t rx_buf_len;
+
+static void uart_cb(struct uart_event *evt, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	switch (evt->type) {
+	case UART_TX_DONE:
+	case UART_TX_ABORTED:
+		tx_type = evt->type;
+		tx_len = evt->data.tx.len;
+		k_sem_give(&tx_sem);
+		break;
+	case UART_RX_RDY:
+		if (rx_total + evt->data.rx.len <= sizeof(rx_data)) {
+			memcpy(rx_data + rx_total,
+			       evt->data.rx.buf + evt->data.rx.offset,
+			       evt->data.rx.len);
+		}
+		rx_total += evt->data.rx.len;
+		rx_events++;
+		k_sem_give(&rx_sem);
+		break;
+	case UART_RX_BUF_REQUEST:
+		if (rx_provide) {
+			uart_rx_buf_rsp(uart_dev, rx_bufs[rx_next], rx_buf_len);
+			rx_next = !rx_next;
+		}
+		break;
+	case UART_RX_BUF_RELEASED:
+		rx_released++;
+		break;
+	case UART_RX_DISABLED:
+		k_sem_give(&rx_disabled_sem);
+		break;
+	}
+}
+
+static void rx_reset(bool provide, size_t buf_len)
+{
+	k_sem_reset(&tx_sem);
+	k_sem_reset(&rx_sem);
+	k_sem_reset(&rx_disabled_sem);
+
+	rx_total = 0;
+	rx_events = 0;
+	rx_released = 0;
+	rx_provide = provide;
+	rx_next = 1;
+	rx_buf_len = buf_len;
+
+	memset(rx_data, 0, sizeof(rx_data));
+	memset(rx_bufs, 0, sizeof(rx_bufs));
+}
+
+static void wait_rx(size_t len)
+{
+	while (rx_total < len) {
+		assert_equal(k_sem_take(&rx_sem, EVT_TIMEOUT), 0,
+			     "data not received");
+	}
+}
+
+static void fill_tx(size_t len, uint8_t seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		tx_buf[i] = seed + i;
+	}
+}
+
+static void test_async_setup(void)
+{
+	uart_dev = device_get_binding(UART_NAME);
+	assert_not_null(uart_dev, "no UART device");
+
+	k_sem_init(&tx_sem, 0, 1);
+	k_sem_init(&rx_sem, 0, UINT_MAX);
+	k_sem_init(&rx_disabled_sem, 0, 1);
+
+	assert_equal(uart_drv_cmd(uart_dev, CMD_SET_LOOPBACK, 1), 0,
+		     "cannot enable loopback");
+	assert_equal(uart_callback_set(uart_dev, uart_cb, NULL), 0,
+		     "cannot set callback");
+}
+
+static void test_async_tx_rx(void)
+{
+	rx_reset(false, 0);
+	fill_tx(32, 0x20);
+
+	assert_equal(uart_rx_enable(uart_dev, rx_bufs[0], 64, RX_TIMEOUT), 0,
+		     "rx enable failed");
+	assert_equal(uart_rx_enable(uart_dev, rx_bufs[0], 64, RX_TIMEOUT),
+		     -EBUSY, "rx enabled twice");
+
+	assert_equal(uart_tx(uart_dev, tx_buf, 32), 0, "tx failed");
+	assert_equal(k_sem_take(&tx_sem, EVT_TIMEOUT), 0, "tx not done");
+	assert_equal(tx_type, UART_TX_DONE, "wrong tx event");
+	assert_equal(tx_len, 32, "wrong tx length");
+
+	/* less than the buffer: only the idle timeout reports it */
+	wait_rx(32);
+	assert_equal(rx_total, 32, "wrong rx length");
+	assert_equal(memcmp(rx_data, tx_buf, 32), 0, "wrong rx data");
+	assert_equal(rx_released, 0, "buffer released early");
+
+	assert_equal(uart_rx_disable(uart_dev), 0, "rx disable failed");
+	assert_equal(k_sem_take(&rx_disabled_sem, EVT_TIMEOUT), 0,
+		     "rx not disabled");
+	assert_equal(rx_released, 1, "buffer not released");
+	assert_equal(uart_rx_disable(uart_dev), -EFAULT,
+		     "rx disabled twice");
+}
+
+static void test_async_double_buffer(void)
+{
+	rx_reset(true, 16);
+	fill_tx(40, 0x40);
+
+	assert_equal(uart_rx_enable(uart_dev, rx_bufs[0], 16, RX_TIMEOUT), 0,
+		     "rx enable failed");
+
+	/* spans three buffers, the callback keeps providing the next one */
+	assert_equal(uart_tx(uart_dev, tx_buf, 40), 0, "tx failed");
+	assert_equal(k_sem_take(&tx_sem, EVT_TIMEOUT), 0, "tx not done");
+
+	wait_rx(40);
+	assert_equal(rx_total, 40, "wrong rx length");
+	assert_equal(memcmp(rx_data, tx_buf, 40), 0, "wrong rx data");
+	assert_equal(rx_released, 2, "full buffers not released");
+
+	/* without a next buffer reception stops once the buffer is full */
+	rx_provide = false;
+	k_sem_reset(&rx_disabled_sem);
+	assert_equal(uart_tx(uart_dev, tx_buf, 24), 0, "tx failed");
+	assert_equal(k_sem_take(&rx_disabled_sem, EVT_TIMEOUT), 0,
+		     "rx not stopped");
+	assert_equal(rx_total, 40 + 8 + 16, "wrong rx length");
+	assert_equal(uart_rx_disable(uart_dev), -EFAULT,
+		     "rx still enabled");
+
+	k_sem_take(&tx_sem, EVT_TIMEOUT);
+}
+
+static void test_async_tx_abort(void)
+{
+	rx_reset(false, 0);
+	fill_tx(BULK_BUF_SIZE, 0);
+
+	/* swallow what gets through, so that later tests start clean */
+	assert_equal(uart_rx_enable(uart_dev, rx_bufs[0], BULK_BUF_SIZE,
+				    RX_TIMEOUT), 0, "rx enable failed");
+
+	assert_equal(uart_tx_abort(uart_dev), -EFAULT, "idle tx aborted");
+
+	assert_equal(uart_tx(uart_dev, tx_buf, BULK_BUF_SIZE), 0, "tx failed");
+	assert_equal(uart_tx(uart_dev, tx_buf, 1), -EBUSY,
+		     "second tx accepted");
+
+	/* the transfer may already be over on a fast port */
+	if (uart_tx_abort(uart_dev) == 0) {
+		assert_equal(k_sem_take(&tx_sem, EVT_TIMEOUT), 0,
+			     "no tx event");
+		assert_equal(tx_type, UART_TX_ABORTED, "wrong tx event");
+		assert_true(tx_len <= BULK_BUF_SIZE, "wrong tx length");
+	} else {
+		assert_equal(k_sem_take(&tx_sem, EVT_TIMEOUT), 0,
+			     "no tx event");
+		assert_equal(tx_type, UART_TX_DONE, "wrong tx event");
+	}
+
+	assert_equal(uart_tx(uart_dev, tx_buf, 1), 0, "tx after abort failed");
+	assert_equal(k_sem_take(&tx_sem, EVT_TIMEOUT), 0, "tx not done");
+
+	k_sleep(4 * RX_TIMEOUT);
+	assert_true(rx_total > 0, "nothing received");
+	assert_equal(uart_rx_disable(uart_dev), 0, "rx disable failed");
+}
+
+static volatile uint32_t idle_count;
+static volatile bool idle_run;
+
+static void idle_counter(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (idle_run) {
+		idle_count++;
+	}
+}
+
+#define COUNTER_STACK_SIZE	512
+static char __stack counter_stack[COUNTER_STACK_SIZE];
+
+static uint32_t count_during(size_t len)
+{
+	uint32_t start_count;
+	size_t sent;
+
+	idle_count = 0;
+	idle_run = true;
+	k_thread_spawn(counter_stack, COUNTER_STACK_SIZE, idle_counter,
+		       NULL, NULL, NULL, K_LOWEST_APPLICATION_THREAD_PRIO, 0,
+		       K_NO_WAIT);
+
+	start_count = idle_count;
+
+	if (len) {
+		for (sent = 0; sent < len; sent += BULK_BUF_SIZE) {
+			assert_equal(uart_tx(uart_dev, tx_buf, BULK_BUF_SIZE),
+				     0, "tx failed");
+			assert_equal(k_sem_take(&tx_sem, EVT_TIMEOUT), 0,
+				     "tx not done");
+		}
+		wait_rx(len);
+	} else {
+		k_sleep(100);
+	}
+
+	idle_run = false;
+	k_sleep(1);
+
+	return idle_count - start_count;
+}
+
+/* report throughput and the CPU left to other threads during a transfer */
+static void test_async_throughput(void)
+{
+	uint32_t start, us, ms, baseline, busy;
+
+	rx_reset(true, BULK_BUF_SIZE);
+	fill_tx(BULK_BUF_SIZE, 0x80);
+
+	assert_equal(uart_rx_enable(uart_dev, rx_bufs[0], BULK_BUF_SIZE,
+				    RX_TIMEOUT), 0, "rx enable failed");
+
+	start = k_cycle_get_32();
+	busy = count_during(BULK_SIZE);
+	us = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start) / 1000;
+
+	/* counts per millisecond with nothing else running */
+	start = k_cycle_get_32();
+	baseline = count_during(0);
+	ms = SYS_CLOCK_HW_CYCLES_TO_NS64(k_cycle_get_32() - start) / 1000000;
+	baseline = ms ? baseline / ms : 0;
+
+	assert_equal(rx_total, BULK_SIZE, "wrong rx length");
+	assert_equal(memcmp(rx_data, tx_buf, BULK_BUF_SIZE), 0,
+		     "wrong rx data");
+
+	TC_PRINT("%u B in %u us, %u B/s, %u RX events, %u%% CPU left\n",
+		 BULK_SIZE, us,
+		 us ? (uint32_t)((uint64_t)BULK_SIZE * 1000000 / us) : 0,
+		 rx_events,
+		 (baseline && us >= 1000) ?
+		 (uint32_t)((uint64_t)busy * 100 / baseline / (us / 1000)) : 0);
+
+	assert_equal(uart_rx_disable(uart_dev), 0, "rx disable failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(uart_async_test,
+			 ztest_unit_test(test_async_setup),
+			 ztest_unit_test(test_async_tx_rx),
+			 ztest_unit_test(test_async_double_buffer),
+			 ztest_unit_test(test_async_tx_abort),
+			 ztest_unit_test(test_async_throughput));
+	ztest_run_test_suite(uart_async_test);
+}
@@ -245,6 +245,96 @@ void memcmp_test(void)
 	assert_true((ret != 0), "memcmp 5");
 }
 
+/*
+ * buffers for the tests of every alignment and length of the word at a
+ * time functions
+ */
+#define ALIGN_SIZE 64
+
+static unsigned char src_buf[ALIGN_SIZE + 8] __aligned(4);
+static unsigned char dst_buf[ALIGN_SIZE + 8] __aligned(4);
+
+/**
+ *
+ * @brief Test memory copy and move functions at every alignment
+ *
+ */
+
+void memcpy_test(void)
+{
+	int s, d, n, i;
+
+	for (s = 0; s < 4; s++) {
+		for (d = 0; d < 4; d++) {
+			for (n = 0; n < ALIGN_SIZE; n++) {
+				for (i = 0; i < sizeof(src_buf); i++) {
+					src_buf[i] = i + 1;
+					dst_buf[i] = 0;
+				}
+
+				memcpy(&dst_buf[d], &src_buf[s], n);
+
+				assert_true(memcmp(&dst_buf[d], &src_buf[s],
+						   n) == 0, "memcpy data");
+				assert_true(dst_buf[d + n] == 0,
+					    "memcpy overrun");
+
+				/* overlapping, forward and backward */
+				memmove(&src_buf[d], &src_buf[s + 4], n);
+				for (i = 0; i < n; i++) {
+					assert_true(src_buf[d + i] ==
+						    s + 4 + i + 1, "memmove");
+				}
+				memmove(&src_buf[s + 4], &src_buf[d], n);
+				for (i = 0; i < n; i++) {
+					assert_true(src_buf[s + 4 + i] ==
+						    s + 4 + i + 1, "memmove");
+				}
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test memory and string scanning functions at every alignment
+ *
+ */
+
+void memchr_test(void)
+{
+	char *str = (char *)src_buf;
+	int s, n;
+
+	for (s = 0; s < 4; s++) {
+		for (n = 0; n < ALIGN_SIZE; n++) {
+			memset(src_buf, 'a', sizeof(src_buf));
+			src_buf[s + n] = '\0';
+
+			assert_equal(strlen(&str[s]), n, "strlen");
+			assert_true(memchr(&str[s], '\0', ALIGN_SIZE) ==
+				    &str[s + n], "memchr");
+			assert_true(strchr(&str[s], '\0') == &str[s + n],
+				    "strchr terminator");
+			assert_true(strchr(&str[s], 'b') == NULL,
+				    "strchr missing");
+
+			memcpy(dst_buf, src_buf, sizeof(dst_buf));
+			assert_true(strcmp(&str[s], (char *)&dst_buf[s]) == 0,
+				    "strcmp equal");
+
+			if (n > 0) {
+				dst_buf[s + n - 1] = 'b';
+				assert_true(strcmp(&str[s],
+						   (char *)&dst_buf[s]) < 0,
+					    "strcmp less");
+				assert_true(memcmp(&str[s], &dst_buf[s], n) < 0,
+					    "memcmp less");
+			}
+		}
+	}
+}
+
 /**
  *
  * @brief Test string operations library
@@ -261,6 +351,8 @@ void string_test(void)
 	strncmp_test();
 	strchr_test();
 	memcmp_test();
+	memcpy_test();
+	memchr_test();
 }
 
 void test_main(void)
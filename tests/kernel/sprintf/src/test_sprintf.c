@@ -27,8 +27,7 @@ This module contains the code for testing sprintf() functionality.
 #define DEADBEEF_PTR_STR       "0xdeadbeef"
 
 /*
- * A really long string (330 characters + NUL).
- * The underlying sprintf() architecture will truncate it.
+ * A really long string (390 characters + NUL).
  */
 #define REALLY_LONG_STRING \
 		"11111111111111111111111111111111111111111111111111111111111111111" \
@@ -38,8 +37,6 @@ This module contains the code for testing sprintf() functionality.
 		"55555555555555555555555555555555555555555555555555555555555555555" \
 		"66666666666666666666666666666666666666666666666666666666666666666"
 
-#define PRINTF_MAX_STRING_LENGTH   200
-
 typedef union {
 	double  d;
 	struct {
@@ -619,14 +616,13 @@ int sprintfStringTest(void)
 	}
 
 	len = sprintf(buffer, "%s", REALLY_LONG_STRING);
-	if (len != PRINTF_MAX_STRING_LENGTH) {
-		TC_ERROR("Internals changed.  Max string length no longer %d\n",
-				 PRINTF_MAX_STRING_LENGTH);
+	if (len != sizeof(REALLY_LONG_STRING) - 1) {
+		TC_ERROR("sprintf(%%s).  Expected %d characters, got %d\n",
+			 sizeof(REALLY_LONG_STRING) - 1, len);
 		status = TC_FAIL;
 	}
-	if (strncmp(buffer, REALLY_LONG_STRING, PRINTF_MAX_STRING_LENGTH) != 0) {
-		TC_ERROR("First %d characters of REALLY_LONG_STRING not printed!\n",
-				 PRINTF_MAX_STRING_LENGTH);
+	if (strcmp(buffer, REALLY_LONG_STRING) != 0) {
+		TC_ERROR("REALLY_LONG_STRING not printed!\n");
 		status = TC_FAIL;
 	}
 
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2017 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_kvs
+ * @{
+ * @defgroup t_kvs_basic test_kvs_basic_operations
+ * @brief TestPurpose: verify the flash key-value store on the flash
+ *                     simulator
+ * - API coverage
+ *   -# kvs_init kvs_clear
+ *   -# kvs_write kvs_read kvs_delete
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <flash.h>
+#include <kvs.h>
+
+#define SECTOR_SIZE	4096
+#define SECTOR_COUNT	4
+
+static struct kvs_fs fs = {
+	.offset = 0,
+	.sector_size = SECTOR_SIZE,
+	.sector_count = SECTOR_COUNT,
+};
+
+/* with its header, three such records fill a sector */
+#define BIG_LEN		1016
+
+static uint8_t buf[128];
+static uint8_t big[BIG_LEN];
+
+static void remount(void)
+{
+	assert_equal(kvs_init(&fs, CONFIG_FLASH_SIMULATOR_DEV_NAME), 0,
+		     "mount failed");
+}
+
+static void check_record(uint16_t id, uint8_t fill, size_t len)
+{
+	size_t i;
+
+	memset(buf, 0, sizeof(buf));
+	assert_equal(kvs_read(&fs, id, buf, sizeof(buf)), len,
+		     "wrong record length");
+
+	for (i = 0; i < len; i++) {
+		assert_equal(buf[i], (uint8_t)(fill + i), "wrong record data");
+	}
+}
+
+static void write_record(uint16_t id, uint8_t fill, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		buf[i] = fill + i;
+	}
+
+	assert_equal(kvs_write(&fs, id, buf, len), 0, "write failed");
+}
+
+static int write_big(uint16_t id, uint8_t fill)
+{
+	memset(big, fill, sizeof(big));
+
+	return kvs_write(&fs, id, big, sizeof(big));
+}
+
+static void check_big(uint16_t id, uint8_t fill)
+{
+	memset(big, ~fill, sizeof(big));
+	assert_equal(kvs_read(&fs, id, big, sizeof(big)), sizeof(big),
+		     "wrong record length");
+	assert_equal(big[0], fill, "wrong record data");
+	assert_equal(big[sizeof(big) - 1], fill, "wrong record data");
+}
+
+static void test_kvs_init(void)
+{
+	struct kvs_fs bad = {
+		.sector_size = SECTOR_SIZE,
+		.sector_count = 1,
+	};
+
+	assert_equal(kvs_init(&bad, CONFIG_FLASH_SIMULATOR_DEV_NAME), -EINVAL,
+		     "one sector store accepted");
+	assert_equal(kvs_init(&fs, "NO_SUCH_DEVICE"), -ENODEV,
+		     "missing device accepted");
+
+	remount();
+	assert_equal(kvs_clear(&fs), 0, "clear failed");
+}
+
+static void test_kvs_write_read(void)
+{
+	uint8_t small[2];
+
+	/* lengths around the write block size exercise the padding */
+	write_record(1, 0x10, 1);
+	write_record(2, 0x20, 3);
+	write_record(3, 0x30, 4);
+	write_record(4, 0x40, 5);
+	write_record(5, 0x50, sizeof(buf));
+
+	check_record(1, 0x10, 1);
+	check_record(2, 0x20, 3);
+	check_record(3, 0x30, 4);
+	check_record(4, 0x40, 5);
+	check_record(5, 0x50, sizeof(buf));
+
+	/* a short buffer gets the start of the record and its full length */
+	assert_equal(kvs_read(&fs, 5, small, sizeof(small)), sizeof(buf),
+		     "wrong record length");
+	assert_equal(small[1], 0x51, "wrong record data");
+
+	assert_equal(kvs_read(&fs, 6, buf, sizeof(buf)), -ENOENT,
+		     "missing record found");
+	assert_equal(kvs_write(&fs, KVS_ID_INVALID, buf, 1), -EINVAL,
+		     "invalid id accepted");
+	assert_equal(kvs_write(&fs, 6, buf, 0), -EINVAL,
+		     "empty record accepted");
+}
+
+static void test_kvs_overwrite(void)
+{
+	uint32_t writes;
+	uint32_t skipped;
+
+	write_record(1, 0x11, 8);
+	check_record(1, 0x11, 8);
+
+	writes = fs.stats.writes;
+	skipped = fs.stats.skipped_writes;
+
+	/* unchanged data must not reach the flash */
+	write_record(1, 0x11, 8);
+	assert_equal(fs.stats.writes, writes, "unchanged record written");
+	assert_equal(fs.stats.skipped_writes, skipped + 1,
+		     "unchanged write not skipped");
+
+	write_record(1, 0x12, 8);
+	assert_equal(fs.stats.writes, writes + 1, "changed record skipped");
+	check_record(1, 0x12, 8);
+}
+
+static void test_kvs_delete(void)
+{
+	assert_equal(kvs_delete(&fs, 2), 0, "delete failed");
+	assert_equal(kvs_read(&fs, 2, buf, sizeof(buf)), -ENOENT,
+		     "deleted record found");
+	assert_equal(kvs_delete(&fs, 2), -ENOENT, "record deleted twice");
+
+	check_record(3, 0x30, 4);
+}
+
+static void test_kvs_gc(void)
+{
+	uint32_t erases = fs.stats.erases;
+	int i;
+
+	/* several times the store size, so every sector gets reclaimed */
+	for (i = 0; i < 4 * SECTOR_COUNT * SECTOR_SIZE / sizeof(buf); i++) {
+		write_record(10 + (i % 4), i, sizeof(buf));
+	}
+
+	assert_true(fs.stats.erases > erases, "no garbage collection");
+	assert_true(fs.stats.gc_copies > 0, "no live record copied");
+
+	for (i -= 4; i < 4 * SECTOR_COUNT * SECTOR_SIZE / sizeof(buf); i++) {
+		check_record(10 + (i % 4), i, sizeof(buf));
+	}
+
+	check_record(1, 0x12, 8);
+	check_record(3, 0x30, 4);
+	assert_equal(kvs_read(&fs, 2, buf, sizeof(buf)), -ENOENT,
+		     "deleted record came back");
+}
+
+static void test_kvs_remount(void)
+{
+	remount();
+
+	check_record(1, 0x12, 8);
+	check_record(3, 0x30, 4);
+	check_record(4, 0x40, 5);
+	check_record(5, 0x50, sizeof(buf));
+	assert_equal(kvs_read(&fs, 2, buf, sizeof(buf)), -ENOENT,
+		     "deleted record came back");
+}
+
+static void test_kvs_torn_write(void)
+{
+	struct device *dev = device_get_binding(CONFIG_FLASH_SIMULATOR_DEV_NAME);
+	/* id 3 with a bad CRC, as left by a reset in the middle of a write */
+	uint16_t hdr[4] = { 3, 4, 0x1234, 0xffff };
+
+	assert_not_null(dev, "no flash device");
+	assert_equal(flash_write_pages(dev, fs.offset + fs.write_addr, hdr,
+				       sizeof(hdr)), 0, "flash write failed");
+
+	remount();
+	check_record(3, 0x30, 4);
+
+	write_record(3, 0x33, 4);
+	remount();
+	check_record(3, 0x33, 4);
+}
+
+static void test_kvs_index_full(void)
+{
+	int i;
+
+	assert_equal(kvs_clear(&fs), 0, "clear failed");
+
+	for (i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		write_record(100 + i, i, 4);
+	}
+
+	assert_equal(kvs_write(&fs, 99, buf, 4), -ENOMEM,
+		     "index overflow not detected");
+
+	/* existing records can still be updated */
+	write_record(100, 0xaa, 4);
+
+	remount();
+	for (i = 1; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		check_record(100 + i, i, 4);
+	}
+	check_record(100, 0xaa, 4);
+}
+
+static void test_kvs_full(void)
+{
+	uint32_t erases;
+	int i;
+
+	assert_equal(kvs_clear(&fs), 0, "clear failed");
+
+	/* live records in all the sectors but the spare one */
+	for (i = 0; i < 3 * (SECTOR_COUNT - 1); i++) {
+		assert_equal(write_big(200 + i, i), 0, "write failed");
+	}
+
+	/* no room left, and the flash must be left alone */
+	erases = fs.stats.erases;
+	assert_equal(write_big(300, 0), -ENOSPC, "full store written");
+	assert_equal(write_big(200, 0xaa), -ENOSPC, "full store overwritten");
+	assert_equal(fs.stats.erases, erases, "full store erased");
+
+	/* a deleted record makes room for overwrites */
+	assert_equal(kvs_delete(&fs, 200), 0, "delete failed");
+
+	for (i = 0; i < 12 * SECTOR_COUNT; i++) {
+		assert_equal(write_big(201 + i % 8, i), 0, "overwrite failed");
+	}
+
+	assert_true(fs.stats.erases > erases, "no garbage collection");
+
+	/* the room of the deleted record, and no more */
+	assert_equal(write_big(300, 0xcc), 0, "write failed");
+
+	erases = fs.stats.erases;
+	assert_equal(write_big(301, 0), -ENOSPC, "full store written");
+	assert_equal(fs.stats.erases, erases, "full store erased");
+
+	remount();
+	for (i = 12 * SECTOR_COUNT - 8; i < 12 * SECTOR_COUNT; i++) {
+		check_big(201 + i % 8, i);
+	}
+	check_big(300, 0xcc);
+	assert_equal(kvs_read(&fs, 200, big, sizeof(big)), -ENOENT,
+		     "deleted record came back");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(kvs_test,
+			 ztest_unit_test(test_kvs_init),
+			 ztest_unit_test(test_kvs_write_read),
+			 ztest_unit_test(test_kvs_overwrite),
+			 ztest_unit_test(test_kvs_delete),
+			 ztest_unit_test(test_kvs_gc),
+			 ztest_unit_test(test_kvs_remount),
+			 ztest_unit_test(test_kvs_torn_write),
+			 ztest_unit_test(test_kvs_index_full),
+			 ztest_unit_test(test_kvs_full));
+	ztest_run_test_suite(kvs_test);
+}
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <json.h>
+
+struct test_nested {
+	int32_t nested_int;
+	bool nested_bool;
+	const char *nested_string;
+};
+
+struct test_struct {
+	const char *some_string;
+	int32_t some_int;
+	bool some_bool;
+	struct test_nested some_nested_struct;
+	int32_t some_array[16];
+	size_t some_array_len;
+	struct test_nested some_obj_array[2];
+	size_t some_obj_array_len;
+};
+
+static const struct json_obj_descr nested_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct test_nested, nested_int, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct test_nested, nested_bool, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct test_nested, nested_string,
+			    JSON_TOK_STRING),
+};
+
+static const struct json_obj_descr test_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct test_struct, some_string, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct test_struct, some_int, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct test_struct, some_bool, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_OBJECT(struct test_struct, some_nested_struct,
+			      nested_descr),
+	JSON_OBJ_DESCR_ARRAY(struct test_struct, some_array, some_array_len,
+			     JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct test_struct, some_obj_array,
+				 some_obj_array_len, nested_descr),
+};
+
+#define ENCODED "{\"some_string\":\"zephyr \\\"123\\\"\\n\"," \
+	"\"some_int\":-42,\"some_bool\":true," \
+	"\"some_nested_struct\":{\"nested_int\":-1234," \
+	"\"nested_bool\":false,\"nested_string\":\"this should be escaped: \\t\"}," \
+	"\"some_array\":[1,4,8,16,32]," \
+	"\"some_obj_array\":[{\"nested_int\":1,\"nested_bool\":true," \
+	"\"nested_string\":\"a\"},{\"nested_int\":-2147483648," \
+	"\"nested_bool\":false,\"nested_string\":null}]}"
+
+static const struct test_struct ts = {
+	.some_string = "zephyr \"123\"\n",
+	.some_int = -42,
+	.some_bool = true,
+	.some_nested_struct = {
+		.nested_int = -1234,
+		.nested_bool = false,
+		.nested_string = "this should be escaped: \t",
+	},
+	.some_array = { 1, 4, 8, 16, 32 },
+	.some_array_len = 5,
+	.some_obj_array = {
+		{ .nested_int = 1, .nested_bool = true,
+		  .nested_string = "a" },
+		{ .nested_int = INT32_MIN, .nested_bool = false,
+		  .nested_string = NULL },
+	},
+	.some_obj_array_len = 2,
+};
+
+static void test_json_encoding(void)
+{
+	char buffer[sizeof(ENCODED)];
+	ssize_t len;
+	int ret;
+
+	len = json_calc_encoded_len(test_descr, ARRAY_SIZE(test_descr), &ts);
+	assert_equal(len, sizeof(ENCODED) - 1, "Encoded length not correct");
+
+	ret = json_obj_encode_buf(test_descr, ARRAY_SIZE(test_descr), &ts,
+				  buffer, sizeof(buffer));
+	assert_equal(ret, 0, "Encoding function failed");
+	assert_true(!strcmp(buffer, ENCODED), "Encoded contents not correct");
+
+	ret = json_obj_encode_buf(test_descr, ARRAY_SIZE(test_descr), &ts,
+				  buffer, sizeof(buffer) - 1);
+	assert_equal(ret, -ENOMEM, "Encoding did not detect short buffer");
+}
+
+static void test_json_decoding(void)
+{
+	struct test_struct ts_decoded = {};
+	char encoded[] = "{\"some_string\":\"zephyr 123\","
+		"\"unknown_obj\":{\"a\":[1,{\"b\":[]}],\"c\":{}},"
+		"\"some_int\":42,\"some_bool\":true,"
+		"\"some_nested_struct\":{\"nested_int\":-1234,"
+		"\"nested_bool\":false,\"nested_string\":\"this is a string\"},"
+		"\"some_array\":[11,22, 33,\t45,\n299],"
+		"\"unknown_array\":[[1],[2]],"
+		"\"some_obj_array\":[{\"nested_int\":7,\"nested_bool\":true,"
+		"\"nested_string\":\"x\"}]}";
+	int ret;
+
+	ret = json_obj_parse(encoded, sizeof(encoded) - 1, test_descr,
+			     ARRAY_SIZE(test_descr), &ts_decoded);
+
+	assert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+		     "Not all fields decoded correctly");
+	assert_true(!strcmp(ts_decoded.some_string, "zephyr 123"),
+		    "String not decoded correctly");
+	assert_equal(ts_decoded.some_int, 42, "Positive integer not decoded");
+	assert_equal(ts_decoded.some_bool, true, "Boolean not decoded");
+	assert_equal(ts_decoded.some_nested_struct.nested_int, -1234,
+		     "Nested negative integer not decoded");
+	assert_equal(ts_decoded.some_nested_struct.nested_bool, false,
+		     "Nested boolean value not decoded");
+	assert_true(!strcmp(ts_decoded.some_nested_struct.nested_string,
+			    "this is a string"),
+		    "Nested string not decoded");
+	assert_equal(ts_decoded.some_array_len, 5,
+		     "Array doesn't have correct number of items");
+	assert_equal(ts_decoded.some_array[0], 11, "Array element 0 not decoded");
+	assert_equal(ts_decoded.some_array[4], 299,
+		     "Array element 4 not decoded");
+	assert_equal(ts_decoded.some_obj_array_len, 1,
+		     "Object array doesn't have correct number of items");
+	assert_equal(ts_decoded.some_obj_array[0].nested_int, 7,
+		     "Object array element not decoded");
+	assert_true(!strcmp(ts_decoded.some_obj_array[0].nested_string, "x"),
+		    "Object array element string not decoded");
+}
+
+static void test_json_round_trip(void)
+{
+	struct test_struct ts_decoded = {};
+	struct test_struct ts_plain = ts;
+	char buffer[sizeof(ENCODED)];
+	int ret;
+
+	/* Strings are not unescaped by the parser */
+	ts_plain.some_string = "zephyr";
+	ts_plain.some_nested_struct.nested_string = "nested";
+	ts_plain.some_obj_array[1].nested_string = "b";
+
+	ret = json_obj_encode_buf(test_descr, ARRAY_SIZE(test_descr),
+				  &ts_plain, buffer, sizeof(buffer));
+	assert_equal(ret, 0, "Encoding function failed");
+
+	ret = json_obj_parse(buffer, strlen(buffer), test_descr,
+			     ARRAY_SIZE(test_descr), &ts_decoded);
+	assert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+		     "Encoded object not decoded");
+	assert_equal(ts_decoded.some_obj_array[1].nested_int, INT32_MIN,
+		     "Smallest integer not decoded");
+	assert_equal(ts_decoded.some_array_len, ts_plain.some_array_len,
+		     "Array length not decoded");
+	assert_true(!memcmp(ts_decoded.some_array, ts_plain.some_array,
+			    sizeof(ts_plain.some_array)),
+		    "Array not decoded");
+}
+
+static void test_json_invalid(void)
+{
+	struct test_struct ts_decoded = {};
+	char too_many[] = "{\"some_obj_array\":[{},{},{}]}";
+	char unterminated[] = "{\"some_array\":[1,2";
+	char bad_separator[] = "{\"some_array\":[1:2]}";
+	char wrong_type[] = "{\"some_nested_struct\":[1]}";
+	const struct json_obj_descr obj_array_descr[] = {
+		JSON_OBJ_DESCR_OBJ_ARRAY(struct test_struct, some_obj_array,
+					 some_obj_array_len, nested_descr),
+	};
+	int ret;
+
+	ret = json_obj_parse(too_many, sizeof(too_many) - 1, obj_array_descr,
+			     ARRAY_SIZE(obj_array_descr), &ts_decoded);
+	assert_true(ret < 0, "Array overflow not detected");
+
+	ret = json_obj_parse(unterminated, sizeof(unterminated) - 1,
+			     test_descr, ARRAY_SIZE(test_descr), &ts_decoded);
+	assert_equal(ret, -EINVAL, "Unterminated array not detected");
+
+	ret = json_obj_parse(bad_separator, sizeof(bad_separator) - 1,
+			     test_descr, ARRAY_SIZE(test_descr), &ts_decoded);
+	assert_equal(ret, -EINVAL, "Bad separator not detected");
+
+	ret = json_obj_parse(wrong_type, sizeof(wrong_type) - 1,
+			     test_descr, ARRAY_SIZE(test_descr), &ts_decoded);
+	assert_equal(ret, -EINVAL, "Wrong type not detected");
+}
+
+static const char stream_encoded[] = "{\"some_string\":\"zephyr \\\"123\\\"\","
+	"\"unknown_obj\":{\"a\":[1,{\"b\":[\"x\"]}],\"c\":{}},"
+	"\"some_int\":-2147483648,\"some_bool\":false,"
+	"\"some_nested_struct\":{\"nested_string\":\"out of order\","
+	"\"nested_bool\":true,\"nested_int\":2147483647},"
+	"\"some_array\":[11,22, 33,\t45,\n299],"
+	"\"some_obj_array\":[{\"nested_int\":7,\"nested_bool\":true,"
+	"\"nested_string\":\"x\"}]}trailing";
+
+static void test_json_stream(void)
+{
+	struct json_obj_stream stream;
+	struct test_struct ts_decoded;
+	char storage[64];
+	size_t chunk, pos;
+	int ret;
+
+	/* Any split of the input decodes the same */
+	for (chunk = 1; chunk < sizeof(stream_encoded); chunk++) {
+		memset(&ts_decoded, 0, sizeof(ts_decoded));
+		json_obj_stream_init(&stream, test_descr,
+				     ARRAY_SIZE(test_descr), &ts_decoded,
+				     storage, sizeof(storage));
+
+		for (pos = 0, ret = -EAGAIN;
+		     pos < sizeof(stream_encoded) - 1 && ret == -EAGAIN;
+		     pos += chunk) {
+			char buf[chunk];
+			size_t len = min(chunk, sizeof(stream_encoded) - 1 - pos);
+
+			/* The buffer is overwritten after each call */
+			memcpy(buf, stream_encoded + pos, len);
+			ret = json_obj_stream_parse(&stream, buf, len);
+			memset(buf, 0, len);
+		}
+
+		assert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+			     "Split object not decoded");
+		assert_true(!strcmp(ts_decoded.some_string,
+				    "zephyr \\\"123\\\""),
+			    "Split string not decoded");
+		assert_equal(ts_decoded.some_int, INT32_MIN,
+			     "Split integer not decoded");
+		assert_equal(ts_decoded.some_bool, false,
+			     "Split boolean not decoded");
+		assert_equal(ts_decoded.some_nested_struct.nested_int,
+			     INT32_MAX, "Nested integer not decoded");
+		assert_true(!strcmp(ts_decoded.some_nested_struct.nested_string,
+				    "out of order"),
+			    "Nested string not decoded");
+		assert_equal(ts_decoded.some_array_len, 5,
+			     "Split array not decoded");
+		assert_equal(ts_decoded.some_array[4], 299,
+			     "Split array element not decoded");
+		assert_true(!strcmp(ts_decoded.some_obj_array[0].nested_string,
+				    "x"),
+			    "Split object array not decoded");
+	}
+
+	/* Strings not fitting in the storage */
+	json_obj_stream_init(&stream, test_descr, ARRAY_SIZE(test_descr),
+			     &ts_decoded, storage, 8);
+	ret = json_obj_stream_parse(&stream, stream_encoded,
+				    sizeof(stream_encoded) - 1);
+	assert_equal(ret, -ENOMEM, "Storage overflow not detected");
+}
+
+static void test_json_numbers(void)
+{
+	const struct json_obj_descr num_descr[] = {
+		JSON_OBJ_DESCR_PRIM(struct test_struct, some_int,
+				    JSON_TOK_NUMBER),
+	};
+	struct test_struct ts_decoded;
+	char too_large[] = "{\"some_int\":2147483648}";
+	char too_small[] = "{\"some_int\":-2147483649}";
+	char fraction[] = "{\"some_int\":1.5}";
+	char sign_only[] = "{\"some_int\":-}";
+	char zero[] = "{\"some_int\":-0}";
+	int ret;
+
+	ret = json_obj_parse(too_large, sizeof(too_large) - 1, num_descr,
+			     ARRAY_SIZE(num_descr), &ts_decoded);
+	assert_equal(ret, -EINVAL, "Overflow not detected");
+
+	ret = json_obj_parse(too_small, sizeof(too_small) - 1, num_descr,
+			     ARRAY_SIZE(num_descr), &ts_decoded);
+	assert_equal(ret, -EINVAL, "Underflow not detected");
+
+	ret = json_obj_parse(fraction, sizeof(fraction) - 1, num_descr,
+			     ARRAY_SIZE(num_descr), &ts_decoded);
+	assert_equal(ret, -EINVAL, "Fraction not rejected");
+
+	ret = json_obj_parse(sign_only, sizeof(sign_only) - 1, num_descr,
+			     ARRAY_SIZE(num_descr), &ts_decoded);
+	assert_equal(ret, -EINVAL, "Sign without digits not rejected");
+
+	ts_decoded.some_int = 1;
+	ret = json_obj_parse(zero, sizeof(zero) - 1, num_descr,
+			     ARRAY_SIZE(num_descr), &ts_decoded);
+	assert_equal(ret, 1, "Negative zero not decoded");
+	assert_equal(ts_decoded.some_int, 0, "Negative zero not decoded");
+}
+
+#define UNKNOWN_KEY "{\"unknown\":"
+#define KNOWN_FIELD ",\"some_int\":1}"
+
+static size_t deep_nesting(char *buf, size_t depth, bool closed)
+{
+	size_t len = strlen(UNKNOWN_KEY);
+
+	memcpy(buf, UNKNOWN_KEY, len);
+	memset(buf + len, '[', depth);
+	len += depth;
+
+	if (closed) {
+		memset(buf + len, ']', depth);
+		len += depth;
+	}
+
+	memcpy(buf + len, KNOWN_FIELD, strlen(KNOWN_FIELD));
+
+	return len + strlen(KNOWN_FIELD);
+}
+
+static void test_json_deep_nesting(void)
+{
+	const struct json_obj_descr num_descr[] = {
+		JSON_OBJ_DESCR_PRIM(struct test_struct, some_int,
+				    JSON_TOK_NUMBER),
+	};
+	struct test_struct ts_decoded;
+	char deep[sizeof(UNKNOWN_KEY KNOWN_FIELD) +
+		  2 * (JSON_MAX_SKIP_DEPTH + 1)];
+	size_t len;
+	int ret;
+
+	len = deep_nesting(deep, JSON_MAX_SKIP_DEPTH, true);
+	ret = json_obj_parse(deep, len, num_descr, ARRAY_SIZE(num_descr),
+			     &ts_decoded);
+	assert_equal(ret, 1, "Deep unknown value not skipped");
+
+	/* One level more must not end the skipped value early */
+	len = deep_nesting(deep, JSON_MAX_SKIP_DEPTH + 1, false);
+	ret = json_obj_parse(deep, len, num_descr, ARRAY_SIZE(num_descr),
+			     &ts_decoded);
+	assert_equal(ret, -EINVAL, "Too deep unknown value not rejected");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lib_json_test,
+			 ztest_unit_test(test_json_encoding),
+			 ztest_unit_test(test_json_decoding),
+			 ztest_unit_test(test_json_round_trip),
+			 ztest_unit_test(test_json_invalid),
+			 ztest_unit_test(test_json_stream),
+			 ztest_unit_test(test_json_numbers),
+			 ztest_unit_test(test_json_deep_nesting)
+		);
+
+	ztest_run_test_suite(lib_json_test);
+}